@@ -0,0 +1,344 @@
+// Copyright (C) Chad McKinney - All Rights Reserved
+// Unauthorized copying of this file, via any medium is strictly prohibited
+// Proprietary and confidential
+
+// SDF scene, shared by the fragment (sdf.frag) and compute (sdf.comp) raymarching paths
+// Includers must define SDF_SHAPE_COUNT and SDF_SHAPE_INDEX(i) before including
+
+////////////////////////////////////////////
+// Constants
+
+const int MAX_MARCHING_STEPS = 255;
+const float MIN_DIST = 0.0;
+const float MAX_DIST = 1000.0;
+const float EPSILON = 0.0001;
+const float FIELD_OF_VIEW = 45.0;
+
+// Shape Enum - keep in sync with code in renderer.cpp
+const int MAX_SHAPES = 256;
+const int SPHERE = 0;
+const int CUBE = 1;
+
+////////////////////////////////////////////
+// Inputs
+
+layout(set=0, binding=1) uniform u_UniformBuffer
+{
+    // we store inverted transform data as this is how we need to use it with SDF functions
+    mat4 u_InvShapeTransforms[MAX_SHAPES];
+};
+
+// Per-frame data, one slice per swap chain image bound with a dynamic offset
+// Keep in sync with vulkan::SFrameUniforms in renderer.cpp
+layout(set = 0, binding = 2) uniform FrameUniforms
+{
+    mat4 u_ViewMatrix;
+    vec2 u_RenderSize; // pixels rendered by the SDF pass, scaled by dynamic resolution
+    vec2 u_OutputSize; // swap chain extent
+    float u_TimeSecs;
+    int u_NumSpheres;
+    int u_NumCubes;
+};
+
+////////////////////////////////////////////
+// SDF helpers
+//
+
+float intersectSDF(float distA, float distB)
+{
+    return max(distA, distB);
+}
+
+float unionSDF(float distA, float distB)
+{
+    return min(distA, distB);
+}
+
+
+float differenceSDF(float distA, float distB)
+{
+    return max(distA, -distB);
+}
+////////////////////////////////////////////
+// SDF scene
+
+float sphereSDF(vec4 samplePos, mat4 invTransform, float radius)
+{
+    return length(vec3(invTransform * samplePos)) - radius;
+}
+
+float cubeSDF(vec4 samplePos, mat4 invTransform, vec3 halfExtents)
+{
+    // if d.x < 0 then -1 < p.x < 1, same for p.y, p.z
+    // so if all components of d are negative, then p is inside the unit cube
+    vec3 d = abs(vec3(invTransform * samplePos)) - halfExtents;
+    float insideDistance = min(max(d.x, max(d.y, d.z)), 0.0);
+
+    // Assuming p is inside the cube, how far is it from the surface?
+    // Result will be negative or zero
+    float outsideDistance = length(max(d, 0.0));
+    return insideDistance + outsideDistance;
+}
+
+float wrap(float f)
+{
+    const float w = 8;
+    return mod(f + w, w * 2) - 2;
+}
+
+/*
+float wobblySphereSDF(vec3 pos)
+{
+    vec3 spherePos = vec3(sin(u_TimeSecs * 0.5) * 0.25, cos(u_TimeSecs * 2) * 0.125, 0.0);
+    float sphereRadius = sin(u_TimeSecs * 4) * 0.75 + 1.5;
+    vec3 cubePos = vec3(cos(u_TimeSecs * 5) * 0.125, sin(u_TimeSecs) * 0.25, 0.0);
+    vec3 cubeHalfExtents = vec3(0.5, 0.5, 0.5) * (sin(u_TimeSecs * 5) * 0.5 + 1);
+    float sphereDist = sphereSDF(pos, spherePos, sphereRadius);
+    float cubeDist = cubeSDF(pos, cubePos, cubeHalfExtents);
+    float d1 = intersectSDF(cubeDist, sphereDist);
+    float d2 = intersectSDF(d1, differenceSDF(-sphereDist * 0.25, -cubeDist * 0.25));
+    return unionSDF(d2, intersectSDF((d2 - d1) * 0.25, ((d1 - d2) * 0.125)) + sphereSDF(pos, spherePos, 0.8));
+}
+
+float boxesAndSphere(vec3 pos)
+{
+    return unionSDF(
+        sphereSDF(pos, vec3(1.0, 1.0, -1.0), 0.5),
+        unionSDF(cubeSDF(pos, vec3(1.0, 0.0, 1.0), vec3(0.5, 0.5, 0.5)),
+        unionSDF(cubeSDF(pos, vec3(-1.0, 0.0, 1.0), vec3(0.5, 0.5, 0.5)),
+        cubeSDF(pos, vec3(0.0, 0.0, 0.0), vec3(0.5, 0.5, 0.5)))));
+}
+*/
+
+
+// Shapes are stored spheres first, then cubes, see EShape in renderer.cpp
+float shapeSDF(vec4 samplePos, int shapeIndex)
+{
+    if (shapeIndex < u_NumSpheres)
+    {
+        return sphereSDF(samplePos, u_InvShapeTransforms[shapeIndex], 1.0);
+    }
+
+    return cubeSDF(samplePos, u_InvShapeTransforms[shapeIndex], vec3(1, 1, 1));
+}
+
+// SDF_SHAPE_COUNT and SDF_SHAPE_INDEX(i) select the shapes marched against, all shapes for the fragment
+// path, the tile's culled list for the compute path
+float sceneSDF(vec3 pos)
+{
+    vec4 pos4 = vec4(pos, 1);
+    float dist = MAX_DIST;
+    for (int i = 0; i < SDF_SHAPE_COUNT; ++i)
+    {
+        dist = unionSDF(dist, shapeSDF(pos4, SDF_SHAPE_INDEX(i)));
+    }
+
+    return dist;
+}
+
+float shortestDistanceToSurface(vec3 eye, vec3 marchingDirection, float start, float end)
+{
+    float depth = start;
+    float dist = 0;
+    for (int i = 0; i < MAX_MARCHING_STEPS; ++i)
+    {
+        dist = sceneSDF(eye + depth * marchingDirection);
+        if (dist < EPSILON)
+        {
+            return depth;
+        }
+
+        depth += dist;
+        if (depth >= end)
+        {
+            return end;
+        }
+    }
+
+    return end;
+}
+
+// pixelCoord is in pixels from the top left of the render region, pixel centers at .5
+vec3 rayDirection(float fieldOfView, vec2 size, vec2 pixelCoord)
+{
+    vec2 xy = pixelCoord - (size / 2.0);
+    float z = size.y / tan(radians(fieldOfView) / 2.0);
+    return normalize(vec3(xy.x, -xy.y, -z));
+}
+
+// Use the gradient of the SDF to estimate the normal on the surface at point p
+vec3 estimateNormal(vec3 p)
+{
+    return normalize(
+        vec3(
+            sceneSDF(vec3(p.x + EPSILON, p.y, p.z)) - sceneSDF(vec3(p.x - EPSILON, p.y, p.z)),
+            sceneSDF(vec3(p.x, p.y + EPSILON, p.z)) - sceneSDF(vec3(p.x, p.y - EPSILON, p.z)),
+            sceneSDF(vec3(p.x, p.y, p.z + EPSILON)) - sceneSDF(vec3(p.x, p.y, p.z - EPSILON))
+        ));
+}
+
+/*
+ * Lighting contribution of a single point light source via Phong illumination
+ *
+ * The vec3 returned is the RGB color of the light's contribution
+ *
+ * k_a: Ambient color
+ * k_d: Diffuse colo
+ * k_s: specular
+ * alpha: shininess coefficient
+ * p: position of point being lit
+ * eye: position of the camera
+ * lightPos: the position of the light
+ * lightIntensity color/intensity of the light
+ */
+
+vec3 phongContributionForLight(
+    vec3 k_d,
+    vec3 k_s,
+    float alpha,
+    vec3 p,
+    vec3 eye,
+    vec3 lightPos,
+    vec3 lightIntensity)
+{
+    vec3 N = estimateNormal(p);
+    vec3 L = normalize(lightPos - p);
+    vec3 V = normalize(eye - p);
+    vec3 R = normalize(reflect(-L, N));
+
+    float dotLN = dot(L, N);
+    float dotRV = dot(R, N);
+
+    // facing away from light
+    if (dotLN < 0.0)
+    {
+        return vec3(0.0, 0.0, 0.0);
+    }
+
+    // facing away from view, apply only diffuse
+    if (dotRV < 0.0)
+    {
+        lightIntensity * (k_d * dotLN);
+    }
+
+    return lightIntensity * (k_d * dotLN + k_s * pow(dotRV, alpha));
+}
+
+/*
+ * Lighting via Phong illumination
+ * 
+ * The vec3 return is the RGB color of that point after lighting is applied
+ * k_a: Ambient color
+ * k_d: Diffuse colo
+ * k_s: specular
+ * alpha: shininess coefficient
+ * p: position of point being lit
+ * eye: position of the camera
+ */
+vec3 phongIllumination(
+    vec3 k_a,
+    vec3 k_d,
+    vec3 k_s,
+    float alpha,
+    vec3 p,
+    vec3 eye)
+{
+    const vec3 ambientLight = 0.5 * vec3(1.0, 1.0, 1.0);
+    vec3 color = ambientLight * k_a;
+
+    vec3 light1Pos = vec3(4.0 * sin(u_TimeSecs * 1.5), 2.0 * sin(u_TimeSecs * 0.25), 4.0 * cos(u_TimeSecs * 1.5));
+    vec3 light1Intensity = vec3(0.6, 0.4, 0.4) + (vec3(0.125) * sin(u_TimeSecs * 16.0));
+
+    color += phongContributionForLight(
+        k_d,
+        k_s,
+        alpha,
+        p,
+        eye,
+        light1Pos,
+        light1Intensity);
+
+    vec3 light2Pos = vec3(4.0 * sin(u_TimeSecs * 0.333), 4.0 * cos(u_TimeSecs * 0.5), 2.0) + eye;
+    vec3 light2Intensity = vec3(0.4, 0.4, 0.6) + (vec3(0.125) * sin(u_TimeSecs * 8.0));
+
+    color += phongContributionForLight(
+        k_d,
+        k_s,
+        alpha,
+        p,
+        eye,
+        light2Pos,
+        light2Intensity);
+
+    return color;
+}
+
+mat3 lookAtMat3(vec3 eye, vec3 lookAt, vec3 up)
+{
+    vec3 forward = normalize(lookAt - eye);
+    vec3 right = normalize(cross(up, forward));
+    vec3 fixedUp = normalize(cross(forward, right));
+    return mat3(
+        right,
+        fixedUp,
+        -forward
+    );
+}
+
+mat4 lookAtMat4(vec3 eye, vec3 lookAt, vec3 up)
+{
+    vec3 forward = normalize(lookAt - eye);
+    vec3 right = normalize(cross(up, forward));
+    vec3 fixedUp = normalize(cross(forward, right));
+    return mat4(
+        vec4(right, 0.0),
+        vec4(fixedUp, 0.0),
+        vec4(-forward, 0.0),
+        vec4(0.0, 0.0, 0.0, 1.0)
+    );
+}
+
+mat3 RotationY(float radians)
+{
+    float sinTheta = sin(radians);
+    float cosTheta = cos(radians);
+    return mat3(
+        vec3(cosTheta, 0.0, -sinTheta),
+        vec3(0.0, 1.0, 0.0),
+        vec3(sinTheta, 0.0, cosTheta));
+}
+
+mat3 RotationZ(float radians)
+{
+    float sinTheta = sin(radians);
+    float cosTheta = cos(radians);
+    return mat3(
+        vec3(cosTheta, sinTheta, 0.0),
+        vec3(-sinTheta, cosTheta, 0.0),
+        vec3(0.0, 0.0, 1.0));
+}
+
+////////////////////////////////////////////
+// Shading
+
+vec4 shadeSDF(vec2 pixelCoord)
+{
+    vec3 viewDir = rayDirection(FIELD_OF_VIEW, u_RenderSize, pixelCoord);
+    vec3 eye = u_ViewMatrix[3].xyz;
+    vec3 dir = mat3(u_ViewMatrix[0].xyz, u_ViewMatrix[1].xyz, u_ViewMatrix[2].xyz) * viewDir;
+    float dist = shortestDistanceToSurface(eye, dir, MIN_DIST, MAX_DIST);
+    if (dist > MAX_DIST - EPSILON)
+    {
+        return vec4(0.0, 0.0, 0.0, 0.0);
+    }
+
+    // The closest point on the surface to the eyepoint along the view ray
+    vec3 p = eye + dist * dir;
+
+    vec3 k_a = vec3(0.2, 0.2, 0.2);
+    vec3 k_d = vec3(0.2, 0.2, 0.4);
+    vec3 k_s = vec3(1.0, 1.0, 1.0);
+    float shininess = 10.0;
+    vec3 color = phongIllumination(k_a, k_d, k_s, shininess, p, eye);
+    return vec4(color, 1.0);
+}
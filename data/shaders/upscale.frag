@@ -0,0 +1,44 @@
+// Copyright (C) Chad McKinney - All Rights Reserved
+// Unauthorized copying of this file, via any medium is strictly prohibited
+// Proprietary and confidential
+
+// Upscale Fragment Shader
+// Bilinear filters the scaled SDF pass output up to the swap chain extent
+
+#version 450
+
+////////////////////////////////////////////
+// Inputs
+
+// Scene color target, the SDF pass only fills the top left u_RenderSize pixels
+layout(set = 0, binding = 0) uniform sampler2D u_SceneColor;
+
+// Keep in sync with vulkan::SFrameUniforms in renderer.cpp
+layout(set = 0, binding = 1) uniform FrameUniforms
+{
+    mat4 u_ViewMatrix;
+    vec2 u_RenderSize;
+    vec2 u_OutputSize;
+    float u_TimeSecs;
+    int u_NumSpheres;
+    int u_NumCubes;
+};
+
+layout(location = 0) in vec2 v_Texcoord;
+
+////////////////////////////////////////////
+// Outputs
+layout(location = 0) out vec4 o_Color;
+
+////////////////////////////////////////////
+// main
+void main()
+{
+    // The scene color target is allocated at the output size, map output pixels onto the rendered region
+    vec2 texelSize = 1.0 / u_OutputSize;
+    vec2 uv = (gl_FragCoord.xy / u_OutputSize) * (u_RenderSize / u_OutputSize);
+
+    // Clamp half a texel inside the rendered region so filtering never reads stale pixels beyond it
+    uv = clamp(uv, texelSize * 0.5, (u_RenderSize - 0.5) * texelSize);
+    o_Color = texture(u_SceneColor, uv);
+}
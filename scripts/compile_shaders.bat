@@ -13,7 +13,7 @@ if defined glslangValidator (
     goto convert
 )
 
-echo Could not find "glslangValidator.exe" file.
+echo Warning: could not find "glslangValidator.exe", using the committed SPIR-V binaries in data\shaders.
 goto end
 
 :convert
@@ -28,17 +28,38 @@ if not exist %folder% (
 pushd %folder%
 echo compiling shaders in folder: %folder%
 
+set result=0
+
 for %%a in (*.vert) do (
     echo Converting the following shader file: %%a
-    glslangValidator.exe -V -H -o %%a.spv %%a > %%a.spv.txt
+    glslangValidator.exe -V -H -o %%a.spv %%a > %%a.spv.txt || (
+        echo Failed to compile %%a
+        set result=1
+    )
     type %%a.spv.txt
 )
 
 for %%a in (*.frag) do (
     echo Converting the following shader file: %%a
-    glslangValidator.exe -V -H -o %%a.spv %%a > %%a.spv.txt
+    glslangValidator.exe -V -H -o %%a.spv %%a > %%a.spv.txt || (
+        echo Failed to compile %%a
+        set result=1
+    )
     type %%a.spv.txt
 )
+
+for %%a in (*.comp) do (
+    echo Converting the following shader file: %%a
+    glslangValidator.exe -V -H -o %%a.spv %%a > %%a.spv.txt || (
+        echo Failed to compile %%a
+        set result=1
+    )
+    type %%a.spv.txt
+)
+
+popd
+ENDLOCAL & exit /b %result%
+
 :end
 
 ENDLOCAL
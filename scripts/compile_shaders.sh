@@ -4,6 +4,32 @@
 # Unauthorized copying of this file, via any medium is strictly prohibited
 # Proprietary and confidential
 
-folder=../data/shaders
+folder=data/shaders
 
-echo "Not yet implemented for this platform, please write me!"
+if ! command -v glslangValidator > /dev/null 2>&1; then
+    echo "Warning: could not find \"glslangValidator\", using the committed SPIR-V binaries in $folder."
+    exit 0
+fi
+
+if [ ! -d "$folder" ]; then
+    echo "Could not find $folder"
+    exit 0
+fi
+
+pushd "$folder" > /dev/null
+echo "compiling shaders in folder: $folder"
+
+result=0
+
+for shader in *.vert *.frag *.comp; do
+    [ -e "$shader" ] || continue
+    echo "Converting the following shader file: $shader"
+    if ! glslangValidator -V -H -o "$shader.spv" "$shader" > "$shader.spv.txt"; then
+        echo "Failed to compile $shader"
+        result=1
+    fi
+    cat "$shader.spv.txt"
+done
+
+popd > /dev/null
+exit $result
@@ -0,0 +1,250 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "lz.h"
+
+#include <vector>
+
+namespace compression
+{
+
+/////////////////////////////////////////////////////////
+// Constants
+
+static constexpr uint32_t kHashBits = 14;
+static constexpr uint32_t kLiteralLengthMask = 0xf;
+static constexpr uint32_t kMatchLengthMask = 0xf;
+static constexpr uint32_t kSkipShift = 6; // search step grows by one every 64 bytes without a match
+
+/////////////////////////////////////////////////////////
+// Functions
+
+static inline uint32_t Read32(const uint8_t* p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline uint32_t HashSequence(uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - kHashBits);
+}
+
+// Writes the 255 run extension of a length whose first 4 bits went in the token
+static bool WriteExtraLength(size_t length, uint8_t** ppOut, const uint8_t* pOutEnd)
+{
+    uint8_t* pOut = *ppOut;
+    while (length >= 255)
+    {
+        if (pOut >= pOutEnd)
+            return false;
+
+        *pOut++ = 255;
+        length -= 255;
+    }
+
+    if (pOut >= pOutEnd)
+        return false;
+
+    *pOut++ = (uint8_t)length;
+    *ppOut = pOut;
+    return true;
+}
+
+static bool ReadExtraLength(const uint8_t** ppIn, const uint8_t* pInEnd, size_t* pLength)
+{
+    const uint8_t* pIn = *ppIn;
+    uint8_t byte = 255;
+    while (byte == 255)
+    {
+        if (pIn >= pInEnd)
+            return false;
+
+        byte = *pIn++;
+        *pLength += byte;
+    }
+
+    *ppIn = pIn;
+    return true;
+}
+
+// Literals from pLiterals, then a match unless matchLength is 0 (the final sequence)
+static bool WriteSequence(
+    const uint8_t* pLiterals,
+    size_t literalLength,
+    size_t offset,
+    size_t matchLength,
+    uint8_t** ppOut,
+    const uint8_t* pOutEnd)
+{
+    uint8_t* pOut = *ppOut;
+    if (pOut >= pOutEnd)
+        return false;
+
+    uint8_t* pToken = pOut++;
+    const size_t matchCode = matchLength > 0 ? matchLength - kLzMinMatch : 0;
+    *pToken = uint8_t((std::min<size_t>(literalLength, kLiteralLengthMask) << 4) | std::min<size_t>(matchCode, kMatchLengthMask));
+
+    if (literalLength >= kLiteralLengthMask && !WriteExtraLength(literalLength - kLiteralLengthMask, &pOut, pOutEnd))
+        return false;
+
+    if ((size_t)(pOutEnd - pOut) < literalLength)
+        return false;
+
+    if (literalLength > 0)
+    {
+        memcpy(pOut, pLiterals, literalLength);
+        pOut += literalLength;
+    }
+
+    if (matchLength > 0)
+    {
+        if (pOutEnd - pOut < 2)
+            return false;
+
+        *pOut++ = uint8_t(offset & 0xff);
+        *pOut++ = uint8_t(offset >> 8);
+        if (matchCode >= kMatchLengthMask && !WriteExtraLength(matchCode - kMatchLengthMask, &pOut, pOutEnd))
+            return false;
+    }
+
+    *ppOut = pOut;
+    return true;
+}
+
+size_t LzCompressBlock(const void* pSrc, size_t srcSize, void* pDst, size_t dstCapacity)
+{
+    assert(pSrc != nullptr || srcSize == 0);
+    assert(pDst != nullptr);
+
+    const uint8_t* const pIn = (const uint8_t*)pSrc;
+    const uint8_t* const pInEnd = pIn + srcSize;
+    uint8_t* pOut = (uint8_t*)pDst;
+    const uint8_t* const pOutEnd = pOut + dstCapacity;
+
+    // Positions are block relative, anything older than kLzMaxOffset is rejected by the distance check
+    std::vector<uint32_t> hashTable(size_t(1) << kHashBits, 0);
+
+    const uint8_t* pAnchor = pIn;
+    const uint8_t* pCursor = pIn;
+    while (srcSize >= kLzMinMatch && pCursor <= pInEnd - kLzMinMatch)
+    {
+        const uint32_t sequence = Read32(pCursor);
+        uint32_t& rSlot = hashTable[HashSequence(sequence)];
+        const uint8_t* pCandidate = pIn + rSlot;
+        rSlot = uint32_t(pCursor - pIn);
+
+        const size_t offset = size_t(pCursor - pCandidate);
+        if (offset == 0 || offset > kLzMaxOffset || Read32(pCandidate) != sequence)
+        {
+            pCursor += 1 + (size_t(pCursor - pAnchor) >> kSkipShift);
+            continue;
+        }
+
+        // extend backwards over pending literals, then forwards
+        while (pCursor > pAnchor && pCandidate > pIn && pCursor[-1] == pCandidate[-1])
+        {
+            --pCursor;
+            --pCandidate;
+        }
+
+        size_t matchLength = kLzMinMatch;
+        while (pCursor + matchLength < pInEnd && pCursor[matchLength] == pCandidate[matchLength])
+        {
+            ++matchLength;
+        }
+
+        if (!WriteSequence(pAnchor, size_t(pCursor - pAnchor), offset, matchLength, &pOut, pOutEnd))
+            return 0;
+
+        // seed the table inside the match so the next search can find it
+        if (matchLength > 2 && pCursor + matchLength - 2 <= pInEnd - kLzMinMatch)
+        {
+            const uint8_t* pSeed = pCursor + matchLength - 2;
+            hashTable[HashSequence(Read32(pSeed))] = uint32_t(pSeed - pIn);
+        }
+
+        pCursor += matchLength;
+        pAnchor = pCursor;
+    }
+
+    if (!WriteSequence(pAnchor, size_t(pInEnd - pAnchor), 0, 0, &pOut, pOutEnd))
+        return 0;
+
+    return size_t(pOut - (uint8_t*)pDst);
+}
+
+bool LzDecompressBlock(const void* pSrc, size_t srcSize, void* pDst, size_t dstSize)
+{
+    assert(pSrc != nullptr);
+    assert(pDst != nullptr || dstSize == 0);
+
+    const uint8_t* pIn = (const uint8_t*)pSrc;
+    const uint8_t* const pInEnd = pIn + srcSize;
+    uint8_t* pOut = (uint8_t*)pDst;
+    uint8_t* const pOutStart = pOut;
+    uint8_t* const pOutEnd = pOut + dstSize;
+
+    // every block ends with a literals only sequence, running out of input before it means truncation
+    while (true)
+    {
+        if (pIn >= pInEnd)
+            return false;
+
+        const uint8_t token = *pIn++;
+
+        size_t literalLength = token >> 4;
+        if (literalLength == kLiteralLengthMask && !ReadExtraLength(&pIn, pInEnd, &literalLength))
+            return false;
+
+        if ((size_t)(pInEnd - pIn) < literalLength || (size_t)(pOutEnd - pOut) < literalLength)
+            return false;
+
+        if (literalLength > 0)
+        {
+            memcpy(pOut, pIn, literalLength);
+            pIn += literalLength;
+            pOut += literalLength;
+        }
+
+        if (pIn == pInEnd)
+            break; // final sequence
+
+        if (pInEnd - pIn < 2)
+            return false;
+
+        const size_t offset = size_t(pIn[0]) | (size_t(pIn[1]) << 8);
+        pIn += 2;
+
+        size_t matchLength = token & kMatchLengthMask;
+        if (matchLength == kMatchLengthMask && !ReadExtraLength(&pIn, pInEnd, &matchLength))
+            return false;
+
+        matchLength += kLzMinMatch;
+        if (offset == 0 || offset > size_t(pOut - pOutStart) || (size_t)(pOutEnd - pOut) < matchLength)
+            return false;
+
+        const uint8_t* pMatch = pOut - offset;
+        if (offset >= matchLength)
+        {
+            memcpy(pOut, pMatch, matchLength);
+            pOut += matchLength;
+        }
+        else
+        {
+            // overlapping copy repeats the last offset bytes
+            for (size_t i = 0; i < matchLength; ++i)
+            {
+                *pOut++ = *pMatch++;
+            }
+        }
+    }
+
+    return pOut == pOutEnd;
+}
+
+} // compression namespace
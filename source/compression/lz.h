@@ -0,0 +1,34 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+namespace compression
+{
+
+/////////////////////////////////////////////////////////
+// LZ block codec
+//
+// Byte oriented LZ77 in the style of LZ4: a block is a run of sequences, each one a token byte
+// (literal length << 4 | match length - kLzMinMatch), extra length bytes of 255 for long runs, the literals,
+// then a little endian 16 bit match offset. The last sequence has literals only.
+// Blocks never reference data outside themselves, so every block decodes independently.
+
+static constexpr size_t kLzMinMatch = 4;
+static constexpr size_t kLzMaxOffset = 65535;
+
+// Worst case compressed size of an incompressible block
+inline constexpr size_t LzCompressBound(size_t numBytes)
+{
+    return numBytes + numBytes / 255 + 16;
+}
+
+// Returns the compressed size, or 0 if dstCapacity is too small
+size_t LzCompressBlock(const void* pSrc, size_t srcSize, void* pDst, size_t dstCapacity);
+
+// dstSize must be the exact decompressed size. Fails on malformed input rather than reading or writing out of bounds.
+bool LzDecompressBlock(const void* pSrc, size_t srcSize, void* pDst, size_t dstSize);
+
+} // compression namespace
@@ -34,16 +34,23 @@ struct SFrameContext
 /////////////////////////////////////////////////////////////////////
 // Logging
 
+// Messages above VERBOSITY are compiled out, logging::SetLogVerbosity filters the rest at runtime. Formatting is
+// deferred to the logger's writer thread, the unevaluated printf only keeps the compiler's format checks.
 #define VERBOSITY 1
 
+#include "logging/logger.h"
+
+#define DiracLogToStream(stream, bNewLine, ...) do { (void)sizeof(printf(__VA_ARGS__)); logging::Log(stream, bNewLine, __VA_ARGS__); } while (0)
+
 #if VERBOSITY > 0
-#define DiracLog(logVerbosity, ...) do { if constexpr (logVerbosity <= VERBOSITY) { printf(__VA_ARGS__); puts(""); } } while (0)
-#define DiracLogSameLine(logVerbosity, ...) do { if constexpr (logVerbosity <= VERBOSITY) { printf(__VA_ARGS__); } } while (0)
+#define DiracLog(logVerbosity, ...) do { if constexpr (logVerbosity <= VERBOSITY) { if (logging::IsLogVerbosityEnabled(logVerbosity)) { DiracLogToStream(logging::ELogStream::Out, true, __VA_ARGS__); } } } while (0)
+#define DiracLogSameLine(logVerbosity, ...) do { if constexpr (logVerbosity <= VERBOSITY) { if (logging::IsLogVerbosityEnabled(logVerbosity)) { DiracLogToStream(logging::ELogStream::Out, false, __VA_ARGS__); } } } while (0)
 #else
 #define DiracLog(...)
+#define DiracLogSameLine(...)
 #endif
 
-#define DiracError(...) do { fprintf(stderr, __VA_ARGS__); puts(""); } while (0)
+#define DiracError(...) DiracLogToStream(logging::ELogStream::Error, true, __VA_ARGS__)
 /////////////////////////////////////////////////////////////////////
 
 enum ERunResult : int32_t
@@ -0,0 +1,70 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "command_buffer.h"
+
+#include "world.h"
+
+namespace ecs
+{
+
+const char* ToString(EEntityCommand command)
+{
+    switch (command)
+    {
+    case EEntityCommand::CreateEntity: return "CreateEntity";
+    case EEntityCommand::DestroyEntity: return "DestroyEntity";
+    case EEntityCommand::AddComponent: return "AddComponent";
+    case EEntityCommand::RemoveComponent: return "RemoveComponent";
+    }
+
+    return "Unknown";
+}
+
+SCommandBuffer::SCommandBuffer(SWorld* pWorld)
+    : m_pWorld(pWorld)
+{
+    assert(m_pWorld != nullptr);
+}
+
+SEntity SCommandBuffer::CreateEntity()
+{
+    const SEntity entity = m_pWorld->ReserveEntity();
+    Record(EEntityCommand::CreateEntity, entity, kInvalidComponentId, nullptr, 0);
+    return entity;
+}
+
+void SCommandBuffer::DestroyEntity(SEntity entity)
+{
+    Record(EEntityCommand::DestroyEntity, entity, kInvalidComponentId, nullptr, 0);
+}
+
+void SCommandBuffer::Clear()
+{
+    m_commands.clear();
+    m_numCommands = 0;
+}
+
+void SCommandBuffer::Record(EEntityCommand command, SEntity entity, TComponentId componentId, const void* pValue, uint32_t valueSize)
+{
+    SCommandHeader header;
+    header.command = command;
+    header.componentId = componentId;
+    header.entity = entity;
+    header.valueSize = valueSize;
+
+    const size_t offset = m_commands.size();
+    m_commands.resize(offset + sizeof(SCommandHeader) + valueSize);
+    memcpy(m_commands.data() + offset, &header, sizeof(SCommandHeader));
+    if (valueSize > 0)
+    {
+        memcpy(m_commands.data() + offset + sizeof(SCommandHeader), pValue, valueSize);
+    }
+
+    ++m_numCommands;
+}
+
+} // ecs namespace
@@ -0,0 +1,74 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "component.h"
+#include "entity.h"
+
+namespace ecs
+{
+
+struct SWorld;
+
+/////////////////////////////////////////////////////////
+// Command buffer
+//
+// Records structural changes to apply later with SWorld::Playback, which is how queries create, destroy and
+// reshape entities while chunks are being iterated. A buffer belongs to one thread at a time, give each job or
+// job thread its own. Component values are copied into the buffer when recorded.
+
+enum class EEntityCommand : uint8_t
+{
+    CreateEntity,
+    DestroyEntity,
+    AddComponent,
+    RemoveComponent
+};
+
+const char* ToString(EEntityCommand command);
+
+struct SCommandBuffer
+{
+    explicit SCommandBuffer(SWorld* pWorld);
+    SCommandBuffer(const SCommandBuffer&) = delete;
+    SCommandBuffer& operator=(const SCommandBuffer&) = delete;
+
+    // Reserves the handle now, so later commands in this buffer (or others played back after it) can refer to it.
+    // Reserved handles of buffers cleared without playback are never reused.
+    SEntity CreateEntity();
+    void DestroyEntity(SEntity entity);
+
+    template <typename T>
+    inline void AddComponent(SEntity entity, const T& value) { Record(EEntityCommand::AddComponent, entity, GetComponentId<T>(), &value, uint32_t(sizeof(T))); }
+
+    template <typename T>
+    inline void RemoveComponent(SEntity entity) { Record(EEntityCommand::RemoveComponent, entity, GetComponentId<T>(), nullptr, 0); }
+
+    bool IsEmpty() const { return m_commands.empty(); }
+    uint32_t GetCommandCount() const { return m_numCommands; }
+    void Clear();
+
+private:
+    friend struct SWorld;
+
+    struct SCommandHeader
+    {
+        EEntityCommand command;
+        TComponentId componentId;
+        SEntity entity;
+        uint32_t valueSize; // bytes following the header
+    };
+
+    void Record(EEntityCommand command, SEntity entity, TComponentId componentId, const void* pValue, uint32_t valueSize);
+
+    SWorld* m_pWorld = nullptr;
+    std::vector<uint8_t> m_commands; // headers each followed by their value bytes
+    uint32_t m_numCommands = 0;
+};
+
+} // ecs namespace
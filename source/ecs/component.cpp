@@ -0,0 +1,40 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "component.h"
+
+#include <atomic>
+
+namespace ecs
+{
+
+static SComponentInfo g_componentInfos[kMaxComponents];
+static std::atomic<uint32_t> g_numComponents = { 0 };
+
+TComponentId RegisterComponent(uint32_t size, uint32_t alignment)
+{
+    assert(size > 0);
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+    const uint32_t id = g_numComponents.fetch_add(1);
+    if (id >= kMaxComponents)
+    {
+        DiracError("[ECS] more than %u component types registered", kMaxComponents);
+        return kInvalidComponentId;
+    }
+
+    // Ids are only handed out through GetComponentId's static, which publishes the info along with the id
+    g_componentInfos[id].size = size;
+    g_componentInfos[id].alignment = alignment;
+    return id;
+}
+
+const SComponentInfo& GetComponentInfo(TComponentId id)
+{
+    assert(id < kMaxComponents && id < g_numComponents.load());
+    return g_componentInfos[id];
+}
+
+} // ecs namespace
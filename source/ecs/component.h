@@ -0,0 +1,61 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+#include <type_traits>
+
+namespace ecs
+{
+
+/////////////////////////////////////////////////////////
+// Components
+//
+// Any trivially copyable, trivially destructible struct can be a component. Ids are handed out on first use of
+// GetComponentId<T> and are shared by every world, a set of components is a bit mask so at most kMaxComponents
+// types exist per process. Storage is raw bytes moved with memcpy, which is why constructors and destructors are off
+// the table: new components are zero filled unless a value is given.
+
+typedef uint32_t TComponentId;
+typedef uint64_t TComponentMask;
+
+static constexpr uint32_t kMaxComponents = 64;
+static constexpr uint32_t kMaxComponentAlignment = 64;
+static constexpr TComponentId kInvalidComponentId = UINT32_MAX;
+
+struct SComponentInfo
+{
+    uint32_t size = 0;
+    uint32_t alignment = 0;
+};
+
+// Thread safe, returns kInvalidComponentId once kMaxComponents have been registered
+TComponentId RegisterComponent(uint32_t size, uint32_t alignment);
+const SComponentInfo& GetComponentInfo(TComponentId id);
+
+template <typename T>
+inline TComponentId GetComponentId()
+{
+    static_assert(std::is_trivially_copyable<T>::value, "components are moved with memcpy");
+    static_assert(std::is_trivially_destructible<T>::value, "component destructors are never run");
+    static_assert(alignof(T) <= kMaxComponentAlignment, "component arrays are only aligned to kMaxComponentAlignment");
+    static const TComponentId id = RegisterComponent(uint32_t(sizeof(T)), uint32_t(alignof(T)));
+    assert(id != kInvalidComponentId && "out of component ids, raise kMaxComponents");
+    return id;
+}
+
+inline TComponentMask GetComponentBit(TComponentId id)
+{
+    assert(id < kMaxComponents);
+    return TComponentMask(1) << id;
+}
+
+template <typename... TComponents>
+inline TComponentMask GetComponentMask()
+{
+    return (TComponentMask(0) | ... | GetComponentBit(GetComponentId<TComponents>()));
+}
+
+} // ecs namespace
@@ -0,0 +1,25 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+namespace ecs
+{
+
+// Generational handle: the index names a slot in the world's entity table, the generation is bumped every time the
+// slot is freed so handles to destroyed entities never resolve to whatever reuses the slot.
+struct SEntity
+{
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    inline bool IsValid() const { return index != UINT32_MAX; }
+    inline bool operator==(const SEntity& rhs) const { return index == rhs.index && generation == rhs.generation; }
+    inline bool operator!=(const SEntity& rhs) const { return !(*this == rhs); }
+};
+
+static constexpr SEntity kInvalidEntity = SEntity();
+
+} // ecs namespace
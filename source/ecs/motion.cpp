@@ -0,0 +1,54 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "motion.h"
+
+#include "world.h"
+
+namespace ecs
+{
+
+static_assert(sizeof(SPosition) == 3 * sizeof(float) && sizeof(SVelocity) == 3 * sizeof(float), "integration treats the arrays as packed floats");
+
+static constexpr uint32_t kMinChunksPerJob = 2;
+
+void IntegrateVelocities(SWorld* pWorld, float dtSecs)
+{
+    assert(pWorld != nullptr);
+    pWorld->ParallelForEachChunk(SQuery::With<SPosition, SVelocity>(), [dtSecs](const SChunkView& chunk)
+    {
+        // Both arrays are packed xyz triples, so one flat loop covers every lane and vectorizes without shuffles
+        float* __restrict pPositions = &chunk.GetComponents<SPosition>()->value.x;
+        const float* __restrict pVelocities = &chunk.GetComponents<SVelocity>()->value.x;
+        const uint32_t numFloats = chunk.GetCount() * 3;
+        for (uint32_t i = 0; i < numFloats; ++i)
+        {
+            pPositions[i] += pVelocities[i] * dtSecs;
+        }
+    }, kMinChunksPerJob);
+}
+
+void IntegrateAngularVelocities(SWorld* pWorld, float dtSecs)
+{
+    assert(pWorld != nullptr);
+    pWorld->ParallelForEachChunk(SQuery::With<SOrientation, SAngularVelocity>(), [dtSecs](const SChunkView& chunk)
+    {
+        SOrientation* pOrientations = chunk.GetComponents<SOrientation>();
+        const SAngularVelocity* pAngularVelocities = chunk.GetComponents<SAngularVelocity>();
+        for (uint32_t i = 0, count = chunk.GetCount(); i < count; ++i)
+        {
+            const Vec3l& radiansPerSec = pAngularVelocities[i].radiansPerSec;
+            if (radiansPerSec.IsZero(kFLocalEpsilon))
+                continue;
+
+            Quaternionl& orientation = pOrientations[i].value;
+            orientation = orientation * Quaternionl::CreateRotationXYZ(radiansPerSec.x * dtSecs, radiansPerSec.y * dtSecs, radiansPerSec.z * dtSecs);
+            orientation.Normalize();
+        }
+    }, kMinChunksPerJob);
+}
+
+} // ecs namespace
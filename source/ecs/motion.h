@@ -0,0 +1,48 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+#include "quaternion.h"
+#include "vector3.h"
+
+namespace ecs
+{
+
+struct SWorld;
+
+/////////////////////////////////////////////////////////
+// Motion components
+//
+// Kept as separate single member components so each lands in its own chunk array: integration streams positions and
+// velocities as flat float arrays, and systems that only read positions never pull velocities into cache.
+
+struct SPosition
+{
+    Vec3l value;
+};
+
+struct SVelocity
+{
+    Vec3l value; // units per second
+};
+
+struct SOrientation
+{
+    Quaternionl value;
+};
+
+struct SAngularVelocity
+{
+    Vec3l radiansPerSec; // about the local x, y and z axes
+};
+
+// position += velocity * dt for every entity with both, chunks in parallel. Job system threads only.
+void IntegrateVelocities(SWorld* pWorld, float dtSecs);
+
+// Rotates orientations by their angular velocity, chunks in parallel. Job system threads only.
+void IntegrateAngularVelocities(SWorld* pWorld, float dtSecs);
+
+} // ecs namespace
@@ -0,0 +1,408 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "world.h"
+
+#include <new>
+
+#include "command_buffer.h"
+
+namespace ecs
+{
+
+static inline uint32_t AlignUp(uint32_t value, uint32_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static inline uint8_t* GetComponentPointer(const SArchetype& archetype, const SChunk& chunk, TComponentId id, uint32_t row)
+{
+    return chunk.pData + archetype.componentOffsets[id] + size_t(row) * GetComponentInfo(id).size;
+}
+
+static inline SEntity* GetEntityArray(const SChunk& chunk)
+{
+    return reinterpret_cast<SEntity*>(chunk.pData);
+}
+
+// Lays out the chunk arrays for capacity entities, returns false if they don't fit in kChunkSize
+static bool LayoutArchetype(SArchetype* pArchetype, uint32_t capacity)
+{
+    uint32_t offset = capacity * uint32_t(sizeof(SEntity));
+    for (TComponentId id : pArchetype->componentIds)
+    {
+        offset = AlignUp(offset, kChunkArrayAlignment);
+        pArchetype->componentOffsets[id] = offset;
+        offset += capacity * GetComponentInfo(id).size;
+        if (offset > kChunkSize)
+            return false;
+    }
+
+    return true;
+}
+
+SWorld::SWorld()
+{
+    GetOrCreateArchetype(0); // reserved entities start in the empty archetype once played back
+}
+
+SWorld::~SWorld()
+{
+    for (const std::unique_ptr<SArchetype>& pArchetype : m_archetypes)
+    {
+        for (SChunk& chunk : pArchetype->chunks)
+        {
+            ::operator delete(chunk.pData, std::align_val_t(kChunkArrayAlignment));
+        }
+    }
+}
+
+////////////////////////////////////
+// Structural changes
+
+SEntity SWorld::CreateEntity(TComponentMask mask)
+{
+    assert(m_numActiveQueries.load(std::memory_order_relaxed) == 0 && "structural change while iterating, use an SCommandBuffer");
+    const SEntity entity = ReserveEntity();
+    MaterializeEntity(entity);
+
+    ++m_numEntities;
+
+    SEntityRecord& record = m_records[entity.index];
+    const uint32_t archetypeIndex = GetOrCreateArchetype(mask);
+    AllocateRow(archetypeIndex, entity, &record.chunk, &record.row);
+    record.archetype = archetypeIndex;
+
+    const SArchetype& archetype = *m_archetypes[archetypeIndex];
+    const SChunk& chunk = archetype.chunks[record.chunk];
+    for (TComponentId id : archetype.componentIds)
+    {
+        memset(GetComponentPointer(archetype, chunk, id, record.row), 0, GetComponentInfo(id).size);
+    }
+
+    return entity;
+}
+
+bool SWorld::DestroyEntity(SEntity entity)
+{
+    assert(m_numActiveQueries.load(std::memory_order_relaxed) == 0 && "structural change while iterating, use an SCommandBuffer");
+    if (FindRecord(entity) == nullptr)
+        return false;
+
+    SEntityRecord& record = m_records[entity.index];
+    RemoveRow(record.archetype, record.chunk, record.row);
+    record.archetype = kNoArchetype;
+    ++record.generation;
+    --m_numEntities;
+
+    synchronization::SLockGuard<synchronization::SMutex> lock(m_reserveMutex);
+    m_freeIndices.push_back(entity.index);
+    return true;
+}
+
+bool SWorld::AddComponent(SEntity entity, TComponentId id, const void* pValue)
+{
+    assert(m_numActiveQueries.load(std::memory_order_relaxed) == 0 && "structural change while iterating, use an SCommandBuffer");
+    const SEntityRecord* pRecord = FindRecord(entity);
+    if (pRecord == nullptr)
+        return false;
+
+    const SArchetype& archetype = *m_archetypes[pRecord->archetype];
+    if ((archetype.mask & GetComponentBit(id)) != 0)
+    {
+        uint8_t* pComponent = GetComponentPointer(archetype, archetype.chunks[pRecord->chunk], id, pRecord->row);
+        if (pValue != nullptr)
+        {
+            memcpy(pComponent, pValue, GetComponentInfo(id).size);
+        }
+        else
+        {
+            memset(pComponent, 0, GetComponentInfo(id).size);
+        }
+
+        return true;
+    }
+
+    MoveEntity(entity, archetype.mask | GetComponentBit(id), id, pValue);
+    return true;
+}
+
+bool SWorld::RemoveComponent(SEntity entity, TComponentId id)
+{
+    assert(m_numActiveQueries.load(std::memory_order_relaxed) == 0 && "structural change while iterating, use an SCommandBuffer");
+    const SEntityRecord* pRecord = FindRecord(entity);
+    if (pRecord == nullptr)
+        return false;
+
+    const TComponentMask mask = m_archetypes[pRecord->archetype]->mask;
+    if ((mask & GetComponentBit(id)) != 0)
+    {
+        MoveEntity(entity, mask & ~GetComponentBit(id), kInvalidComponentId, nullptr);
+    }
+
+    return true;
+}
+
+void SWorld::Playback(SCommandBuffer* pCommandBuffer)
+{
+    assert(pCommandBuffer != nullptr && pCommandBuffer->m_pWorld == this);
+    assert(m_numActiveQueries.load(std::memory_order_relaxed) == 0 && "command buffers can't be played back while iterating");
+
+    const uint8_t* pCommand = pCommandBuffer->m_commands.data();
+    const uint8_t* pEnd = pCommand + pCommandBuffer->m_commands.size();
+    while (pCommand < pEnd)
+    {
+        SCommandBuffer::SCommandHeader header;
+        memcpy(&header, pCommand, sizeof(header));
+        const uint8_t* pValue = pCommand + sizeof(header);
+        pCommand = pValue + header.valueSize;
+
+        switch (header.command)
+        {
+        case EEntityCommand::CreateEntity:
+        {
+            MaterializeEntity(header.entity);
+            ++m_numEntities;
+            SEntityRecord& record = m_records[header.entity.index];
+            assert(record.generation == header.entity.generation && record.archetype == kNoArchetype);
+            AllocateRow(0, header.entity, &record.chunk, &record.row);
+            record.archetype = 0;
+            break;
+        }
+        case EEntityCommand::DestroyEntity:
+            DestroyEntity(header.entity);
+            break;
+        case EEntityCommand::AddComponent:
+            // Component values are copied into place with memcpy, so the unaligned bytes in the buffer are fine
+            AddComponent(header.entity, header.componentId, header.valueSize > 0 ? pValue : nullptr);
+            break;
+        case EEntityCommand::RemoveComponent:
+            RemoveComponent(header.entity, header.componentId);
+            break;
+        }
+    }
+
+    pCommandBuffer->Clear();
+}
+
+////////////////////////////////////
+// Lookups
+
+SEntity SWorld::ReserveEntity()
+{
+    synchronization::SLockGuard<synchronization::SMutex> lock(m_reserveMutex);
+    if (!m_freeIndices.empty())
+    {
+        const uint32_t index = m_freeIndices.back();
+        m_freeIndices.pop_back();
+        return SEntity{ index, m_records[index].generation };
+    }
+
+    return SEntity{ uint32_t(m_records.size()) + m_numPendingIndices++, 0 };
+}
+
+bool SWorld::IsAlive(SEntity entity) const
+{
+    return FindRecord(entity) != nullptr;
+}
+
+TComponentMask SWorld::GetComponentMask(SEntity entity) const
+{
+    const SEntityRecord* pRecord = FindRecord(entity);
+    return pRecord != nullptr ? m_archetypes[pRecord->archetype]->mask : 0;
+}
+
+void* SWorld::GetComponent(SEntity entity, TComponentId id)
+{
+    const SEntityRecord* pRecord = FindRecord(entity);
+    if (pRecord == nullptr)
+        return nullptr;
+
+    const SArchetype& archetype = *m_archetypes[pRecord->archetype];
+    if ((archetype.mask & GetComponentBit(id)) == 0)
+        return nullptr;
+
+    return GetComponentPointer(archetype, archetype.chunks[pRecord->chunk], id, pRecord->row);
+}
+
+uint32_t SWorld::GetChunkCount() const
+{
+    uint32_t numChunks = 0;
+    for (const std::unique_ptr<SArchetype>& pArchetype : m_archetypes)
+    {
+        numChunks += uint32_t(pArchetype->chunks.size());
+    }
+
+    return numChunks;
+}
+
+void SWorld::GatherChunks(const SQuery& query, std::vector<SChunkView>* pOutChunks)
+{
+    assert(pOutChunks != nullptr);
+    pOutChunks->clear();
+    for (const std::unique_ptr<SArchetype>& pArchetype : m_archetypes)
+    {
+        if (!query.Matches(pArchetype->mask))
+            continue;
+
+        for (SChunk& chunk : pArchetype->chunks)
+        {
+            SChunkView view;
+            view.pArchetype = pArchetype.get();
+            view.pChunk = &chunk;
+            pOutChunks->push_back(view);
+        }
+    }
+}
+
+////////////////////////////////////
+// Internals
+
+const SWorld::SEntityRecord* SWorld::FindRecord(SEntity entity) const
+{
+    if (entity.index >= m_records.size())
+        return nullptr;
+
+    const SEntityRecord& record = m_records[entity.index];
+    if (record.generation != entity.generation || record.archetype == kNoArchetype)
+        return nullptr;
+
+    return &record;
+}
+
+// Grows the record table to cover a reserved index, indices reserved past the old end stay pending until their own
+// create is played back
+void SWorld::MaterializeEntity(SEntity entity)
+{
+    synchronization::SLockGuard<synchronization::SMutex> lock(m_reserveMutex);
+    const uint32_t reservedEnd = uint32_t(m_records.size()) + m_numPendingIndices;
+    assert(entity.index < reservedEnd && "entity was never reserved");
+    if (entity.index >= m_records.size())
+    {
+        m_records.resize(size_t(entity.index) + 1);
+        m_numPendingIndices = reservedEnd - uint32_t(m_records.size());
+    }
+}
+
+uint32_t SWorld::GetOrCreateArchetype(TComponentMask mask)
+{
+    const std::unordered_map<TComponentMask, uint32_t>::const_iterator it = m_archetypeLookup.find(mask);
+    if (it != m_archetypeLookup.end())
+        return it->second;
+
+    std::unique_ptr<SArchetype> pArchetype = std::make_unique<SArchetype>();
+    pArchetype->mask = mask;
+    uint32_t rowSize = uint32_t(sizeof(SEntity));
+    for (TComponentId id = 0; id < kMaxComponents; ++id)
+    {
+        if ((mask & GetComponentBit(id)) != 0)
+        {
+            pArchetype->componentIds.push_back(id);
+            rowSize += GetComponentInfo(id).size;
+        }
+    }
+
+    // Start from the unpadded estimate and back off until the aligned arrays fit
+    uint32_t capacity = kChunkSize / rowSize;
+    while (capacity > 0 && !LayoutArchetype(pArchetype.get(), capacity))
+    {
+        --capacity;
+    }
+
+    assert(capacity > 0 && "a single entity with these components doesn't fit in a chunk");
+    pArchetype->capacity = capacity;
+
+    const uint32_t archetypeIndex = uint32_t(m_archetypes.size());
+    m_archetypes.push_back(std::move(pArchetype));
+    m_archetypeLookup.emplace(mask, archetypeIndex);
+    DiracLog(2, "[ECS] archetype %u: mask 0x%llx, %u components, %u entities per chunk",
+        archetypeIndex, (unsigned long long)mask, (uint32_t)m_archetypes.back()->componentIds.size(), capacity);
+    return archetypeIndex;
+}
+
+void SWorld::AllocateRow(uint32_t archetypeIndex, SEntity entity, uint32_t* pOutChunk, uint32_t* pOutRow)
+{
+    SArchetype& archetype = *m_archetypes[archetypeIndex];
+    if (archetype.chunks.empty() || archetype.chunks.back().count == archetype.capacity)
+    {
+        SChunk chunk;
+        chunk.pData = static_cast<uint8_t*>(::operator new(kChunkSize, std::align_val_t(kChunkArrayAlignment)));
+        archetype.chunks.push_back(chunk);
+    }
+
+    SChunk& chunk = archetype.chunks.back();
+    *pOutChunk = uint32_t(archetype.chunks.size() - 1);
+    *pOutRow = chunk.count++;
+    GetEntityArray(chunk)[*pOutRow] = entity;
+}
+
+// Fills the hole with the archetype's last entity so chunks stay dense
+void SWorld::RemoveRow(uint32_t archetypeIndex, uint32_t chunkIndex, uint32_t row)
+{
+    SArchetype& archetype = *m_archetypes[archetypeIndex];
+    SChunk& lastChunk = archetype.chunks.back();
+    const uint32_t lastRow = lastChunk.count - 1;
+    if (chunkIndex != archetype.chunks.size() - 1 || row != lastRow)
+    {
+        SChunk& chunk = archetype.chunks[chunkIndex];
+        for (TComponentId id : archetype.componentIds)
+        {
+            memcpy(GetComponentPointer(archetype, chunk, id, row), GetComponentPointer(archetype, lastChunk, id, lastRow), GetComponentInfo(id).size);
+        }
+
+        const SEntity movedEntity = GetEntityArray(lastChunk)[lastRow];
+        GetEntityArray(chunk)[row] = movedEntity;
+        m_records[movedEntity.index].chunk = chunkIndex;
+        m_records[movedEntity.index].row = row;
+    }
+
+    if (--lastChunk.count == 0)
+    {
+        ::operator delete(lastChunk.pData, std::align_val_t(kChunkArrayAlignment));
+        archetype.chunks.pop_back();
+    }
+}
+
+void SWorld::MoveEntity(SEntity entity, TComponentMask newMask, TComponentId addedId, const void* pAddedValue)
+{
+    SEntityRecord& record = m_records[entity.index];
+    const uint32_t srcArchetypeIndex = record.archetype;
+    const uint32_t dstArchetypeIndex = GetOrCreateArchetype(newMask);
+
+    uint32_t dstChunkIndex = 0;
+    uint32_t dstRow = 0;
+    AllocateRow(dstArchetypeIndex, entity, &dstChunkIndex, &dstRow);
+
+    const SArchetype& srcArchetype = *m_archetypes[srcArchetypeIndex];
+    const SArchetype& dstArchetype = *m_archetypes[dstArchetypeIndex];
+    const SChunk& srcChunk = srcArchetype.chunks[record.chunk];
+    const SChunk& dstChunk = dstArchetype.chunks[dstChunkIndex];
+    for (TComponentId id : dstArchetype.componentIds)
+    {
+        uint8_t* pDst = GetComponentPointer(dstArchetype, dstChunk, id, dstRow);
+        const uint32_t size = GetComponentInfo(id).size;
+        if ((srcArchetype.mask & GetComponentBit(id)) != 0)
+        {
+            memcpy(pDst, GetComponentPointer(srcArchetype, srcChunk, id, record.row), size);
+        }
+        else if (id == addedId && pAddedValue != nullptr)
+        {
+            memcpy(pDst, pAddedValue, size);
+        }
+        else
+        {
+            memset(pDst, 0, size);
+        }
+    }
+
+    // Only patches the record of the entity moved into the hole, never this one
+    RemoveRow(srcArchetypeIndex, record.chunk, record.row);
+    record.archetype = dstArchetypeIndex;
+    record.chunk = dstChunkIndex;
+    record.row = dstRow;
+}
+
+} // ecs namespace
@@ -0,0 +1,248 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "component.h"
+#include "entity.h"
+#include "jobs/job_system.h"
+#include "sync/mutex.h"
+
+namespace ecs
+{
+
+/////////////////////////////////////////////////////////
+// World
+//
+// Archetype storage: every distinct set of components is an archetype, and an archetype's entities live in
+// kChunkSize chunks. A chunk holds its entity handles followed by one tightly packed array per component (SoA),
+// each array starting on a kChunkArrayAlignment boundary, so a system touching two components streams through two
+// contiguous arrays per chunk and the loops vectorize. Chunks are kept dense, removing an entity moves the archetype's
+// last entity into the hole, so every chunk but an archetype's last is full.
+//
+// Adding or removing a component moves the entity to another archetype. Structural changes (create, destroy,
+// add, remove) must not happen while a query is iterating, inside queries record them into an SCommandBuffer and
+// Playback it afterwards. Queries may run concurrently with each other, ParallelForEachChunk spreads the matching
+// chunks over the job system.
+
+struct SCommandBuffer;
+
+static constexpr uint32_t kChunkSize = 16 * 1024;
+static constexpr uint32_t kChunkArrayAlignment = kMaxComponentAlignment; // a cache line, and wide enough for any SIMD load
+
+struct SChunk
+{
+    uint8_t* pData = nullptr; // kChunkSize bytes, see SArchetype::componentOffsets
+    uint32_t count = 0;
+};
+
+struct SArchetype
+{
+    TComponentMask mask = 0;
+    uint32_t capacity = 0; // entities per chunk
+    std::vector<TComponentId> componentIds;
+    uint32_t componentOffsets[kMaxComponents] = {}; // by component id, byte offset of its array in every chunk
+    std::vector<SChunk> chunks;
+};
+
+// One chunk as seen by a query, valid until the next structural change
+struct SChunkView
+{
+    const SArchetype* pArchetype = nullptr;
+    SChunk* pChunk = nullptr;
+
+    inline uint32_t GetCount() const { return pChunk->count; }
+    inline const SEntity* GetEntities() const { return reinterpret_cast<const SEntity*>(pChunk->pData); }
+
+    template <typename T>
+    inline bool HasComponent() const { return (pArchetype->mask & GetComponentBit(GetComponentId<T>())) != 0; }
+
+    // The component must be part of the query's (or the archetype's) component set
+    template <typename T>
+    inline T* GetComponents() const
+    {
+        const TComponentId id = GetComponentId<T>();
+        assert((pArchetype->mask & GetComponentBit(id)) != 0 && "component isn't part of this chunk's archetype");
+        return reinterpret_cast<T*>(pChunk->pData + pArchetype->componentOffsets[id]);
+    }
+};
+
+struct SQuery
+{
+    TComponentMask all = 0; // archetypes must have every one of these
+    TComponentMask none = 0; // and none of these
+
+    template <typename... TComponents>
+    static inline SQuery With()
+    {
+        SQuery query;
+        query.all = GetComponentMask<TComponents...>();
+        return query;
+    }
+
+    template <typename... TComponents>
+    inline SQuery Without() const
+    {
+        SQuery query = *this;
+        query.none |= GetComponentMask<TComponents...>();
+        return query;
+    }
+
+    inline bool Matches(TComponentMask mask) const { return (mask & all) == all && (mask & none) == 0; }
+};
+
+struct SWorld
+{
+    SWorld();
+    ~SWorld();
+    SWorld(const SWorld&) = delete;
+    SWorld& operator=(const SWorld&) = delete;
+
+    ////////////////////////////////////
+    // Structural changes, not while a query runs
+
+    SEntity CreateEntity(TComponentMask mask = 0); // components zero filled
+    bool DestroyEntity(SEntity entity); // false if the entity isn't alive
+
+    // Overwrites the value when the entity already has the component. False if the entity isn't alive.
+    template <typename T>
+    inline bool AddComponent(SEntity entity, const T& value) { return AddComponent(entity, GetComponentId<T>(), &value); }
+
+    template <typename T>
+    inline bool RemoveComponent(SEntity entity) { return RemoveComponent(entity, GetComponentId<T>()); }
+
+    bool AddComponent(SEntity entity, TComponentId id, const void* pValue); // pValue nullptr to zero fill
+    bool RemoveComponent(SEntity entity, TComponentId id);
+
+    // Applies the buffer's commands in the order they were recorded and clears it. Commands naming entities that are
+    // no longer alive are skipped.
+    void Playback(SCommandBuffer* pCommandBuffer);
+
+    ////////////////////////////////////
+    // Lookups
+
+    // Thread safe. The handle is valid immediately but the entity only exists once a CreateEntity for it is played back.
+    SEntity ReserveEntity();
+
+    bool IsAlive(SEntity entity) const;
+    TComponentMask GetComponentMask(SEntity entity) const; // 0 if the entity isn't alive
+
+    template <typename T>
+    inline T* GetComponent(SEntity entity) { return static_cast<T*>(GetComponent(entity, GetComponentId<T>())); }
+
+    template <typename T>
+    inline bool HasComponent(SEntity entity) const { return (GetComponentMask(entity) & GetComponentBit(GetComponentId<T>())) != 0; }
+
+    void* GetComponent(SEntity entity, TComponentId id); // nullptr if the entity isn't alive or lacks the component
+
+    uint32_t GetEntityCount() const { return m_numEntities; }
+    uint32_t GetArchetypeCount() const { return uint32_t(m_archetypes.size()); }
+    uint32_t GetChunkCount() const;
+
+    ////////////////////////////////////
+    // Queries
+
+    // function(const SChunkView&) for every non empty chunk of every matching archetype
+    template <typename F>
+    void ForEachChunk(const SQuery& query, F&& function);
+
+    // As ForEachChunk, with the chunks split across jobs. Waits for every chunk, must be called from a job system thread.
+    template <typename F>
+    void ParallelForEachChunk(const SQuery& query, F&& function, uint32_t minChunksPerJob = 1);
+
+    void GatherChunks(const SQuery& query, std::vector<SChunkView>* pOutChunks);
+
+private:
+    static constexpr uint32_t kNoArchetype = UINT32_MAX;
+
+    struct SEntityRecord
+    {
+        uint32_t generation = 0;
+        uint32_t archetype = kNoArchetype; // kNoArchetype while free or reserved
+        uint32_t chunk = 0;
+        uint32_t row = 0;
+    };
+
+    // Counts running queries so structural changes during iteration assert instead of corrupting chunks
+    struct SQueryScope
+    {
+        explicit SQueryScope(SWorld* pWorld) : m_pWorld(pWorld) { m_pWorld->m_numActiveQueries.fetch_add(1, std::memory_order_relaxed); }
+        ~SQueryScope() { m_pWorld->m_numActiveQueries.fetch_sub(1, std::memory_order_relaxed); }
+
+    private:
+        SWorld* m_pWorld;
+    };
+
+    const SEntityRecord* FindRecord(SEntity entity) const; // nullptr if the entity isn't alive
+    void MaterializeEntity(SEntity entity);
+    uint32_t GetOrCreateArchetype(TComponentMask mask);
+    void AllocateRow(uint32_t archetypeIndex, SEntity entity, uint32_t* pOutChunk, uint32_t* pOutRow);
+    void RemoveRow(uint32_t archetypeIndex, uint32_t chunkIndex, uint32_t row);
+    void MoveEntity(SEntity entity, TComponentMask newMask, TComponentId addedId, const void* pAddedValue);
+
+    std::vector<std::unique_ptr<SArchetype>> m_archetypes; // stable addresses for SChunkView
+    std::unordered_map<TComponentMask, uint32_t> m_archetypeLookup;
+    std::vector<SEntityRecord> m_records;
+    std::vector<uint32_t> m_freeIndices;
+    uint32_t m_numPendingIndices = 0; // reserved past the end of m_records
+    uint32_t m_numEntities = 0;
+    synchronization::SMutex m_reserveMutex; // m_freeIndices, m_numPendingIndices and the size of m_records
+    std::atomic<uint32_t> m_numActiveQueries = { 0 };
+};
+
+/////////////////////////////////////////////////////////
+// Query templates
+
+template <typename F>
+void SWorld::ForEachChunk(const SQuery& query, F&& function)
+{
+    SQueryScope scope(this);
+    for (const std::unique_ptr<SArchetype>& pArchetype : m_archetypes)
+    {
+        if (!query.Matches(pArchetype->mask))
+            continue;
+
+        for (SChunk& chunk : pArchetype->chunks)
+        {
+            SChunkView view;
+            view.pArchetype = pArchetype.get();
+            view.pChunk = &chunk;
+            function(static_cast<const SChunkView&>(view));
+        }
+    }
+}
+
+template <typename F>
+void SWorld::ParallelForEachChunk(const SQuery& query, F&& function, uint32_t minChunksPerJob)
+{
+    struct SContext
+    {
+        const SChunkView* pChunks;
+        typename std::remove_reference<F>::type* pFunction;
+    };
+
+    SQueryScope scope(this);
+    std::vector<SChunkView> chunks;
+    GatherChunks(query, &chunks);
+    if (chunks.empty())
+        return;
+
+    SContext context = { chunks.data(), &function };
+    jobs::ParallelFor(uint32_t(chunks.size()), [](uint32_t begin, uint32_t end, void* pData)
+    {
+        SContext* pContext = static_cast<SContext*>(pData);
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            (*pContext->pFunction)(pContext->pChunks[i]);
+        }
+    }, &context, std::max(minChunksPerJob, 1u));
+}
+
+} // ecs namespace
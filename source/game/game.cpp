@@ -9,15 +9,21 @@
 #include <SDL_keycode.h>
 
 #include "camera.h"
+#include "cpu_profiler.h"
+#include "fixed_timestep.h"
+#include "game_state.h"
 #include "platform.h"
 #include "quaternion.h"
-#include "renderer.h"
+#include "render_snapshot.h"
+#include "transform_hierarchy.h"
 
 namespace game
 {
 /////////////////////////////////////////////////////////
 // Constants
 static constexpr int kDebugVerbosity = 2;
+static constexpr uint32_t kNumSceneShapes = renderer::kNumSceneShapes;
+static constexpr const char* kQuickSaveFileName = "quicksave.dsgs";
 
 /////////////////////////////////////////////////////////
 // State
@@ -49,15 +55,33 @@ struct SPlayer
     EDirection::Flags directions = EDirection::Flags::FLAGS_NONE;
     EDirection::Flags activeDirections = EDirection::Flags::FLAGS_NONE;
     Vec3l controlDir = { EZero::Constructor };
-    Vec3l velocity = { EZero::Constructor };
-    float movAccelPerSec = 0.1f;
+    Vec3l velocity = { EZero::Constructor }; // units per second
+    float movAccelPerSec = 12.5f; // units per second squared
+    float movDampingPerSec = 0.4f; // fraction of the velocity shed per second while coasting
     float rotSpdPerSec = kFLocalPi;
 
-    static constexpr float kMaxMoveSpeed = 0.5f;
+    // Same feel as the old per frame speeds (0.5 units per 8 ms frame, accelerating by 0.1 per second)
+    static constexpr float kMaxMoveSpeed = 62.5f;
 };
 
 SPlayer g_player;
 
+// The player is simulated in fixed ticks and drawn between the last two of them
+struct SPlayerTransform
+{
+    Vec3l position = { EZero::Constructor };
+    Quaternionl orientation = { EIdentity::Constructor };
+};
+
+platform::SFixedTimestep g_simulation;
+SPlayerTransform g_previousPlayerTransform; // as of the tick before the latest one
+
+// Scene shapes are nodes in the hierarchy, their index into the renderer's shape transforms is the array position
+STransformHierarchy g_sceneTransforms;
+TTransformNode g_shapeNodes[kNumSceneShapes];
+
+TFrameId g_lastFrameId = 0;
+
 /////////////////////////////////////////////////////////
 // Internal Functions
 
@@ -164,35 +188,88 @@ void HandleQ(int32_t, uint16_t, platform::EKeyChange keyChange)
     HandleRotationKeyDown(ERotation::Flags::RollBack, ERotation::Flags::Roll, keyChange, "Q");
 }
 
-/////////////////////////////////////////////////////////
-// Exposed Functions
+void CaptureGameState(std::vector<uint8_t>* pOutState)
+{
+    SPlayerState player;
+    player.position = g_player.position;
+    player.velocity = g_player.velocity;
+    player.controlDir = g_player.controlDir;
+    player.orientation = g_player.orientation;
+    player.targetOrientation = g_player.targetOrientation;
+    player.directions = EDirection::TUnderlyingType(g_player.directions);
+    player.activeDirections = EDirection::TUnderlyingType(g_player.activeDirections);
+    player.rotations = ERotation::TUnderlyingType(g_player.rotations);
+    player.activeRotations = ERotation::TUnderlyingType(g_player.activeRotations);
+
+    SCameraState camera;
+    camera.transform = g_camera.transform;
+
+    SShapeState shapes[kNumSceneShapes];
+    for (uint32_t shapeIndex = 0; shapeIndex < kNumSceneShapes; ++shapeIndex)
+    {
+        const TTransformNode node = g_shapeNodes[shapeIndex];
+        shapes[shapeIndex].localPosition = g_sceneTransforms.GetLocalPosition(node);
+        shapes[shapeIndex].localRotation = g_sceneTransforms.GetLocalRotation(node);
+        shapes[shapeIndex].localScale = g_sceneTransforms.GetLocalScale(node);
+        shapes[shapeIndex].inverseWorldMatrix = g_sceneTransforms.GetInverseWorldMatrix(node);
+    }
+
+    SGameStateDesc desc;
+    desc.frameId = g_lastFrameId;
+    desc.pPlayer = &player;
+    desc.pCamera = &camera;
+    desc.pShapes = shapes;
+    desc.numShapes = kNumSceneShapes;
+    BuildGameState(desc, pOutState);
+}
 
-ERunResult Initialize()
+// Held keys belong to the live keyboard rather than the snapshot, so the control flags are left as they are
+bool RestoreGameState(const SGameStateView& view)
 {
-    g_player.position = Vec3l(0, 0, 8);
-    g_camera.transform = Matrix44l::CreateRotationAndTranslation(
-        EIdentity::Constructor,
-        g_player.position
-    );
+    if (view.numShapes != kNumSceneShapes)
+    {
+        DiracError("[GameState] snapshot holds %u shapes, the scene has %u", view.numShapes, kNumSceneShapes);
+        return false;
+    }
 
-    platform::TActionMap actionMap = {
-      { SDLK_w, 0, HandleW },
-      { SDLK_a, 0, HandleA },
-      { SDLK_s, 0, HandleS },
-      { SDLK_d, 0, HandleD },
-      { SDLK_LCTRL, 0, HandleCtrl },
-      { SDLK_SPACE, 0, HandleSpace },
-      { SDLK_e, 0, HandleE },
-      { SDLK_q, 0, HandleQ }
-    };
+    g_player.position = view.pPlayer->position;
+    g_player.velocity = view.pPlayer->velocity;
+    g_player.orientation = view.pPlayer->orientation;
+    g_player.targetOrientation = view.pPlayer->targetOrientation;
+    g_previousPlayerTransform = { g_player.position, g_player.orientation }; // don't interpolate from before the load
+    g_camera.transform = view.pCamera->transform;
 
-    platform::PushActionMap(std::move(actionMap));
-    return eRR_Success;
+    for (uint32_t shapeIndex = 0; shapeIndex < kNumSceneShapes; ++shapeIndex)
+    {
+        const TTransformNode node = g_shapeNodes[shapeIndex];
+        g_sceneTransforms.SetLocalPosition(node, view.pShapes[shapeIndex].localPosition);
+        g_sceneTransforms.SetLocalRotation(node, view.pShapes[shapeIndex].localRotation);
+        g_sceneTransforms.SetLocalScale(node, view.pShapes[shapeIndex].localScale);
+    }
+
+    return true;
+}
+
+void HandleF5(int32_t, uint16_t, platform::EKeyChange keyChange)
+{
+    if (keyChange == platform::EKeyChange::Pressed)
+    {
+        SaveGameState(kQuickSaveFileName);
+    }
+}
+
+void HandleF9(int32_t, uint16_t, platform::EKeyChange keyChange)
+{
+    if (keyChange == platform::EKeyChange::Pressed)
+    {
+        LoadGameState(kQuickSaveFileName);
+    }
 }
 
-ERunResult Run(const SFrameContext& frameContext)
+void SimulateTick(float fTimeSecs)
 {
-    const float fTimeSecs = float(TSeconds(frameContext.lastFrameDuration).count());
+    g_previousPlayerTransform = { g_player.position, g_player.orientation };
+
     if (!g_player.controlDir.IsZero(kFLocalEpsilon))
     {
         const Matrix33l rotation = g_camera.transform.GetRotation();
@@ -204,12 +281,12 @@ ERunResult Run(const SFrameContext& frameContext)
         {
             g_player.velocity.Scale(g_player.kMaxMoveSpeed / fSpeed);
         }
-        g_player.position = g_player.position + g_player.velocity;
+        g_player.position = g_player.position + g_player.velocity.Scaled(fTimeSecs);
     }
     else if (g_player.velocity.Magnitude() > kFLocalEpsilon)
     {
-        g_player.velocity = g_player.velocity - (g_player.velocity.Scaled(g_player.movAccelPerSec * fTimeSecs * 4.0f));
-        g_player.position = g_player.position + g_player.velocity;
+        g_player.velocity = g_player.velocity - (g_player.velocity.Scaled(g_player.movDampingPerSec * fTimeSecs));
+        g_player.position = g_player.position + g_player.velocity.Scaled(fTimeSecs);
     }
     else
     {
@@ -220,13 +297,73 @@ ERunResult Run(const SFrameContext& frameContext)
 
     if ((g_player.activeRotations & ERotation::Flags::Roll) != ERotation::Flags::FLAGS_NONE)
     {
-        rollRadians = float(TSeconds(frameContext.lastFrameDuration).count() * kFWorldQuarterPi * 0.5);
+        rollRadians = float(fTimeSecs * kFWorldQuarterPi * 0.5);
     }
     else if ((g_player.activeRotations & ERotation::Flags::RollBack) != ERotation::Flags::FLAGS_NONE)
     {
-        rollRadians = float(-TSeconds(frameContext.lastFrameDuration).count() * kFWorldQuarterPi * 0.5);
+        rollRadians = float(-fTimeSecs * kFWorldQuarterPi * 0.5);
+    }
+
+    if (abs(rollRadians) > kFLocalEpsilon)
+    {
+        g_player.targetOrientation = g_player.targetOrientation * Quaternionl::CreateRotationXYZ(0, 0, rollRadians);
+        g_player.targetOrientation.Normalize();
     }
 
+    g_player.orientation = Quaternionl::CreateSlerp(g_player.orientation, g_player.targetOrientation, fTimeSecs * 2);
+    g_player.orientation.Normalize();
+}
+
+/////////////////////////////////////////////////////////
+// Exposed Functions
+
+ERunResult Initialize(const platform::SFixedTimestepConfig& simulationConfig)
+{
+    if (!g_simulation.Initialize(simulationConfig))
+        return eRR_Error;
+
+    g_player.position = Vec3l(0, 0, 8);
+    g_previousPlayerTransform = { g_player.position, g_player.orientation };
+    g_camera.transform = Matrix44l::CreateRotationAndTranslation(
+        EIdentity::Constructor,
+        g_player.position
+    );
+
+    platform::TActionMap actionMap = {
+      { SDLK_w, 0, HandleW },
+      { SDLK_a, 0, HandleA },
+      { SDLK_s, 0, HandleS },
+      { SDLK_d, 0, HandleD },
+      { SDLK_LCTRL, 0, HandleCtrl },
+      { SDLK_SPACE, 0, HandleSpace },
+      { SDLK_e, 0, HandleE },
+      { SDLK_q, 0, HandleQ },
+      { SDLK_F5, 0, HandleF5 },
+      { SDLK_F9, 0, HandleF9 }
+    };
+
+    platform::PushActionMap(std::move(actionMap));
+
+    { // Scene
+        const TTransformNode root = g_sceneTransforms.CreateNode();
+        g_shapeNodes[0] = g_sceneTransforms.CreateNode(root, Vec3l(1, 0, -1)); // spheres
+        g_shapeNodes[1] = g_sceneTransforms.CreateNode(root, Vec3l(3, 0, -1));
+
+        const TTransformNode cubePivot = g_sceneTransforms.CreateNode(root, Vec3l(-2, 0, -1));
+        g_shapeNodes[2] = g_sceneTransforms.CreateNode(cubePivot, Vec3l(1, 0, 0)); // cubes
+        g_shapeNodes[3] = g_sceneTransforms.CreateNode(cubePivot, Vec3l(-1, 0, 0));
+    } // ~Scene
+
+    return eRR_Success;
+}
+
+ERunResult Run(const SFrameContext& frameContext, renderer::SRenderSnapshot* pOutSnapshot)
+{
+    PROFILE_FUNCTION();
+    assert(pOutSnapshot != nullptr);
+    g_lastFrameId = frameContext.frameId;
+
+    // Mouse motion is a per frame delta, it turns the target orientation once and the ticks turn towards it
     Vec2i rawRelMouse(EUninitialized::Constructor);
     Vec2l relMouse(EUninitialized::Constructor);
     platform::GetRelativeMouseState(&rawRelMouse, &relMouse);
@@ -243,37 +380,118 @@ ERunResult Run(const SFrameContext& frameContext)
         normalizedMouse.y);
 #endif
 
-    float yawRadians = 0;
-    float pitchRadians = 0;
-
     if (rawRelMouse.x != 0 || rawRelMouse.y != 0)
     {
         static const double fSensitivity = 50.f;
         const float fSpdPerSec = g_player.rotSpdPerSec * float(TSeconds(frameContext.lastFrameDuration).count() * fSensitivity);
-        yawRadians = relMouse.x * fSpdPerSec;
-        pitchRadians = relMouse.y * fSpdPerSec;
+        const float yawRadians = relMouse.x * fSpdPerSec;
+        const float pitchRadians = relMouse.y * fSpdPerSec;
+        if (abs(yawRadians + pitchRadians) > kFLocalEpsilon)
+        {
+            g_player.targetOrientation = g_player.targetOrientation * Quaternionl::CreateRotationXYZ(pitchRadians, yawRadians, 0);
+            g_player.targetOrientation.Normalize();
+        }
     }
 
-    if (abs(rollRadians + yawRadians + pitchRadians) > kFLocalEpsilon)
+    const uint32_t numTicks = g_simulation.Advance(std::chrono::duration_cast<TTime::duration>(frameContext.lastFrameDuration));
+    const float fTickSecs = float(g_simulation.GetTickSeconds().count());
+    for (uint32_t tick = 0; tick < numTicks; ++tick)
     {
-        g_player.targetOrientation = g_player.targetOrientation * Quaternionl::CreateRotationXYZ(pitchRadians, yawRadians, rollRadians);
-        g_player.targetOrientation.Normalize();
+        PROFILE_SCOPE("SimulateTick");
+        SimulateTick(fTickSecs);
     }
 
-    g_player.orientation = Quaternionl::CreateSlerp(g_player.orientation, g_player.targetOrientation, float(TSeconds(frameContext.lastFrameDuration).count() * 2));
-    g_player.orientation.Normalize();
+    { // interpolation
+        const float alpha = g_simulation.GetInterpolationAlpha();
+        const Vec3l position = g_previousPlayerTransform.position + (g_player.position - g_previousPlayerTransform.position).Scaled(alpha);
+        Quaternionl orientation = Quaternionl::CreateSlerp(g_previousPlayerTransform.orientation, g_player.orientation, alpha);
+        orientation.Normalize();
 
-    g_camera.transform = Matrix44l::CreateRotationAndTranslation(
-        g_player.orientation,
-        g_player.position
-    );
+        g_camera.transform = Matrix44l::CreateRotationAndTranslation(
+            orientation,
+            position
+        );
+    } // ~interpolation
+
+    pOutSnapshot->viewMatrix = g_camera.transform;
+
+    g_sceneTransforms.UpdateTransforms();
+    renderer::ReserveShapeTransformUpdates(pOutSnapshot, kNumSceneShapes);
+    for (uint32_t shapeIndex = 0; shapeIndex < kNumSceneShapes; ++shapeIndex)
+    {
+        const TTransformNode node = g_shapeNodes[shapeIndex];
+        if (g_sceneTransforms.HasWorldChanged(node))
+        {
+            const bool bAdded = renderer::AddShapeTransformUpdate(pOutSnapshot, shapeIndex, g_sceneTransforms.GetInverseWorldMatrix(node));
+            assert(bAdded);
+            (void)bAdded;
+        }
+    }
 
-    renderer::SetViewMatrix(g_camera.transform);
     return eRR_Success;
 }
 
+bool SaveGameState(const char* fileName)
+{
+    std::vector<uint8_t> state;
+    CaptureGameState(&state);
+    if (!platform::WriteFileAtomic(fileName, state.data(), state.size()))
+    {
+        DiracError("[GameState] failed to save %s", fileName);
+        return false;
+    }
+
+    DiracLog(1, "[GameState] saved frame %llu to %s, %zu bytes", (unsigned long long)g_lastFrameId, fileName, state.size());
+    return true;
+}
+
+bool LoadGameState(const char* fileName)
+{
+    // Used in place, straight out of the file buffer or the mounted pak
+    platform::SFile file;
+    if (!platform::LoadFiles(&fileName, 1, platform::EFileType::Binary, &file))
+        return false;
+
+    SGameStateView view;
+    const EGameStateValidation validation = OpenGameState(file.pBytes, file.numBytes, &view);
+    if (validation != EGameStateValidation::Valid)
+    {
+        DiracError("[GameState] %s is not a valid snapshot: %s", fileName, ToString(validation));
+        return false;
+    }
+
+    if (!RestoreGameState(view))
+        return false;
+
+    DiracLog(1, "[GameState] loaded frame %llu from %s", (unsigned long long)view.pHeader->frameId, fileName);
+    return true;
+}
+
+uint64_t GetGameStateHash()
+{
+    std::vector<uint8_t> state;
+    CaptureGameState(&state);
+    SGameStateHeader header;
+    memcpy(&header, state.data(), sizeof(header));
+    return header.hash;
+}
+
 ERunResult Shutdown()
 {
+    if (g_sceneTransforms.GetNodeCount() > 0) // initialized
+    {
+        DiracLog(1, "[GameState] frame %llu hash %016llx", (unsigned long long)g_lastFrameId, (unsigned long long)GetGameStateHash());
+    }
+
+    platform::SFixedTimestepStats stats;
+    g_simulation.GetStats(&stats);
+    DiracLog(1, "[Simulation] %.1f ms ticks: %llu ticks over %llu frames, %llu frames without a tick, %llu clamped (%.1f ms dropped)",
+        TMilliseconds(g_simulation.GetTickDuration()).count(),
+        (unsigned long long)stats.numTicks,
+        (unsigned long long)stats.numFrames,
+        (unsigned long long)stats.numFramesWithoutTicks,
+        (unsigned long long)stats.numClampedFrames,
+        stats.droppedMs);
     return eRR_Success;
 }
 
@@ -7,9 +7,24 @@
 
 #include <vector2.h>
 
+#include "fixed_timestep.h"
+
+namespace renderer
+{
+    struct SRenderSnapshot;
+} // renderer namespace
+
 namespace game
 {
-    ERunResult Initialize();
-    ERunResult Run(const SFrameContext& frameContext);
+    ERunResult Initialize(const platform::SFixedTimestepConfig& simulationConfig);
+
+    // Runs the simulation ticks that fit into the frame's duration and fills pOutSnapshot with what the renderer
+    // needs to draw it, interpolated between the last two ticks
+    ERunResult Run(const SFrameContext& frameContext, renderer::SRenderSnapshot* pOutSnapshot);
     ERunResult Shutdown();
+
+    // Snapshots of the player, camera and scene shapes, see game_state.h
+    bool SaveGameState(const char* fileName);
+    bool LoadGameState(const char* fileName);
+    uint64_t GetGameStateHash(); // equal across runs that simulated the same frames
 } // namespace game
@@ -0,0 +1,291 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "game_state.h"
+
+namespace game
+{
+
+static constexpr uint32_t kMaxDeltaGapWords = 2; // a run header costs 2 words, shorter gaps of equal words stay in the run
+
+const char* ToString(EGameStateSection section)
+{
+    switch (section)
+    {
+    case EGameStateSection::Player: return "Player";
+    case EGameStateSection::Camera: return "Camera";
+    case EGameStateSection::Shapes: return "Shapes";
+    default: return "Unknown";
+    }
+}
+
+const char* ToString(EGameStateValidation validation)
+{
+    switch (validation)
+    {
+    case EGameStateValidation::Valid: return "Valid";
+    case EGameStateValidation::TooSmall: return "TooSmall";
+    case EGameStateValidation::BadMagic: return "BadMagic";
+    case EGameStateValidation::BadVersion: return "BadVersion";
+    case EGameStateValidation::SizeMismatch: return "SizeMismatch";
+    case EGameStateValidation::BadSection: return "BadSection";
+    case EGameStateValidation::HashMismatch: return "HashMismatch";
+    default: return "Unknown";
+    }
+}
+
+static size_t AlignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+uint64_t HashGameState(const void* pData, size_t numBytes)
+{
+    // FNV-1a over 64 bit words rather than bytes, finished with the murmur3 mix so every input bit reaches the result
+    const uint8_t* pBytes = (const uint8_t*)pData;
+    uint64_t hash = 14695981039346656037ull ^ numBytes;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= numBytes; i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        memcpy(&word, pBytes + i, sizeof(word));
+        hash = (hash ^ word) * 1099511628211ull;
+    }
+
+    for (; i < numBytes; ++i)
+    {
+        hash = (hash ^ pBytes[i]) * 1099511628211ull;
+    }
+
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+void BuildGameState(const SGameStateDesc& desc, std::vector<uint8_t>* pOutState)
+{
+    assert(desc.pPlayer != nullptr && desc.pCamera != nullptr);
+    assert(desc.pShapes != nullptr || desc.numShapes == 0);
+    assert(pOutState != nullptr);
+
+    SGameStateSection sections[(size_t)EGameStateSection::COUNT];
+    const void* sectionData[(size_t)EGameStateSection::COUNT] = { desc.pPlayer, desc.pCamera, desc.pShapes };
+    sections[(size_t)EGameStateSection::Player] = { EGameStateSection::Player, SPlayerState::kVersion, 0, 1, sizeof(SPlayerState), 0 };
+    sections[(size_t)EGameStateSection::Camera] = { EGameStateSection::Camera, SCameraState::kVersion, 0, 1, sizeof(SCameraState), 0 };
+    sections[(size_t)EGameStateSection::Shapes] = { EGameStateSection::Shapes, SShapeState::kVersion, 0, desc.numShapes, sizeof(SShapeState), 0 };
+
+    size_t offset = sizeof(SGameStateHeader) + sizeof(sections);
+    for (SGameStateSection& section : sections)
+    {
+        offset = AlignUp(offset, kGameStateAlignment);
+        section.offset = (uint32_t)offset;
+        offset += (size_t)section.count * section.elementSize;
+    }
+
+    // Zero filled so padding never differs between otherwise equal snapshots
+    pOutState->assign(AlignUp(offset, kGameStateAlignment), 0);
+    uint8_t* pState = pOutState->data();
+    memcpy(pState + sizeof(SGameStateHeader), sections, sizeof(sections));
+    for (size_t i = 0; i < (size_t)EGameStateSection::COUNT; ++i)
+    {
+        if (sections[i].count > 0)
+        {
+            memcpy(pState + sections[i].offset, sectionData[i], (size_t)sections[i].count * sections[i].elementSize);
+        }
+    }
+
+    SGameStateHeader header;
+    header.magic = kGameStateMagic;
+    header.version = kGameStateVersion;
+    header.size = (uint32_t)pOutState->size();
+    header.numSections = (uint32_t)EGameStateSection::COUNT;
+    header.frameId = desc.frameId;
+    header.hash = HashGameState(pState + sizeof(SGameStateHeader), pOutState->size() - sizeof(SGameStateHeader));
+    memcpy(pState, &header, sizeof(header));
+}
+
+EGameStateValidation OpenGameState(const void* pData, size_t numBytes, SGameStateView* pOutView)
+{
+    assert(pOutView != nullptr);
+    *pOutView = SGameStateView();
+    if (pData == nullptr || numBytes < sizeof(SGameStateHeader))
+        return EGameStateValidation::TooSmall;
+
+    assert(((uintptr_t)pData & 7) == 0);
+    const uint8_t* pState = (const uint8_t*)pData;
+    const SGameStateHeader* pHeader = reinterpret_cast<const SGameStateHeader*>(pState);
+    if (pHeader->magic != kGameStateMagic)
+        return EGameStateValidation::BadMagic;
+
+    if (pHeader->version != kGameStateVersion)
+        return EGameStateValidation::BadVersion;
+
+    if (pHeader->size != numBytes || pHeader->numSections != (uint32_t)EGameStateSection::COUNT ||
+        sizeof(SGameStateHeader) + sizeof(SGameStateSection) * pHeader->numSections > numBytes)
+        return EGameStateValidation::SizeMismatch;
+
+    static const uint32_t kSectionVersions[(size_t)EGameStateSection::COUNT] = { SPlayerState::kVersion, SCameraState::kVersion, SShapeState::kVersion };
+    static const uint32_t kSectionElementSizes[(size_t)EGameStateSection::COUNT] = { sizeof(SPlayerState), sizeof(SCameraState), sizeof(SShapeState) };
+    const SGameStateSection* pSections = reinterpret_cast<const SGameStateSection*>(pState + sizeof(SGameStateHeader));
+    const size_t sectionTableEnd = sizeof(SGameStateHeader) + sizeof(SGameStateSection) * pHeader->numSections;
+    for (uint32_t i = 0; i < pHeader->numSections; ++i)
+    {
+        const SGameStateSection& section = pSections[i];
+        if (section.id != (EGameStateSection)i || section.version != kSectionVersions[i] || section.elementSize != kSectionElementSizes[i] ||
+            section.offset % kGameStateAlignment != 0 || section.offset < sectionTableEnd ||
+            section.offset + (uint64_t)section.count * section.elementSize > numBytes)
+            return EGameStateValidation::BadSection;
+    }
+
+    if (pSections[(size_t)EGameStateSection::Player].count != 1 || pSections[(size_t)EGameStateSection::Camera].count != 1)
+        return EGameStateValidation::BadSection;
+
+    if (pHeader->hash != HashGameState(pState + sizeof(SGameStateHeader), numBytes - sizeof(SGameStateHeader)))
+        return EGameStateValidation::HashMismatch;
+
+    pOutView->pHeader = pHeader;
+    pOutView->pPlayer = reinterpret_cast<const SPlayerState*>(pState + pSections[(size_t)EGameStateSection::Player].offset);
+    pOutView->pCamera = reinterpret_cast<const SCameraState*>(pState + pSections[(size_t)EGameStateSection::Camera].offset);
+    pOutView->pShapes = reinterpret_cast<const SShapeState*>(pState + pSections[(size_t)EGameStateSection::Shapes].offset);
+    pOutView->numShapes = pSections[(size_t)EGameStateSection::Shapes].count;
+    return EGameStateValidation::Valid;
+}
+
+static uint32_t ReadStateWord(const uint8_t* pState, size_t wordIndex)
+{
+    uint32_t word;
+    memcpy(&word, pState + wordIndex * sizeof(uint32_t), sizeof(word));
+    return word;
+}
+
+bool BuildGameStateDelta(const void* pFrom, const void* pTo, size_t numBytes, std::vector<uint8_t>* pOutDelta)
+{
+    assert(pOutDelta != nullptr);
+    pOutDelta->clear();
+    SGameStateHeader fromHeader;
+    SGameStateHeader toHeader;
+    if (pFrom == nullptr || pTo == nullptr || numBytes < sizeof(SGameStateHeader) || numBytes % sizeof(uint32_t) != 0)
+        return false;
+
+    memcpy(&fromHeader, pFrom, sizeof(fromHeader));
+    memcpy(&toHeader, pTo, sizeof(toHeader));
+    if (fromHeader.size != numBytes || toHeader.size != numBytes)
+        return false;
+
+    SGameStateDeltaHeader header;
+    header.magic = kGameStateDeltaMagic;
+    header.stateSize = (uint32_t)numBytes;
+    header.fromHash = fromHeader.hash;
+    header.toHash = toHeader.hash;
+    pOutDelta->resize(sizeof(header));
+
+    const uint8_t* pFromBytes = (const uint8_t*)pFrom;
+    const uint8_t* pToBytes = (const uint8_t*)pTo;
+    const size_t numWords = numBytes / sizeof(uint32_t);
+    size_t word = 0;
+    while (word < numWords)
+    {
+        if (ReadStateWord(pFromBytes, word) == ReadStateWord(pToBytes, word))
+        {
+            ++word;
+            continue;
+        }
+
+        // Extend the run over short gaps of equal words, they cost less than a new run header
+        const size_t runBegin = word;
+        size_t runEnd = word + 1;
+        for (size_t next = runEnd; next < numWords && next - runEnd <= kMaxDeltaGapWords; ++next)
+        {
+            if (ReadStateWord(pFromBytes, next) != ReadStateWord(pToBytes, next))
+            {
+                runEnd = next + 1;
+            }
+        }
+
+        const SGameStateDeltaRun run = { (uint32_t)runBegin, (uint32_t)(runEnd - runBegin) };
+        const size_t runOffset = pOutDelta->size();
+        pOutDelta->resize(runOffset + sizeof(run) + run.numWords * sizeof(uint32_t));
+        memcpy(pOutDelta->data() + runOffset, &run, sizeof(run));
+        for (size_t i = runBegin; i < runEnd; ++i)
+        {
+            const uint32_t delta = ReadStateWord(pFromBytes, i) ^ ReadStateWord(pToBytes, i);
+            memcpy(pOutDelta->data() + runOffset + sizeof(run) + (i - runBegin) * sizeof(uint32_t), &delta, sizeof(delta));
+        }
+
+        ++header.numRuns;
+        word = runEnd;
+    }
+
+    memcpy(pOutDelta->data(), &header, sizeof(header));
+    return true;
+}
+
+// XORs every run into pState, returns false for a malformed delta before touching anything
+static bool XorGameStateDelta(const uint8_t* pDelta, size_t deltaSize, const SGameStateDeltaHeader& header, uint8_t* pState, bool bApply)
+{
+    const size_t numWords = header.stateSize / sizeof(uint32_t);
+    size_t offset = sizeof(SGameStateDeltaHeader);
+    for (uint32_t runIndex = 0; runIndex < header.numRuns; ++runIndex)
+    {
+        SGameStateDeltaRun run;
+        if (offset + sizeof(run) > deltaSize)
+            return false;
+
+        memcpy(&run, pDelta + offset, sizeof(run));
+        offset += sizeof(run);
+        if ((uint64_t)run.wordOffset + run.numWords > numWords || offset + (size_t)run.numWords * sizeof(uint32_t) > deltaSize)
+            return false;
+
+        for (uint32_t i = 0; bApply && i < run.numWords; ++i)
+        {
+            uint32_t delta;
+            memcpy(&delta, pDelta + offset + i * sizeof(uint32_t), sizeof(delta));
+            const uint32_t word = ReadStateWord(pState, run.wordOffset + i) ^ delta;
+            memcpy(pState + (run.wordOffset + i) * sizeof(uint32_t), &word, sizeof(word));
+        }
+
+        offset += (size_t)run.numWords * sizeof(uint32_t);
+    }
+
+    return offset == deltaSize;
+}
+
+bool ApplyGameStateDelta(const void* pDelta, size_t deltaSize, void* pState, size_t numBytes)
+{
+    SGameStateDeltaHeader header;
+    SGameStateHeader stateHeader;
+    if (pDelta == nullptr || pState == nullptr || deltaSize < sizeof(header) || numBytes < sizeof(stateHeader))
+        return false;
+
+    memcpy(&header, pDelta, sizeof(header));
+    memcpy(&stateHeader, pState, sizeof(stateHeader));
+    if (header.magic != kGameStateDeltaMagic || header.stateSize != numBytes || stateHeader.size != numBytes)
+        return false;
+
+    if (stateHeader.hash != header.fromHash && stateHeader.hash != header.toHash)
+        return false;
+
+    const uint8_t* pDeltaBytes = (const uint8_t*)pDelta;
+    uint8_t* pStateBytes = (uint8_t*)pState;
+    if (!XorGameStateDelta(pDeltaBytes, deltaSize, header, pStateBytes, false))
+        return false;
+
+    const uint64_t expectedHash = stateHeader.hash == header.fromHash ? header.toHash : header.fromHash;
+    XorGameStateDelta(pDeltaBytes, deltaSize, header, pStateBytes, true);
+    if (HashGameState(pStateBytes + sizeof(SGameStateHeader), numBytes - sizeof(SGameStateHeader)) != expectedHash)
+    {
+        DiracError("[GameState] delta produced a snapshot with an unexpected hash, restoring the original");
+        XorGameStateDelta(pDeltaBytes, deltaSize, header, pStateBytes, true);
+        return false;
+    }
+
+    return true;
+}
+
+} // game namespace
@@ -0,0 +1,175 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+#include <type_traits>
+#include <vector>
+
+#include "matrix43.h"
+#include "matrix44.h"
+#include "quaternion.h"
+#include "vector3.h"
+
+namespace game
+{
+
+/////////////////////////////////////////////////////////
+// Game state snapshots
+//
+// A flat binary layout of everything needed to restore the simulation, readable in place straight from a file
+// load or a mapping without any parsing (little endian):
+//   SGameStateHeader
+//   SGameStateSection[numSections]
+//   section data, every section starts on a kGameStateAlignment boundary, referenced by SGameStateSection::offset
+//
+// The header version covers the layout, each section carries its own version and element size so changing one
+// section's contents only invalidates that section. The header hash covers everything after the header and is a
+// cheap determinism check: two runs that simulated the same frames produce the same hash.
+//
+// Deltas between two snapshots of the same size store XOR runs of the 32 bit words that differ, so applying a delta
+// turns either snapshot into the other one, which is all a rewind buffer needs: a keyframe plus a chain of deltas
+// walks both ways.
+
+static constexpr uint32_t kGameStateMagic = 0x53475344; // "DSGS"
+static constexpr uint32_t kGameStateVersion = 1;
+static constexpr uint32_t kGameStateDeltaMagic = 0x44475344; // "DSGD"
+static constexpr uint32_t kGameStateAlignment = 16;
+
+enum class EGameStateSection : uint32_t
+{
+    Player,
+    Camera,
+    Shapes,
+    COUNT
+};
+
+const char* ToString(EGameStateSection section);
+
+struct SGameStateHeader
+{
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    uint32_t size = 0; // of the whole snapshot
+    uint32_t numSections = 0;
+    uint64_t frameId = 0;
+    uint64_t hash = 0; // HashGameState of everything after the header
+};
+
+struct SGameStateSection
+{
+    EGameStateSection id = EGameStateSection::COUNT;
+    uint32_t version = 0;
+    uint32_t offset = 0; // from the start of the snapshot
+    uint32_t count = 0;
+    uint32_t elementSize = 0;
+    uint32_t reserved = 0;
+};
+
+/////////////////////////////////////////////////////////
+// Sections, bump the version when a section's contents change
+
+struct SPlayerState
+{
+    static constexpr uint32_t kVersion = 2; // 2: velocity in units per second instead of per tick
+
+    Vec3l position;
+    Vec3l velocity;
+    Vec3l controlDir;
+    Quaternionl orientation;
+    Quaternionl targetOrientation;
+    uint16_t directions = 0; // EDirection::Flags
+    uint16_t activeDirections = 0;
+    uint16_t rotations = 0; // ERotation::Flags
+    uint16_t activeRotations = 0;
+};
+
+struct SCameraState
+{
+    static constexpr uint32_t kVersion = 1;
+
+    Matrix44l transform;
+};
+
+struct SShapeState
+{
+    static constexpr uint32_t kVersion = 1;
+
+    Vec3l localPosition;
+    Quaternionl localRotation;
+    Vec3l localScale;
+    Matrix43l inverseWorldMatrix; // what the SDF shaders consume, for using a snapshot without the game
+};
+
+static_assert(std::is_trivially_copyable_v<SPlayerState> && std::is_trivially_copyable_v<SCameraState> && std::is_trivially_copyable_v<SShapeState>, "sections are used in place");
+
+enum class EGameStateValidation : uint8_t
+{
+    Valid,
+    TooSmall,
+    BadMagic,
+    BadVersion,
+    SizeMismatch,
+    BadSection,
+    HashMismatch
+};
+
+const char* ToString(EGameStateValidation validation);
+
+struct SGameStateDesc
+{
+    TFrameId frameId = 0;
+    const SPlayerState* pPlayer = nullptr;
+    const SCameraState* pCamera = nullptr;
+    const SShapeState* pShapes = nullptr;
+    uint32_t numShapes = 0;
+};
+
+// Pointers into the snapshot, valid as long as its data
+struct SGameStateView
+{
+    const SGameStateHeader* pHeader = nullptr;
+    const SPlayerState* pPlayer = nullptr;
+    const SCameraState* pCamera = nullptr;
+    const SShapeState* pShapes = nullptr;
+    uint32_t numShapes = 0;
+};
+
+uint64_t HashGameState(const void* pData, size_t numBytes);
+
+void BuildGameState(const SGameStateDesc& desc, std::vector<uint8_t>* pOutState);
+
+// pData must be 8 byte aligned and outlive the view
+EGameStateValidation OpenGameState(const void* pData, size_t numBytes, SGameStateView* pOutView);
+
+/////////////////////////////////////////////////////////
+// Deltas
+//
+// SGameStateDeltaHeader followed by numRuns SGameStateDeltaRun, each followed by numWords uint32_t XOR values.
+
+struct SGameStateDeltaHeader
+{
+    uint32_t magic = 0;
+    uint32_t stateSize = 0; // both snapshots
+    uint32_t numRuns = 0;
+    uint32_t reserved = 0;
+    uint64_t fromHash = 0;
+    uint64_t toHash = 0;
+};
+
+struct SGameStateDeltaRun
+{
+    uint32_t wordOffset = 0;
+    uint32_t numWords = 0;
+};
+
+// Fails when the snapshots differ in size, store a full snapshot then
+bool BuildGameStateDelta(const void* pFrom, const void* pTo, size_t numBytes, std::vector<uint8_t>* pOutDelta);
+
+// Turns the snapshot at pState into the other side of the delta, in place. Fails without touching pState when it is
+// neither side, and reports a corrupt delta when the result doesn't hash to the other side.
+bool ApplyGameStateDelta(const void* pDelta, size_t deltaSize, void* pState, size_t numBytes);
+
+} // game namespace
@@ -0,0 +1,314 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "transform_hierarchy.h"
+
+#include <atomic>
+
+#include "jobs/job_system.h"
+
+namespace game
+{
+
+static constexpr uint32_t kParallelLevelSize = 1024; // smaller levels aren't worth the job overhead
+static constexpr uint32_t kParallelGrainSize = 256;
+
+struct SLevelUpdateContext
+{
+    STransformHierarchy* pHierarchy;
+    uint32_t levelStart;
+    std::atomic<uint32_t> numUpdated;
+};
+
+template <typename T>
+static void Permute(std::vector<T>* pValues, const std::vector<uint32_t>& order)
+{
+    std::vector<T> permuted;
+    permuted.reserve(order.size());
+    for (uint32_t slot : order)
+    {
+        permuted.push_back((*pValues)[slot]);
+    }
+
+    pValues->swap(permuted);
+}
+
+TTransformNode STransformHierarchy::CreateNode(TTransformNode parent, const Vec3l& position, const Quaternionl& rotation, const Vec3l& scale)
+{
+    assert(parent == kInvalidTransformNode || IsValid(parent));
+    TTransformNode node = kInvalidTransformNode;
+    if (!m_freeNodes.empty())
+    {
+        node = m_freeNodes.back();
+        m_freeNodes.pop_back();
+    }
+    else
+    {
+        node = TTransformNode(m_slotOfNode.size());
+        m_slotOfNode.push_back(kNoSlot);
+        m_destroyed.push_back(0);
+    }
+
+    // Appended out of depth order, SortByDepth places it before the next update
+    const uint32_t slot = uint32_t(m_nodeOfSlot.size());
+    m_slotOfNode[node] = slot;
+    m_nodeOfSlot.push_back(node);
+    m_parentNodes.push_back(parent);
+    m_parentSlots.push_back(parent != kInvalidTransformNode ? m_slotOfNode[parent] : kNoSlot);
+    m_depths.push_back(parent != kInvalidTransformNode ? m_depths[m_slotOfNode[parent]] + 1 : 0);
+    m_localPositions.push_back(position);
+    m_localRotations.push_back(rotation);
+    m_localScales.push_back(scale);
+    m_worldMatrices.push_back(Matrix43l(EIdentity::Constructor));
+    m_inverseWorldMatrices.push_back(Matrix43l(EIdentity::Constructor));
+    m_changedUpdates.push_back(0);
+    m_localDirty.push_back(1);
+    m_bOrderDirty = true;
+    return node;
+}
+
+void STransformHierarchy::DestroyNode(TTransformNode node)
+{
+    assert(IsValid(node));
+    m_destroyed[node] = 1; // descendants go with it when SortByDepth drops the subtree
+    ++m_numDestroyed;
+    m_bOrderDirty = true;
+}
+
+void STransformHierarchy::SetParent(TTransformNode node, TTransformNode parent)
+{
+    const uint32_t slot = GetSlot(node);
+    for (TTransformNode ancestor = parent; ancestor != kInvalidTransformNode; ancestor = m_parentNodes[GetSlot(ancestor)])
+    {
+        assert(ancestor != node && "reparenting would create a cycle");
+    }
+
+    m_parentNodes[slot] = parent;
+    m_localDirty[slot] = 1;
+    m_bOrderDirty = true;
+}
+
+bool STransformHierarchy::IsValid(TTransformNode node) const
+{
+    return node < m_slotOfNode.size() && m_slotOfNode[node] != kNoSlot && m_destroyed[node] == 0;
+}
+
+void STransformHierarchy::SetLocalPosition(TTransformNode node, const Vec3l& position)
+{
+    const uint32_t slot = GetSlot(node);
+    m_localPositions[slot] = position;
+    MarkDirty(slot);
+}
+
+void STransformHierarchy::SetLocalRotation(TTransformNode node, const Quaternionl& rotation)
+{
+    const uint32_t slot = GetSlot(node);
+    m_localRotations[slot] = rotation;
+    MarkDirty(slot);
+}
+
+void STransformHierarchy::SetLocalScale(TTransformNode node, const Vec3l& scale)
+{
+    const uint32_t slot = GetSlot(node);
+    m_localScales[slot] = scale;
+    MarkDirty(slot);
+}
+
+bool STransformHierarchy::HasWorldChanged(TTransformNode node) const
+{
+    return m_updateIndex > 0 && m_changedUpdates[GetSlot(node)] == m_updateIndex;
+}
+
+uint32_t STransformHierarchy::UpdateTransforms()
+{
+    if (m_bOrderDirty)
+    {
+        SortByDepth();
+    }
+
+    ++m_updateIndex;
+    uint32_t numUpdated = 0;
+    bool bLevelAboveChanged = false;
+    for (uint32_t depth = 0; depth < GetDepthCount(); ++depth)
+    {
+        if (m_levelDirty[depth] == 0 && !bLevelAboveChanged)
+            continue;
+
+        m_levelDirty[depth] = 0;
+        const uint32_t numLevelUpdated = UpdateLevel(m_levelStarts[depth], m_levelStarts[depth + 1]);
+        bLevelAboveChanged = numLevelUpdated > 0;
+        numUpdated += numLevelUpdated;
+    }
+
+    return numUpdated;
+}
+
+void STransformHierarchy::MarkDirty(uint32_t slot)
+{
+    m_localDirty[slot] = 1;
+    if (!m_bOrderDirty)
+    {
+        m_levelDirty[m_depths[slot]] = 1;
+    }
+}
+
+// Drops destroyed subtrees, recomputes depths and stable sorts every array by depth. Every node is marked dirty,
+// structural changes are rare enough that tracking which subtrees moved isn't worth it.
+void STransformHierarchy::SortByDepth()
+{
+    const uint32_t numSlots = uint32_t(m_nodeOfSlot.size());
+    std::vector<uint32_t> depths(numSlots, kNoSlot); // kNoSlot until resolved
+    std::vector<uint8_t> alive(numSlots, 0);
+    std::vector<uint32_t> chain;
+    uint32_t maxDepth = 0;
+    for (uint32_t slot = 0; slot < numSlots; ++slot)
+    {
+        // Walk up to a resolved ancestor (or a root), then resolve the chain on the way back down
+        uint32_t current = slot;
+        uint32_t baseDepth = kNoSlot; // depth of the resolved parent, kNoSlot meaning none
+        bool bBaseAlive = true;
+        while (depths[current] == kNoSlot)
+        {
+            chain.push_back(current);
+            const TTransformNode parent = m_parentNodes[current];
+            if (parent == kInvalidTransformNode)
+                break;
+
+            current = m_slotOfNode[parent];
+            if (depths[current] != kNoSlot)
+            {
+                baseDepth = depths[current];
+                bBaseAlive = alive[current] != 0;
+            }
+        }
+
+        while (!chain.empty())
+        {
+            const uint32_t chainSlot = chain.back();
+            chain.pop_back();
+            depths[chainSlot] = baseDepth + 1; // wraps to 0 for roots
+            alive[chainSlot] = bBaseAlive && m_destroyed[m_nodeOfSlot[chainSlot]] == 0;
+            baseDepth = depths[chainSlot];
+            bBaseAlive = alive[chainSlot] != 0;
+            maxDepth = std::max(maxDepth, baseDepth);
+        }
+    }
+
+    // Counting sort, stable so siblings keep their creation order
+    m_levelStarts.assign(size_t(maxDepth) + 2, 0);
+    for (uint32_t slot = 0; slot < numSlots; ++slot)
+    {
+        if (alive[slot] != 0)
+        {
+            ++m_levelStarts[depths[slot] + 1];
+        }
+    }
+
+    for (uint32_t depth = 1; depth < m_levelStarts.size(); ++depth)
+    {
+        m_levelStarts[depth] += m_levelStarts[depth - 1];
+    }
+
+    while (m_levelStarts.size() > 1 && m_levelStarts[m_levelStarts.size() - 2] == m_levelStarts.back())
+    {
+        m_levelStarts.pop_back(); // trailing levels emptied by destroyed subtrees
+    }
+
+    std::vector<uint32_t> order(m_levelStarts.back());
+    std::vector<uint32_t> nextSlot(m_levelStarts.begin(), m_levelStarts.end() - 1);
+    for (uint32_t slot = 0; slot < numSlots; ++slot)
+    {
+        const TTransformNode node = m_nodeOfSlot[slot];
+        if (alive[slot] != 0)
+        {
+            order[nextSlot[depths[slot]]++] = slot;
+        }
+        else
+        {
+            m_slotOfNode[node] = kNoSlot;
+            m_destroyed[node] = 0;
+            m_freeNodes.push_back(node);
+        }
+    }
+
+    Permute(&m_localPositions, order);
+    Permute(&m_localRotations, order);
+    Permute(&m_localScales, order);
+    Permute(&m_worldMatrices, order);
+    Permute(&m_inverseWorldMatrices, order);
+    Permute(&m_nodeOfSlot, order);
+    Permute(&m_parentNodes, order);
+    Permute(&depths, order);
+    m_depths.swap(depths);
+
+    const uint32_t numAlive = uint32_t(order.size());
+    m_parentSlots.resize(numAlive);
+    for (uint32_t slot = 0; slot < numAlive; ++slot)
+    {
+        m_slotOfNode[m_nodeOfSlot[slot]] = slot;
+    }
+
+    for (uint32_t slot = 0; slot < numAlive; ++slot)
+    {
+        const TTransformNode parent = m_parentNodes[slot];
+        m_parentSlots[slot] = parent != kInvalidTransformNode ? m_slotOfNode[parent] : kNoSlot;
+    }
+
+    m_changedUpdates.assign(numAlive, 0);
+    m_localDirty.assign(numAlive, 1);
+    m_levelDirty.assign(m_levelStarts.size() - 1, 1);
+    m_numDestroyed = 0;
+    m_bOrderDirty = false;
+}
+
+uint32_t STransformHierarchy::UpdateLevel(uint32_t begin, uint32_t end)
+{
+    SLevelUpdateContext context;
+    context.pHierarchy = this;
+    context.levelStart = begin;
+    context.numUpdated = 0;
+
+    const uint32_t count = end - begin;
+    if (count >= kParallelLevelSize)
+    {
+        jobs::ParallelFor(count, UpdateLevelRange, &context, kParallelGrainSize);
+    }
+    else
+    {
+        UpdateLevelRange(0, count, &context);
+    }
+
+    return context.numUpdated.load();
+}
+
+// Range is relative to the level start. Parents are a level up, so they are final by the time any node here reads them.
+void STransformHierarchy::UpdateLevelRange(uint32_t begin, uint32_t end, void* pData)
+{
+    SLevelUpdateContext* pContext = static_cast<SLevelUpdateContext*>(pData);
+    STransformHierarchy& hierarchy = *pContext->pHierarchy;
+    const uint32_t updateIndex = hierarchy.m_updateIndex;
+    uint32_t numUpdated = 0;
+    for (uint32_t slot = pContext->levelStart + begin, endSlot = pContext->levelStart + end; slot < endSlot; ++slot)
+    {
+        const uint32_t parentSlot = hierarchy.m_parentSlots[slot];
+        const bool bParentChanged = parentSlot != kNoSlot && hierarchy.m_changedUpdates[parentSlot] == updateIndex;
+        if (hierarchy.m_localDirty[slot] == 0 && !bParentChanged)
+            continue;
+
+        const Matrix33l scaleRotation = Matrix33l::CreateScale(hierarchy.m_localScales[slot]) * Matrix33l(hierarchy.m_localRotations[slot]);
+        const Matrix43l local = Matrix43l::CreateRotationAndTranslation(scaleRotation, hierarchy.m_localPositions[slot]);
+        const Matrix43l world = parentSlot != kNoSlot ? local * hierarchy.m_worldMatrices[parentSlot] : local;
+        hierarchy.m_worldMatrices[slot] = world;
+        hierarchy.m_inverseWorldMatrices[slot] = world.Inverted_Safe();
+        hierarchy.m_changedUpdates[slot] = updateIndex;
+        hierarchy.m_localDirty[slot] = 0;
+        ++numUpdated;
+    }
+
+    pContext->numUpdated.fetch_add(numUpdated, std::memory_order_relaxed);
+}
+
+} // game namespace
@@ -0,0 +1,112 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "matrix43.h"
+#include "quaternion.h"
+#include "vector3.h"
+
+namespace game
+{
+
+/////////////////////////////////////////////////////////
+// Transform hierarchy
+//
+// Parent/child transforms with local translation, rotation and scale. Every per node field is its own array (SoA),
+// and the arrays are kept sorted by depth so parents always come before their children: UpdateTransforms is one
+// linear pass per depth level, and large levels are split across the job system since nodes within a level never
+// depend on each other.
+//
+// Setting a local transform marks the node and its depth level dirty. A level is only visited when it holds a dirty
+// node or the level above changed, and within a visited level only dirty nodes and children of changed nodes do any
+// matrix work, so static subtrees cost nothing. Each world matrix is produced alongside its inverse, which is what the
+// SDF shapes consume.
+//
+// Structural changes (create, destroy, reparent) only reorder the arrays at the next UpdateTransforms, which then
+// recomputes every node. Node ids are stable until the node is destroyed and may be reused afterwards.
+
+typedef uint32_t TTransformNode;
+static constexpr TTransformNode kInvalidTransformNode = UINT32_MAX;
+
+struct STransformHierarchy
+{
+    STransformHierarchy() = default;
+    STransformHierarchy(const STransformHierarchy&) = delete;
+    STransformHierarchy& operator=(const STransformHierarchy&) = delete;
+
+    TTransformNode CreateNode(
+        TTransformNode parent = kInvalidTransformNode,
+        const Vec3l& position = Vec3l(EZero::Constructor),
+        const Quaternionl& rotation = Quaternionl(EIdentity::Constructor),
+        const Vec3l& scale = Vec3l(1, 1, 1));
+
+    void DestroyNode(TTransformNode node); // and all of its descendants
+    void SetParent(TTransformNode node, TTransformNode parent); // the local transform is kept, so the world one moves
+    bool IsValid(TTransformNode node) const;
+
+    void SetLocalPosition(TTransformNode node, const Vec3l& position);
+    void SetLocalRotation(TTransformNode node, const Quaternionl& rotation);
+    void SetLocalScale(TTransformNode node, const Vec3l& scale);
+
+    const Vec3l& GetLocalPosition(TTransformNode node) const { return m_localPositions[GetSlot(node)]; }
+    const Quaternionl& GetLocalRotation(TTransformNode node) const { return m_localRotations[GetSlot(node)]; }
+    const Vec3l& GetLocalScale(TTransformNode node) const { return m_localScales[GetSlot(node)]; }
+
+    // As of the last UpdateTransforms
+    const Matrix43l& GetWorldMatrix(TTransformNode node) const { return m_worldMatrices[GetSlot(node)]; }
+    const Matrix43l& GetInverseWorldMatrix(TTransformNode node) const { return m_inverseWorldMatrices[GetSlot(node)]; }
+    bool HasWorldChanged(TTransformNode node) const; // recomputed by the last UpdateTransforms
+
+    // Returns the number of world matrices recomputed
+    uint32_t UpdateTransforms();
+
+    uint32_t GetNodeCount() const { return uint32_t(m_nodeOfSlot.size()) - m_numDestroyed; }
+    uint32_t GetDepthCount() const { return m_levelStarts.empty() ? 0 : uint32_t(m_levelStarts.size()) - 1; }
+
+private:
+    static constexpr uint32_t kNoSlot = UINT32_MAX;
+
+    inline uint32_t GetSlot(TTransformNode node) const
+    {
+        assert(IsValid(node));
+        return m_slotOfNode[node];
+    }
+
+    void MarkDirty(uint32_t slot);
+    void SortByDepth();
+    uint32_t UpdateLevel(uint32_t begin, uint32_t end);
+    static void UpdateLevelRange(uint32_t begin, uint32_t end, void* pData);
+
+    // By slot, sorted by depth once m_bOrderDirty is clear
+    std::vector<Vec3l> m_localPositions;
+    std::vector<Quaternionl> m_localRotations;
+    std::vector<Vec3l> m_localScales;
+    std::vector<Matrix43l> m_worldMatrices;
+    std::vector<Matrix43l> m_inverseWorldMatrices;
+    std::vector<uint32_t> m_parentSlots; // kNoSlot for roots
+    std::vector<uint32_t> m_depths;
+    std::vector<uint32_t> m_changedUpdates; // m_updateIndex of the last update that recomputed the world matrix
+    std::vector<uint8_t> m_localDirty;
+    std::vector<TTransformNode> m_nodeOfSlot;
+    std::vector<TTransformNode> m_parentNodes; // survives reordering, m_parentSlots is derived from it
+
+    // By depth
+    std::vector<uint32_t> m_levelStarts; // slots of depth d are [m_levelStarts[d], m_levelStarts[d + 1])
+    std::vector<uint8_t> m_levelDirty;
+
+    // By node
+    std::vector<uint32_t> m_slotOfNode; // kNoSlot when free
+    std::vector<uint8_t> m_destroyed; // destroyed, still holding its slot until the next reorder
+    std::vector<TTransformNode> m_freeNodes;
+
+    uint32_t m_numDestroyed = 0;
+    uint32_t m_updateIndex = 0;
+    bool m_bOrderDirty = false;
+};
+
+} // game namespace
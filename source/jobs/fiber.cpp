@@ -0,0 +1,183 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "fiber.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace jobs
+{
+
+#if defined(_WIN32)
+
+static void WINAPI FiberEntry(void* pParameter)
+{
+    SFiber* pFiber = static_cast<SFiber*>(pParameter);
+    pFiber->function(pFiber->pData);
+    assert(false && "fiber functions must not return");
+}
+
+bool InitializeThreadFiber(SFiber* pFiber)
+{
+    assert(pFiber != nullptr);
+    pFiber->bThreadFiber = true;
+    pFiber->pHandle = IsThreadAFiber() ? GetCurrentFiber() : ConvertThreadToFiber(nullptr);
+    return pFiber->pHandle != nullptr;
+}
+
+void ShutdownThreadFiber(SFiber* pFiber)
+{
+    assert(pFiber != nullptr && pFiber->bThreadFiber);
+    ConvertFiberToThread();
+    pFiber->pHandle = nullptr;
+}
+
+bool InitializeFiber(SFiber* pFiber, size_t stackSize, TFiberFunction function, void* pData)
+{
+    assert(pFiber != nullptr && function != nullptr);
+    pFiber->function = function;
+    pFiber->pData = pData;
+    pFiber->bThreadFiber = false;
+    pFiber->pHandle = CreateFiberEx(stackSize, stackSize, FIBER_FLAG_FLOAT_SWITCH, FiberEntry, pFiber);
+    return pFiber->pHandle != nullptr;
+}
+
+void DestroyFiber(SFiber* pFiber)
+{
+    assert(pFiber != nullptr && !pFiber->bThreadFiber);
+    if (pFiber->pHandle != nullptr)
+    {
+        DeleteFiber(pFiber->pHandle);
+        pFiber->pHandle = nullptr;
+    }
+}
+
+void SwitchFiber(SFiber* /*pFrom*/, SFiber* pTo)
+{
+    SwitchToFiber(pTo->pHandle);
+}
+
+bool PinCurrentThreadToCore(uint32_t core)
+{
+    if (core >= sizeof(DWORD_PTR) * 8)
+        return false;
+
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << core) != 0;
+}
+
+#else
+
+static void FiberEntry(uint32_t pointerHigh, uint32_t pointerLow)
+{
+    // makecontext only passes ints
+    SFiber* pFiber = reinterpret_cast<SFiber*>((uintptr_t(pointerHigh) << 16 << 16) | uintptr_t(pointerLow));
+    pFiber->function(pFiber->pData);
+    assert(false && "fiber functions must not return");
+}
+
+bool InitializeThreadFiber(SFiber* pFiber)
+{
+    assert(pFiber != nullptr);
+    pFiber->bThreadFiber = true;
+    return true; // the context is filled in by the first switch away
+}
+
+void ShutdownThreadFiber(SFiber* pFiber)
+{
+    assert(pFiber != nullptr && pFiber->bThreadFiber);
+    (void)pFiber;
+}
+
+// Kept apart from InitializeFiber, getcontext returns twice so locals alive across it may be clobbered
+static bool MakeFiberContext(SFiber* pFiber, size_t guardSize)
+{
+    if (getcontext(&pFiber->context) != 0)
+        return false;
+
+    pFiber->context.uc_stack.ss_sp = (char*)pFiber->pStack + guardSize;
+    pFiber->context.uc_stack.ss_size = pFiber->stackAllocationSize - guardSize;
+    pFiber->context.uc_link = nullptr;
+    const uintptr_t pointer = reinterpret_cast<uintptr_t>(pFiber);
+    makecontext(
+        &pFiber->context,
+        reinterpret_cast<void (*)()>(FiberEntry),
+        2,
+        uint32_t(pointer >> 16 >> 16),
+        uint32_t(pointer & 0xffffffff));
+
+    return true;
+}
+
+bool InitializeFiber(SFiber* pFiber, size_t stackSize, TFiberFunction function, void* pData)
+{
+    assert(pFiber != nullptr && function != nullptr);
+    pFiber->function = function;
+    pFiber->pData = pData;
+    pFiber->bThreadFiber = false;
+
+    const size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    stackSize = (stackSize + pageSize - 1) / pageSize * pageSize;
+    pFiber->stackAllocationSize = stackSize + pageSize;
+    void* pStack = mmap(nullptr, pFiber->stackAllocationSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pStack == MAP_FAILED)
+        return false;
+
+    pFiber->pStack = pStack;
+    mprotect(pStack, pageSize, PROT_NONE); // stacks grow down, overflow faults instead of corrupting the neighbour
+    if (!MakeFiberContext(pFiber, pageSize))
+    {
+        DestroyFiber(pFiber);
+        return false;
+    }
+
+    return true;
+}
+
+void DestroyFiber(SFiber* pFiber)
+{
+    assert(pFiber != nullptr && !pFiber->bThreadFiber);
+    if (pFiber->pStack != nullptr)
+    {
+        munmap(pFiber->pStack, pFiber->stackAllocationSize);
+        pFiber->pStack = nullptr;
+        pFiber->stackAllocationSize = 0;
+    }
+}
+
+void SwitchFiber(SFiber* pFrom, SFiber* pTo)
+{
+    assert(pFrom != nullptr && pTo != nullptr && pFrom != pTo);
+    swapcontext(&pFrom->context, &pTo->context);
+}
+
+bool PinCurrentThreadToCore(uint32_t core)
+{
+#if defined(__linux__)
+    if (core >= CPU_SETSIZE)
+        return false;
+
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(core, &cpuSet);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet) == 0;
+#else
+    (void)core;
+    return false;
+#endif
+}
+
+#endif
+
+} // jobs namespace
@@ -0,0 +1,49 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+#if !defined(_WIN32)
+#include <ucontext.h>
+#endif
+
+namespace jobs
+{
+
+/////////////////////////////////////////////////////////
+// Fibers
+//
+// Thin wrapper over the OS user mode context switch: Win32 fibers on Windows, ucontext elsewhere.
+// Stacks are allocated once in InitializeFiber (with a guard page where supported) and reused for the fiber's lifetime.
+
+typedef void (*TFiberFunction)(void* pData); // must never return
+
+struct SFiber
+{
+#if defined(_WIN32)
+    void* pHandle = nullptr;
+#else
+    ucontext_t context;
+    void* pStack = nullptr; // includes the guard page
+    size_t stackAllocationSize = 0;
+#endif
+    TFiberFunction function = nullptr;
+    void* pData = nullptr;
+    bool bThreadFiber = false;
+};
+
+// Turns the calling thread into a fiber so it can switch to others, pair with ShutdownThreadFiber on the same thread
+bool InitializeThreadFiber(SFiber* pFiber);
+void ShutdownThreadFiber(SFiber* pFiber);
+
+bool InitializeFiber(SFiber* pFiber, size_t stackSize, TFiberFunction function, void* pData);
+void DestroyFiber(SFiber* pFiber); // must not be running
+
+// pFrom must be the running fiber, returns when something switches back to it
+void SwitchFiber(SFiber* pFrom, SFiber* pTo);
+
+bool PinCurrentThreadToCore(uint32_t core);
+
+} // jobs namespace
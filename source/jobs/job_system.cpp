@@ -0,0 +1,1031 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "job_system.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "fiber.h"
+#include "profiling/cpu_profiler.h"
+
+namespace jobs
+{
+
+////////////////////////////////////////////////
+// Constants
+
+static constexpr uint32_t kJobDequeCapacity = kJobPoolSize; // power of two
+static constexpr size_t kJobPayloadSize = 32;
+static constexpr uint32_t kIdleSpinCount = 64; // failed steal rounds before a worker sleeps
+static constexpr uint32_t kParallelForRangesPerThread = 8; // default grain aims for this many ranges per thread
+static constexpr uint32_t kInvalidThreadIndex = UINT32_MAX;
+
+static_assert((kJobPoolSize & (kJobPoolSize - 1)) == 0, "kJobPoolSize must be a power of two");
+
+#if defined(_MSC_VER)
+#define JOBS_NOINLINE __declspec(noinline)
+#else
+#define JOBS_NOINLINE __attribute__((noinline))
+#endif
+
+////////////////////////////////////////////////
+// Types
+
+struct SJob
+{
+    TJobFunction function = nullptr;
+    void* pData = nullptr;
+    SJob* pParent = nullptr;
+    SJobCounter* pCounter = nullptr;
+    std::atomic<int32_t> unfinishedJobs = { 0 }; // this job + unfinished children
+    std::atomic<int32_t> pendingDependencies = { 0 }; // unfinished prerequisites + 1 until submitted
+    std::atomic<uint32_t> generation = { 0 }; // bumped every time the slot is allocated, see SJobHandle
+    SJob* continuations[kMaxJobContinuations] = { nullptr };
+    uint32_t numContinuations = 0;
+    EJobAffinity affinity = EJobAffinity::Any;
+    bool bSubmitted = false;
+    alignas(8) char payload[kJobPayloadSize]; // inline pData storage for internal jobs
+};
+
+// Chase-Lev deque, see "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al. 2013).
+// Push and Pop are owner only, Steal is called by any thread.
+struct SJobDeque
+{
+    alignas(64) std::atomic<int64_t> top = { 0 }; // separate cache lines, thieves hammer top
+    alignas(64) std::atomic<int64_t> bottom = { 0 };
+    std::atomic<SJob*> buffer[kJobDequeCapacity];
+
+    bool Push(SJob* pJob)
+    {
+        const int64_t b = bottom.load(std::memory_order_relaxed);
+        const int64_t t = top.load(std::memory_order_acquire);
+        if (b - t >= (int64_t)kJobDequeCapacity)
+            return false;
+
+        buffer[b & (kJobDequeCapacity - 1)].store(pJob, std::memory_order_relaxed);
+        bottom.store(b + 1, std::memory_order_release);
+        return true;
+    }
+
+    SJob* Pop()
+    {
+        const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+        if (t > b)
+        {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        SJob* pJob = buffer[b & (kJobDequeCapacity - 1)].load(std::memory_order_relaxed);
+        if (t == b)
+        {
+            // last job, race thieves for it
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                pJob = nullptr;
+            }
+
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+
+        return pJob;
+    }
+
+    SJob* Steal()
+    {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b)
+            return nullptr;
+
+        SJob* pJob = buffer[t & (kJobDequeCapacity - 1)].load(std::memory_order_relaxed);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr; // lost to the owner or another thief
+
+        return pJob;
+    }
+
+    bool IsEmpty() const
+    {
+        return bottom.load(std::memory_order_seq_cst) <= top.load(std::memory_order_seq_cst);
+    }
+};
+
+struct SFiberSlot
+{
+    SFiber fiber;
+    uint32_t id = 0;
+    uint32_t mainThreadJobDepth = 0; // main thread jobs running on this fiber, pins it to the main thread while parked
+};
+
+// A parked fiber and what it waits for, no counter and no job means it only yielded
+struct SFiberWait
+{
+    SFiberSlot* pFiber = nullptr;
+    const SJobCounter* pCounter = nullptr;
+    SJobHandle job;
+    bool bMainThreadOnly = false;
+};
+
+// Deferred until the thread is off the old fiber's stack, so no other thread can resume it early
+enum class EFiberSwitchAction : uint8_t
+{
+    None,
+    ReturnToPool,
+    Park
+};
+
+struct SJobThread
+{
+    SJobDeque deque;
+    std::unique_ptr<SJob[]> pJobs = std::make_unique<SJob[]>(kJobPoolSize);
+    uint32_t nextJob = 0; // owner only
+    uint32_t randomState = 0; // owner only, victim selection
+
+    // Fibers, owner only. pCurrentFiber is nullptr when fibers are disabled.
+    SFiberSlot threadFiber;
+    SFiberSlot* pCurrentFiber = nullptr;
+    SFiberSlot* pSwitchedFrom = nullptr;
+    EFiberSwitchAction switchAction = EFiberSwitchAction::None;
+    SFiberWait pendingWait;
+
+    // Stats, written by the owner and read by GetJobSystemStats
+    std::atomic<uint64_t> jobsExecuted = { 0 };
+    std::atomic<uint64_t> jobsStolen = { 0 };
+    std::atomic<uint64_t> fiberSwitches = { 0 };
+    std::atomic<uint64_t> waitsParked = { 0 };
+    std::atomic<uint64_t> waitsHelped = { 0 };
+};
+
+struct SParallelForRange
+{
+    TParallelForFunction function;
+    void* pData;
+    uint32_t begin;
+    uint32_t end;
+    uint32_t grainSize;
+};
+
+static_assert(sizeof(SParallelForRange) <= kJobPayloadSize, "SParallelForRange doesn't fit in a job payload");
+
+////////////////////////////////////////////////
+// State
+
+static std::unique_ptr<SJobThread[]> g_pThreads;
+static uint32_t g_numThreads = 0;
+static std::vector<std::thread> g_workers; // main thread only
+static std::atomic<bool> g_bStopWorkers = { false };
+static bool g_bPinThreads = false;
+static thread_local uint32_t t_threadIndex = kInvalidThreadIndex; // read through CurrentThreadIndex, see there
+
+// Sleeping workers, g_wakeTokens guarded by g_sleepMutex
+static std::mutex g_sleepMutex;
+static std::condition_variable g_sleepCondition;
+static std::atomic<uint32_t> g_numSleepingWorkers = { 0 };
+static uint32_t g_wakeTokens = 0;
+
+// Main thread affinity jobs, guarded by g_mainThreadJobsMutex
+static std::mutex g_mainThreadJobsMutex;
+static std::vector<SJob*> g_mainThreadJobs;
+static std::atomic<uint32_t> g_numMainThreadJobs = { 0 };
+
+// Fiber pool, guarded by g_fiberPoolMutex
+static bool g_bFibers = false;
+static std::mutex g_fiberPoolMutex;
+static std::unique_ptr<SFiberSlot[]> g_pFibers;
+static uint32_t g_numFibers = 0;
+static std::vector<SFiberSlot*> g_freeFibers;
+static uint32_t g_peakFibersInUse = 0;
+
+// Parked fibers in the order they parked, guarded by g_parkedFibersMutex
+static std::mutex g_parkedFibersMutex;
+static std::vector<SFiberWait> g_parkedFibers;
+static std::atomic<uint32_t> g_numParkedFibers = { 0 };
+
+static std::atomic<TFiberSwitchCallback> g_fiberSwitchCallback = { nullptr };
+
+////////////////////////////////////////////////
+// Scheduling
+
+static void ExecuteJob(SJob* pJob);
+
+// A fiber can park on one thread and resume on another, but compilers assume the address of a thread_local is fixed
+// for the duration of a function and may cache it across the switch. Every read goes through a call that can't be inlined.
+static JOBS_NOINLINE uint32_t CurrentThreadIndex()
+{
+    return t_threadIndex;
+}
+
+static SJobThread& CurrentThread()
+{
+    const uint32_t threadIndex = CurrentThreadIndex();
+    assert(threadIndex < g_numThreads && "only job system threads can run, create or wait on jobs");
+    return g_pThreads[threadIndex];
+}
+
+static bool HasStealableJobs()
+{
+    for (uint32_t i = 0; i < g_numThreads; ++i)
+    {
+        if (!g_pThreads[i].deque.IsEmpty())
+            return true;
+    }
+
+    return false;
+}
+
+static void WakeWorker()
+{
+    // pairs with the increment in WaitForWork: either the sleeper sees the pushed job or we see the sleeper
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (g_numSleepingWorkers.load(std::memory_order_seq_cst) == 0)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(g_sleepMutex);
+        g_wakeTokens = std::min<uint32_t>(g_wakeTokens + 1, (uint32_t)g_workers.size());
+    }
+
+    g_sleepCondition.notify_one();
+}
+
+static void ScheduleJob(SJob* pJob)
+{
+    if (pJob->affinity == EJobAffinity::MainThread)
+    {
+        std::lock_guard<std::mutex> lock(g_mainThreadJobsMutex);
+        g_mainThreadJobs.push_back(pJob);
+        g_numMainThreadJobs.fetch_add(1, std::memory_order_release);
+        return;
+    }
+
+    if (!CurrentThread().deque.Push(pJob))
+    {
+        ExecuteJob(pJob); // deque full, running inline keeps the ordering guarantees
+        return;
+    }
+
+    WakeWorker();
+}
+
+static void FinishJob(SJob* pJob)
+{
+    // Copy everything needed before the final decrement, the slot may be reused as soon as it reaches zero
+    SJob* pParent = pJob->pParent;
+    SJobCounter* pCounter = pJob->pCounter;
+    SJob* continuations[kMaxJobContinuations];
+    const uint32_t numContinuations = pJob->numContinuations;
+    std::copy(pJob->continuations, pJob->continuations + numContinuations, continuations);
+
+    if (pJob->unfinishedJobs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        return; // children still running, the last one finishes us
+
+    for (uint32_t i = 0; i < numContinuations; ++i)
+    {
+        if (continuations[i]->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            ScheduleJob(continuations[i]);
+        }
+    }
+
+    if (pCounter != nullptr)
+    {
+        pCounter->value.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    // A parked fiber may be waiting on this job or counter, make sure a sleeping worker comes to look.
+    // Pairs with the increment in ParkFiber.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (g_numParkedFibers.load(std::memory_order_relaxed) > 0)
+    {
+        WakeWorker();
+    }
+
+    if (pParent != nullptr)
+    {
+        FinishJob(pParent);
+    }
+}
+
+static void ExecuteJob(SJob* pJob)
+{
+    SJobThread& thread = CurrentThread();
+    thread.jobsExecuted.fetch_add(1, std::memory_order_relaxed);
+
+    // The fiber travels with the job if it parks, so the depth stays with the right stack
+    SFiberSlot* pFiber = thread.pCurrentFiber;
+    const bool bMainThreadJob = pJob->affinity == EJobAffinity::MainThread && pFiber != nullptr;
+    if (bMainThreadJob)
+    {
+        ++pFiber->mainThreadJobDepth;
+    }
+
+    pJob->function(pJob, pJob->pData);
+
+    if (bMainThreadJob)
+    {
+        --pFiber->mainThreadJobDepth;
+    }
+
+    FinishJob(pJob);
+}
+
+static SJob* PopMainThreadJob()
+{
+    if (g_numMainThreadJobs.load(std::memory_order_acquire) == 0)
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(g_mainThreadJobsMutex);
+    if (g_mainThreadJobs.empty())
+        return nullptr;
+
+    SJob* pJob = g_mainThreadJobs.front();
+    g_mainThreadJobs.erase(g_mainThreadJobs.begin());
+    g_numMainThreadJobs.fetch_sub(1, std::memory_order_relaxed);
+    return pJob;
+}
+
+static SJob* StealJob(uint32_t threadIndex)
+{
+    if (g_numThreads < 2)
+        return nullptr;
+
+    // xorshift, a random first victim spreads thieves across deques
+    uint32_t& state = g_pThreads[threadIndex].randomState;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+
+    const uint32_t firstVictim = state % g_numThreads;
+    for (uint32_t i = 0; i < g_numThreads; ++i)
+    {
+        const uint32_t victim = (firstVictim + i) % g_numThreads;
+        if (victim == threadIndex)
+            continue;
+
+        if (SJob* pJob = g_pThreads[victim].deque.Steal())
+        {
+            g_pThreads[threadIndex].jobsStolen.fetch_add(1, std::memory_order_relaxed);
+            return pJob;
+        }
+    }
+
+    return nullptr;
+}
+
+static bool RunOneJob(uint32_t threadIndex)
+{
+    assert(threadIndex < g_numThreads && "only job system threads can run jobs");
+    SJob* pJob = nullptr;
+    if (threadIndex == kMainThreadIndex)
+    {
+        pJob = PopMainThreadJob();
+    }
+
+    if (pJob == nullptr)
+    {
+        pJob = g_pThreads[threadIndex].deque.Pop();
+    }
+
+    if (pJob == nullptr)
+    {
+        pJob = StealJob(threadIndex);
+    }
+
+    if (pJob == nullptr)
+        return false;
+
+    ExecuteJob(pJob);
+    return true;
+}
+
+static void WaitForWork()
+{
+    std::unique_lock<std::mutex> lock(g_sleepMutex);
+    g_numSleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+    g_sleepCondition.wait(lock, [] { return g_wakeTokens > 0 || g_bStopWorkers.load() || HasStealableJobs(); });
+    if (g_wakeTokens > 0)
+    {
+        --g_wakeTokens;
+    }
+
+    g_numSleepingWorkers.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+////////////////////////////////////////////////
+// Fibers
+
+static bool IsWaitSatisfied(const SFiberWait& wait)
+{
+    if (wait.pCounter != nullptr)
+        return wait.pCounter->value.load(std::memory_order_acquire) <= 0;
+
+    if (wait.job.pJob != nullptr)
+        return IsJobFinished(wait.job);
+
+    return true;
+}
+
+static bool IsMainThreadBound(const SFiberSlot* pFiber)
+{
+    return pFiber == &g_pThreads[kMainThreadIndex].threadFiber || pFiber->mainThreadJobDepth > 0;
+}
+
+static SFiberSlot* AcquireFiber()
+{
+    std::lock_guard<std::mutex> lock(g_fiberPoolMutex);
+    if (g_freeFibers.empty())
+        return nullptr;
+
+    SFiberSlot* pFiber = g_freeFibers.back();
+    g_freeFibers.pop_back();
+    g_peakFibersInUse = std::max(g_peakFibersInUse, g_numFibers - (uint32_t)g_freeFibers.size());
+    return pFiber;
+}
+
+static void ReleaseFiber(SFiberSlot* pFiber)
+{
+    assert(pFiber != nullptr && !pFiber->fiber.bThreadFiber && pFiber->mainThreadJobDepth == 0);
+    std::lock_guard<std::mutex> lock(g_fiberPoolMutex);
+    g_freeFibers.push_back(pFiber);
+}
+
+static void ParkFiber(const SFiberWait& wait)
+{
+    std::lock_guard<std::mutex> lock(g_parkedFibersMutex);
+    g_parkedFibers.push_back(wait);
+    g_numParkedFibers.fetch_add(1, std::memory_order_seq_cst);
+}
+
+// Removes and returns the longest parked fiber the thread may resume whose wait is satisfied
+static SFiberSlot* TakeResumableFiber(uint32_t threadIndex)
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with the fence in FinishJob
+    if (g_numParkedFibers.load(std::memory_order_relaxed) == 0)
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(g_parkedFibersMutex);
+    for (auto it = g_parkedFibers.begin(); it != g_parkedFibers.end(); ++it)
+    {
+        if ((it->bMainThreadOnly && threadIndex != kMainThreadIndex) || !IsWaitSatisfied(*it))
+            continue;
+
+        SFiberSlot* pFiber = it->pFiber;
+        g_parkedFibers.erase(it);
+        g_numParkedFibers.fetch_sub(1, std::memory_order_relaxed);
+        return pFiber;
+    }
+
+    return nullptr;
+}
+
+static bool HasResumableFiber(uint32_t threadIndex)
+{
+    if (g_numParkedFibers.load(std::memory_order_acquire) == 0)
+        return false;
+
+    std::lock_guard<std::mutex> lock(g_parkedFibersMutex);
+    return std::any_of(g_parkedFibers.begin(), g_parkedFibers.end(), [threadIndex](const SFiberWait& wait)
+    {
+        return (!wait.bMainThreadOnly || threadIndex == kMainThreadIndex) && IsWaitSatisfied(wait);
+    });
+}
+
+// Runs on whichever fiber a switch lands on, possibly on a different thread than the one that left it
+static void FinishFiberSwitch()
+{
+    SJobThread& thread = CurrentThread();
+    SFiberSlot* pFrom = thread.pSwitchedFrom;
+    const EFiberSwitchAction action = thread.switchAction;
+    thread.pSwitchedFrom = nullptr;
+    thread.switchAction = EFiberSwitchAction::None;
+
+    switch (action)
+    {
+    case EFiberSwitchAction::None: break;
+    case EFiberSwitchAction::ReturnToPool: ReleaseFiber(pFrom); break;
+    case EFiberSwitchAction::Park: ParkFiber(thread.pendingWait); break;
+    }
+}
+
+static void SwitchToFiberSlot(SFiberSlot* pTo, EFiberSwitchAction action)
+{
+    SJobThread& thread = CurrentThread();
+    SFiberSlot* pFrom = thread.pCurrentFiber;
+    assert(pFrom != nullptr && pTo != nullptr && pFrom != pTo);
+    thread.pSwitchedFrom = pFrom;
+    thread.switchAction = action;
+    thread.pCurrentFiber = pTo;
+    thread.fiberSwitches.fetch_add(1, std::memory_order_relaxed);
+    if (TFiberSwitchCallback callback = g_fiberSwitchCallback.load(std::memory_order_relaxed))
+    {
+        callback(CurrentThreadIndex(), pFrom->id, pTo->id);
+    }
+
+    SwitchFiber(&pFrom->fiber, &pTo->fiber);
+
+    // resumed, maybe on another thread
+    FinishFiberSwitch();
+}
+
+// Parks the running fiber until the wait is satisfied, returns false if no fiber was free to switch to
+static bool ParkCurrentFiber(SFiberWait wait)
+{
+    SJobThread& thread = CurrentThread();
+    if (thread.pCurrentFiber == nullptr)
+        return false;
+
+    SFiberSlot* pNext = AcquireFiber();
+    if (pNext == nullptr)
+        return false;
+
+    wait.pFiber = thread.pCurrentFiber;
+    wait.bMainThreadOnly = IsMainThreadBound(thread.pCurrentFiber);
+    thread.pendingWait = wait;
+    thread.waitsParked.fetch_add(1, std::memory_order_relaxed);
+    SwitchToFiberSlot(pNext, EFiberSwitchAction::Park);
+    return true;
+}
+
+static void WaitFor(const SFiberWait& wait)
+{
+    if (IsWaitSatisfied(wait))
+        return;
+
+    if (ParkCurrentFiber(wait))
+    {
+        assert(IsWaitSatisfied(wait));
+        return;
+    }
+
+    CurrentThread().waitsHelped.fetch_add(1, std::memory_order_relaxed);
+    while (!IsWaitSatisfied(wait))
+    {
+        if (!RunOneJob(CurrentThreadIndex()))
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+// Resumes parked fibers and runs jobs, returns once a worker is asked to stop. The main thread never returns.
+static void RunScheduler()
+{
+    uint32_t numIdleSpins = 0;
+    while (true)
+    {
+        const uint32_t threadIndex = CurrentThreadIndex();
+        if (threadIndex != kMainThreadIndex && g_bStopWorkers.load(std::memory_order_acquire))
+            return;
+
+        if (SFiberSlot* pFiber = TakeResumableFiber(threadIndex))
+        {
+            // this fiber is only running the scheduler, so it can go straight back to the pool
+            SwitchToFiberSlot(pFiber, EFiberSwitchAction::ReturnToPool);
+            numIdleSpins = 0;
+        }
+        else if (RunOneJob(threadIndex))
+        {
+            numIdleSpins = 0;
+        }
+        else if (threadIndex == kMainThreadIndex || ++numIdleSpins < kIdleSpinCount)
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            numIdleSpins = 0;
+            WaitForWork();
+        }
+    }
+}
+
+static void FiberMain(void* /*pData*/)
+{
+    FinishFiberSwitch();
+    while (true)
+    {
+        RunScheduler();
+
+        // stopping, hand the thread back to the stack it started on. Resumed again if reused from the pool.
+        SwitchToFiberSlot(&CurrentThread().threadFiber, EFiberSwitchAction::ReturnToPool);
+    }
+}
+
+static void JobWorker(uint32_t threadIndex)
+{
+    t_threadIndex = threadIndex;
+    char threadName[profiling::kMaxProfileThreadName];
+    snprintf(threadName, sizeof(threadName), "Job worker %u", threadIndex);
+    profiling::SetProfileThreadName(threadName);
+    if (g_bPinThreads && !PinCurrentThreadToCore(threadIndex))
+    {
+        DiracLog(1, "[Jobs] failed to pin worker %u", threadIndex);
+    }
+
+    if (!g_bFibers)
+    {
+        RunScheduler();
+        return;
+    }
+
+    SJobThread& thread = g_pThreads[threadIndex];
+    InitializeThreadFiber(&thread.threadFiber.fiber);
+    thread.pCurrentFiber = &thread.threadFiber;
+    SFiberSlot* pFiber = AcquireFiber();
+    assert(pFiber != nullptr && "the fiber pool is sized for every thread");
+    SwitchToFiberSlot(pFiber, EFiberSwitchAction::None);
+
+    // back on the thread fiber after RunScheduler returned
+    thread.pCurrentFiber = nullptr;
+    ShutdownThreadFiber(&thread.threadFiber.fiber);
+}
+
+static bool InitializeFibers(const SJobSystemConfig& config)
+{
+    // every thread's scheduler needs a fiber, leave at least as many again for parked waits
+    g_numFibers = std::max(config.numFibers, g_numThreads * 2);
+    g_pFibers = std::make_unique<SFiberSlot[]>(g_numFibers);
+    g_freeFibers.clear();
+    g_freeFibers.reserve(g_numFibers);
+    for (uint32_t i = 0; i < g_numFibers; ++i)
+    {
+        SFiberSlot& slot = g_pFibers[i];
+        slot.id = i;
+        if (!InitializeFiber(&slot.fiber, config.fiberStackSize, FiberMain, nullptr))
+        {
+            DiracError("[Jobs] failed to create fiber %u", i);
+            for (uint32_t j = 0; j < i; ++j)
+            {
+                DestroyFiber(&g_pFibers[j].fiber);
+            }
+
+            g_pFibers.reset();
+            g_freeFibers.clear();
+            g_numFibers = 0;
+            return false;
+        }
+
+        g_freeFibers.push_back(&slot);
+    }
+
+    // pop from the back, hand out low ids first
+    std::reverse(g_freeFibers.begin(), g_freeFibers.end());
+
+    for (uint32_t i = 0; i < g_numThreads; ++i)
+    {
+        g_pThreads[i].threadFiber.id = g_numFibers + i;
+    }
+
+    SJobThread& mainThread = g_pThreads[kMainThreadIndex];
+    if (!InitializeThreadFiber(&mainThread.threadFiber.fiber))
+    {
+        DiracError("[Jobs] failed to convert the main thread to a fiber");
+        return false;
+    }
+
+    mainThread.pCurrentFiber = &mainThread.threadFiber;
+    return true;
+}
+
+static void ShutdownFibers()
+{
+    SJobThread& mainThread = g_pThreads[kMainThreadIndex];
+    if (mainThread.pCurrentFiber != nullptr)
+    {
+        assert(mainThread.pCurrentFiber == &mainThread.threadFiber);
+        ShutdownThreadFiber(&mainThread.threadFiber.fiber);
+        mainThread.pCurrentFiber = nullptr;
+    }
+
+    assert(g_parkedFibers.empty() && "job system shut down with parked fibers");
+    assert(g_freeFibers.size() == g_numFibers);
+    for (uint32_t i = 0; i < g_numFibers; ++i)
+    {
+        DestroyFiber(&g_pFibers[i].fiber);
+    }
+
+    g_pFibers.reset();
+    g_freeFibers.clear();
+    g_numFibers = 0;
+}
+
+////////////////////////////////////////////////
+// Functions
+
+const char* ToString(EJobAffinity affinity)
+{
+    switch (affinity)
+    {
+    case EJobAffinity::Any: return "Any";
+    case EJobAffinity::MainThread: return "MainThread";
+    }
+
+    return "Unknown";
+}
+
+bool InitializeJobSystem(const SJobSystemConfig& config)
+{
+    assert(g_workers.empty() && g_pThreads == nullptr);
+    g_numThreads = config.numWorkerThreads + 1;
+    g_pThreads = std::make_unique<SJobThread[]>(g_numThreads);
+    for (uint32_t i = 0; i < g_numThreads; ++i)
+    {
+        g_pThreads[i].randomState = 0x9e3779b9u * (i + 1);
+    }
+
+    g_bStopWorkers = false;
+    g_bPinThreads = config.bPinThreads;
+    g_peakFibersInUse = 0;
+    t_threadIndex = kMainThreadIndex;
+    if (g_bPinThreads && !PinCurrentThreadToCore(kMainThreadIndex))
+    {
+        DiracLog(1, "[Jobs] failed to pin the main thread");
+    }
+
+    g_bFibers = config.bFibers && InitializeFibers(config);
+    if (config.bFibers && !g_bFibers)
+    {
+        DiracLog(1, "[Jobs] fibers unavailable, waits will run jobs on the waiting stack");
+    }
+
+    g_workers.reserve(config.numWorkerThreads);
+    for (uint32_t i = 0; i < config.numWorkerThreads; ++i)
+    {
+        g_workers.emplace_back(JobWorker, i + 1);
+    }
+
+    DiracLog(1, "[Jobs] worker threads: %u, fibers: %u", config.numWorkerThreads, g_numFibers);
+    return true;
+}
+
+void ShutdownJobSystem()
+{
+    assert(CurrentThreadIndex() == kMainThreadIndex);
+    {
+        std::lock_guard<std::mutex> lock(g_sleepMutex);
+        g_bStopWorkers = true;
+    }
+
+    g_sleepCondition.notify_all();
+    for (std::thread& worker : g_workers)
+    {
+        worker.join();
+    }
+
+    g_workers.clear();
+    assert(!HasStealableJobs() && g_mainThreadJobs.empty() && "job system shut down with jobs in flight");
+    if (g_bFibers)
+    {
+        ShutdownFibers();
+        g_bFibers = false;
+    }
+
+    g_pThreads.reset();
+    g_numThreads = 0;
+    g_wakeTokens = 0;
+    t_threadIndex = kInvalidThreadIndex;
+}
+
+bool AreJobFibersEnabled()
+{
+    return g_bFibers;
+}
+
+void GetJobSystemStats(SJobSystemStats* pOutStats)
+{
+    assert(pOutStats != nullptr);
+    *pOutStats = SJobSystemStats();
+    for (uint32_t i = 0; i < g_numThreads; ++i)
+    {
+        const SJobThread& thread = g_pThreads[i];
+        pOutStats->jobsExecuted += thread.jobsExecuted.load(std::memory_order_relaxed);
+        pOutStats->jobsStolen += thread.jobsStolen.load(std::memory_order_relaxed);
+        pOutStats->fiberSwitches += thread.fiberSwitches.load(std::memory_order_relaxed);
+        pOutStats->waitsParked += thread.waitsParked.load(std::memory_order_relaxed);
+        pOutStats->waitsHelped += thread.waitsHelped.load(std::memory_order_relaxed);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_fiberPoolMutex);
+        pOutStats->fibersInUse = g_numFibers - (uint32_t)g_freeFibers.size();
+        pOutStats->peakFibersInUse = g_peakFibersInUse;
+    }
+
+    pOutStats->fibersParked = g_numParkedFibers.load(std::memory_order_relaxed);
+}
+
+void SetFiberSwitchCallback(TFiberSwitchCallback callback)
+{
+    g_fiberSwitchCallback.store(callback, std::memory_order_relaxed);
+}
+
+uint32_t GetJobThreadCount()
+{
+    return g_numThreads;
+}
+
+uint32_t GetCurrentJobThreadIndex()
+{
+    return CurrentThreadIndex();
+}
+
+static SJob* AllocateJob(SJob* pParent, TJobFunction function, void* pData, EJobAffinity affinity)
+{
+    assert(function != nullptr);
+    SJobThread& thread = CurrentThread();
+    SJob* pJob = &thread.pJobs[thread.nextJob++ & (kJobPoolSize - 1)];
+
+    // acquire pairs with the final decrement in FinishJob so the previous use is complete
+    const int32_t previousUnfinishedJobs = pJob->unfinishedJobs.load(std::memory_order_acquire);
+    assert(previousUnfinishedJobs == 0 && "job pool wrapped around onto an unfinished job");
+    (void)previousUnfinishedJobs;
+
+    pJob->function = function;
+    pJob->pData = pData;
+    pJob->pParent = pParent;
+    pJob->pCounter = nullptr;
+    pJob->generation.store(pJob->generation.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    pJob->unfinishedJobs.store(1, std::memory_order_release); // publishes the generation to IsJobFinished
+    pJob->pendingDependencies.store(1, std::memory_order_relaxed);
+    pJob->numContinuations = 0;
+    pJob->affinity = affinity;
+    pJob->bSubmitted = false;
+
+    if (pParent != nullptr)
+    {
+        pParent->unfinishedJobs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    return pJob;
+}
+
+SJob* CreateJob(TJobFunction function, void* pData, EJobAffinity affinity)
+{
+    return AllocateJob(nullptr, function, pData, affinity);
+}
+
+SJob* CreateChildJob(SJob* pParent, TJobFunction function, void* pData, EJobAffinity affinity)
+{
+    assert(pParent != nullptr);
+    assert(pParent->unfinishedJobs.load(std::memory_order_relaxed) > 0 && "children can only be added to running jobs");
+    return AllocateJob(pParent, function, pData, affinity);
+}
+
+bool AddJobDependency(SJob* pJob, SJob* pPrerequisite)
+{
+    assert(pJob != nullptr && pPrerequisite != nullptr && pJob != pPrerequisite);
+    assert(!pJob->bSubmitted && !pPrerequisite->bSubmitted && "dependencies must be added before submitting");
+    if (pPrerequisite->numContinuations == kMaxJobContinuations)
+        return false;
+
+    pPrerequisite->continuations[pPrerequisite->numContinuations++] = pJob;
+    pJob->pendingDependencies.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+SJobHandle SubmitJob(SJob* pJob, SJobCounter* pCounter)
+{
+    assert(pJob != nullptr);
+    assert(!pJob->bSubmitted);
+    pJob->bSubmitted = true;
+
+    // taken before the job can run, the slot may be reused as soon as it finishes
+    SJobHandle handle;
+    handle.pJob = pJob;
+    handle.generation = pJob->generation.load(std::memory_order_relaxed);
+    pJob->pCounter = pCounter;
+    if (pCounter != nullptr)
+    {
+        pCounter->value.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // drops the submit reference, runnable once prerequisites have also finished
+    if (pJob->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        ScheduleJob(pJob);
+    }
+
+    return handle;
+}
+
+bool IsJobFinished(SJobHandle handle)
+{
+    assert(handle.pJob != nullptr);
+    if (handle.pJob->unfinishedJobs.load(std::memory_order_acquire) == 0)
+        return true;
+
+    // Slots are only reused once finished, so an unfinished slot with a newer generation means ours is done.
+    // The acquire above pairs with the release in AllocateJob, a newer use's count implies its generation is visible.
+    return handle.pJob->generation.load(std::memory_order_relaxed) != handle.generation;
+}
+
+void WaitForJob(SJobHandle handle)
+{
+    assert(handle.pJob != nullptr);
+    SFiberWait wait;
+    wait.job = handle;
+    WaitFor(wait);
+}
+
+void WaitForCounter(const SJobCounter* pCounter)
+{
+    assert(pCounter != nullptr);
+    SFiberWait wait;
+    wait.pCounter = pCounter;
+    WaitFor(wait);
+}
+
+size_t RunMainThreadJobs()
+{
+    assert(CurrentThreadIndex() == kMainThreadIndex);
+    size_t numJobsRun = 0;
+    while (SJob* pJob = PopMainThreadJob())
+    {
+        ExecuteJob(pJob);
+        ++numJobsRun;
+    }
+
+    // Fibers parked by main thread jobs can only continue here. Without workers nobody else would resume the rest.
+    if (HasResumableFiber(kMainThreadIndex))
+    {
+        ParkCurrentFiber(SFiberWait()); // yield, resumed after the fibers ahead of it in the queue
+    }
+
+    return numJobsRun;
+}
+
+////////////////////////////////////////////////
+// Parallel for
+
+static void ParallelForRangeJob(SJob* pJob, void* pData);
+
+static SJob* CreateParallelForRangeJob(SJob* pParent, const SParallelForRange& range)
+{
+    SJob* pJob = AllocateJob(pParent, ParallelForRangeJob, nullptr, EJobAffinity::Any);
+    memcpy(pJob->payload, &range, sizeof(SParallelForRange));
+    pJob->pData = pJob->payload;
+    return pJob;
+}
+
+static void ParallelForRangeJob(SJob* pJob, void* pData)
+{
+    SParallelForRange range;
+    memcpy(&range, pData, sizeof(SParallelForRange));
+
+    // Lazy binary splitting: hand half of the range to thieves only while our own deque is empty
+    while (range.end - range.begin > range.grainSize)
+    {
+        if (CurrentThread().deque.IsEmpty()) // re-read, range functions may wait and resume elsewhere
+        {
+            SParallelForRange upperHalf = range;
+            upperHalf.begin = range.begin + (range.end - range.begin) / 2;
+            range.end = upperHalf.begin;
+            SubmitJob(CreateParallelForRangeJob(pJob, upperHalf));
+        }
+        else
+        {
+            range.function(range.begin, range.begin + range.grainSize, range.pData);
+            range.begin += range.grainSize;
+        }
+    }
+
+    if (range.begin < range.end)
+    {
+        range.function(range.begin, range.end, range.pData);
+    }
+}
+
+SJob* CreateParallelForJob(uint32_t count, TParallelForFunction function, void* pData, uint32_t minGrainSize)
+{
+    assert(function != nullptr);
+    SParallelForRange range;
+    range.function = function;
+    range.pData = pData;
+    range.begin = 0;
+    range.end = count;
+    range.grainSize = std::max(std::max(minGrainSize, 1u), count / (g_numThreads * kParallelForRangesPerThread));
+    return CreateParallelForRangeJob(nullptr, range);
+}
+
+void ParallelFor(uint32_t count, TParallelForFunction function, void* pData, uint32_t minGrainSize)
+{
+    if (count == 0)
+        return;
+
+    SJob* pJob = CreateParallelForJob(count, function, pData, minGrainSize);
+    WaitForJob(SubmitJob(pJob));
+}
+
+} // jobs namespace
@@ -0,0 +1,126 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+#include <atomic>
+
+namespace jobs
+{
+
+/////////////////////////////////////////////////////////
+// Job system
+//
+// One worker thread per extra core plus the main thread, each with a Chase-Lev work stealing deque. Jobs are
+// pushed to the deque of the thread that submits them, owners pop newest first and idle threads steal oldest first.
+// Waiting (WaitForJob, WaitForCounter, ParallelFor) never blocks the thread. With fibers enabled every job runs on a
+// fiber from a preallocated pool, and a wait parks the fiber and switches the thread to a fresh one that keeps running
+// jobs. Parked fibers resume on whichever thread notices their condition is met first, so jobs can be written as
+// straight line code that waits on sub jobs. Without fibers (or when the pool is exhausted) the waiting thread runs
+// other jobs on its own stack until the condition is met instead.
+//
+// A job isn't finished until every child created with CreateChildJob has finished, which gives fork-join without
+// explicit counters. Task graphs are built with AddJobDependency before submitting: a job only becomes runnable once
+// it has been submitted and all of its prerequisites (including their children) have finished.
+//
+// Jobs with EJobAffinity::MainThread never run on workers, they run when the main thread waits or calls
+// RunMainThreadJobs, which is where SDL and presentation work belongs. A fiber parked by the main thread itself or by a
+// main thread job only ever resumes on the main thread.
+//
+// Job memory comes from a per thread ring of kJobPoolSize jobs and is recycled without tracking, so a job pointer
+// must not be kept after the job has been submitted and is only valid on threads owned by the job system. Waits go
+// through the SJobHandle returned by SubmitJob, which carries the generation of the slot and stays safe to wait on
+// after the slot has been reused.
+
+struct SJob;
+
+// A submitted job. Once the slot's generation moves on the job it named has finished.
+struct SJobHandle
+{
+    const SJob* pJob = nullptr;
+    uint32_t generation = 0;
+};
+
+// Decremented by every job submitted against it as the job finishes, zero means all of them are done.
+// Only the job system may modify the value, waiters are woken by job completion.
+struct SJobCounter
+{
+    std::atomic<int32_t> value = { 0 };
+};
+
+enum class EJobAffinity : uint8_t
+{
+    Any,
+    MainThread
+};
+
+const char* ToString(EJobAffinity affinity);
+
+typedef void (*TJobFunction)(SJob* pJob, void* pData);
+typedef void (*TParallelForFunction)(uint32_t begin, uint32_t end, void* pData);
+
+// Called on the switching thread just before every fiber switch. Pool fibers have ids [0, numFibers),
+// thread fibers (the stack a thread started on) are numFibers + thread index.
+typedef void (*TFiberSwitchCallback)(uint32_t threadIndex, uint32_t fromFiberId, uint32_t toFiberId);
+
+struct SJobSystemConfig
+{
+    uint32_t numWorkerThreads = 0;
+    bool bFibers = true;
+    uint32_t numFibers = 128; // pool shared by all threads, bounds the number of parked waits
+    size_t fiberStackSize = 64 * 1024;
+    bool bPinThreads = false; // thread i only runs on core i, the main thread included
+};
+
+struct SJobSystemStats
+{
+    uint64_t jobsExecuted = 0;
+    uint64_t jobsStolen = 0;
+    uint64_t fiberSwitches = 0;
+    uint64_t waitsParked = 0; // waits that switched fibers
+    uint64_t waitsHelped = 0; // waits that ran jobs on the waiting stack, fibers disabled or the pool was empty
+    uint32_t fibersInUse = 0; // running or parked, thread fibers excluded
+    uint32_t peakFibersInUse = 0;
+    uint32_t fibersParked = 0;
+};
+
+static constexpr uint32_t kJobPoolSize = 4096; // jobs per thread in flight before slots are reused
+static constexpr uint32_t kMaxJobContinuations = 8; // dependents per prerequisite
+static constexpr uint32_t kMainThreadIndex = 0;
+
+bool InitializeJobSystem(const SJobSystemConfig& config);
+void ShutdownJobSystem(); // expects every submitted job to have finished
+bool AreJobFibersEnabled(); // false when disabled in the config or fiber creation failed
+
+void GetJobSystemStats(SJobSystemStats* pOutStats);
+void SetFiberSwitchCallback(TFiberSwitchCallback callback); // nullptr to clear, set while no jobs are running
+
+uint32_t GetJobThreadCount(); // workers + main thread
+uint32_t GetCurrentJobThreadIndex(); // kMainThreadIndex on the main thread, UINT32_MAX on threads the job system doesn't own
+
+SJob* CreateJob(TJobFunction function, void* pData, EJobAffinity affinity = EJobAffinity::Any);
+
+// Call from inside pParent's function, pParent doesn't finish until the child has
+SJob* CreateChildJob(SJob* pParent, TJobFunction function, void* pData, EJobAffinity affinity = EJobAffinity::Any);
+
+// Neither job may have been submitted yet. Returns false if pPrerequisite already has kMaxJobContinuations dependents.
+bool AddJobDependency(SJob* pJob, SJob* pPrerequisite);
+
+// pCounter, when given, is incremented now and decremented when the job finishes
+SJobHandle SubmitJob(SJob* pJob, SJobCounter* pCounter = nullptr);
+
+bool IsJobFinished(SJobHandle handle);
+void WaitForJob(SJobHandle handle);
+void WaitForCounter(const SJobCounter* pCounter);
+
+// Runs queued main thread jobs, returns the number run. Main thread only, called once per frame.
+size_t RunMainThreadJobs();
+
+// Splits [0, count) into ranges of at least minGrainSize. Ranges are only split further when the running thread's deque
+// is empty, so work is divided finely while other threads are hungry and run in large chunks while they are busy.
+SJob* CreateParallelForJob(uint32_t count, TParallelForFunction function, void* pData, uint32_t minGrainSize = 1);
+void ParallelFor(uint32_t count, TParallelForFunction function, void* pData, uint32_t minGrainSize = 1);
+
+} // jobs namespace
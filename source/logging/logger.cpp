@@ -0,0 +1,494 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "logger.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "memory/memory_report.h"
+#include "sync/event.h"
+#include "sync/mutex.h"
+
+namespace logging
+{
+
+using synchronization::kCacheLineSize;
+using synchronization::SEvent;
+using synchronization::SLockGuard;
+using synchronization::SMutex;
+
+// Single producer (the owning thread), single consumer (the writer). Records never wrap around the end of the ring,
+// a padding record skips the tail instead.
+struct alignas(kCacheLineSize) SLogRing
+{
+    std::unique_ptr<uint64_t[]> pStorage;
+    uint8_t* pBytes = nullptr;
+    alignas(kCacheLineSize) std::atomic<uint64_t> writePos = { 0 };
+    std::atomic<uint64_t> numDropped = { 0 };
+    uint64_t pendingWritePos = 0; // producer only, published by CommitLogRecord
+    alignas(kCacheLineSize) std::atomic<uint64_t> readPos = { 0 };
+    uint64_t numDroppedReported = 0; // writer only
+    uint32_t threadNumber = 0;
+};
+
+std::atomic<int> g_logVerbosity = { VERBOSITY };
+
+static std::atomic<bool> g_bLoggerRunning = { false };
+static uint32_t g_bufferSize = 0; // power of two
+static uint32_t g_writeIntervalMs = kDefaultLogWriteIntervalMs;
+static SMutex g_ringsMutex;
+static std::vector<std::unique_ptr<SLogRing>> g_rings; // guarded by g_ringsMutex
+static std::atomic<uint32_t> g_generation = { 0 }; // bumped by every initialize so threads drop stale rings
+static thread_local SLogRing* t_pRing = nullptr;
+static thread_local uint32_t t_generation = 0;
+static thread_local std::vector<uint64_t> t_syncRecord; // formatted on the spot while the logger isn't running
+
+// writer
+static std::thread g_writerThread;
+static SEvent g_writerEvent(true);
+static std::atomic<bool> g_bWriterStop = { false };
+static std::atomic<uint64_t> g_numWritten = { 0 };
+static std::mutex g_flushMutex;
+static std::condition_variable g_flushCondition;
+static uint64_t g_flushRequests = 0; // guarded by g_flushMutex
+static uint64_t g_flushesDone = 0; // guarded by g_flushMutex
+
+/////////////////////////////////////////////////////////
+// Formatting
+
+// snprintf returns the untruncated length
+static void Append(size_t bufferSize, size_t* pLength, int written)
+{
+    if (written > 0)
+    {
+        *pLength = std::min(*pLength + (size_t)written, bufferSize - 1);
+    }
+}
+
+static int64_t ArgAsInt(const SLogArg& arg)
+{
+    if (arg.type == ELogArgType::Double)
+    {
+        double d;
+        memcpy(&d, &arg.bits, sizeof(d));
+        return (int64_t)d;
+    }
+
+    return arg.type == ELogArgType::String ? 0 : (int64_t)arg.bits;
+}
+
+static double ArgAsDouble(const SLogArg& arg)
+{
+    if (arg.type != ELogArgType::Double)
+        return arg.type == ELogArgType::Int ? (double)(int64_t)arg.bits : (double)arg.bits;
+
+    double d;
+    memcpy(&d, &arg.bits, sizeof(d));
+    return d;
+}
+
+// Formats one conversion with snprintf, casting the stored value to the type the length modifier asks for
+static int FormatArg(char* pBuffer, size_t bufferSize, const char* spec, const char* length, char conversion, int numStars, const int* stars, const SLogArg& arg)
+{
+#define LOG_SNPRINTF(value) (numStars == 0 ? snprintf(pBuffer, bufferSize, spec, value) : numStars == 1 ? snprintf(pBuffer, bufferSize, spec, stars[0], value) : snprintf(pBuffer, bufferSize, spec, stars[0], stars[1], value))
+    switch (conversion)
+    {
+    case 'd':
+    case 'i':
+    {
+        const int64_t value = ArgAsInt(arg);
+        if (strcmp(length, "l") == 0) return LOG_SNPRINTF((long)value);
+        if (strcmp(length, "ll") == 0) return LOG_SNPRINTF((long long)value);
+        if (strcmp(length, "j") == 0) return LOG_SNPRINTF((intmax_t)value);
+        if (strcmp(length, "z") == 0 || strcmp(length, "t") == 0) return LOG_SNPRINTF((ptrdiff_t)value);
+        return LOG_SNPRINTF((int)value);
+    }
+    case 'u':
+    case 'o':
+    case 'x':
+    case 'X':
+    {
+        const uint64_t value = (uint64_t)ArgAsInt(arg);
+        if (strcmp(length, "l") == 0) return LOG_SNPRINTF((unsigned long)value);
+        if (strcmp(length, "ll") == 0) return LOG_SNPRINTF((unsigned long long)value);
+        if (strcmp(length, "j") == 0) return LOG_SNPRINTF((uintmax_t)value);
+        if (strcmp(length, "z") == 0 || strcmp(length, "t") == 0) return LOG_SNPRINTF((size_t)value);
+        return LOG_SNPRINTF((unsigned)value);
+    }
+    case 'c':
+        return LOG_SNPRINTF((int)ArgAsInt(arg));
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+        if (strcmp(length, "L") == 0) return LOG_SNPRINTF((long double)ArgAsDouble(arg));
+        return LOG_SNPRINTF(ArgAsDouble(arg));
+    case 's':
+        if (arg.type != ELogArgType::String)
+            return LOG_SNPRINTF(arg.bits == 0 ? "(null)" : "(?)");
+        return LOG_SNPRINTF(reinterpret_cast<const char*>(&arg + 1));
+    case 'p':
+        return LOG_SNPRINTF((const void*)(uintptr_t)arg.bits);
+    default:
+        return 0;
+    }
+#undef LOG_SNPRINTF
+}
+
+static const SLogArg* NextArg(const SLogArg* pArg)
+{
+    const size_t size = sizeof(SLogArg) + (pArg->type == ELogArgType::String ? AlignLogSize(pArg->length + 1) : 0);
+    return reinterpret_cast<const SLogArg*>(reinterpret_cast<const uint8_t*>(pArg) + size);
+}
+
+size_t FormatLogRecord(const SLogRecord& record, char* pBuffer, size_t bufferSize)
+{
+    assert(pBuffer != nullptr && bufferSize > 0);
+    const SLogArg* pArg = reinterpret_cast<const SLogArg*>(&record + 1);
+    uint32_t argsLeft = record.numArgs;
+    size_t length = 0;
+    pBuffer[0] = '\0';
+
+    for (const char* pFormat = record.format; *pFormat != '\0' && length + 1 < bufferSize;)
+    {
+        if (*pFormat != '%' || pFormat[1] == '%')
+        {
+            pBuffer[length++] = *pFormat;
+            pFormat += *pFormat == '%' ? 2 : 1;
+            continue;
+        }
+
+        // %[flags][width][.precision][length]conversion, * width and precision take an int argument
+        char spec[32] = { '%' };
+        size_t specLength = 1;
+        int stars[2] = { 0, 0 };
+        int numStars = 0;
+        const char* pSpec = pFormat + 1;
+        while (*pSpec != '\0' && strchr("-+ #0123456789.*", *pSpec) != nullptr && specLength < sizeof(spec) - 4)
+        {
+            if (*pSpec == '*' && numStars < 2)
+            {
+                stars[numStars++] = argsLeft > 0 ? (int)ArgAsInt(*pArg) : 0;
+                if (argsLeft > 0)
+                {
+                    pArg = NextArg(pArg);
+                    --argsLeft;
+                }
+            }
+
+            spec[specLength++] = *pSpec++;
+        }
+
+        char lengthModifier[3] = {};
+        for (size_t i = 0; i < 2 && *pSpec != '\0' && strchr("hljztL", *pSpec) != nullptr; ++i)
+        {
+            lengthModifier[i] = *pSpec;
+            spec[specLength++] = *pSpec++;
+        }
+
+        const char conversion = *pSpec;
+        if (conversion == '\0')
+            break;
+
+        spec[specLength++] = conversion;
+        spec[specLength] = '\0';
+        pFormat = pSpec + 1;
+
+        if (argsLeft == 0)
+        {
+            Append(bufferSize, &length, snprintf(pBuffer + length, bufferSize - length, "(missing)"));
+            continue;
+        }
+
+        Append(bufferSize, &length, FormatArg(pBuffer + length, bufferSize - length, spec, lengthModifier, conversion, numStars, stars, *pArg));
+        pArg = NextArg(pArg);
+        --argsLeft;
+    }
+
+    pBuffer[length] = '\0';
+    return length;
+}
+
+static void WriteRecord(const SLogRecord& record)
+{
+    char line[kMaxLogLineLength + 1];
+    size_t length = FormatLogRecord(record, line, kMaxLogLineLength);
+    if (record.bNewLine)
+    {
+        line[length++] = '\n';
+    }
+
+    fwrite(line, 1, length, record.stream == ELogStream::Error ? stderr : stdout);
+}
+
+/////////////////////////////////////////////////////////
+// Rings
+
+static SLogRing* CreateLogRing()
+{
+    std::unique_ptr<SLogRing> pRing = std::make_unique<SLogRing>();
+    pRing->pStorage = std::make_unique<uint64_t[]>(g_bufferSize / sizeof(uint64_t));
+    pRing->pBytes = reinterpret_cast<uint8_t*>(pRing->pStorage.get());
+    memory::TrackReservedMemory(memory::EMemoryTag::Platform, (int64_t)g_bufferSize);
+
+    SLockGuard<SMutex> lock(g_ringsMutex);
+    pRing->threadNumber = (uint32_t)g_rings.size();
+    g_rings.push_back(std::move(pRing));
+    return g_rings.back().get();
+}
+
+static const SLogRecord* PeekRecord(SLogRing* pRing)
+{
+    const uint64_t writePos = pRing->writePos.load(std::memory_order_acquire);
+    uint64_t readPos = pRing->readPos.load(std::memory_order_relaxed);
+    while (readPos != writePos)
+    {
+        const SLogRecord* pRecord = reinterpret_cast<const SLogRecord*>(pRing->pBytes + (readPos & (g_bufferSize - 1)));
+        if (!pRecord->bPadding)
+            return pRecord;
+
+        readPos += pRecord->size;
+        pRing->readPos.store(readPos, std::memory_order_release);
+    }
+
+    return nullptr;
+}
+
+static void PopRecord(SLogRing* pRing, const SLogRecord& record)
+{
+    pRing->readPos.store(pRing->readPos.load(std::memory_order_relaxed) + record.size, std::memory_order_release);
+}
+
+// Writes everything published so far, merging the rings in time order
+static void DrainRings(std::vector<SLogRing*>* pRings)
+{
+    { // pick up rings of threads that logged for the first time
+        SLockGuard<SMutex> lock(g_ringsMutex);
+        for (size_t i = pRings->size(); i < g_rings.size(); ++i)
+        {
+            pRings->push_back(g_rings[i].get());
+        }
+    } // ~pick up rings
+
+    uint64_t numWritten = 0;
+    for (;;)
+    {
+        SLogRing* pOldestRing = nullptr;
+        const SLogRecord* pOldest = nullptr;
+        for (SLogRing* pRing : *pRings)
+        {
+            const SLogRecord* pRecord = PeekRecord(pRing);
+            if (pRecord != nullptr && (pOldest == nullptr || pRecord->timeTicks < pOldest->timeTicks))
+            {
+                pOldest = pRecord;
+                pOldestRing = pRing;
+            }
+        }
+
+        if (pOldest == nullptr)
+            break;
+
+        WriteRecord(*pOldest);
+        PopRecord(pOldestRing, *pOldest);
+        ++numWritten;
+    }
+
+    for (SLogRing* pRing : *pRings)
+    {
+        const uint64_t numDropped = pRing->numDropped.load(std::memory_order_relaxed);
+        if (numDropped != pRing->numDroppedReported)
+        {
+            fprintf(stderr, "[Log] dropped %llu messages from thread %u, its log buffer was full\n", (unsigned long long)(numDropped - pRing->numDroppedReported), pRing->threadNumber);
+            pRing->numDroppedReported = numDropped;
+        }
+    }
+
+    if (numWritten > 0)
+    {
+        fflush(stdout);
+        g_numWritten.fetch_add(numWritten, std::memory_order_relaxed);
+    }
+}
+
+static void WriterThreadMain()
+{
+    std::vector<SLogRing*> rings;
+    bool bStop = false;
+    while (!bStop)
+    {
+        g_writerEvent.Wait(g_writeIntervalMs);
+        bStop = g_bWriterStop.load(std::memory_order_acquire);
+
+        uint64_t flushRequests = 0;
+        {
+            std::lock_guard<std::mutex> lock(g_flushMutex);
+            flushRequests = g_flushRequests;
+        }
+
+        DrainRings(&rings);
+
+        if (flushRequests != 0)
+        {
+            std::lock_guard<std::mutex> lock(g_flushMutex);
+            g_flushesDone = flushRequests;
+        }
+
+        g_flushCondition.notify_all();
+    }
+}
+
+/////////////////////////////////////////////////////////
+// Interface
+
+bool InitializeLogger(const SLoggerConfig& config)
+{
+    if (config.bufferSize < 1024 || config.bufferSize > (1u << 30))
+    {
+        DiracError("[Log] invalid buffer size %u", config.bufferSize);
+        return false;
+    }
+
+    assert(!g_bLoggerRunning.load() && "logger is already initialized");
+    g_bufferSize = 1;
+    while (g_bufferSize < config.bufferSize)
+    {
+        g_bufferSize <<= 1;
+    }
+
+    g_writeIntervalMs = std::max(config.writeIntervalMs, 1u);
+    g_numWritten.store(0, std::memory_order_relaxed);
+    g_bWriterStop.store(false, std::memory_order_relaxed);
+    g_generation.fetch_add(1, std::memory_order_release);
+    g_writerThread = std::thread(WriterThreadMain);
+    g_bLoggerRunning.store(true, std::memory_order_release);
+    return true;
+}
+
+void ShutdownLogger()
+{
+    if (!g_bLoggerRunning.load())
+        return;
+
+    g_bLoggerRunning.store(false, std::memory_order_release);
+    g_bWriterStop.store(true, std::memory_order_release);
+    g_writerEvent.Set();
+    g_writerThread.join(); // drains once more after seeing the stop flag
+
+    SLockGuard<SMutex> lock(g_ringsMutex);
+    memory::TrackReservedMemory(memory::EMemoryTag::Platform, -(int64_t)g_rings.size() * g_bufferSize);
+    g_rings.clear(); // threads still pointing at theirs recreate it after the next initialize
+    g_bufferSize = 0;
+}
+
+bool IsLoggerRunning()
+{
+    return g_bLoggerRunning.load(std::memory_order_acquire);
+}
+
+void FlushLog()
+{
+    if (!IsLoggerRunning())
+    {
+        fflush(stdout);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(g_flushMutex);
+    const uint64_t request = ++g_flushRequests;
+    g_writerEvent.Set();
+    g_flushCondition.wait(lock, [request] { return g_flushesDone >= request; });
+}
+
+void GetLogStats(SLogStats* pOutStats)
+{
+    assert(pOutStats != nullptr);
+    *pOutStats = SLogStats();
+    pOutStats->bufferSize = g_bufferSize;
+    pOutStats->numWritten = g_numWritten.load(std::memory_order_relaxed);
+
+    SLockGuard<SMutex> lock(g_ringsMutex);
+    pOutStats->numThreads = (uint32_t)g_rings.size();
+    for (const std::unique_ptr<SLogRing>& pRing : g_rings)
+    {
+        pOutStats->numDropped += pRing->numDropped.load(std::memory_order_relaxed);
+    }
+}
+
+void SetLogVerbosity(int verbosity)
+{
+    g_logVerbosity.store(verbosity, std::memory_order_relaxed);
+}
+
+uint8_t* BeginLogRecord(size_t size, ELogStream stream, bool bNewLine, const char* format, uint32_t numArgs)
+{
+    const SLogRecord header = { (uint32_t)size, 0, stream, (uint8_t)bNewLine, (uint8_t)numArgs, format, TSteadyClock::now().time_since_epoch().count() };
+    uint8_t* pRecord = nullptr;
+    if (!g_bLoggerRunning.load(std::memory_order_acquire))
+    {
+        t_syncRecord.resize(size / sizeof(uint64_t));
+        t_pRing = nullptr;
+        pRecord = reinterpret_cast<uint8_t*>(t_syncRecord.data());
+    }
+    else
+    {
+        const uint32_t generation = g_generation.load(std::memory_order_acquire);
+        if (t_generation != generation)
+        {
+            t_pRing = CreateLogRing();
+            t_generation = generation;
+        }
+
+        SLogRing* pRing = t_pRing;
+        const uint64_t writePos = pRing->writePos.load(std::memory_order_relaxed);
+        const uint64_t readPos = pRing->readPos.load(std::memory_order_acquire);
+        const size_t offset = (size_t)(writePos & (g_bufferSize - 1));
+        const size_t padding = offset + size > g_bufferSize ? g_bufferSize - offset : 0;
+        if (writePos + padding + size - readPos > g_bufferSize)
+        {
+            pRing->numDropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        if (padding > 0)
+        { // the first 8 bytes hold the size and padding flag, a tail that short is all a padding record needs
+            const uint32_t paddingSize = (uint32_t)padding;
+            memcpy(pRing->pBytes + offset, &paddingSize, sizeof(paddingSize));
+            pRing->pBytes[offset + offsetof(SLogRecord, bPadding)] = 1;
+        }
+
+        pRing->pendingWritePos = writePos + padding + size;
+        pRecord = pRing->pBytes + ((writePos + padding) & (g_bufferSize - 1));
+    }
+
+    memcpy(pRecord, &header, sizeof(header));
+    return pRecord + sizeof(header);
+}
+
+void CommitLogRecord()
+{
+    SLogRing* pRing = t_pRing;
+    if (pRing == nullptr)
+    {
+        WriteRecord(*reinterpret_cast<const SLogRecord*>(t_syncRecord.data()));
+        return;
+    }
+
+    pRing->writePos.store(pRing->pendingWritePos, std::memory_order_release);
+    if (pRing->pendingWritePos - pRing->readPos.load(std::memory_order_relaxed) > g_bufferSize / 2)
+    {
+        g_writerEvent.Set(); // only wakes the kernel if the writer is sleeping
+    }
+}
+
+} // logging namespace
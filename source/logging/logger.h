@@ -0,0 +1,197 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace logging
+{
+
+/////////////////////////////////////////////////////////
+// Logger
+//
+// DiracLog and DiracError don't format on the calling thread. The format pointer and the arguments are copied in
+// binary form into a ring buffer owned by the calling thread and a background writer formats, orders by time and
+// writes them. Logging never blocks: a message that doesn't fit into its thread's ring is dropped and counted.
+// Before InitializeLogger and after ShutdownLogger messages are formatted and written synchronously. Messages still
+// buffered when the process dies without ShutdownLogger (e.g. an assert) are lost.
+//
+// Formats must be string literals (or otherwise outlive the logger), string arguments are copied.
+
+static constexpr uint32_t kDefaultLogBufferSize = 64 * 1024; // per thread
+static constexpr uint32_t kDefaultLogWriteIntervalMs = 5;
+static constexpr size_t kMaxLogLineLength = 1024; // longer messages are truncated
+
+enum class ELogStream : uint8_t
+{
+    Out,
+    Error
+};
+
+struct SLoggerConfig
+{
+    uint32_t bufferSize = kDefaultLogBufferSize; // rounded up to a power of two
+    uint32_t writeIntervalMs = kDefaultLogWriteIntervalMs; // the writer also wakes once a ring is half full
+};
+
+struct SLogStats
+{
+    uint32_t bufferSize = 0;
+    uint32_t numThreads = 0;
+    uint64_t numWritten = 0;
+    uint64_t numDropped = 0;
+};
+
+bool InitializeLogger(const SLoggerConfig& config);
+void ShutdownLogger(); // writes everything pending, other threads must have stopped logging
+bool IsLoggerRunning();
+void FlushLog(); // blocks until every message logged before the call has been written, never call it mid frame
+void GetLogStats(SLogStats* pOutStats);
+
+// Runtime filter on top of the compile time VERBOSITY, errors are always logged
+extern std::atomic<int> g_logVerbosity;
+void SetLogVerbosity(int verbosity);
+
+inline bool IsLogVerbosityEnabled(int verbosity)
+{
+    return verbosity <= g_logVerbosity.load(std::memory_order_relaxed);
+}
+
+/////////////////////////////////////////////////////////
+// Binary encoding
+//
+// A record is a SLogRecord followed by one SLogArg per argument, strings follow their SLogArg null terminated and
+// padded to 8 bytes.
+
+enum class ELogArgType : uint32_t
+{
+    Int,
+    UInt,
+    Double,
+    String,
+    Pointer
+};
+
+struct SLogRecord
+{
+    uint32_t size; // including the arguments
+    uint8_t bPadding; // skip to the start of the ring
+    ELogStream stream;
+    uint8_t bNewLine;
+    uint8_t numArgs;
+    const char* format;
+    int64_t timeTicks;
+};
+
+struct SLogArg
+{
+    ELogArgType type;
+    uint32_t length; // strings only, bytes excluding the terminator
+    uint64_t bits;
+};
+
+static_assert(sizeof(SLogRecord) % 8 == 0 && sizeof(SLogArg) % 8 == 0, "records keep 8 byte alignment");
+
+inline size_t AlignLogSize(size_t size)
+{
+    return (size + 7) & ~size_t(7);
+}
+
+template <typename T>
+inline size_t GetLogArgSize(T value)
+{
+    if constexpr (std::is_same_v<T, const char*> || std::is_same_v<T, char*>)
+    {
+        return sizeof(SLogArg) + AlignLogSize((value != nullptr ? strlen(value) : 0) + 1);
+    }
+    else
+    {
+        return sizeof(SLogArg);
+    }
+}
+
+template <typename T>
+inline uint8_t* WriteLogArg(uint8_t* pWrite, T value)
+{
+    if constexpr (std::is_enum_v<T>)
+    {
+        return WriteLogArg(pWrite, static_cast<std::underlying_type_t<T>>(value));
+    }
+    else if constexpr (std::is_same_v<T, const char*> || std::is_same_v<T, char*>)
+    {
+        const char* string = value != nullptr ? value : "";
+        const SLogArg arg = { value != nullptr ? ELogArgType::String : ELogArgType::Pointer, (uint32_t)strlen(string), 0 };
+        memcpy(pWrite, &arg, sizeof(arg));
+        memcpy(pWrite + sizeof(arg), string, arg.length + 1);
+        return pWrite + sizeof(arg) + AlignLogSize(arg.length + 1);
+    }
+    else
+    {
+        SLogArg arg = { ELogArgType::Pointer, 0, 0 };
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            const double d = (double)value;
+            arg.type = ELogArgType::Double;
+            memcpy(&arg.bits, &d, sizeof(d));
+        }
+        else if constexpr (std::is_integral_v<T>)
+        {
+            arg.type = std::is_signed_v<T> ? ELogArgType::Int : ELogArgType::UInt;
+            arg.bits = (uint64_t)(std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>)value;
+        }
+        else
+        {
+            static_assert(std::is_pointer_v<T> || std::is_null_pointer_v<T>, "unsupported log argument type");
+            arg.bits = (uint64_t)reinterpret_cast<uintptr_t>((const void*)value);
+        }
+
+        memcpy(pWrite, &arg, sizeof(arg));
+        return pWrite + sizeof(arg);
+    }
+}
+
+template <typename... TArgs>
+inline size_t GetLogRecordSize(TArgs... args)
+{
+    return sizeof(SLogRecord) + (size_t(0) + ... + GetLogArgSize(args));
+}
+
+// Formats an encoded record, returns the message length excluding the terminator
+size_t FormatLogRecord(const SLogRecord& record, char* pBuffer, size_t bufferSize);
+
+// Returns the arguments area of a record of size bytes in the calling thread's ring, nullptr if it was dropped
+uint8_t* BeginLogRecord(size_t size, ELogStream stream, bool bNewLine, const char* format, uint32_t numArgs);
+void CommitLogRecord();
+
+template <typename... TArgs>
+void Log(ELogStream stream, bool bNewLine, const char* format, TArgs... args)
+{
+    static_assert(sizeof...(TArgs) < 256, "too many log arguments");
+    uint8_t* pWrite = BeginLogRecord(GetLogRecordSize(args...), stream, bNewLine, format, sizeof...(TArgs));
+    if (pWrite == nullptr)
+        return;
+
+    ((pWrite = WriteLogArg(pWrite, args)), ...);
+    CommitLogRecord();
+}
+
+// Encodes and formats on the calling thread, for tools and tests
+template <typename... TArgs>
+size_t FormatLogMessage(char* pBuffer, size_t bufferSize, const char* format, TArgs... args)
+{
+    std::vector<uint64_t> storage(GetLogRecordSize(args...) / sizeof(uint64_t));
+    SLogRecord* pRecord = reinterpret_cast<SLogRecord*>(storage.data());
+    *pRecord = SLogRecord{ (uint32_t)(storage.size() * sizeof(uint64_t)), 0, ELogStream::Out, 0, (uint8_t)sizeof...(TArgs), format, 0 };
+    [[maybe_unused]] uint8_t* pWrite = reinterpret_cast<uint8_t*>(pRecord + 1);
+    ((pWrite = WriteLogArg(pWrite, args)), ...);
+    return FormatLogRecord(*pRecord, pBuffer, bufferSize);
+}
+
+} // logging namespace
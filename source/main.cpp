@@ -5,26 +5,83 @@
 
 #include "diracsea.h"
 
+#include <atomic>
+#include <thread>
+
 #include "game/game.h"
+#include "jobs/job_system.h"
+#include "logging/logger.h"
+#include "memory/frame_arena.h"
+#include "memory/memory_report.h"
+#include "platform/fixed_timestep.h"
+#include "platform/frame_pacer.h"
+#include "platform/frame_pipeline.h"
 #include "platform/platform.h"
+#include "profiling/cpu_profiler.h"
+#include "profiling/metrics.h"
+#include "renderer/render_snapshot.h"
 #include "renderer/renderer.h"
 #include "tests/tests.h"
 
 ERunResult Initialize()
 {
     DiracLog(1, "[DiracSea] Initializing...");
+
+    { // metrics, --metrics-dump=<path.csv|path.json> appends the rolling window every few seconds
+        profiling::SMetricsConfig metricsConfig;
+        metricsConfig.dumpPath = platform::GetCommandLineValue("--metrics-dump");
+        if (!profiling::GetMetrics().Initialize(metricsConfig, TSteadyClock::now()))
+            return eRR_Error;
+    } // ~metrics
+
+    { // jobs, the main thread runs jobs too so one worker per remaining core
+        jobs::SJobSystemConfig jobConfig;
+        jobConfig.numWorkerThreads = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+        if (const char* jobWorkers = platform::GetCommandLineValue("--job-workers"))
+        {
+            jobConfig.numWorkerThreads = (uint32_t)std::max(atoi(jobWorkers), 0);
+        }
+
+        jobConfig.bFibers = !platform::HasCommandLineArg("--no-job-fibers");
+        jobConfig.bPinThreads = platform::HasCommandLineArg("--pin-job-threads");
+        if (!jobs::InitializeJobSystem(jobConfig))
+        {
+            DiracError("Job system initialization failed!");
+            return eRR_Error;
+        }
+    } // ~jobs
+
     if (platform::Initialize() != eRR_Success)
     {
         DiracError("Platform initialization failed!");
         return eRR_Error;
     }
 
-    if (game::Initialize() != eRR_Success)
+    // --sim-rate=<ticks per second> runs the simulation independently of the frame rate, at most --sim-max-ticks per frame
+    platform::SFixedTimestepConfig simulationConfig;
+    if (const char* simulationRate = platform::GetCommandLineValue("--sim-rate"))
+    {
+        simulationConfig.ticksPerSecond = (uint32_t)std::max(atoi(simulationRate), 0);
+    }
+
+    if (const char* maxTicks = platform::GetCommandLineValue("--sim-max-ticks"))
+    {
+        simulationConfig.maxTicksPerFrame = (uint32_t)std::max(atoi(maxTicks), 0);
+    }
+
+    if (game::Initialize(simulationConfig) != eRR_Success)
     {
         DiracError("Game initialization failed!");
         return eRR_Error;
     }
 
+    // --load-state=<file> starts from a saved game state snapshot
+    if (const char* stateFileName = platform::GetCommandLineValue("--load-state"))
+    {
+        if (!game::LoadGameState(stateFileName))
+            return eRR_Error;
+    }
+
     if (renderer::Initialize() != eRR_Success)
     {
         DiracError("Renderer initialization failed!");
@@ -34,11 +91,116 @@ ERunResult Initialize()
     return eRR_Success;
 }
 
+/////////////////////////////////////////////////////////
+// Frame pipeline
+// Snapshots are double (or triple) buffered between game::Run on the main thread and renderer::Render, which runs
+// on a render thread whenever the pipeline is deeper than one frame. Select with --frame-pipeline-depth=1|2|3.
+
+static constexpr uint32_t kDefaultFramePipelineDepth = 2;
+
+static platform::SFramePipeline g_framePipeline;
+static platform::SFramePacer g_framePacer;
+static renderer::SRenderSnapshot g_renderSnapshots[platform::kMaxFramePipelineDepth];
+static std::atomic<ERunResult> g_renderResult = { eRR_Success };
+static profiling::SHistogram* g_pFrameTimeMetric = nullptr;
+static profiling::SHistogram* g_pRunIOTimeMetric = nullptr;
+static profiling::SHistogram* g_pGameRunTimeMetric = nullptr;
+static profiling::SHistogram* g_pRenderTimeMetric = nullptr;
+static profiling::SHistogram* g_pFrameLimitWaitMetric = nullptr;
+static_assert(memory::kMaxFramesInFlight >= platform::kMaxFramePipelineDepth, "every pipeline depth needs its frame arenas");
+
+// Renders the next published snapshot, returns false once the pipeline has been stopped and drained
+static bool RenderNextFrame(ERunResult* pOutRenderResult)
+{
+    uint32_t slot = 0;
+    if (!g_framePipeline.BeginRender(&slot))
+        return false;
+
+    // After a failure frames are still retired so the main thread never blocks on a free slot
+    {
+        const renderer::SRenderSnapshot& snapshot = g_renderSnapshots[slot];
+        profiling::SScopedHistogramTimer renderTimer(snapshot.bSkipRender ? nullptr : g_pRenderTimeMetric);
+        if (snapshot.bSkipRender)
+        {
+            renderer::ApplySnapshot(snapshot);
+        }
+        else
+        {
+            *pOutRenderResult = g_renderResult.load() == eRR_Success ? renderer::Render(snapshot) : g_renderResult.load();
+        }
+    }
+
+    g_framePipeline.EndRender(slot);
+    return true;
+}
+
+static void RenderThreadMain()
+{
+    profiling::SetProfileThreadName("Render");
+    ERunResult renderResult = eRR_Success;
+    while (RenderNextFrame(&renderResult))
+    {
+        if (renderResult != eRR_Success)
+        {
+            g_renderResult = renderResult; // the main loop exits and stops the pipeline, which ends this loop
+        }
+    }
+}
+
 ERunResult Run()
 {
     DiracLog(1, "[DiracSea] Running...");
     RunTests();
 
+    { // profiler, --profile-capture=N writes the N frames after startup to --profile-capture-path
+        if (!profiling::InitializeCpuProfiler(profiling::SCpuProfilerConfig()))
+            return eRR_Error;
+
+        profiling::SetProfileThreadName("Main");
+        if (const char* captureFrames = platform::GetCommandLineValue("--profile-capture"))
+        {
+            const char* capturePath = platform::GetCommandLineValue("--profile-capture-path");
+            profiling::RequestCpuCapture((uint32_t)std::max(atoi(captureFrames), 1), capturePath != nullptr ? capturePath : "cpu_trace.json");
+        }
+    } // ~profiler
+
+    uint32_t framePipelineDepth = kDefaultFramePipelineDepth;
+    if (const char* depth = platform::GetCommandLineValue("--frame-pipeline-depth"))
+    {
+        framePipelineDepth = (uint32_t)std::max(atoi(depth), 0);
+    }
+
+    if (!g_framePipeline.Initialize(framePipelineDepth))
+        return eRR_Error;
+
+    // One arena per frame in flight, frame N's scratch memory stays valid until its snapshot has been rendered
+    memory::SFrameArenaConfig frameArenaConfig;
+    frameArenaConfig.numFramesInFlight = framePipelineDepth;
+    if (!memory::InitializeFrameArenas(frameArenaConfig))
+        return eRR_Error;
+
+    { // frame metrics, CPU time of each phase in microseconds
+        profiling::SMetricsRegistry& metrics = profiling::GetMetrics();
+        g_pFrameTimeMetric = metrics.RegisterHistogram("frame.time", "us", profiling::kMaxMetricDurationUs);
+        g_pRunIOTimeMetric = metrics.RegisterHistogram("frame.run_io", "us", profiling::kMaxMetricDurationUs);
+        g_pGameRunTimeMetric = metrics.RegisterHistogram("frame.game_run", "us", profiling::kMaxMetricDurationUs);
+        g_pRenderTimeMetric = metrics.RegisterHistogram("frame.render", "us", profiling::kMaxMetricDurationUs);
+        g_pFrameLimitWaitMetric = metrics.RegisterHistogram("frame.limiter_wait", "us", profiling::kMaxMetricDurationUs);
+    } // ~frame metrics
+
+    // --frame-skip skips rendering the frame after the loop fell more than a frame behind
+    platform::SFramePacerConfig framePacerConfig;
+    framePacerConfig.targetFrameDuration = platform::GetTargetFrameDuration();
+    framePacerConfig.skipPolicy = platform::HasCommandLineArg("--frame-skip") ? platform::EFrameSkipPolicy::SkipRender : platform::EFrameSkipPolicy::Never;
+    if (!g_framePacer.Initialize(framePacerConfig, TSteadyClock::now()))
+        return eRR_Error;
+
+    std::thread renderThread;
+    if (framePipelineDepth > 1)
+    {
+        renderThread = std::thread(RenderThreadMain);
+    }
+
     bool bExit = false;
     ERunResult platformRunIOResult = eRR_Success;
     ERunResult gameRunResult = eRR_Success;
@@ -49,18 +211,107 @@ ERunResult Run()
 
     while (bExit == false && (platformRunIOResult | gameRunResult | renderResult) == eRR_Success)
     {
+        // Claim the snapshot before sampling input so time spent waiting on the renderer isn't added to latency
+        const uint32_t snapshotSlot = g_framePipeline.BeginSimulation();
+
         lastFrameTime = frameContext.frameStartTime;
         frameContext.frameStartTime = TSteadyClock::now();
         frameContext.lastFrameDuration = frameContext.frameStartTime - lastFrameTime;
+        if (platform::IsReplayingInput())
+        {
+            frameContext.lastFrameDuration = platform::GetReplayFrameDuration(); // replays step as recorded whatever the frame took
+        }
+
         frameContext.gameDuration += frameContext.lastFrameDuration;
         frameContext.frameId++;
+        profiling::BeginProfileFrame(frameContext.frameId);
+        profiling::GetMetrics().Update(frameContext.frameStartTime);
+        g_pFrameTimeMetric->RecordDuration(lastFrameTime, frameContext.frameStartTime);
+
+        {
+            PROFILE_SCOPE("RunIO");
+            profiling::SScopedHistogramTimer runIOTimer(g_pRunIOTimeMetric);
+            platformRunIOResult = platform::RunIO(frameContext, &bExit);
+            jobs::RunMainThreadJobs();
+        }
+
+        renderer::SRenderSnapshot& snapshot = g_renderSnapshots[snapshotSlot];
+        snapshot.frameContext = frameContext;
+        snapshot.pShapeUpdates = nullptr;
+        snapshot.numShapeUpdates = 0;
+        snapshot.maxShapeUpdates = 0;
+        snapshot.bSkipRender = g_framePacer.ShouldSkipRender();
+        {
+            profiling::SScopedHistogramTimer gameRunTimer(g_pGameRunTimeMetric);
+            gameRunResult = game::Run(frameContext, &snapshot);
+        }
 
-        platformRunIOResult = platform::RunIO(frameContext, &bExit);
-        gameRunResult = game::Run(frameContext);
-        renderResult = renderer::Render(frameContext);
-        platform::RegulateFrameLimit(frameContext);
+        g_framePipeline.EndSimulation(snapshotSlot, frameContext.frameStartTime);
+
+        if (renderThread.joinable())
+        {
+            renderResult = g_renderResult.load();
+        }
+        else
+        {
+            RenderNextFrame(&renderResult);
+        }
+
+        {
+            PROFILE_SCOPE("WaitForNextFrame");
+            profiling::SScopedHistogramTimer frameLimitTimer(g_pFrameLimitWaitMetric);
+            g_framePacer.WaitForNextFrame();
+        }
     }
 
+    { // frame pipeline, finish frames in flight before the renderer shuts down
+        g_framePipeline.Stop();
+        if (renderThread.joinable())
+        {
+            renderThread.join();
+            renderResult = ERunResult(renderResult | g_renderResult.load());
+        }
+
+        platform::SFramePipelineStats stats;
+        g_framePipeline.GetStats(&stats);
+        DiracLog(1, "[FramePipeline] depth %u: %llu frames, %.1f fps, latency %.2f ms average %.2f ms max, simulation waited %.2f ms/frame, render waited %.2f ms/frame",
+            stats.depth,
+            (unsigned long long)stats.framesRendered,
+            stats.framesPerSecond,
+            stats.averageLatencyMs,
+            stats.maxLatencyMs,
+            stats.averageSimulationWaitMs,
+            stats.averageRenderWaitMs);
+
+        platform::SFramePacerStats pacerStats;
+        g_framePacer.GetStats(&pacerStats);
+        DiracLog(1, "[FramePacer] %llu frames, %llu missed deadlines, %llu re-phased, %llu renders skipped (%s), slept %.1f ms spun %.1f ms, jitter %.1f us average %.1f us max",
+            (unsigned long long)pacerStats.numFrames,
+            (unsigned long long)pacerStats.numMissedDeadlines,
+            (unsigned long long)pacerStats.numRephases,
+            (unsigned long long)pacerStats.numSkippedRenders,
+            platform::ToString(framePacerConfig.skipPolicy),
+            pacerStats.sleptMs,
+            pacerStats.spunMs,
+            pacerStats.averageJitterUs,
+            pacerStats.maxJitterUs);
+
+        memory::SFrameArenaStats frameArenaStats;
+        memory::GetFrameArenaStats(&frameArenaStats);
+        DiracLog(1, "[FrameArena] %u threads, %zu KB arenas x %u: high water %zu KB, %llu allocations, %llu overflowed (%llu KB)",
+            frameArenaStats.numThreads,
+            frameArenaStats.arenaSize / 1024,
+            frameArenaStats.numFramesInFlight,
+            frameArenaStats.highWaterMark / 1024,
+            (unsigned long long)frameArenaStats.numAllocations,
+            (unsigned long long)frameArenaStats.numOverflows,
+            (unsigned long long)(frameArenaStats.overflowBytes / 1024));
+        memory::LogMemoryReport();
+        profiling::GetMetrics().Log();
+        memory::ShutdownFrameArenas();
+        profiling::ShutdownCpuProfiler();
+    } // ~frame pipeline
+
     if (platformRunIOResult != eRR_Success)
     {
         DiracError("Platform RunIO failed!");
@@ -92,11 +343,24 @@ ERunResult Shutdown()
     {
         DiracError("Platform shutdown error!");
     }
+    jobs::ShutdownJobSystem();
+    profiling::GetMetrics().Shutdown();
     return ERunResult(platformShutdownResult | rendererShutdownResult);
 }
 
-int main()
+int main(int argc, char* argv[])
 {
+    platform::SetCommandLine(argc, argv);
+
+    { // logging, everything logged before this point was written synchronously
+        if (const char* logVerbosity = platform::GetCommandLineValue("--log-verbosity"))
+        {
+            logging::SetLogVerbosity(atoi(logVerbosity));
+        }
+
+        logging::InitializeLogger(logging::SLoggerConfig());
+    } // ~logging
+
     ERunResult initializationResult = Initialize();
 
     ERunResult runResult = eRR_Success;
@@ -112,5 +376,13 @@ int main()
         DiracError("[DiracSea] exiting with error: %d\n", diracSeaEngineResult);
     }
 
+    logging::SLogStats logStats;
+    logging::GetLogStats(&logStats);
+    DiracLog(1, "[Log] %llu messages written by %u threads, %llu dropped",
+        (unsigned long long)logStats.numWritten,
+        logStats.numThreads,
+        (unsigned long long)logStats.numDropped);
+    logging::ShutdownLogger();
+
     return diracSeaEngineResult;
 }
@@ -437,8 +437,8 @@ inline Matrix43<T> Matrix43<T>::CreateRotationAndTranslation(const Matrix33<T>&
 template <typename T>
 inline T Matrix43<T>::Determinant() const
 {
-    // Simplified determinant as fourth column makes a more precise one ambiguous
-    return (m11 * m11) + (m12 * m21) + (m31 * m13);
+    // Determinant of the implied 4x4 with a (0, 0, 0, 1) fourth column, the translation row doesn't contribute
+    return WithoutTranslation().Determinant();
 }
 
 ///////////////////////////////////////////////////////////////////////
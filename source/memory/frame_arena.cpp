@@ -0,0 +1,233 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "frame_arena.h"
+
+#include <atomic>
+
+#include "memory_report.h"
+#include "sync/mutex.h"
+
+namespace memory
+{
+
+using synchronization::kCacheLineSize;
+
+static constexpr TFrameId kNoFrame = UINT64_MAX;
+
+// Header of a heap block taken when an arena is full, the data follows at kOverflowHeaderSize
+struct SOverflowBlock
+{
+    SOverflowBlock* pNext = nullptr;
+    size_t size = 0;
+    size_t used = 0;
+};
+
+static constexpr size_t kOverflowHeaderSize = (sizeof(SOverflowBlock) + kCacheLineSize - 1) & ~(kCacheLineSize - 1);
+
+struct SArena
+{
+    uint8_t* pBase = nullptr;
+    size_t used = 0;
+    TFrameId frameId = kNoFrame;
+    SOverflowBlock* pOverflow = nullptr; // newest first
+};
+
+// Arenas are only touched by the owning thread, the counters are read by GetFrameArenaStats from any thread
+struct alignas(kCacheLineSize) SThreadArenas
+{
+    uint8_t* pMemory = nullptr; // every arena of the thread, arenaSize apart
+    SArena arenas[kMaxFramesInFlight];
+    std::atomic<size_t> highWaterMark = { 0 };
+    std::atomic<uint64_t> numAllocations = { 0 };
+    std::atomic<uint64_t> numOverflows = { 0 };
+    std::atomic<uint64_t> overflowBytes = { 0 };
+};
+
+static synchronization::SMutex g_threadArenasMutex;
+static std::vector<SThreadArenas*> g_threadArenas; // guarded by g_threadArenasMutex
+static size_t g_arenaSize = 0;
+static uint32_t g_numFramesInFlight = 0;
+static std::atomic<uint32_t> g_generation = { 0 }; // bumped by every initialize so threads drop stale arenas
+static thread_local SThreadArenas* t_pThreadArenas = nullptr;
+static thread_local uint32_t t_generation = 0;
+
+static inline uintptr_t AlignUp(uintptr_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~uintptr_t(alignment - 1);
+}
+
+// Only the owning thread writes its counters, so a plain load and store is enough and avoids a locked add
+static inline void AddRelaxed(std::atomic<uint64_t>& counter, uint64_t value)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+static void FreeOverflowBlocks(SArena* pArena)
+{
+    SOverflowBlock* pBlock = pArena->pOverflow;
+    while (pBlock != nullptr)
+    {
+        SOverflowBlock* pNext = pBlock->pNext;
+        TrackReservedMemory(EMemoryTag::FrameArena, -int64_t(kOverflowHeaderSize + pBlock->size));
+        ::operator delete(pBlock, std::align_val_t(kCacheLineSize));
+        pBlock = pNext;
+    }
+
+    pArena->pOverflow = nullptr;
+}
+
+static SThreadArenas* CreateThreadArenas()
+{
+    SThreadArenas* pThreadArenas = new SThreadArenas();
+    pThreadArenas->pMemory = static_cast<uint8_t*>(::operator new(g_arenaSize * g_numFramesInFlight, std::align_val_t(kCacheLineSize)));
+    TrackReservedMemory(EMemoryTag::FrameArena, int64_t(g_arenaSize * g_numFramesInFlight));
+    for (uint32_t i = 0; i < g_numFramesInFlight; ++i)
+    {
+        pThreadArenas->arenas[i].pBase = pThreadArenas->pMemory + g_arenaSize * i;
+    }
+
+    synchronization::SLockGuard<synchronization::SMutex> lock(g_threadArenasMutex);
+    g_threadArenas.push_back(pThreadArenas);
+    return pThreadArenas;
+}
+
+static void DestroyThreadArenas(SThreadArenas* pThreadArenas)
+{
+    for (SArena& arena : pThreadArenas->arenas)
+    {
+        FreeOverflowBlocks(&arena);
+    }
+
+    ::operator delete(pThreadArenas->pMemory, std::align_val_t(kCacheLineSize));
+    TrackReservedMemory(EMemoryTag::FrameArena, -int64_t(g_arenaSize * g_numFramesInFlight));
+    delete pThreadArenas;
+}
+
+static inline SThreadArenas* GetThreadArenas()
+{
+    const uint32_t generation = g_generation.load(std::memory_order_acquire);
+    if (t_generation != generation)
+    {
+        t_pThreadArenas = CreateThreadArenas();
+        t_generation = generation;
+    }
+
+    return t_pThreadArenas;
+}
+
+static void* OverflowAlloc(SThreadArenas* pThreadArenas, SArena* pArena, size_t size, size_t alignment)
+{
+    SOverflowBlock* pBlock = pArena->pOverflow;
+    uintptr_t address = 0;
+    if (pBlock != nullptr)
+    {
+        const uintptr_t data = reinterpret_cast<uintptr_t>(pBlock) + kOverflowHeaderSize;
+        address = AlignUp(data + pBlock->used, alignment);
+        if (address + size > data + pBlock->size)
+        {
+            pBlock = nullptr;
+        }
+    }
+
+    if (pBlock == nullptr)
+    {
+        const size_t blockSize = std::max(g_arenaSize, size + alignment);
+        void* pMemory = ::operator new(kOverflowHeaderSize + blockSize, std::align_val_t(kCacheLineSize));
+        TrackReservedMemory(EMemoryTag::FrameArena, int64_t(kOverflowHeaderSize + blockSize));
+        pBlock = new (pMemory) SOverflowBlock();
+        pBlock->size = blockSize;
+        pBlock->pNext = pArena->pOverflow;
+        pArena->pOverflow = pBlock;
+        address = AlignUp(reinterpret_cast<uintptr_t>(pBlock) + kOverflowHeaderSize, alignment);
+    }
+
+    pBlock->used = address + size - (reinterpret_cast<uintptr_t>(pBlock) + kOverflowHeaderSize);
+    AddRelaxed(pThreadArenas->numOverflows, 1);
+    AddRelaxed(pThreadArenas->overflowBytes, size);
+    return reinterpret_cast<void*>(address);
+}
+
+bool InitializeFrameArenas(const SFrameArenaConfig& config)
+{
+    if (config.arenaSize == 0 || config.numFramesInFlight == 0 || config.numFramesInFlight > kMaxFramesInFlight)
+    {
+        DiracError("[FrameArena] invalid config: arena size %zu, %u frames in flight (1 to %u)",
+            config.arenaSize,
+            config.numFramesInFlight,
+            kMaxFramesInFlight);
+        return false;
+    }
+
+    assert(g_arenaSize == 0 && "frame arenas are already initialized");
+    g_arenaSize = AlignUp(config.arenaSize, kCacheLineSize);
+    g_numFramesInFlight = config.numFramesInFlight;
+    g_generation.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+void ShutdownFrameArenas()
+{
+    synchronization::SLockGuard<synchronization::SMutex> lock(g_threadArenasMutex);
+    for (SThreadArenas* pThreadArenas : g_threadArenas)
+    {
+        DestroyThreadArenas(pThreadArenas);
+    }
+
+    g_threadArenas.clear();
+    g_arenaSize = 0;
+    g_numFramesInFlight = 0;
+}
+
+void GetFrameArenaStats(SFrameArenaStats* pOutStats)
+{
+    assert(pOutStats != nullptr);
+    *pOutStats = SFrameArenaStats();
+    pOutStats->arenaSize = g_arenaSize;
+    pOutStats->numFramesInFlight = g_numFramesInFlight;
+
+    synchronization::SLockGuard<synchronization::SMutex> lock(g_threadArenasMutex);
+    pOutStats->numThreads = (uint32_t)g_threadArenas.size();
+    for (const SThreadArenas* pThreadArenas : g_threadArenas)
+    {
+        pOutStats->highWaterMark = std::max(pOutStats->highWaterMark, pThreadArenas->highWaterMark.load(std::memory_order_relaxed));
+        pOutStats->numAllocations += pThreadArenas->numAllocations.load(std::memory_order_relaxed);
+        pOutStats->numOverflows += pThreadArenas->numOverflows.load(std::memory_order_relaxed);
+        pOutStats->overflowBytes += pThreadArenas->overflowBytes.load(std::memory_order_relaxed);
+    }
+}
+
+void* FrameAlloc(TFrameId frameId, size_t size, size_t alignment)
+{
+    assert(g_arenaSize != 0 && "frame arenas aren't initialized");
+    assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+    SThreadArenas* pThreadArenas = GetThreadArenas();
+    SArena& arena = pThreadArenas->arenas[frameId % g_numFramesInFlight];
+    if (arena.frameId != frameId)
+    {
+        // The previous user of this arena is at least numFramesInFlight frames old and retired by the pipeline
+        assert((arena.frameId == kNoFrame || arena.frameId < frameId) && "allocating for a frame whose arena was reused");
+        FreeOverflowBlocks(&arena);
+        arena.used = 0;
+        arena.frameId = frameId;
+    }
+
+    AddRelaxed(pThreadArenas->numAllocations, 1);
+    const uintptr_t base = reinterpret_cast<uintptr_t>(arena.pBase);
+    const size_t offset = AlignUp(base + arena.used, alignment) - base;
+    if (offset + size > g_arenaSize)
+        return OverflowAlloc(pThreadArenas, &arena, size, alignment);
+
+    arena.used = offset + size;
+    if (arena.used > pThreadArenas->highWaterMark.load(std::memory_order_relaxed))
+    {
+        pThreadArenas->highWaterMark.store(arena.used, std::memory_order_relaxed);
+    }
+
+    return arena.pBase + offset;
+}
+
+} // memory namespace
@@ -0,0 +1,100 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace memory
+{
+
+/////////////////////////////////////////////////////////
+// Frame arenas
+//
+// Scratch memory that lives for one frame. Every thread that allocates owns numFramesInFlight linear arenas and
+// frame N bumps through arena N % numFramesInFlight, so an allocation is a pointer increment with no locking and
+// nothing is ever freed individually. An arena is reset as a whole the first time its thread allocates for a later
+// frame, which can only happen once the frame pipeline has retired every frame that shared it, so memory from frame N
+// may be handed to other threads (e.g. the render thread through the snapshot) until frame N + numFramesInFlight.
+//
+// Allocations that don't fit spill into heap overflow blocks freed at the same reset. They are counted in the stats
+// alongside the high water mark, an overflow means arenaSize should grow.
+
+static constexpr uint32_t kMaxFramesInFlight = 3; // platform::kMaxFramePipelineDepth
+static constexpr size_t kDefaultFrameArenaSize = 1024 * 1024;
+
+struct SFrameArenaConfig
+{
+    size_t arenaSize = kDefaultFrameArenaSize; // per thread per frame in flight, reserved on the thread's first allocation
+    uint32_t numFramesInFlight = 2; // the frame pipeline depth
+};
+
+struct SFrameArenaStats
+{
+    size_t arenaSize = 0;
+    uint32_t numFramesInFlight = 0;
+    uint32_t numThreads = 0; // threads that have allocated
+    size_t highWaterMark = 0; // most arena bytes a thread used in one frame, overflow excluded
+    uint64_t numAllocations = 0;
+    uint64_t numOverflows = 0; // allocations served from overflow blocks
+    uint64_t overflowBytes = 0;
+};
+
+bool InitializeFrameArenas(const SFrameArenaConfig& config);
+void ShutdownFrameArenas(); // frees every thread's arenas, nothing may allocate or use frame memory after
+void GetFrameArenaStats(SFrameArenaStats* pOutStats); // approximate while other threads allocate
+
+// Valid until frameId + numFramesInFlight starts allocating on this thread. frameId must never go backwards on a
+// thread by numFramesInFlight or more, that memory has been reused.
+void* FrameAlloc(TFrameId frameId, size_t size, size_t alignment = alignof(std::max_align_t));
+
+inline void* FrameAlloc(const SFrameContext& frameContext, size_t size, size_t alignment = alignof(std::max_align_t))
+{
+    return FrameAlloc(frameContext.frameId, size, alignment);
+}
+
+// Uninitialized, T is never destroyed
+template <typename T>
+inline T* FrameAllocArray(const SFrameContext& frameContext, size_t count)
+{
+    return static_cast<T*>(FrameAlloc(frameContext.frameId, sizeof(T) * count, alignof(T)));
+}
+
+/////////////////////////////////////////////////////////
+// STL adapter, deallocate is a no-op and the memory goes away with the frame. Containers must not outlive it.
+
+template <typename T>
+struct SFrameAllocator
+{
+    typedef T value_type;
+
+    explicit SFrameAllocator(const SFrameContext& frameContext) : frameId(frameContext.frameId) {}
+    explicit SFrameAllocator(TFrameId frameId_) : frameId(frameId_) {}
+
+    template <typename U>
+    SFrameAllocator(const SFrameAllocator<U>& other) : frameId(other.frameId) {}
+
+    T* allocate(size_t count)
+    {
+        return static_cast<T*>(FrameAlloc(frameId, sizeof(T) * count, alignof(T)));
+    }
+
+    void deallocate(T*, size_t) {}
+
+    template <typename U>
+    bool operator==(const SFrameAllocator<U>& rhs) const { return frameId == rhs.frameId; }
+
+    template <typename U>
+    bool operator!=(const SFrameAllocator<U>& rhs) const { return frameId != rhs.frameId; }
+
+    TFrameId frameId;
+};
+
+template <typename T>
+using TFrameVector = std::vector<T, SFrameAllocator<T>>;
+
+} // memory namespace
@@ -0,0 +1,146 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "memory_report.h"
+
+#include <atomic>
+#include <vector>
+
+#include "sync/mutex.h"
+
+namespace memory
+{
+
+struct SMemoryUser
+{
+    EMemoryTag tag = EMemoryTag::General;
+    const char* name = nullptr;
+    const void* pUser = nullptr;
+    TMemoryUsageFunction function = nullptr;
+};
+
+static std::atomic<int64_t> g_reservedBytes[(size_t)EMemoryTag::COUNT];
+static std::atomic<int64_t> g_peakReservedBytes[(size_t)EMemoryTag::COUNT];
+static synchronization::SMutex g_usersMutex;
+static std::vector<SMemoryUser> g_users; // guarded by g_usersMutex
+
+const char* ToString(EMemoryTag tag)
+{
+    switch (tag)
+    {
+    case EMemoryTag::General: return "General";
+    case EMemoryTag::FrameArena: return "FrameArena";
+    case EMemoryTag::Ecs: return "Ecs";
+    case EMemoryTag::Jobs: return "Jobs";
+    case EMemoryTag::Renderer: return "Renderer";
+    case EMemoryTag::Platform: return "Platform";
+    case EMemoryTag::Game: return "Game";
+    case EMemoryTag::COUNT: break;
+    }
+
+    return "Unknown";
+}
+
+void TrackReservedMemory(EMemoryTag tag, int64_t bytes)
+{
+    assert(tag < EMemoryTag::COUNT);
+    const size_t tagIndex = (size_t)tag;
+    const int64_t reserved = g_reservedBytes[tagIndex].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    assert(reserved >= 0);
+
+    int64_t peak = g_peakReservedBytes[tagIndex].load(std::memory_order_relaxed);
+    while (reserved > peak && !g_peakReservedBytes[tagIndex].compare_exchange_weak(peak, reserved, std::memory_order_relaxed))
+    {
+    }
+}
+
+void RegisterMemoryUser(EMemoryTag tag, const char* name, const void* pUser, TMemoryUsageFunction function)
+{
+    assert(tag < EMemoryTag::COUNT && pUser != nullptr && function != nullptr);
+    SMemoryUser user;
+    user.tag = tag;
+    user.name = name != nullptr ? name : "unnamed";
+    user.pUser = pUser;
+    user.function = function;
+
+    synchronization::SLockGuard<synchronization::SMutex> lock(g_usersMutex);
+    g_users.push_back(user);
+}
+
+void UnregisterMemoryUser(const void* pUser)
+{
+    synchronization::SLockGuard<synchronization::SMutex> lock(g_usersMutex);
+    for (size_t i = 0; i < g_users.size(); ++i)
+    {
+        if (g_users[i].pUser == pUser)
+        {
+            g_users[i] = g_users.back();
+            g_users.pop_back();
+            return;
+        }
+    }
+
+    assert(false && "memory user was never registered");
+}
+
+void GetMemoryReport(SMemoryReport* pOutReport)
+{
+    assert(pOutReport != nullptr);
+    *pOutReport = SMemoryReport();
+    for (size_t i = 0; i < (size_t)EMemoryTag::COUNT; ++i)
+    {
+        SMemoryTagStats& stats = pOutReport->tags[i];
+        stats.reservedBytes = g_reservedBytes[i].load(std::memory_order_relaxed);
+        stats.peakReservedBytes = g_peakReservedBytes[i].load(std::memory_order_relaxed);
+        pOutReport->totalReservedBytes += stats.reservedBytes;
+    }
+
+    synchronization::SLockGuard<synchronization::SMutex> lock(g_usersMutex);
+    for (const SMemoryUser& user : g_users)
+    {
+        const SMemoryUsage usage = user.function(user.pUser);
+        SMemoryTagStats& stats = pOutReport->tags[(size_t)user.tag];
+        stats.usedBytes += usage.usedBytes;
+        stats.liveAllocations += usage.liveAllocations;
+        pOutReport->totalUsedBytes += usage.usedBytes;
+    }
+}
+
+void LogMemoryReport()
+{
+    SMemoryReport report;
+    GetMemoryReport(&report);
+    DiracLog(1, "[Memory] %lld KB reserved, %llu KB in use",
+        (long long)(report.totalReservedBytes / 1024),
+        (unsigned long long)(report.totalUsedBytes / 1024));
+
+    for (size_t i = 0; i < (size_t)EMemoryTag::COUNT; ++i)
+    {
+        const SMemoryTagStats& stats = report.tags[i];
+        if (stats.peakReservedBytes == 0 && stats.usedBytes == 0)
+            continue;
+
+        DiracLog(1, "[Memory]     %-12s %8lld KB reserved (%lld KB peak), %8llu KB in use by %llu allocations",
+            ToString(EMemoryTag(i)),
+            (long long)(stats.reservedBytes / 1024),
+            (long long)(stats.peakReservedBytes / 1024),
+            (unsigned long long)(stats.usedBytes / 1024),
+            (unsigned long long)stats.liveAllocations);
+    }
+
+    synchronization::SLockGuard<synchronization::SMutex> lock(g_usersMutex);
+    for (const SMemoryUser& user : g_users)
+    {
+        const SMemoryUsage usage = user.function(user.pUser);
+        DiracLog(1, "[Memory]     %s/%s: %llu bytes in %llu allocations",
+            ToString(user.tag),
+            user.name,
+            (unsigned long long)usage.usedBytes,
+            (unsigned long long)usage.liveAllocations);
+    }
+}
+
+} // memory namespace
@@ -0,0 +1,64 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+namespace memory
+{
+
+/////////////////////////////////////////////////////////
+// Memory report
+//
+// Per subsystem footprint, available in every build. Allocators call TrackReservedMemory when they take memory from
+// or return it to the heap (slabs, arenas), which is rare, and register themselves as users so what they have handed
+// out is only gathered when a report is built. Nothing here is touched per allocation.
+
+enum class EMemoryTag : uint8_t
+{
+    General,
+    FrameArena,
+    Ecs,
+    Jobs,
+    Renderer,
+    Platform,
+    Game,
+    COUNT
+};
+
+const char* ToString(EMemoryTag tag);
+
+struct SMemoryUsage
+{
+    uint64_t usedBytes = 0;
+    uint64_t liveAllocations = 0;
+};
+
+typedef SMemoryUsage (*TMemoryUsageFunction)(const void* pUser);
+
+struct SMemoryTagStats
+{
+    int64_t reservedBytes = 0;
+    int64_t peakReservedBytes = 0;
+    uint64_t usedBytes = 0; // registered users only
+    uint64_t liveAllocations = 0;
+};
+
+struct SMemoryReport
+{
+    SMemoryTagStats tags[(size_t)EMemoryTag::COUNT];
+    int64_t totalReservedBytes = 0;
+    uint64_t totalUsedBytes = 0;
+};
+
+void TrackReservedMemory(EMemoryTag tag, int64_t bytes); // negative when returned
+
+// pUser identifies the registration and is passed back to function, which may be called from any thread
+void RegisterMemoryUser(EMemoryTag tag, const char* name, const void* pUser, TMemoryUsageFunction function);
+void UnregisterMemoryUser(const void* pUser);
+
+void GetMemoryReport(SMemoryReport* pOutReport);
+void LogMemoryReport(); // every tag with reserved memory, then every registered user
+
+} // memory namespace
@@ -0,0 +1,353 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "pool_allocator.h"
+
+#include "jobs/job_system.h"
+
+namespace memory
+{
+
+using synchronization::kCacheLineSize;
+using synchronization::SLockGuard;
+using synchronization::SMutex;
+
+static constexpr uint32_t kMaxLeaksListed = 16;
+
+static inline size_t AlignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Only the owning thread writes its cache counters, so a plain load and store is enough and avoids a locked add
+static inline void AddRelaxed(std::atomic<uint64_t>& counter, uint64_t value)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+static inline bool IsFilledWith(const uint8_t* pBytes, size_t size, uint8_t value)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        if (pBytes[i] != value)
+            return false;
+    }
+
+    return true;
+}
+
+SPoolAllocator::~SPoolAllocator()
+{
+    if (m_bInitialized)
+    {
+        Shutdown();
+    }
+}
+
+bool SPoolAllocator::Initialize(const SPoolAllocatorConfig& config)
+{
+    assert(!m_bInitialized);
+    if (config.blockSize == 0 || config.blocksPerSlab == 0 || config.alignment == 0 || (config.alignment & (config.alignment - 1)) != 0)
+    {
+        DiracError("[Pool] %s: invalid config, block size %zu, alignment %zu, %u blocks per slab",
+            config.name,
+            config.blockSize,
+            config.alignment,
+            config.blocksPerSlab);
+        return false;
+    }
+
+    m_config = config;
+    m_config.alignment = std::max(config.alignment, alignof(SFreeBlock)); // free blocks hold the list link
+    const size_t backGuardSize = POOL_GUARD_BYTES ? kPoolGuardSize : 0;
+    m_frontGuardSize = POOL_GUARD_BYTES ? AlignUp(kPoolGuardSize, m_config.alignment) : 0;
+    m_stride = AlignUp(m_frontGuardSize + std::max(config.blockSize, sizeof(SFreeBlock)) + backGuardSize, m_config.alignment);
+    m_slabSize = m_stride * config.blocksPerSlab;
+    m_slabAlignment = std::max(m_config.alignment, kCacheLineSize);
+
+    m_numThreadCaches = jobs::GetJobThreadCount(); // 0 before the job system is up, every call then takes the lock
+    m_pThreadCaches.reset(m_numThreadCaches > 0 ? new SThreadCache[m_numThreadCaches] : nullptr);
+
+    m_bInitialized = true;
+    RegisterMemoryUser(m_config.tag, m_config.name, this, GetMemoryUsage);
+    return true;
+}
+
+uint64_t SPoolAllocator::Shutdown()
+{
+    assert(m_bInitialized);
+    UnregisterMemoryUser(this);
+
+    const uint64_t liveBlocks = GetLiveBlocks();
+    SLockGuard<SMutex> lock(m_mutex);
+    if (liveBlocks > 0)
+    {
+        DiracError("[Pool] %s (%s): %llu blocks leaked, %llu bytes",
+            m_config.name,
+            ToString(m_config.tag),
+            (unsigned long long)liveBlocks,
+            (unsigned long long)(liveBlocks * m_config.blockSize));
+
+#if POOL_GUARD_BYTES
+        // Allocated blocks are the ones whose front guard is intact, free ones are filled with kPoolDeadByte
+        uint32_t numListed = 0;
+        for (uint8_t* pSlab : m_slabs)
+        {
+            uint8_t* pSlabEnd = (pSlab == m_slabs.back()) ? m_pSlabCursor : pSlab + m_slabSize;
+            for (uint8_t* pBlock = pSlab; pBlock < pSlabEnd && numListed < kMaxLeaksListed; pBlock += m_stride)
+            {
+                if (!IsFilledWith(pBlock, m_frontGuardSize, kPoolGuardByte))
+                    continue;
+
+                void* pUser = ToUser(pBlock);
+                DiracError("[Pool]     leaked %p%s", pUser, CheckGuards(pUser) ? "" : ", guard bytes overwritten");
+                ++numListed;
+            }
+        }
+#endif
+    }
+
+    for (uint8_t* pSlab : m_slabs)
+    {
+        ::operator delete(pSlab, std::align_val_t(m_slabAlignment));
+        TrackReservedMemory(m_config.tag, -int64_t(m_slabSize));
+    }
+
+    m_slabs.clear();
+    m_pFreeList = nullptr;
+    m_pSlabCursor = nullptr;
+    m_pSlabEnd = nullptr;
+    m_numLockedAllocations = 0;
+    m_numLockedFrees = 0;
+    m_sharedLiveBlocks = 0;
+    m_peakSharedLiveBlocks = 0;
+    m_pThreadCaches.reset();
+    m_numThreadCaches = 0;
+    m_bInitialized = false;
+    return liveBlocks;
+}
+
+void* SPoolAllocator::Allocate()
+{
+    assert(m_bInitialized);
+    void* pUser = nullptr;
+    const uint32_t threadIndex = jobs::GetCurrentJobThreadIndex();
+    if (threadIndex < m_numThreadCaches)
+    {
+        SThreadCache& cache = m_pThreadCaches[threadIndex];
+        if (cache.count == 0)
+        {
+            SLockGuard<SMutex> lock(m_mutex);
+            while (cache.count < kPoolThreadCacheSize / 2)
+            {
+                void* pRefill = AllocateLocked();
+                if (pRefill == nullptr)
+                    break;
+
+                cache.blocks[cache.count++] = pRefill;
+            }
+        }
+
+        if (cache.count == 0)
+            return nullptr;
+
+        pUser = cache.blocks[--cache.count];
+        AddRelaxed(cache.numAllocations, 1);
+    }
+    else
+    {
+        SLockGuard<SMutex> lock(m_mutex);
+        pUser = AllocateLocked();
+        if (pUser == nullptr)
+            return nullptr;
+
+        ++m_numLockedAllocations;
+    }
+
+    MarkAllocated(pUser);
+    return pUser;
+}
+
+void SPoolAllocator::Free(void* pUser)
+{
+    if (pUser == nullptr)
+        return;
+
+    assert(m_bInitialized);
+#if POOL_GUARD_BYTES
+    assert(Owns(pUser) && "block doesn't belong to this pool");
+    if (!CheckGuards(pUser))
+    {
+        DiracError("[Pool] %s: guard bytes around %p overwritten", m_config.name, pUser);
+        assert(false && "pool block overrun");
+    }
+#endif
+
+    MarkFreed(pUser);
+    const uint32_t threadIndex = jobs::GetCurrentJobThreadIndex();
+    if (threadIndex < m_numThreadCaches)
+    {
+        SThreadCache& cache = m_pThreadCaches[threadIndex];
+        if (cache.count == kPoolThreadCacheSize)
+        {
+            SLockGuard<SMutex> lock(m_mutex);
+            while (cache.count > kPoolThreadCacheSize / 2)
+            {
+                FreeLocked(cache.blocks[--cache.count]);
+            }
+        }
+
+        cache.blocks[cache.count++] = pUser;
+        AddRelaxed(cache.numFrees, 1);
+    }
+    else
+    {
+        SLockGuard<SMutex> lock(m_mutex);
+        FreeLocked(pUser);
+        ++m_numLockedFrees;
+    }
+}
+
+bool SPoolAllocator::Owns(const void* pUser) const
+{
+    const uint8_t* pBlock = static_cast<const uint8_t*>(pUser) - m_frontGuardSize;
+    SLockGuard<SMutex> lock(m_mutex);
+    for (const uint8_t* pSlab : m_slabs)
+    {
+        if (pBlock >= pSlab && pBlock < pSlab + m_slabSize)
+            return size_t(pBlock - pSlab) % m_stride == 0;
+    }
+
+    return false;
+}
+
+void SPoolAllocator::GetStats(SPoolAllocatorStats* pOutStats) const
+{
+    assert(pOutStats != nullptr);
+    *pOutStats = SPoolAllocatorStats();
+    pOutStats->liveBlocks = GetLiveBlocks();
+
+    uint64_t numAllocations = 0;
+    for (uint32_t i = 0; i < m_numThreadCaches; ++i)
+    {
+        numAllocations += m_pThreadCaches[i].numAllocations.load(std::memory_order_relaxed);
+    }
+
+    SLockGuard<SMutex> lock(m_mutex);
+    pOutStats->peakLiveBlocks = m_peakSharedLiveBlocks;
+    pOutStats->numAllocations = numAllocations + m_numLockedAllocations;
+    pOutStats->numSlabs = (uint32_t)m_slabs.size();
+    pOutStats->reservedBytes = m_slabs.size() * m_slabSize;
+}
+
+SMemoryUsage SPoolAllocator::GetMemoryUsage(const void* pUser)
+{
+    const SPoolAllocator* pPool = static_cast<const SPoolAllocator*>(pUser);
+    SMemoryUsage usage;
+    usage.liveAllocations = pPool->GetLiveBlocks();
+    usage.usedBytes = usage.liveAllocations * pPool->m_config.blockSize;
+    return usage;
+}
+
+uint8_t* SPoolAllocator::ToBlock(void* pUser) const
+{
+    return static_cast<uint8_t*>(pUser) - m_frontGuardSize;
+}
+
+void* SPoolAllocator::ToUser(uint8_t* pBlock) const
+{
+    return pBlock + m_frontGuardSize;
+}
+
+void* SPoolAllocator::AllocateLocked()
+{
+    void* pUser = nullptr;
+    if (m_pFreeList != nullptr)
+    {
+        pUser = m_pFreeList;
+        m_pFreeList = m_pFreeList->pNext;
+    }
+    else
+    {
+        if (m_pSlabCursor == m_pSlabEnd)
+        {
+            if (m_config.maxSlabs != 0 && m_slabs.size() >= m_config.maxSlabs)
+                return nullptr;
+
+            uint8_t* pSlab = static_cast<uint8_t*>(::operator new(m_slabSize, std::align_val_t(m_slabAlignment)));
+            TrackReservedMemory(m_config.tag, int64_t(m_slabSize));
+            m_slabs.push_back(pSlab);
+            m_pSlabCursor = pSlab;
+            m_pSlabEnd = pSlab + m_slabSize;
+        }
+
+        pUser = ToUser(m_pSlabCursor);
+        m_pSlabCursor += m_stride;
+    }
+
+    m_peakSharedLiveBlocks = std::max(m_peakSharedLiveBlocks, ++m_sharedLiveBlocks);
+    return pUser;
+}
+
+void SPoolAllocator::FreeLocked(void* pUser)
+{
+    SFreeBlock* pFree = static_cast<SFreeBlock*>(pUser);
+    pFree->pNext = m_pFreeList;
+    m_pFreeList = pFree;
+    --m_sharedLiveBlocks;
+}
+
+void SPoolAllocator::MarkAllocated(void* pUser)
+{
+#if POOL_GUARD_BYTES
+    uint8_t* pBlock = ToBlock(pUser);
+    memset(pBlock, kPoolGuardByte, m_frontGuardSize);
+    memset(pBlock + m_frontGuardSize + m_config.blockSize, kPoolGuardByte, m_stride - m_frontGuardSize - m_config.blockSize);
+#else
+    (void)pUser;
+#endif
+}
+
+void SPoolAllocator::MarkFreed(void* pUser)
+{
+#if POOL_GUARD_BYTES
+    uint8_t* pBlock = ToBlock(pUser);
+    assert(IsFilledWith(pBlock, m_frontGuardSize, kPoolGuardByte) && "pool block freed twice");
+    memset(pBlock, kPoolDeadByte, m_stride);
+#else
+    (void)pUser;
+#endif
+}
+
+bool SPoolAllocator::CheckGuards(const void* pUser) const
+{
+#if POOL_GUARD_BYTES
+    const uint8_t* pBlock = static_cast<const uint8_t*>(pUser) - m_frontGuardSize;
+    return IsFilledWith(pBlock, m_frontGuardSize, kPoolGuardByte)
+        && IsFilledWith(pBlock + m_frontGuardSize + m_config.blockSize, m_stride - m_frontGuardSize - m_config.blockSize, kPoolGuardByte);
+#else
+    (void)pUser;
+    return true;
+#endif
+}
+
+uint64_t SPoolAllocator::GetLiveBlocks() const
+{
+    uint64_t numAllocations = 0;
+    uint64_t numFrees = 0;
+    for (uint32_t i = 0; i < m_numThreadCaches; ++i)
+    {
+        numAllocations += m_pThreadCaches[i].numAllocations.load(std::memory_order_relaxed);
+        numFrees += m_pThreadCaches[i].numFrees.load(std::memory_order_relaxed);
+    }
+
+    SLockGuard<SMutex> lock(m_mutex);
+    numAllocations += m_numLockedAllocations;
+    numFrees += m_numLockedFrees;
+    return numAllocations > numFrees ? numAllocations - numFrees : 0; // counters are read racily while in use
+}
+
+} // memory namespace
@@ -0,0 +1,170 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "memory_report.h"
+#include "sync/mutex.h"
+
+// Guard bytes around every block, checked on free and shutdown, freed blocks filled with kPoolDeadByte
+#if !defined(NDEBUG)
+#define POOL_GUARD_BYTES 1
+#else
+#define POOL_GUARD_BYTES 0
+#endif
+
+namespace memory
+{
+
+/////////////////////////////////////////////////////////
+// Pool allocator
+//
+// Fixed size blocks carved out of slabs of blocksPerSlab. A slab is only taken from the heap when every earlier
+// block is in use, and freed blocks go on an intrusive free list, so allocation and free are O(1) and slabs are only
+// returned at Shutdown. maxSlabs = 1 makes a fixed capacity pool that returns nullptr when full.
+//
+// Job system threads each get a small cache of free blocks and only take the pool lock to move a batch of blocks
+// between their cache and the shared free list, other threads always take the lock. Blocks may be freed on any
+// thread. Every pool registers with the memory report under its tag, and Shutdown reports blocks still allocated.
+
+static constexpr uint32_t kPoolThreadCacheSize = 64; // blocks, a refill or flush moves half
+static constexpr size_t kPoolGuardSize = 16; // bytes on either side of a block when POOL_GUARD_BYTES is on
+static constexpr uint8_t kPoolGuardByte = 0xfd;
+static constexpr uint8_t kPoolDeadByte = 0xdd;
+
+struct SPoolAllocatorConfig
+{
+    const char* name = "pool"; // must outlive the pool, used by the memory and leak reports
+    EMemoryTag tag = EMemoryTag::General;
+    size_t blockSize = 0;
+    size_t alignment = alignof(std::max_align_t);
+    uint32_t blocksPerSlab = 256;
+    uint32_t maxSlabs = 0; // 0 is unbounded
+};
+
+struct SPoolAllocatorStats
+{
+    uint64_t liveBlocks = 0;
+    uint64_t peakLiveBlocks = 0; // as seen by the shared free list, blocks parked in thread caches count as live
+    uint64_t numAllocations = 0;
+    uint32_t numSlabs = 0;
+    size_t reservedBytes = 0;
+};
+
+struct SPoolAllocator
+{
+    SPoolAllocator() = default;
+    ~SPoolAllocator();
+    SPoolAllocator(const SPoolAllocator&) = delete;
+    SPoolAllocator& operator=(const SPoolAllocator&) = delete;
+
+    bool Initialize(const SPoolAllocatorConfig& config);
+
+    // Reports leaks and returns every slab. Nothing may use the pool concurrently, live blocks become dangling.
+    // Returns the number of blocks that were still allocated.
+    uint64_t Shutdown();
+
+    void* Allocate(); // nullptr when maxSlabs are full
+    void Free(void* pBlock); // nullptr is ignored
+
+    bool Owns(const void* pBlock) const; // takes the lock, for asserts and debugging
+    size_t GetBlockSize() const { return m_config.blockSize; }
+    void GetStats(SPoolAllocatorStats* pOutStats) const;
+
+private:
+    struct SFreeBlock
+    {
+        SFreeBlock* pNext;
+    };
+
+    struct alignas(synchronization::kCacheLineSize) SThreadCache
+    {
+        void* blocks[kPoolThreadCacheSize];
+        uint32_t count = 0;
+        std::atomic<uint64_t> numAllocations = { 0 }; // written by the owning thread only
+        std::atomic<uint64_t> numFrees = { 0 };
+    };
+
+    static SMemoryUsage GetMemoryUsage(const void* pUser);
+
+    uint8_t* ToBlock(void* pUser) const;
+    void* ToUser(uint8_t* pBlock) const;
+    void* AllocateLocked(); // m_mutex held
+    void FreeLocked(void* pUser);
+    void MarkAllocated(void* pUser);
+    void MarkFreed(void* pUser);
+    bool CheckGuards(const void* pUser) const;
+    uint64_t GetLiveBlocks() const;
+
+    SPoolAllocatorConfig m_config;
+    size_t m_frontGuardSize = 0;
+    size_t m_stride = 0;
+    size_t m_slabSize = 0;
+    size_t m_slabAlignment = 0;
+    std::unique_ptr<SThreadCache[]> m_pThreadCaches;
+    uint32_t m_numThreadCaches = 0;
+
+    mutable synchronization::SMutex m_mutex;
+    std::vector<uint8_t*> m_slabs; // guarded by m_mutex, as is everything below
+    SFreeBlock* m_pFreeList = nullptr;
+    uint8_t* m_pSlabCursor = nullptr; // next never used block of the newest slab
+    uint8_t* m_pSlabEnd = nullptr;
+    uint64_t m_numLockedAllocations = 0;
+    uint64_t m_numLockedFrees = 0;
+    uint64_t m_sharedLiveBlocks = 0;
+    uint64_t m_peakSharedLiveBlocks = 0;
+    bool m_bInitialized = false;
+};
+
+/////////////////////////////////////////////////////////
+// Typed pool, constructs and destroys T in pool blocks
+
+template <typename T>
+struct SObjectPool
+{
+    bool Initialize(const char* name, EMemoryTag tag, uint32_t blocksPerSlab = 256, uint32_t maxSlabs = 0)
+    {
+        SPoolAllocatorConfig config;
+        config.name = name;
+        config.tag = tag;
+        config.blockSize = sizeof(T);
+        config.alignment = alignof(T);
+        config.blocksPerSlab = blocksPerSlab;
+        config.maxSlabs = maxSlabs;
+        return m_pool.Initialize(config);
+    }
+
+    uint64_t Shutdown() { return m_pool.Shutdown(); } // leaked objects aren't destroyed
+
+    template <typename... TArgs>
+    T* New(TArgs&&... args)
+    {
+        void* pMemory = m_pool.Allocate();
+        return pMemory != nullptr ? new (pMemory) T(std::forward<TArgs>(args)...) : nullptr;
+    }
+
+    void Delete(T* pObject)
+    {
+        if (pObject == nullptr)
+            return;
+
+        pObject->~T();
+        m_pool.Free(pObject);
+    }
+
+    void GetStats(SPoolAllocatorStats* pOutStats) const { m_pool.GetStats(pOutStats); }
+
+private:
+    SPoolAllocator m_pool;
+};
+
+} // memory namespace
@@ -0,0 +1,268 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "async_io.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace platform
+{
+
+////////////////////////////////////////////////
+// State
+
+struct SAsyncReadBatch
+{
+    TAsyncReadCallback callback = nullptr;
+    void* pUserData = nullptr;
+    size_t numPending = 0;
+    bool bFailed = false;
+    EAsyncReadStatus status = EAsyncReadStatus::Pending; // only leaves Pending once every file has been read
+};
+
+struct SAsyncReadJob
+{
+    TAsyncReadHandle handle = kInvalidAsyncReadHandle;
+    std::string fileName;
+    EFileType fileType = EFileType::Binary;
+    SFile* pOutFile = nullptr;
+};
+
+// All guarded by g_asyncMutex
+static std::mutex g_asyncMutex;
+static std::condition_variable g_jobCondition; // workers wait for jobs
+static std::condition_variable g_completionCondition; // WaitForAsyncRead waits for batches
+static std::deque<SAsyncReadJob> g_jobs;
+static std::unordered_map<TAsyncReadHandle, SAsyncReadBatch> g_batches;
+static std::vector<TAsyncReadHandle> g_completedHandles;
+static TAsyncReadHandle g_nextHandle = kInvalidAsyncReadHandle;
+static bool g_bStopWorkers = false;
+
+static std::vector<std::thread> g_workers; // main thread only
+
+////////////////////////////////////////////////
+// Functions
+
+const char* ToString(EAsyncReadStatus status)
+{
+    switch (status)
+    {
+    case EAsyncReadStatus::Invalid: return "Invalid";
+    case EAsyncReadStatus::Pending: return "Pending";
+    case EAsyncReadStatus::Complete: return "Complete";
+    case EAsyncReadStatus::Failed: return "Failed";
+    }
+
+    return "Unknown";
+}
+
+// expects g_asyncMutex to be held
+static void FinishAsyncReadJob(TAsyncReadHandle handle, bool bSuccess)
+{
+    auto it = g_batches.find(handle);
+    assert(it != g_batches.end());
+    SAsyncReadBatch& batch = it->second;
+    assert(batch.numPending > 0);
+    batch.bFailed |= !bSuccess;
+    if (--batch.numPending == 0)
+    {
+        batch.status = batch.bFailed ? EAsyncReadStatus::Failed : EAsyncReadStatus::Complete;
+        g_completedHandles.push_back(handle);
+        g_completionCondition.notify_all();
+    }
+}
+
+static void RunAsyncReadJob(SAsyncReadJob& job)
+{
+    const char* fileNames[] = { job.fileName.c_str() };
+    const bool bSuccess = LoadFiles(fileNames, 1, job.fileType, job.pOutFile);
+
+    std::lock_guard<std::mutex> lock(g_asyncMutex);
+    FinishAsyncReadJob(job.handle, bSuccess);
+}
+
+static void AsyncIOWorker()
+{
+    std::unique_lock<std::mutex> lock(g_asyncMutex);
+    while (true)
+    {
+        g_jobCondition.wait(lock, [] { return g_bStopWorkers || !g_jobs.empty(); });
+        if (g_jobs.empty())
+            return; // stopping and drained
+
+        SAsyncReadJob job = std::move(g_jobs.front());
+        g_jobs.pop_front();
+        lock.unlock();
+        RunAsyncReadJob(job);
+        lock.lock();
+    }
+}
+
+bool InitializeAsyncIO(uint32_t numThreads)
+{
+    assert(g_workers.empty());
+    g_bStopWorkers = false;
+    g_workers.reserve(numThreads);
+    for (uint32_t i = 0; i < numThreads; ++i)
+    {
+        g_workers.emplace_back(AsyncIOWorker);
+    }
+
+    DiracLog(1, "[Platform] async IO threads: %u", numThreads);
+    return true;
+}
+
+void ShutdownAsyncIO()
+{
+    {
+        std::lock_guard<std::mutex> lock(g_asyncMutex);
+        g_bStopWorkers = true;
+    }
+
+    g_jobCondition.notify_all();
+    for (std::thread& worker : g_workers)
+    {
+        worker.join();
+    }
+
+    g_workers.clear();
+
+    std::lock_guard<std::mutex> lock(g_asyncMutex);
+    assert(g_jobs.empty());
+    g_batches.clear();
+    g_completedHandles.clear();
+}
+
+TAsyncReadHandle SubmitAsyncRead(
+    const char* fileNames[],
+    size_t numFiles,
+    EFileType fileType,
+    SFile* pOutFiles,
+    TAsyncReadCallback callback,
+    void* pUserData)
+{
+    assert(fileNames != nullptr);
+    assert(numFiles > 0);
+    assert(pOutFiles != nullptr);
+
+    std::vector<SAsyncReadJob> synchronousJobs;
+    TAsyncReadHandle handle = kInvalidAsyncReadHandle;
+    {
+        std::lock_guard<std::mutex> lock(g_asyncMutex);
+        do
+        {
+            handle = ++g_nextHandle;
+        } while (handle == kInvalidAsyncReadHandle || g_batches.count(handle) > 0);
+
+        SAsyncReadBatch& batch = g_batches[handle];
+        batch.callback = callback;
+        batch.pUserData = pUserData;
+        batch.numPending = numFiles;
+
+        const bool bSynchronous = g_workers.empty() || g_bStopWorkers;
+        for (size_t i = 0; i < numFiles; ++i)
+        {
+            assert(fileNames[i] && fileNames[i][0] != 0);
+            SAsyncReadJob job;
+            job.handle = handle;
+            job.fileName = fileNames[i];
+            job.fileType = fileType;
+            job.pOutFile = &pOutFiles[i];
+            if (bSynchronous)
+            {
+                synchronousJobs.push_back(std::move(job));
+            }
+            else
+            {
+                g_jobs.push_back(std::move(job));
+            }
+        }
+    }
+
+    if (synchronousJobs.empty())
+    {
+        g_jobCondition.notify_all();
+    }
+
+    for (SAsyncReadJob& job : synchronousJobs)
+    {
+        RunAsyncReadJob(job);
+    }
+
+    return handle;
+}
+
+EAsyncReadStatus GetAsyncReadStatus(TAsyncReadHandle handle)
+{
+    std::lock_guard<std::mutex> lock(g_asyncMutex);
+    auto it = g_batches.find(handle);
+    return it != g_batches.end() ? it->second.status : EAsyncReadStatus::Invalid;
+}
+
+bool WaitForAsyncRead(TAsyncReadHandle handle)
+{
+    SAsyncReadBatch batch;
+    {
+        std::unique_lock<std::mutex> lock(g_asyncMutex);
+        auto it = g_batches.find(handle);
+        if (it == g_batches.end())
+        {
+            DiracError("[%s] unknown or already dispatched handle: %u", __FUNCTION__, handle);
+            return false;
+        }
+
+        // look the batch up again on wake up, workers never insert but a rehash would invalidate the iterator
+        g_completionCondition.wait(lock, [handle] { return g_batches[handle].status != EAsyncReadStatus::Pending; });
+        it = g_batches.find(handle);
+        batch = it->second;
+        g_batches.erase(it);
+        g_completedHandles.erase(std::find(g_completedHandles.begin(), g_completedHandles.end(), handle));
+    }
+
+    const bool bSuccess = batch.status == EAsyncReadStatus::Complete;
+    if (batch.callback != nullptr)
+    {
+        batch.callback(handle, bSuccess, batch.pUserData);
+    }
+
+    return bSuccess;
+}
+
+size_t DispatchAsyncReadCompletions()
+{
+    std::vector<std::pair<TAsyncReadHandle, SAsyncReadBatch>> completed;
+    {
+        std::lock_guard<std::mutex> lock(g_asyncMutex);
+        completed.reserve(g_completedHandles.size());
+        for (TAsyncReadHandle handle : g_completedHandles)
+        {
+            auto it = g_batches.find(handle);
+            assert(it != g_batches.end());
+            completed.emplace_back(handle, it->second);
+            g_batches.erase(it);
+        }
+
+        g_completedHandles.clear();
+    }
+
+    // outside the lock, callbacks are free to submit more reads
+    for (const auto& completion : completed)
+    {
+        if (completion.second.callback != nullptr)
+        {
+            completion.second.callback(completion.first, completion.second.status == EAsyncReadStatus::Complete, completion.second.pUserData);
+        }
+    }
+
+    return completed.size();
+}
+
+} // platform namespace
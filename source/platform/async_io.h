@@ -0,0 +1,59 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+#include "platform.h"
+
+namespace platform
+{
+
+/////////////////////////////////////////////////////////
+// Async file IO
+//
+// Batches of file reads are split across a small pool of IO threads, every file in a batch is read
+// concurrently through LoadFiles, so pak hits stay zero copy. Finished batches are queued and their
+// callbacks run on the main thread, either from DispatchAsyncReadCompletions (called once per frame by RunIO)
+// or from WaitForAsyncRead when a result is needed immediately.
+// Without IO threads (InitializeAsyncIO(0) or before initialization) batches are read synchronously on submit
+// and still complete through the queue, so callers don't need a separate path.
+
+typedef uint32_t TAsyncReadHandle;
+static constexpr TAsyncReadHandle kInvalidAsyncReadHandle = 0;
+
+enum class EAsyncReadStatus : uint8_t
+{
+    Invalid, // unknown handle, or its completion was already dispatched
+    Pending,
+    Complete,
+    Failed // at least one file in the batch failed to load
+};
+
+const char* ToString(EAsyncReadStatus status);
+
+// Runs on the main thread, the batch's SFiles are filled in before it is called
+typedef void (*TAsyncReadCallback)(TAsyncReadHandle handle, bool bSuccess, void* pUserData);
+
+bool InitializeAsyncIO(uint32_t numThreads);
+void ShutdownAsyncIO(); // waits for queued reads, completions that weren't dispatched are dropped
+
+// File names are copied. pOutFiles must stay alive and untouched until the batch's completion is dispatched.
+TAsyncReadHandle SubmitAsyncRead(
+    const char* fileNames[],
+    size_t numFiles,
+    EFileType fileType,
+    SFile* pOutFiles,
+    TAsyncReadCallback callback = nullptr,
+    void* pUserData = nullptr);
+
+EAsyncReadStatus GetAsyncReadStatus(TAsyncReadHandle handle);
+
+// Blocks until the batch has been read and dispatches its callback, returns false if any file failed
+bool WaitForAsyncRead(TAsyncReadHandle handle);
+
+// Runs callbacks for every finished batch, returns the number dispatched
+size_t DispatchAsyncReadCompletions();
+
+} // platform namespace
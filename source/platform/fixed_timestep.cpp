@@ -0,0 +1,67 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "fixed_timestep.h"
+
+namespace platform
+{
+
+bool SFixedTimestep::Initialize(const SFixedTimestepConfig& config)
+{
+    if (config.ticksPerSecond == 0 || config.maxTicksPerFrame == 0)
+    {
+        DiracError("[FixedTimestep] invalid configuration: %u ticks per second, %u max ticks per frame", config.ticksPerSecond, config.maxTicksPerFrame);
+        return false;
+    }
+
+    m_config = config;
+    m_tickDuration = std::chrono::duration_cast<TTime::duration>(std::chrono::seconds(1)) / config.ticksPerSecond;
+    m_accumulator = TTime::duration::zero();
+    m_stats = SFixedTimestepStats();
+    return true;
+}
+
+uint32_t SFixedTimestep::Advance(TTime::duration frameDuration)
+{
+    assert(m_tickDuration > TTime::duration::zero());
+    ++m_stats.numFrames;
+    m_accumulator += std::max(frameDuration, TTime::duration::zero());
+
+    uint64_t numTicks = uint64_t(m_accumulator / m_tickDuration);
+    if (numTicks > m_config.maxTicksPerFrame)
+    {
+        const TTime::duration dropped = m_tickDuration * (numTicks - m_config.maxTicksPerFrame);
+        m_accumulator -= dropped;
+        m_stats.droppedMs += TMilliseconds(dropped).count();
+        ++m_stats.numClampedFrames;
+        numTicks = m_config.maxTicksPerFrame;
+    }
+
+    m_accumulator -= m_tickDuration * numTicks;
+    m_stats.numTicks += numTicks;
+    if (numTicks == 0)
+    {
+        ++m_stats.numFramesWithoutTicks;
+    }
+
+    return uint32_t(numTicks);
+}
+
+float SFixedTimestep::GetInterpolationAlpha() const
+{
+    if (m_tickDuration <= TTime::duration::zero())
+        return 0.0f;
+
+    return std::min(float(double(m_accumulator.count()) / double(m_tickDuration.count())), 1.0f);
+}
+
+void SFixedTimestep::GetStats(SFixedTimestepStats* pOutStats) const
+{
+    assert(pOutStats != nullptr);
+    *pOutStats = m_stats;
+}
+
+} // platform namespace
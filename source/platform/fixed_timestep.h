@@ -0,0 +1,61 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+namespace platform
+{
+
+/////////////////////////////////////////////////////////
+// Fixed timestep
+//
+// Decouples the simulation rate from the frame rate. Every frame adds its elapsed time to an accumulator and Advance
+// returns how many whole ticks of the fixed tick duration it holds, which may be zero when frames are shorter than a
+// tick. What is left over is the interpolation alpha: the renderer draws the state between the last two ticks, so
+// it trails the simulation by up to one tick but moves smoothly at any frame rate.
+//
+// When a frame holds more than maxTicksPerFrame ticks the excess time is dropped rather than simulated, otherwise a
+// slow tick makes the next frame longer, which asks for more ticks, and the loop never recovers (spiral of death).
+
+static constexpr uint32_t kDefaultSimulationRate = 60; // ticks per second
+static constexpr uint32_t kDefaultMaxTicksPerFrame = 4;
+
+struct SFixedTimestepConfig
+{
+    uint32_t ticksPerSecond = kDefaultSimulationRate;
+    uint32_t maxTicksPerFrame = kDefaultMaxTicksPerFrame;
+};
+
+struct SFixedTimestepStats
+{
+    uint64_t numFrames = 0;
+    uint64_t numTicks = 0;
+    uint64_t numFramesWithoutTicks = 0;
+    uint64_t numClampedFrames = 0;
+    double droppedMs = 0.0; // simulation time lost to the clamp
+};
+
+struct SFixedTimestep
+{
+    bool Initialize(const SFixedTimestepConfig& config);
+
+    // Adds a frame's elapsed time, returns the number of ticks to simulate this frame
+    uint32_t Advance(TTime::duration frameDuration);
+
+    TTime::duration GetTickDuration() const { return m_tickDuration; }
+    TSeconds GetTickSeconds() const { return TSeconds(m_tickDuration); }
+    float GetInterpolationAlpha() const; // [0, 1) from the previous tick's state to the latest one
+    uint64_t GetTickCount() const { return m_stats.numTicks; }
+
+    void GetStats(SFixedTimestepStats* pOutStats) const;
+
+private:
+    SFixedTimestepConfig m_config;
+    TTime::duration m_tickDuration = TTime::duration::zero();
+    TTime::duration m_accumulator = TTime::duration::zero();
+    SFixedTimestepStats m_stats;
+};
+
+} // platform namespace
@@ -0,0 +1,124 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "frame_pacer.h"
+
+#if defined(__linux__)
+#include <cerrno>
+#include <ctime>
+#else
+#include <thread>
+#endif
+
+#include "sync/futex.h"
+
+namespace platform
+{
+
+const char* ToString(EFrameSkipPolicy policy)
+{
+    switch (policy)
+    {
+    case EFrameSkipPolicy::Never: return "Never";
+    case EFrameSkipPolicy::SkipRender: return "SkipRender";
+    default: return "Unknown";
+    }
+}
+
+static void SleepUntil(TTime deadline)
+{
+#if defined(__linux__)
+    // steady_clock is CLOCK_MONOTONIC on Linux, so its time points are valid absolute deadlines
+    const std::chrono::nanoseconds sinceEpoch = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch());
+    timespec deadlineSpec;
+    deadlineSpec.tv_sec = (time_t)(sinceEpoch.count() / 1000000000);
+    deadlineSpec.tv_nsec = (long)(sinceEpoch.count() % 1000000000);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadlineSpec, nullptr) == EINTR)
+    {
+    }
+#else
+    std::this_thread::sleep_until(deadline);
+#endif
+}
+
+bool SFramePacer::Initialize(const SFramePacerConfig& config, TTime now)
+{
+    if (config.targetFrameDuration <= TTime::duration::zero() || config.spinThreshold < TTime::duration::zero())
+    {
+        DiracError("[FramePacer] invalid target frame duration %.3f ms", TMilliseconds(config.targetFrameDuration).count());
+        return false;
+    }
+
+    m_config = config;
+    m_deadline = now + config.targetFrameDuration;
+    m_bSkipRender = false;
+    m_consecutiveSkips = 0;
+    m_stats = SFramePacerStats();
+    m_numPacedFrames = 0;
+    m_totalJitter = TSeconds(0);
+    return true;
+}
+
+TTime SFramePacer::WaitForNextFrame()
+{
+    ++m_stats.numFrames;
+    TTime now = TSteadyClock::now();
+    bool bRephased = false;
+    if (now < m_deadline)
+    {
+        const TTime sleepEnd = m_deadline - m_config.spinThreshold;
+        if (now < sleepEnd)
+        {
+            SleepUntil(sleepEnd);
+            const TTime wakeTime = TSteadyClock::now();
+            m_stats.sleptMs += TMilliseconds(wakeTime - now).count();
+            now = wakeTime;
+        }
+
+        const TTime spinStart = now;
+        while (now < m_deadline)
+        {
+            synchronization::CpuPause();
+            now = TSteadyClock::now();
+        }
+
+        m_stats.spunMs += TMilliseconds(now - spinStart).count();
+
+        const TSeconds jitter = now - m_deadline;
+        m_totalJitter += jitter;
+        m_stats.maxJitterUs = std::max(m_stats.maxJitterUs, std::chrono::duration<double, std::micro>(jitter).count());
+        ++m_numPacedFrames;
+        m_deadline += m_config.targetFrameDuration;
+    }
+    else
+    {
+        ++m_stats.numMissedDeadlines;
+        if (now - m_deadline >= m_config.targetFrameDuration)
+        { // more than a frame behind, start a new phase rather than running frames back to back to catch up
+            ++m_stats.numRephases;
+            bRephased = true;
+            m_deadline = now + m_config.targetFrameDuration;
+        }
+        else
+        {
+            m_deadline += m_config.targetFrameDuration;
+        }
+    }
+
+    m_bSkipRender = bRephased && m_config.skipPolicy == EFrameSkipPolicy::SkipRender && m_consecutiveSkips < m_config.maxConsecutiveSkips;
+    m_consecutiveSkips = m_bSkipRender ? m_consecutiveSkips + 1 : 0;
+    m_stats.numSkippedRenders += m_bSkipRender ? 1 : 0;
+    return now;
+}
+
+void SFramePacer::GetStats(SFramePacerStats* pOutStats) const
+{
+    assert(pOutStats != nullptr);
+    *pOutStats = m_stats;
+    pOutStats->averageJitterUs = m_numPacedFrames > 0 ? std::chrono::duration<double, std::micro>(m_totalJitter).count() / (double)m_numPacedFrames : 0.0;
+}
+
+} // platform namespace
@@ -0,0 +1,79 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+namespace platform
+{
+
+/////////////////////////////////////////////////////////
+// Frame pacer
+//
+// Holds the main loop to a fixed frame period without burning a core. WaitForNextFrame sleeps on an absolute
+// deadline (clock_nanosleep on Linux) until spinThreshold before it and only spins the rest, which absorbs the
+// sleep's wake up latency. A frame finishing after its deadline is a miss: up to a frame late the phase is kept and
+// the next frame simply starts immediately, more than a frame late the deadlines are re-phased to now so the loop
+// never runs a burst of unpaced frames to catch up. With EFrameSkipPolicy::SkipRender the frame after a re-phase is
+// simulated but not rendered, to shed load until the loop keeps up again.
+
+#if defined(_WIN32)
+static constexpr std::chrono::microseconds kDefaultPacerSpinThreshold = std::chrono::microseconds(2000); // Sleep is only accurate to ~1 ms
+#else
+static constexpr std::chrono::microseconds kDefaultPacerSpinThreshold = std::chrono::microseconds(500);
+#endif
+
+enum class EFrameSkipPolicy : uint8_t
+{
+    Never,
+    SkipRender,
+    COUNT
+};
+
+const char* ToString(EFrameSkipPolicy policy);
+
+struct SFramePacerConfig
+{
+    TTime::duration targetFrameDuration = std::chrono::milliseconds(8);
+    TTime::duration spinThreshold = kDefaultPacerSpinThreshold;
+    EFrameSkipPolicy skipPolicy = EFrameSkipPolicy::Never;
+    uint32_t maxConsecutiveSkips = 2; // frames in a row that may skip rendering before one is rendered regardless
+};
+
+struct SFramePacerStats
+{
+    uint64_t numFrames = 0;
+    uint64_t numMissedDeadlines = 0;
+    uint64_t numRephases = 0;
+    uint64_t numSkippedRenders = 0;
+    double sleptMs = 0.0; // CPU time saved over spinning the whole wait
+    double spunMs = 0.0;
+    double averageJitterUs = 0.0; // how far frames started from their deadline, missed deadlines excluded
+    double maxJitterUs = 0.0;
+};
+
+struct SFramePacer
+{
+    bool Initialize(const SFramePacerConfig& config, TTime now);
+
+    // Call once at the end of every frame, returns the time the next frame starts
+    TTime WaitForNextFrame();
+
+    // Whether the frame that WaitForNextFrame just released should skip rendering
+    bool ShouldSkipRender() const { return m_bSkipRender; }
+
+    void GetStats(SFramePacerStats* pOutStats) const;
+
+private:
+    SFramePacerConfig m_config;
+    TTime m_deadline;
+    bool m_bSkipRender = false;
+    uint32_t m_consecutiveSkips = 0;
+
+    SFramePacerStats m_stats;
+    uint64_t m_numPacedFrames = 0; // frames that waited for their deadline, the jitter average's denominator
+    TSeconds m_totalJitter = TSeconds(0);
+};
+
+} // platform namespace
@@ -0,0 +1,118 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "frame_pipeline.h"
+
+namespace platform
+{
+
+bool SFramePipeline::Initialize(uint32_t depth)
+{
+    assert(m_depth == 0 && "frame pipeline initialized twice");
+    if (depth == 0 || depth > kMaxFramePipelineDepth)
+    {
+        DiracError("[FramePipeline] depth %u out of range [1, %u]", depth, kMaxFramePipelineDepth);
+        return false;
+    }
+
+    m_depth = depth;
+    m_freeSlots.Release(depth);
+    return true;
+}
+
+uint32_t SFramePipeline::BeginSimulation()
+{
+    assert(m_depth > 0);
+    if (!m_freeSlots.TryAcquire())
+    {
+        const TTime waitStartTime = TSteadyClock::now();
+        m_freeSlots.Acquire();
+        m_simulationWait += TSteadyClock::now() - waitStartTime;
+    }
+
+    const uint32_t slot = m_nextSimulationSlot;
+    m_nextSimulationSlot = (m_nextSimulationSlot + 1) % m_depth;
+    return slot;
+}
+
+void SFramePipeline::EndSimulation(uint32_t slot, TTime inputTime)
+{
+    assert(slot < m_depth);
+    m_inputTimes[slot] = inputTime;
+    m_numPublished.fetch_add(1, std::memory_order_relaxed); // the release below orders it and the slot
+    m_publishedSlots.Release();
+}
+
+bool SFramePipeline::BeginRender(uint32_t* pOutSlot)
+{
+    assert(pOutSlot != nullptr);
+    assert(m_depth > 0);
+    if (!m_publishedSlots.TryAcquire())
+    {
+        const TTime waitStartTime = TSteadyClock::now();
+        m_publishedSlots.Acquire();
+        m_renderWait += TSteadyClock::now() - waitStartTime;
+    }
+
+    // Stop releases once more after the last publish, taking it means there is nothing left to render
+    if (m_numTaken == m_numPublished.load(std::memory_order_relaxed))
+    {
+        assert(m_bStopping.load());
+        return false;
+    }
+
+    ++m_numTaken;
+    *pOutSlot = m_nextRenderSlot;
+    m_nextRenderSlot = (m_nextRenderSlot + 1) % m_depth;
+    return true;
+}
+
+void SFramePipeline::EndRender(uint32_t slot)
+{
+    assert(slot < m_depth);
+    const TTime endTime = TSteadyClock::now();
+    const TSeconds latency = endTime - m_inputTimes[slot];
+    m_totalLatency += latency;
+    m_maxLatency = std::max(m_maxLatency, latency);
+    if (m_numRendered == 0)
+    {
+        m_firstRenderEndTime = endTime;
+    }
+
+    m_lastRenderEndTime = endTime;
+    ++m_numRendered;
+    m_freeSlots.Release();
+}
+
+void SFramePipeline::Stop()
+{
+    m_bStopping = true;
+    m_publishedSlots.Release();
+}
+
+void SFramePipeline::GetStats(SFramePipelineStats* pOutStats) const
+{
+    assert(pOutStats != nullptr);
+    *pOutStats = SFramePipelineStats();
+    pOutStats->depth = m_depth;
+    pOutStats->framesRendered = m_numRendered;
+    if (m_numRendered == 0)
+        return;
+
+    const TSeconds renderSpan = m_lastRenderEndTime - m_firstRenderEndTime;
+    if (m_numRendered > 1 && renderSpan.count() > 0)
+    {
+        pOutStats->framesPerSecond = double(m_numRendered - 1) / renderSpan.count();
+    }
+
+    const double frames = double(m_numRendered);
+    pOutStats->averageLatencyMs = TMilliseconds(m_totalLatency).count() / frames;
+    pOutStats->maxLatencyMs = TMilliseconds(m_maxLatency).count();
+    pOutStats->averageSimulationWaitMs = TMilliseconds(m_simulationWait).count() / frames;
+    pOutStats->averageRenderWaitMs = TMilliseconds(m_renderWait).count() / frames;
+}
+
+} // platform namespace
@@ -0,0 +1,83 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+#include "sync/event.h"
+
+namespace platform
+{
+
+/////////////////////////////////////////////////////////
+// Frame pipeline
+//
+// Hands frames from the simulation thread to the render thread through a ring of depth snapshot slots. The
+// simulation claims a free slot (BeginSimulation), fills it and publishes it (EndSimulation), the render thread
+// takes published slots in order (BeginRender) and frees them once submitted (EndRender). The pipeline only deals in
+// slot indices, the caller owns the snapshot storage.
+//
+// Depth bounds the frames between input sampling and submission: 1 is the sequential loop, 2 simulates frame N+1
+// while frame N is submitted, 3 lets the simulation run another frame ahead at the cost of another frame of latency.
+// Latency is measured from the time passed to EndSimulation (when input was sampled) to EndRender.
+
+static constexpr uint32_t kMaxFramePipelineDepth = 3;
+
+struct SFramePipelineStats
+{
+    uint32_t depth = 0;
+    uint64_t framesRendered = 0;
+    double framesPerSecond = 0; // between the first and last EndRender
+    double averageLatencyMs = 0;
+    double maxLatencyMs = 0;
+    double averageSimulationWaitMs = 0; // per frame, BeginSimulation blocked on a free slot
+    double averageRenderWaitMs = 0; // per frame, BeginRender blocked on a published slot
+};
+
+struct SFramePipeline
+{
+    SFramePipeline() = default;
+    SFramePipeline(const SFramePipeline&) = delete;
+    SFramePipeline& operator=(const SFramePipeline&) = delete;
+
+    bool Initialize(uint32_t depth); // once, before either side starts
+    uint32_t GetDepth() const { return m_depth; }
+
+    // Simulation side, one thread
+    uint32_t BeginSimulation(); // blocks until a slot is free
+    void EndSimulation(uint32_t slot, TTime inputTime);
+
+    // Render side, one thread. Returns false once Stop was called and every published frame has been taken.
+    bool BeginRender(uint32_t* pOutSlot);
+    void EndRender(uint32_t slot);
+
+    void Stop(); // wakes the render thread, call from the simulation thread after its last EndSimulation
+
+    // Only exact once both sides are idle, e.g. after the render thread has been joined
+    void GetStats(SFramePipelineStats* pOutStats) const;
+
+private:
+    synchronization::SSemaphore m_freeSlots;
+    synchronization::SSemaphore m_publishedSlots;
+    std::atomic<uint64_t> m_numPublished = { 0 };
+    std::atomic<bool> m_bStopping = { false };
+    TTime m_inputTimes[kMaxFramePipelineDepth];
+    uint32_t m_depth = 0;
+
+    // simulation thread
+    uint32_t m_nextSimulationSlot = 0;
+    TSeconds m_simulationWait = TSeconds(0);
+
+    // render thread
+    uint32_t m_nextRenderSlot = 0;
+    uint64_t m_numTaken = 0;
+    uint64_t m_numRendered = 0;
+    TSeconds m_renderWait = TSeconds(0);
+    TSeconds m_totalLatency = TSeconds(0);
+    TSeconds m_maxLatency = TSeconds(0);
+    TTime m_firstRenderEndTime;
+    TTime m_lastRenderEndTime;
+};
+
+} // platform namespace
@@ -0,0 +1,169 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "input.h"
+
+namespace platform
+{
+
+/////////////////////////////////////////////////////////
+// SActionMapStack
+
+TActionMapId SActionMapStack::Push(TActionMap&& actionMap)
+{
+    TActionMapId id = m_idAllocator++;
+    m_maps.emplace_back(id, std::move(actionMap));
+    Compile();
+    return id;
+}
+
+void SActionMapStack::Remove(TActionMapId id)
+{
+    assert(m_maps.empty() == false);
+    for (auto it = m_maps.begin(); it != m_maps.end(); ++it)
+    {
+        if (it->first == id)
+        {
+            m_maps.erase(it);
+            Compile();
+            return;
+        }
+    }
+
+    assert(false && "RemoveActionMap failed to find id!");
+}
+
+const SActionHandler* SActionMapStack::Find(TKeyCode keyCode, TKeyMod keyMod) const
+{
+    const auto it = m_keyHandlers.find(keyCode);
+    if (it == m_keyHandlers.end())
+        return nullptr;
+
+    const SActionHandler* pHandlers = m_compiledHandlers.data() + it->second.first;
+    for (uint32_t i = 0; i < it->second.count; ++i)
+    {
+        if (pHandlers[i].requiredKeyMods == 0 || pHandlers[i].requiredKeyMods == keyMod)
+            return &pHandlers[i];
+    }
+
+    return nullptr;
+}
+
+void SActionMapStack::Compile()
+{
+    // Gather every binding in priority order, top map first and declaration order within a map
+    std::vector<const SActionHandler*> prioritized;
+    for (auto mapIt = m_maps.rbegin(); mapIt != m_maps.rend(); ++mapIt)
+    {
+        for (const SActionHandler& handler : mapIt->second)
+        {
+            assert(handler.callback != nullptr);
+            prioritized.push_back(&handler);
+        }
+    }
+
+    // Group by key keeping that order, then drop the bindings no event can reach
+    std::stable_sort(prioritized.begin(), prioritized.end(), [](const SActionHandler* pLhs, const SActionHandler* pRhs)
+    {
+        return pLhs->keyCode < pRhs->keyCode;
+    });
+
+    m_keyHandlers.clear();
+    m_compiledHandlers.clear();
+    m_compiledHandlers.reserve(prioritized.size());
+    size_t keyBegin = 0;
+    while (keyBegin < prioritized.size())
+    {
+        const TKeyCode keyCode = prioritized[keyBegin]->keyCode;
+        SKeyHandlers keyHandlers;
+        keyHandlers.first = (uint32_t)m_compiledHandlers.size();
+
+        size_t keyEnd = keyBegin;
+        bool bShadowed = false;
+        for (; keyEnd < prioritized.size() && prioritized[keyEnd]->keyCode == keyCode; ++keyEnd)
+        {
+            const SActionHandler& handler = *prioritized[keyEnd];
+            if (bShadowed)
+                continue;
+
+            bool bModsClaimed = false;
+            for (uint32_t i = keyHandlers.first; i < m_compiledHandlers.size(); ++i)
+            {
+                bModsClaimed |= m_compiledHandlers[i].requiredKeyMods == handler.requiredKeyMods;
+            }
+
+            if (!bModsClaimed)
+            {
+                m_compiledHandlers.push_back(handler);
+                bShadowed = handler.requiredKeyMods == 0; // matches every event for this key
+            }
+        }
+
+        keyHandlers.count = (uint32_t)m_compiledHandlers.size() - keyHandlers.first;
+        m_keyHandlers.emplace(keyCode, keyHandlers);
+        keyBegin = keyEnd;
+    }
+}
+
+/////////////////////////////////////////////////////////
+// SInputState
+
+void SInputState::BeginFrame()
+{
+    m_keyEvents.clear();
+    m_mouseRelX = 0;
+    m_mouseRelY = 0;
+}
+
+void SInputState::AddKeyEvent(TKeyCode keyCode, TKeyMod keyMod, EKeyChange keyChange)
+{
+    m_keyEvents.push_back({ keyCode, keyMod, keyChange });
+
+    const auto heldIt = std::find(m_heldKeys.begin(), m_heldKeys.end(), keyCode);
+    if (keyChange == EKeyChange::Pressed && heldIt == m_heldKeys.end())
+    {
+        m_heldKeys.push_back(keyCode);
+    }
+    else if (keyChange == EKeyChange::Released && heldIt != m_heldKeys.end())
+    {
+        m_heldKeys.erase(heldIt);
+    }
+}
+
+void SInputState::SetMouse(int32_t mouseRelX, int32_t mouseRelY, uint32_t mouseButtons)
+{
+    m_mouseRelX = mouseRelX;
+    m_mouseRelY = mouseRelY;
+    m_mouseButtons = mouseButtons;
+}
+
+bool SInputState::IsKeyDown(TKeyCode keyCode) const
+{
+    return std::find(m_heldKeys.begin(), m_heldKeys.end(), keyCode) != m_heldKeys.end();
+}
+
+bool SInputState::WasKeyPressed(TKeyCode keyCode) const
+{
+    return HasKeyEvent(keyCode, EKeyChange::Pressed);
+}
+
+bool SInputState::WasKeyReleased(TKeyCode keyCode) const
+{
+    return HasKeyEvent(keyCode, EKeyChange::Released);
+}
+
+bool SInputState::HasKeyEvent(TKeyCode keyCode, EKeyChange keyChange) const
+{
+    for (const SInputKeyEvent& keyEvent : m_keyEvents)
+    {
+        if (keyEvent.keyCode == keyCode && keyEvent.keyChange == keyChange)
+            return true;
+    }
+
+    return false;
+}
+
+} // platform namespace
@@ -0,0 +1,106 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+namespace platform
+{
+
+enum class EKeyChange
+{
+    Pressed,
+    Released
+};
+
+typedef int32_t TKeyCode;
+typedef uint16_t TKeyMod;
+
+struct SActionHandler
+{
+    TKeyCode keyCode = { 0 };
+    TKeyMod requiredKeyMods = { 0 };
+    void (*callback)(TKeyCode keyCode, TKeyMod keyMod, EKeyChange keyChange);
+};
+
+typedef std::vector<SActionHandler> TActionMap;
+typedef uint8_t TActionMapId;
+
+/////////////////////////////////////////////////////////
+// Action map stack
+//
+// A key event goes to the first handler of the topmost map whose keyCode matches and whose requiredKeyMods are 0
+// (any) or exactly the event's mods. Rather than walking every map per event, Push and Remove compile the stack
+// into a table keyed by keyCode that holds only the handlers that can still win: those of a key in priority order,
+// cut off after the first one that takes any mods and without mods already claimed by a handler above. Find is a
+// hash lookup plus a scan over the few mod combinations bound to that key.
+
+struct SActionMapStack
+{
+    TActionMapId Push(TActionMap&& actionMap);
+    void Remove(TActionMapId id);
+
+    const SActionHandler* Find(TKeyCode keyCode, TKeyMod keyMod) const; // nullptr when nothing is bound
+
+    size_t GetMapCount() const { return m_maps.size(); }
+    size_t GetCompiledHandlerCount() const { return m_compiledHandlers.size(); }
+
+private:
+    struct SKeyHandlers
+    {
+        uint32_t first = 0; // into m_compiledHandlers
+        uint32_t count = 0;
+    };
+
+    void Compile();
+
+    std::vector<std::pair<TActionMapId, TActionMap>> m_maps; // bottom to top
+    TActionMapId m_idAllocator = 0;
+
+    std::unordered_map<TKeyCode, SKeyHandlers> m_keyHandlers;
+    std::vector<SActionHandler> m_compiledHandlers; // grouped by key, in priority order
+};
+
+/////////////////////////////////////////////////////////
+// Input state
+//
+// Everything RunIO gathered for the frame, for game code that polls rather than registering callbacks. Key events
+// are kept in the order they arrived, held keys carry over between frames.
+
+struct SInputKeyEvent
+{
+    TKeyCode keyCode = 0;
+    TKeyMod keyMod = 0;
+    EKeyChange keyChange = EKeyChange::Pressed;
+};
+
+struct SInputState
+{
+    void BeginFrame(); // forgets the previous frame's events
+    void AddKeyEvent(TKeyCode keyCode, TKeyMod keyMod, EKeyChange keyChange);
+    void SetMouse(int32_t mouseRelX, int32_t mouseRelY, uint32_t mouseButtons);
+
+    bool IsKeyDown(TKeyCode keyCode) const;
+    bool WasKeyPressed(TKeyCode keyCode) const; // this frame, including key repeats
+    bool WasKeyReleased(TKeyCode keyCode) const; // this frame
+
+    const std::vector<SInputKeyEvent>& GetKeyEvents() const { return m_keyEvents; }
+    int32_t GetMouseRelX() const { return m_mouseRelX; }
+    int32_t GetMouseRelY() const { return m_mouseRelY; }
+    uint32_t GetMouseButtons() const { return m_mouseButtons; }
+
+private:
+    bool HasKeyEvent(TKeyCode keyCode, EKeyChange keyChange) const;
+
+    std::vector<SInputKeyEvent> m_keyEvents;
+    std::vector<TKeyCode> m_heldKeys; // only a handful are ever held at once
+    int32_t m_mouseRelX = 0;
+    int32_t m_mouseRelY = 0;
+    uint32_t m_mouseButtons = 0;
+};
+
+} // platform namespace
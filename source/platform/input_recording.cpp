@@ -0,0 +1,197 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "input_recording.h"
+
+#include <cstddef>
+
+namespace platform
+{
+
+const char* ToString(EInputEventType type)
+{
+    switch (type)
+    {
+    case EInputEventType::KeyDown: return "KeyDown";
+    case EInputEventType::KeyUp: return "KeyUp";
+    case EInputEventType::Quit: return "Quit";
+    default: return "Unknown";
+    }
+}
+
+/////////////////////////////////////////////////////////
+// SInputRecorder
+
+bool SInputRecorder::Open(const char* fileName, TTime::duration frameDuration)
+{
+    assert(fileName != nullptr);
+    Close();
+
+    m_pFile = fopen(fileName, "wb");
+    if (m_pFile == nullptr)
+    {
+        DiracError("[Input] failed to open %s for recording", fileName);
+        return false;
+    }
+
+    SInputRecordingHeader header;
+    header.magic = kInputRecordingMagic;
+    header.version = kInputRecordingVersion;
+    header.frameDurationNs = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(frameDuration).count();
+    m_events.clear();
+    m_frameCount = 0;
+    m_bWriteFailed = fwrite(&header, sizeof(header), 1, m_pFile) != 1;
+    return !m_bWriteFailed;
+}
+
+void SInputRecorder::AddEvent(const SInputEventRecord& event)
+{
+    if (m_pFile != nullptr && m_events.size() < UINT16_MAX)
+    {
+        m_events.push_back(event);
+    }
+}
+
+void SInputRecorder::EndFrame(TTime::duration frameDuration, int32_t mouseRelX, int32_t mouseRelY, uint32_t mouseButtons)
+{
+    if (m_pFile == nullptr)
+        return;
+
+    SInputFrameRecord frame;
+    frame.frameDurationNs = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(frameDuration).count();
+    frame.mouseRelX = mouseRelX;
+    frame.mouseRelY = mouseRelY;
+    frame.mouseButtons = mouseButtons;
+    frame.numEvents = (uint16_t)m_events.size();
+    if (fwrite(&frame, sizeof(frame), 1, m_pFile) != 1 ||
+        (!m_events.empty() && fwrite(m_events.data(), sizeof(SInputEventRecord), m_events.size(), m_pFile) != m_events.size()))
+    {
+        m_bWriteFailed = true;
+    }
+
+    m_events.clear();
+    ++m_frameCount;
+}
+
+bool SInputRecorder::Close()
+{
+    if (m_pFile == nullptr)
+        return true;
+
+    // Patch the frame count now that the recording is complete
+    const size_t frameCountOffset = offsetof(SInputRecordingHeader, frameCount);
+    if (fseek(m_pFile, (long)frameCountOffset, SEEK_SET) != 0 || fwrite(&m_frameCount, sizeof(m_frameCount), 1, m_pFile) != 1)
+    {
+        m_bWriteFailed = true;
+    }
+
+    m_bWriteFailed |= fclose(m_pFile) != 0;
+    m_pFile = nullptr;
+    if (m_bWriteFailed)
+    {
+        DiracError("[Input] failed writing the recording, %u frames", m_frameCount);
+    }
+
+    return !m_bWriteFailed;
+}
+
+/////////////////////////////////////////////////////////
+// SInputPlayer
+
+bool SInputPlayer::Open(const char* fileName)
+{
+    assert(fileName != nullptr);
+    *this = SInputPlayer();
+
+    FILE* pFile = fopen(fileName, "rb");
+    if (pFile == nullptr)
+    {
+        DiracError("[Input] failed to open recording %s", fileName);
+        return false;
+    }
+
+    uint8_t buffer[4096];
+    size_t bytesRead = 0;
+    while ((bytesRead = fread(buffer, 1, sizeof(buffer), pFile)) > 0)
+    {
+        m_data.insert(m_data.end(), buffer, buffer + bytesRead);
+    }
+
+    fclose(pFile);
+
+    SInputRecordingHeader header;
+    if (m_data.size() < sizeof(header))
+    {
+        DiracError("[Input] %s is too small to be a recording", fileName);
+        return false;
+    }
+
+    memcpy(&header, m_data.data(), sizeof(header));
+    if (header.magic != kInputRecordingMagic || header.version != kInputRecordingVersion || header.frameDurationNs == 0)
+    {
+        DiracError("[Input] %s is not a version %u recording", fileName, kInputRecordingVersion);
+        return false;
+    }
+
+    // Count complete frames, a recording that wasn't closed ends at its last complete frame
+    uint32_t frameCount = 0;
+    size_t offset = sizeof(header);
+    while (offset + sizeof(SInputFrameRecord) <= m_data.size())
+    {
+        SInputFrameRecord frame;
+        memcpy(&frame, m_data.data() + offset, sizeof(frame));
+        const size_t frameSize = sizeof(frame) + sizeof(SInputEventRecord) * frame.numEvents;
+        if (offset + frameSize > m_data.size())
+            break;
+
+        offset += frameSize;
+        ++frameCount;
+    }
+
+    if (header.frameCount != 0 && header.frameCount != frameCount)
+    {
+        DiracError("[Input] %s holds %u of its %u frames", fileName, frameCount, header.frameCount);
+        return false;
+    }
+
+    m_readOffset = sizeof(header);
+    m_frameDuration = std::chrono::duration_cast<TTime::duration>(std::chrono::nanoseconds(header.frameDurationNs));
+    m_frameCount = frameCount;
+    m_bOpen = true;
+    return true;
+}
+
+bool SInputPlayer::NextFrame(SInputFrameRecord* pOutFrame, std::vector<SInputEventRecord>* pOutEvents)
+{
+    assert(pOutFrame != nullptr && pOutEvents != nullptr);
+    if (!m_bOpen || m_frameIndex >= m_frameCount)
+        return false;
+
+    // Open validated every frame up to m_frameCount
+    memcpy(pOutFrame, m_data.data() + m_readOffset, sizeof(SInputFrameRecord));
+    m_readOffset += sizeof(SInputFrameRecord);
+    pOutEvents->resize(pOutFrame->numEvents);
+    if (pOutFrame->numEvents > 0)
+    {
+        memcpy(pOutEvents->data(), m_data.data() + m_readOffset, sizeof(SInputEventRecord) * pOutFrame->numEvents);
+        m_readOffset += sizeof(SInputEventRecord) * pOutFrame->numEvents;
+    }
+
+    ++m_frameIndex;
+    return true;
+}
+
+TTime::duration SInputPlayer::GetNextFrameDuration() const
+{
+    if (!m_bOpen || m_frameIndex >= m_frameCount)
+        return m_frameDuration;
+
+    SInputFrameRecord frame;
+    memcpy(&frame, m_data.data() + m_readOffset, sizeof(frame));
+    return std::chrono::duration_cast<TTime::duration>(std::chrono::nanoseconds(frame.frameDurationNs));
+}
+
+} // platform namespace
@@ -0,0 +1,116 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+namespace platform
+{
+
+/////////////////////////////////////////////////////////
+// Input recording
+//
+// Captures everything RunIO feeds the game so a play session can be replayed exactly, e.g. for repeatable
+// benchmark runs. Each replayed frame advances by the duration recorded for it, so with the same build and data the
+// simulation sees the same input on the same frame with the same time steps, hitches included.
+//
+// On disk layout (little endian):
+//   SInputRecordingHeader
+//   per frame: SInputFrameRecord followed by SInputEventRecord[numEvents]
+//
+// Frames are appended as they end and the header's frame count is only written on close, so a recording cut short
+// by a crash still replays up to its last complete frame.
+
+static constexpr uint32_t kInputRecordingMagic = 0x52495344; // "DSIR"
+static constexpr uint32_t kInputRecordingVersion = 2;
+
+enum class EInputEventType : uint8_t
+{
+    KeyDown,
+    KeyUp,
+    Quit,
+    COUNT
+};
+
+const char* ToString(EInputEventType type);
+
+struct SInputRecordingHeader
+{
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    uint32_t frameCount = 0; // 0 when the recording wasn't closed
+    uint32_t reserved = 0;
+    uint64_t frameDurationNs = 0; // target frame duration, paces the replay
+};
+
+struct SInputFrameRecord
+{
+    uint64_t frameDurationNs = 0; // SFrameContext::lastFrameDuration of the frame
+    int32_t mouseRelX = 0; // relative mouse motion over the frame in pixels
+    int32_t mouseRelY = 0;
+    uint32_t mouseButtons = 0;
+    uint16_t numEvents = 0;
+    uint16_t reserved = 0;
+};
+
+struct SInputEventRecord
+{
+    uint32_t timeMs = 0; // since the recording started
+    int32_t keyCode = 0; // TKeyCode
+    uint16_t keyMod = 0; // TKeyMod
+    EInputEventType type = EInputEventType::COUNT;
+    uint8_t reserved = 0;
+};
+
+static_assert(sizeof(SInputRecordingHeader) == 24 && sizeof(SInputFrameRecord) == 24 && sizeof(SInputEventRecord) == 12, "input recordings are a fixed layout");
+
+struct SInputRecorder
+{
+    SInputRecorder() = default;
+    SInputRecorder(const SInputRecorder&) = delete;
+    SInputRecorder& operator=(const SInputRecorder&) = delete;
+    ~SInputRecorder() { Close(); }
+
+    bool Open(const char* fileName, TTime::duration frameDuration);
+    bool IsRecording() const { return m_pFile != nullptr; }
+
+    void AddEvent(const SInputEventRecord& event); // to the current frame
+    void EndFrame(TTime::duration frameDuration, int32_t mouseRelX, int32_t mouseRelY, uint32_t mouseButtons); // writes the current frame
+    bool Close(); // false if any write failed
+
+    uint32_t GetFrameCount() const { return m_frameCount; }
+
+private:
+    FILE* m_pFile = nullptr;
+    std::vector<SInputEventRecord> m_events;
+    uint32_t m_frameCount = 0;
+    bool m_bWriteFailed = false;
+};
+
+struct SInputPlayer
+{
+    bool Open(const char* fileName); // reads and validates the whole recording
+    bool IsReplaying() const { return m_bOpen; }
+
+    // False once every frame has been replayed
+    bool NextFrame(SInputFrameRecord* pOutFrame, std::vector<SInputEventRecord>* pOutEvents);
+
+    TTime::duration GetFrameDuration() const { return m_frameDuration; }
+    TTime::duration GetNextFrameDuration() const; // recorded duration of the frame NextFrame returns next, GetFrameDuration once done
+    uint32_t GetFrameCount() const { return m_frameCount; }
+    uint32_t GetFrameIndex() const { return m_frameIndex; }
+
+private:
+    std::vector<uint8_t> m_data;
+    size_t m_readOffset = 0;
+    TTime::duration m_frameDuration = TTime::duration::zero();
+    uint32_t m_frameCount = 0;
+    uint32_t m_frameIndex = 0;
+    bool m_bOpen = false;
+};
+
+} // platform namespace
@@ -0,0 +1,562 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "pak.h"
+
+#include "compression/lz.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace platform
+{
+
+/////////////////////////////////////////////////////////
+// Constants
+
+static constexpr uint32_t kPakMagic = 0x4B415044; // "DPAK"
+static constexpr uint32_t kPakVersion = 2; // 2: compressed entries
+
+/////////////////////////////////////////////////////////
+// Functions
+
+static uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static bool IsCompressed(const SPakEntry& entry)
+{
+    return ((uint32_t)entry.flags & (uint32_t)EPakEntryFlags::Compressed) != 0;
+}
+
+static uint64_t GetBlockCount(uint64_t size, uint32_t blockSize)
+{
+    return (size + blockSize - 1) / blockSize;
+}
+
+// Block table followed by the blocks, see the layout in pak.h. Leaves pOutStored empty if it doesn't pay off.
+static void CompressPakEntry(const char* pData, size_t numBytes, uint32_t blockSize, std::vector<char>* pOutStored)
+{
+    pOutStored->clear();
+    const size_t blockCount = (size_t)GetBlockCount(numBytes, blockSize);
+    if (blockCount == 0)
+        return;
+
+    const size_t tableSize = blockCount * sizeof(uint32_t);
+    std::vector<uint32_t> blockEnds(blockCount);
+    std::vector<char> blocks;
+    std::vector<char> scratch(compression::LzCompressBound(blockSize));
+    for (size_t i = 0; i < blockCount; ++i)
+    {
+        const char* pBlock = pData + i * blockSize;
+        const size_t blockBytes = std::min<size_t>(blockSize, numBytes - i * blockSize);
+        const size_t compressedBytes = compression::LzCompressBlock(pBlock, blockBytes, scratch.data(), scratch.size());
+        if (compressedBytes > 0 && compressedBytes < blockBytes)
+        {
+            blocks.insert(blocks.end(), scratch.data(), scratch.data() + compressedBytes);
+        }
+        else
+        {
+            blocks.insert(blocks.end(), pBlock, pBlock + blockBytes); // raw, recognized by its size on read
+        }
+
+        blockEnds[i] = (uint32_t)blocks.size();
+    }
+
+    const size_t storedSize = tableSize + blocks.size();
+    if (storedSize > numBytes * (1.0 - kPakMinCompressionSaving) || blocks.size() > UINT32_MAX)
+        return;
+
+    pOutStored->resize(storedSize);
+    memcpy(pOutStored->data(), blockEnds.data(), tableSize);
+    memcpy(pOutStored->data() + tableSize, blocks.data(), blocks.size());
+}
+
+// Orders by hash first so lookups can binary search on the hash alone in the common case
+static int ComparePakKeys(uint64_t hashA, const char* pathA, size_t lengthA, uint64_t hashB, const char* pathB, size_t lengthB)
+{
+    if (hashA != hashB)
+        return hashA < hashB ? -1 : 1;
+
+    const int result = memcmp(pathA, pathB, std::min(lengthA, lengthB));
+    if (result != 0)
+        return result;
+
+    return lengthA == lengthB ? 0 : (lengthA < lengthB ? -1 : 1);
+}
+
+const char* ToString(EPakValidation validation)
+{
+    switch (validation)
+    {
+    case EPakValidation::Valid: return "Valid";
+    case EPakValidation::TooSmall: return "TooSmall";
+    case EPakValidation::BadMagic: return "BadMagic";
+    case EPakValidation::BadVersion: return "BadVersion";
+    case EPakValidation::BadAlignment: return "BadAlignment";
+    case EPakValidation::SizeMismatch: return "SizeMismatch";
+    case EPakValidation::BadTableOfContents: return "BadTableOfContents";
+    }
+
+    return "Unknown";
+}
+
+uint64_t HashPakPath(const char* path, size_t length)
+{
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash ^= (uint8_t)path[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+bool BuildPak(const SPakBuildInput* pInputs, size_t numInputs, const SPakBuildOptions& options, std::vector<char>* pOutPak)
+{
+    assert(pInputs != nullptr || numInputs == 0);
+    assert(pOutPak != nullptr);
+    assert(options.blockSize > 0 && options.blockSize - 1 <= compression::kLzMaxOffset);
+
+    std::vector<SPakEntry> entries(numInputs);
+    std::vector<size_t> order(numInputs);
+    uint64_t pathsSize = 0;
+    for (size_t i = 0; i < numInputs; ++i)
+    {
+        const SPakBuildInput& input = pInputs[i];
+        const size_t pathLength = input.path != nullptr ? strlen(input.path) : 0;
+        if (pathLength == 0 || pathLength > UINT32_MAX || (input.pData == nullptr && input.numBytes > 0))
+        {
+            DiracError("[%s] invalid input %zu", __FUNCTION__, i);
+            return false;
+        }
+
+        entries[i].pathHash = HashPakPath(input.path, pathLength);
+        entries[i].size = input.numBytes;
+        entries[i].pathLength = (uint32_t)pathLength;
+        order[i] = i;
+        pathsSize += pathLength;
+    }
+
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b)
+    {
+        return ComparePakKeys(
+            entries[a].pathHash, pInputs[a].path, entries[a].pathLength,
+            entries[b].pathHash, pInputs[b].path, entries[b].pathLength) < 0;
+    });
+
+    for (size_t i = 1; i < numInputs; ++i)
+    {
+        const size_t a = order[i - 1];
+        const size_t b = order[i];
+        if (ComparePakKeys(
+            entries[a].pathHash, pInputs[a].path, entries[a].pathLength,
+            entries[b].pathHash, pInputs[b].path, entries[b].pathLength) == 0)
+        {
+            DiracError("[%s] duplicate path: %s", __FUNCTION__, pInputs[b].path);
+            return false;
+        }
+    }
+
+    if (pathsSize > UINT32_MAX)
+    {
+        DiracError("[%s] path table too large", __FUNCTION__);
+        return false;
+    }
+
+    // Compressed payloads, empty for entries stored raw
+    std::vector<std::vector<char>> compressed(numInputs);
+    for (size_t i = 0; i < numInputs; ++i)
+    {
+        if (options.bCompress && pInputs[i].bCompress)
+        {
+            CompressPakEntry((const char*)pInputs[i].pData, pInputs[i].numBytes, options.blockSize, &compressed[i]);
+        }
+
+        entries[i].flags = compressed[i].empty() ? EPakEntryFlags::None : EPakEntryFlags::Compressed;
+        entries[i].storedSize = compressed[i].empty() ? entries[i].size : compressed[i].size();
+    }
+
+    SPakHeader header;
+    header.magic = kPakMagic;
+    header.version = kPakVersion;
+    header.entryCount = (uint32_t)numInputs;
+    header.dataAlignment = kPakDataAlignment;
+    header.blockSize = options.blockSize;
+    header.pathsOffset = sizeof(SPakHeader) + sizeof(SPakEntry) * numInputs;
+    header.pathsSize = pathsSize;
+
+    // Lay out paths and data in table order so a sequential read of the archive follows lookups
+    uint32_t pathOffset = 0;
+    uint64_t dataOffset = AlignUp(header.pathsOffset + pathsSize, kPakDataAlignment);
+    for (size_t i = 0; i < numInputs; ++i)
+    {
+        SPakEntry& entry = entries[order[i]];
+        entry.pathOffset = pathOffset;
+        entry.dataOffset = dataOffset;
+        pathOffset += entry.pathLength;
+        dataOffset = AlignUp(dataOffset + entry.storedSize, kPakDataAlignment);
+    }
+
+    header.fileSize = dataOffset;
+
+    pOutPak->assign((size_t)header.fileSize, 0);
+    char* pPak = pOutPak->data();
+    memcpy(pPak, &header, sizeof(SPakHeader));
+    for (size_t i = 0; i < numInputs; ++i)
+    {
+        const SPakEntry& entry = entries[order[i]];
+        const SPakBuildInput& input = pInputs[order[i]];
+        const void* pStored = IsCompressed(entry) ? (const void*)compressed[order[i]].data() : input.pData;
+        memcpy(pPak + sizeof(SPakHeader) + sizeof(SPakEntry) * i, &entry, sizeof(SPakEntry));
+        memcpy(pPak + header.pathsOffset + entry.pathOffset, input.path, entry.pathLength);
+        if (entry.storedSize > 0)
+        {
+            memcpy(pPak + entry.dataOffset, pStored, (size_t)entry.storedSize);
+        }
+    }
+
+    return true;
+}
+
+// Block table of a compressed entry must be increasing and end exactly at storedSize
+static bool ValidateBlockTable(const char* pData, const SPakEntry& entry, uint32_t blockSize)
+{
+    const uint64_t blockCount = GetBlockCount(entry.size, blockSize);
+    const uint64_t tableSize = blockCount * sizeof(uint32_t);
+    if (blockCount == 0 || entry.storedSize < tableSize)
+        return false;
+
+    const uint64_t blocksSize = entry.storedSize - tableSize;
+    uint32_t previousEnd = 0;
+    for (uint64_t i = 0; i < blockCount; ++i)
+    {
+        uint32_t blockEnd;
+        memcpy(&blockEnd, pData + entry.dataOffset + i * sizeof(uint32_t), sizeof(blockEnd));
+        const uint64_t blockBytes = std::min<uint64_t>(blockSize, entry.size - i * blockSize);
+        if (blockEnd <= previousEnd || blockEnd - previousEnd > blockBytes || blockEnd > blocksSize)
+            return false;
+
+        previousEnd = blockEnd;
+    }
+
+    return previousEnd == blocksSize;
+}
+
+EPakValidation ValidatePak(const char* pData, size_t numBytes)
+{
+    if (pData == nullptr || numBytes < sizeof(SPakHeader))
+        return EPakValidation::TooSmall;
+
+    SPakHeader header;
+    memcpy(&header, pData, sizeof(SPakHeader));
+
+    if (header.magic != kPakMagic)
+        return EPakValidation::BadMagic;
+
+    if (header.version != kPakVersion)
+        return EPakValidation::BadVersion;
+
+    if (header.dataAlignment != kPakDataAlignment)
+        return EPakValidation::BadAlignment;
+
+    if (header.blockSize == 0 || header.blockSize - 1 > compression::kLzMaxOffset)
+        return EPakValidation::BadTableOfContents;
+
+    if (header.fileSize != numBytes)
+        return EPakValidation::SizeMismatch;
+
+    const uint64_t tocEnd = sizeof(SPakHeader) + sizeof(SPakEntry) * (uint64_t)header.entryCount;
+    if (header.pathsOffset != tocEnd || header.pathsOffset + header.pathsSize > numBytes)
+        return EPakValidation::BadTableOfContents;
+
+    const char* pPaths = pData + header.pathsOffset;
+    SPakEntry previous;
+    for (uint32_t i = 0; i < header.entryCount; ++i)
+    {
+        SPakEntry entry;
+        memcpy(&entry, pData + sizeof(SPakHeader) + sizeof(SPakEntry) * i, sizeof(SPakEntry));
+
+        if ((uint64_t)entry.pathOffset + entry.pathLength > header.pathsSize
+            || entry.pathLength == 0
+            || entry.dataOffset % kPakDataAlignment != 0
+            || entry.dataOffset < header.pathsOffset + header.pathsSize
+            || entry.dataOffset > numBytes
+            || entry.storedSize > numBytes - entry.dataOffset
+            || entry.pathHash != HashPakPath(pPaths + entry.pathOffset, entry.pathLength)
+            || ((uint32_t)entry.flags & ~(uint32_t)EPakEntryFlags::Compressed) != 0)
+        {
+            return EPakValidation::BadTableOfContents;
+        }
+
+        if (IsCompressed(entry) ? !ValidateBlockTable(pData, entry, header.blockSize) : entry.storedSize != entry.size)
+            return EPakValidation::BadTableOfContents;
+
+        if (i > 0 && ComparePakKeys(
+            previous.pathHash, pPaths + previous.pathOffset, previous.pathLength,
+            entry.pathHash, pPaths + entry.pathOffset, entry.pathLength) >= 0)
+        {
+            return EPakValidation::BadTableOfContents;
+        }
+
+        previous = entry;
+    }
+
+    return EPakValidation::Valid;
+}
+
+bool OpenPakFromMemory(const char* pData, size_t numBytes, SPakArchive* pOutArchive)
+{
+    assert(pOutArchive != nullptr);
+    assert(((uintptr_t)pData % alignof(SPakEntry)) == 0);
+    *pOutArchive = SPakArchive();
+
+    const EPakValidation validation = ValidatePak(pData, numBytes);
+    if (validation != EPakValidation::Valid)
+    {
+        DiracError("[%s] invalid pak archive: %s", __FUNCTION__, ToString(validation));
+        return false;
+    }
+
+    pOutArchive->pData = pData;
+    pOutArchive->numBytes = numBytes;
+    pOutArchive->pHeader = reinterpret_cast<const SPakHeader*>(pData);
+    pOutArchive->pEntries = reinterpret_cast<const SPakEntry*>(pData + sizeof(SPakHeader));
+    pOutArchive->pPaths = pData + pOutArchive->pHeader->pathsOffset;
+    return true;
+}
+
+bool MapPak(const char* fileName, SPakArchive* pOutArchive)
+{
+    assert(fileName && fileName[0]);
+    assert(pOutArchive != nullptr);
+    *pOutArchive = SPakArchive();
+
+    const char* pData = nullptr;
+    size_t numBytes = 0;
+    void* pMapping = nullptr;
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        DiracError("[%s] failed to open: %s", __FUNCTION__, fileName);
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+    {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+
+    CloseHandle(file); // the mapping keeps the file open
+    if (mapping == nullptr)
+    {
+        DiracError("[%s] failed to map: %s", __FUNCTION__, fileName);
+        return false;
+    }
+
+    pData = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (pData == nullptr)
+    {
+        CloseHandle(mapping);
+        DiracError("[%s] failed to map view of: %s", __FUNCTION__, fileName);
+        return false;
+    }
+
+    numBytes = (size_t)fileSize.QuadPart;
+    pMapping = mapping;
+#else
+    const int file = open(fileName, O_RDONLY);
+    if (file < 0)
+    {
+        DiracError("[%s] failed to open: %s", __FUNCTION__, fileName);
+        return false;
+    }
+
+    struct stat fileStat;
+    void* pMapped = MAP_FAILED;
+    if (fstat(file, &fileStat) == 0 && fileStat.st_size > 0)
+    {
+        pMapped = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    }
+
+    close(file); // the mapping keeps the file open
+    if (pMapped == MAP_FAILED)
+    {
+        DiracError("[%s] failed to map: %s", __FUNCTION__, fileName);
+        return false;
+    }
+
+    pData = (const char*)pMapped;
+    numBytes = (size_t)fileStat.st_size;
+    pMapping = pMapped;
+#endif
+
+    SPakArchive archive;
+    if (!OpenPakFromMemory(pData, numBytes, &archive))
+    {
+        archive.pData = pData;
+        archive.numBytes = numBytes;
+        archive.pMapping = pMapping;
+        UnmapPak(&archive);
+        return false;
+    }
+
+    archive.pMapping = pMapping;
+    *pOutArchive = archive;
+    return true;
+}
+
+void UnmapPak(SPakArchive* pArchive)
+{
+    assert(pArchive != nullptr);
+    if (pArchive->pMapping != nullptr)
+    {
+#if defined(_WIN32)
+        UnmapViewOfFile(pArchive->pData);
+        CloseHandle((HANDLE)pArchive->pMapping);
+#else
+        munmap(pArchive->pMapping, pArchive->numBytes);
+#endif
+    }
+
+    *pArchive = SPakArchive();
+}
+
+const SPakEntry* FindPakEntry(const SPakArchive& archive, const char* path)
+{
+    assert(path != nullptr);
+    if (archive.pHeader == nullptr)
+        return nullptr;
+
+    const size_t pathLength = strlen(path);
+    const uint64_t pathHash = HashPakPath(path, pathLength);
+
+    size_t low = 0;
+    size_t high = archive.pHeader->entryCount;
+    while (low < high)
+    {
+        const size_t middle = low + (high - low) / 2;
+        const SPakEntry& entry = archive.pEntries[middle];
+        const int order = ComparePakKeys(
+            entry.pathHash, archive.pPaths + entry.pathOffset, entry.pathLength,
+            pathHash, path, pathLength);
+
+        if (order == 0)
+            return &entry;
+
+        if (order < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return nullptr;
+}
+
+bool GetPakEntryView(const SPakArchive& archive, const SPakEntry& entry, const char** ppOutData, size_t* pOutNumBytes)
+{
+    assert(ppOutData != nullptr);
+    assert(pOutNumBytes != nullptr);
+    if (IsCompressed(entry))
+        return false;
+
+    *ppOutData = archive.pData + entry.dataOffset;
+    *pOutNumBytes = (size_t)entry.size;
+    return true;
+}
+
+uint32_t GetPakBlockCount(const SPakArchive& archive, const SPakEntry& entry)
+{
+    assert(archive.pHeader != nullptr);
+    return IsCompressed(entry) ? (uint32_t)GetBlockCount(entry.size, archive.pHeader->blockSize) : 1;
+}
+
+bool ReadPakBlock(const SPakArchive& archive, const SPakEntry& entry, uint32_t blockIndex, void* pDst)
+{
+    assert(archive.pHeader != nullptr);
+    assert(pDst != nullptr || entry.size == 0);
+    assert(blockIndex < GetPakBlockCount(archive, entry));
+    const char* pStored = archive.pData + entry.dataOffset;
+    if (!IsCompressed(entry))
+    {
+        if (entry.size > 0)
+        {
+            memcpy(pDst, pStored, (size_t)entry.size);
+        }
+
+        return true;
+    }
+
+    // the table was range checked by ValidatePak when the archive was opened
+    const uint32_t blockSize = archive.pHeader->blockSize;
+    const size_t tableSize = (size_t)GetBlockCount(entry.size, blockSize) * sizeof(uint32_t);
+    uint32_t blockBegin = 0;
+    uint32_t blockEnd = 0;
+    if (blockIndex > 0)
+    {
+        memcpy(&blockBegin, pStored + (blockIndex - 1) * sizeof(uint32_t), sizeof(uint32_t));
+    }
+
+    memcpy(&blockEnd, pStored + blockIndex * sizeof(uint32_t), sizeof(uint32_t));
+
+    const uint64_t dstOffset = (uint64_t)blockIndex * blockSize;
+    const size_t dstBytes = (size_t)std::min<uint64_t>(blockSize, entry.size - dstOffset);
+    const char* pBlock = pStored + tableSize + blockBegin;
+    const size_t blockBytes = blockEnd - blockBegin;
+    char* pBlockDst = (char*)pDst + dstOffset;
+    if (blockBytes == dstBytes)
+    {
+        memcpy(pBlockDst, pBlock, dstBytes);
+        return true;
+    }
+
+    if (!compression::LzDecompressBlock(pBlock, blockBytes, pBlockDst, dstBytes))
+    {
+        DiracError("[%s] corrupt block %u in %.*s", __FUNCTION__, blockIndex, (int)entry.pathLength, archive.pPaths + entry.pathOffset);
+        return false;
+    }
+
+    return true;
+}
+
+bool ReadPakEntry(const SPakArchive& archive, const SPakEntry& entry, void* pDst)
+{
+    const uint32_t blockCount = GetPakBlockCount(archive, entry);
+    for (uint32_t i = 0; i < blockCount; ++i)
+    {
+        if (!ReadPakBlock(archive, entry, i, pDst))
+            return false;
+    }
+
+    return true;
+}
+
+bool FindPakFile(const SPakArchive& archive, const char* path, const char** ppOutData, size_t* pOutNumBytes)
+{
+    const SPakEntry* pEntry = FindPakEntry(archive, path);
+    return pEntry != nullptr && GetPakEntryView(archive, *pEntry, ppOutData, pOutNumBytes);
+}
+
+} // platform namespace
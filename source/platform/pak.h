@@ -0,0 +1,132 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+#include <vector>
+
+namespace platform
+{
+
+/////////////////////////////////////////////////////////
+// Pak archive
+//
+// On disk layout (little endian):
+//   SPakHeader
+//   SPakEntry[entryCount], sorted by (pathHash, path) so lookups are a binary search
+//   path strings, not null terminated, referenced by SPakEntry::pathOffset/pathLength
+//   file data, every entry starts on a kPakDataAlignment boundary
+//
+// Archives are memory mapped once and stored files are returned as views straight into the mapping.
+// Compressed entries (EPakEntryFlags::Compressed) are split into SPakHeader::blockSize blocks of LZ data,
+// prefixed by a table of uint32_t block end offsets relative to the end of the table. A block whose stored size
+// equals its decompressed size is kept raw. Every block decodes on its own, so a large file can be decompressed
+// in parallel or streamed block by block into its destination (e.g. a mapped staging buffer).
+// Paths are stored exactly as they are passed to LoadFiles, e.g. "data/shaders/sdf.vert.spv".
+
+static constexpr uint32_t kPakDataAlignment = 64; // cache line, also satisfies SPIR-V word and texel block alignment
+static constexpr uint32_t kPakDefaultBlockSize = 64 * 1024; // must be <= compression::kLzMaxOffset + 1
+
+struct SPakHeader
+{
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    uint32_t entryCount = 0;
+    uint32_t dataAlignment = 0;
+    uint32_t blockSize = 0;
+    uint32_t reserved = 0;
+    uint64_t pathsOffset = 0;
+    uint64_t pathsSize = 0;
+    uint64_t fileSize = 0;
+};
+
+enum class EPakEntryFlags : uint32_t
+{
+    None = 0,
+    Compressed = 1 << 0
+};
+
+struct SPakEntry
+{
+    uint64_t pathHash = 0;
+    uint64_t dataOffset = 0; // from the start of the archive
+    uint64_t size = 0; // decompressed
+    uint64_t storedSize = 0; // bytes at dataOffset, including the block table of compressed entries
+    uint32_t pathOffset = 0; // from SPakHeader::pathsOffset
+    uint32_t pathLength = 0;
+    EPakEntryFlags flags = EPakEntryFlags::None;
+    uint32_t reserved = 0;
+};
+
+struct SPakBuildInput
+{
+    const char* path = nullptr;
+    const void* pData = nullptr;
+    size_t numBytes = 0;
+    bool bCompress = true; // still stored raw if compression doesn't save at least kPakMinCompressionSaving
+};
+
+struct SPakBuildOptions
+{
+    uint32_t blockSize = kPakDefaultBlockSize;
+    bool bCompress = true; // false stores every entry raw, overriding SPakBuildInput::bCompress
+};
+
+static constexpr double kPakMinCompressionSaving = 0.05;
+
+enum class EPakValidation : uint8_t
+{
+    Valid,
+    TooSmall,
+    BadMagic,
+    BadVersion,
+    BadAlignment,
+    SizeMismatch,
+    BadTableOfContents
+};
+
+const char* ToString(EPakValidation validation);
+
+struct SPakArchive
+{
+    const char* pData = nullptr;
+    size_t numBytes = 0;
+    const SPakHeader* pHeader = nullptr;
+    const SPakEntry* pEntries = nullptr;
+    const char* pPaths = nullptr;
+    void* pMapping = nullptr; // platform mapping handle, null for archives opened from memory
+};
+
+uint64_t HashPakPath(const char* path, size_t length);
+
+// Fails on empty or duplicate paths
+bool BuildPak(const SPakBuildInput* pInputs, size_t numInputs, const SPakBuildOptions& options, std::vector<char>* pOutPak);
+
+EPakValidation ValidatePak(const char* pData, size_t numBytes);
+
+// pData must stay alive and 8 byte aligned while the archive is in use
+bool OpenPakFromMemory(const char* pData, size_t numBytes, SPakArchive* pOutArchive);
+
+bool MapPak(const char* fileName, SPakArchive* pOutArchive);
+void UnmapPak(SPakArchive* pArchive);
+
+const SPakEntry* FindPakEntry(const SPakArchive& archive, const char* path);
+
+// Stored entries only, on success ppOutData points into the archive, valid until it is unmapped
+bool GetPakEntryView(const SPakArchive& archive, const SPakEntry& entry, const char** ppOutData, size_t* pOutNumBytes);
+
+// Whole entry into pDst, which must hold entry.size bytes
+bool ReadPakEntry(const SPakArchive& archive, const SPakEntry& entry, void* pDst);
+
+// Independent blocks of an entry, stored entries are a single block
+uint32_t GetPakBlockCount(const SPakArchive& archive, const SPakEntry& entry);
+
+// Decompresses one block to pDst + blockIndex * blockSize, pDst must hold entry.size bytes
+bool ReadPakBlock(const SPakArchive& archive, const SPakEntry& entry, uint32_t blockIndex, void* pDst);
+
+// Convenience lookup for stored entries, false for missing or compressed entries
+bool FindPakFile(const SPakArchive& archive, const char* path, const char** ppOutData, size_t* pOutNumBytes);
+
+} // platform namespace
@@ -8,9 +8,13 @@
 
 #include <filesystem>
 #include <iostream>
+#include <thread>
 #include <SDL.h>
 
+#include "async_io.h"
 #include "game.h"
+#include "input_recording.h"
+#include "pak.h"
 #include "vector2.h"
 
 namespace platform
@@ -22,21 +26,60 @@ static constexpr int kScreenWidth = 1920;
 static constexpr int kScreenHeight = 1080;
 static constexpr int kScreenHalfWidth = kScreenWidth / 2;
 static constexpr int kScreenHalfHeight = kScreenHeight / 2;
+static constexpr const char* kDefaultPakFileName = "data.pak";
 static constexpr TTime::duration kFrameDuration = { std::chrono::duration_cast<TTime::duration>(TMilliseconds(8)) }; // ~120FPS
 
 ////////////////////////////////////////////////
 // State
 
 static SDL_Window* g_pWindow = nullptr;
+static int g_argc = 0;
+static char** g_argv = nullptr;
+static SPakArchive g_mountedPak;
 
-typedef std::pair<TActionMapId, TActionMap> TActionMapEntry;
-typedef std::vector<TActionMapEntry> TActionMapStack;
-TActionMapId g_actionMapIdAllocator = 0;
-TActionMapStack g_actionMapStack;
+static SActionMapStack g_actionMaps;
+
+// Input is gathered once per frame in RunIO, live or from a recording, then dispatched
+static SInputState g_inputState;
+static SInputRecorder g_inputRecorder;
+static SInputPlayer g_inputPlayer;
+static std::vector<SInputEventRecord> g_replayEvents;
+static uint32_t g_inputStartTicks = 0;
 
 ////////////////////////////////////////////////
 // Functions
 
+void SetCommandLine(int argc, char* argv[])
+{
+    g_argc = argc;
+    g_argv = argv;
+}
+
+bool HasCommandLineArg(const char* name)
+{
+    assert(name && name[0]);
+    for (int i = 1; i < g_argc; ++i)
+    {
+        if (strcmp(g_argv[i], name) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+const char* GetCommandLineValue(const char* name)
+{
+    assert(name && name[0]);
+    const size_t nameLength = strlen(name);
+    for (int i = 1; i < g_argc; ++i)
+    {
+        if (strncmp(g_argv[i], name, nameLength) == 0 && g_argv[i][nameLength] == '=')
+            return g_argv[i] + nameLength + 1;
+    }
+
+    return nullptr;
+}
+
 ERunResult Initialize()
 {
     assert(g_pWindow == nullptr);
@@ -63,12 +106,115 @@ ERunResult Initialize()
     SDL_SetRelativeMouseMode(SDL_TRUE);
 
     g_pWindow = pWindow;
+
+    // --pak=<file> selects an archive, otherwise data.pak is used when present and loose files otherwise
+    const char* pakFileName = GetCommandLineValue("--pak");
+    if (pakFileName == nullptr && !HasCommandLineArg("--no-pak") && FileExists(kDefaultPakFileName))
+    {
+        pakFileName = kDefaultPakFileName;
+    }
+
+    if (pakFileName != nullptr && !MountPak(pakFileName))
+    {
+        DiracLog(1, "[Platform] failed to mount %s, loading loose files", pakFileName);
+    }
+
+    { // async IO, reads are IO bound so a few threads are enough to keep the device queue full
+        uint32_t numIOThreads = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+        if (const char* ioThreads = GetCommandLineValue("--io-threads"))
+        {
+            numIOThreads = (uint32_t)std::max(atoi(ioThreads), 0);
+        }
+
+        InitializeAsyncIO(numIOThreads);
+    } // ~async IO
+
+    { // input, --input-record=<file> saves this session's input and --input-replay=<file> plays one back instead of live input
+        g_inputStartTicks = SDL_GetTicks();
+        if (const char* replayFileName = GetCommandLineValue("--input-replay"))
+        {
+            if (!g_inputPlayer.Open(replayFileName))
+                return eRR_Error;
+
+            DiracLog(1, "[Input] replaying %u frames of %.3f ms from %s", g_inputPlayer.GetFrameCount(), TMilliseconds(g_inputPlayer.GetFrameDuration()).count(), replayFileName);
+        }
+        else if (const char* recordFileName = GetCommandLineValue("--input-record"))
+        {
+            if (!g_inputRecorder.Open(recordFileName, kFrameDuration))
+                return eRR_Error;
+        }
+    } // ~input
+
     return eRR_Success;
 }
 
-ERunResult RunIO(const SFrameContext& /*frameContext*/, bool* pExit)
+static void DispatchKeyEvents(bool* pExit)
+{
+    for (const SInputKeyEvent& keyEvent : g_inputState.GetKeyEvents())
+    {
+        if (keyEvent.keyCode == SDLK_ESCAPE)
+        {
+            *pExit = true;
+        }
+
+        // Copied out, the callback may push or remove action maps
+        if (const SActionHandler* pHandler = g_actionMaps.Find(keyEvent.keyCode, keyEvent.keyMod))
+        {
+            const SActionHandler handler = *pHandler;
+            handler.callback(keyEvent.keyCode, keyEvent.keyMod, keyEvent.keyChange);
+        }
+    }
+}
+
+// Replayed frames ignore live input, only quitting (window close or Escape) ends a replay early
+static void ReplayInputFrame(bool* pExit)
+{
+    SDL_Event event;
+    while (SDL_PollEvent(&event))
+    {
+        if (event.type == SDL_QUIT || (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE))
+        {
+            *pExit = true;
+        }
+    }
+
+    SInputFrameRecord frame;
+    if (!g_inputPlayer.NextFrame(&frame, &g_replayEvents))
+    {
+        DiracLog(1, "[Input] replay finished after %u frames", g_inputPlayer.GetFrameIndex());
+        g_inputState.SetMouse(0, 0, 0);
+        *pExit = true;
+        return;
+    }
+
+    for (const SInputEventRecord& inputEvent : g_replayEvents)
+    {
+        if (inputEvent.type == EInputEventType::Quit)
+        {
+            *pExit = true;
+        }
+        else
+        {
+            const EKeyChange keyChange = inputEvent.type == EInputEventType::KeyDown ? EKeyChange::Pressed : EKeyChange::Released;
+            g_inputState.AddKeyEvent(inputEvent.keyCode, inputEvent.keyMod, keyChange);
+        }
+    }
+
+    g_inputState.SetMouse(frame.mouseRelX, frame.mouseRelY, frame.mouseButtons);
+}
+
+ERunResult RunIO(const SFrameContext& frameContext, bool* pExit)
 {
     assert(pExit != nullptr);
+    DispatchAsyncReadCompletions();
+
+    g_inputState.BeginFrame();
+    if (g_inputPlayer.IsReplaying())
+    {
+        ReplayInputFrame(pExit);
+        DispatchKeyEvents(pExit);
+        return eRR_Success;
+    }
 
     SDL_Event event;
     while (SDL_PollEvent(&event))
@@ -77,35 +223,23 @@ ERunResult RunIO(const SFrameContext& /*frameContext*/, bool* pExit)
         {
         case SDL_KEYDOWN:
         case SDL_KEYUP:
-            if (event.key.keysym.sym == SDLK_ESCAPE)
+        {
+            const EKeyChange keyChange = event.type == SDL_KEYDOWN ? EKeyChange::Pressed : EKeyChange::Released;
+            if (g_inputRecorder.IsRecording())
             {
-                *pExit = true;
-            }
-            if (g_actionMapStack.size() > 0)
-            {
-                bool bActionHandled = false;
-                for (
-                    TActionMapStack::reverse_iterator it = g_actionMapStack.rbegin();
-                    it != g_actionMapStack.rend() && bActionHandled == false;
-                    ++it)
-                {
-                    const TActionMap& rActionMap = it->second;
-                    for (const SActionHandler& rHandler : rActionMap)
-                    {
-                        if (rHandler.keyCode == event.key.keysym.sym &&
-                            (rHandler.requiredKeyMods == 0 || (rHandler.requiredKeyMods == event.key.keysym.mod)))
-                        {
-                            assert(rHandler.callback != nullptr);
-                            EKeyChange eKeyChange = event.type == SDL_KEYDOWN ? EKeyChange::Pressed : EKeyChange::Released;
-                            rHandler.callback(event.key.keysym.sym, event.key.keysym.mod, eKeyChange);
-                            bActionHandled = true;
-                            break;
-                        }
-                    }
-                }
+                const EInputEventType type = keyChange == EKeyChange::Pressed ? EInputEventType::KeyDown : EInputEventType::KeyUp;
+                g_inputRecorder.AddEvent({ event.key.timestamp - g_inputStartTicks, event.key.keysym.sym, event.key.keysym.mod, type });
             }
+
+            g_inputState.AddKeyEvent(event.key.keysym.sym, event.key.keysym.mod, keyChange);
             break;
+        }
         case SDL_QUIT:
+            if (g_inputRecorder.IsRecording())
+            {
+                g_inputRecorder.AddEvent({ event.quit.timestamp - g_inputStartTicks, 0, 0, EInputEventType::Quit });
+            }
+
             *pExit = true;
             break;
         default:
@@ -113,35 +247,50 @@ ERunResult RunIO(const SFrameContext& /*frameContext*/, bool* pExit)
         }
     }
 
+    int x, y;
+    const uint32_t mouseButtons = SDL_GetRelativeMouseState(&x, &y);
+    g_inputState.SetMouse(x, y, mouseButtons);
+    g_inputRecorder.EndFrame(std::chrono::duration_cast<TTime::duration>(frameContext.lastFrameDuration), x, y, mouseButtons);
+    DispatchKeyEvents(pExit);
+
     return eRR_Success;
 }
 
-void RegulateFrameLimit(const SFrameContext& frameContext)
+TTime::duration GetTargetFrameDuration()
 {
-    static TTime::duration lastFrameDuration;
-    { // limit frame rate: TODO: skip render when lagging behind
-        static TTime lastFrameTime = frameContext.frameStartTime;
-        static TTime nextFrameTime = frameContext.frameStartTime;
-        TTime currentTime = frameContext.frameStartTime;
-        TTime::duration timeTillNextFrame = currentTime - nextFrameTime;
-        while (timeTillNextFrame.count() < 0)
-        {
-            SDL_Delay(0);
-            currentTime = TSteadyClock::now();
-            timeTillNextFrame = currentTime - nextFrameTime;
-        }
+    return g_inputPlayer.IsReplaying() ? g_inputPlayer.GetFrameDuration() : kFrameDuration;
+}
 
-        lastFrameDuration = currentTime - lastFrameTime;
-        lastFrameTime = nextFrameTime;
-        nextFrameTime += kFrameDuration;
-    }
+bool IsReplayingInput()
+{
+    return g_inputPlayer.IsReplaying();
+}
 
-    DiracLog(3, "FrameContext::lastFrameDuration: %f, LastFrameDuration (ms): %f", frameContext.lastFrameDuration.count(), TMilliseconds(lastFrameDuration).count());
+TTime::duration GetReplayFrameDuration()
+{
+    assert(g_inputPlayer.IsReplaying());
+    return g_inputPlayer.GetNextFrameDuration();
 }
 
 ERunResult Shutdown()
 {
     ERunResult shutdownResult = eRR_Success;
+    ShutdownAsyncIO(); // before unmounting, in flight reads may be returning views into the pak
+    if (g_inputRecorder.IsRecording())
+    {
+        const uint32_t numRecordedFrames = g_inputRecorder.GetFrameCount();
+        if (g_inputRecorder.Close())
+        {
+            DiracLog(1, "[Input] recorded %u frames", numRecordedFrames);
+        }
+        else
+        {
+            shutdownResult = eRR_Error;
+        }
+    }
+
+    UnmountPak();
+
     if (g_pWindow != nullptr)
     {
         SDL_DestroyWindow(g_pWindow);
@@ -167,7 +316,6 @@ static const char* fileTypeDescriptors[kNumFileTypes] = { "r", "rb" };
 #pragma warning(push)
 #pragma warning(disable: 6385) // disable warning about invalid data access to fileTypeDescripters, we assert before access
 
-// TODO: consider pak filesystem instead of just standard file IO
 bool LoadFiles(const char* fileNames[], size_t numFiles, EFileType fileType, SFile* pOutArray)
 {
     assert(numFiles > 0);
@@ -177,6 +325,30 @@ bool LoadFiles(const char* fileNames[], size_t numFiles, EFileType fileType, SFi
     for (size_t i = 0; i < numFiles; ++i)
     {
         assert(fileNames[i] && fileNames[i][0] != 0);
+        if (const SPakEntry* pEntry = FindPakEntry(g_mountedPak, fileNames[i]))
+        {
+            pOutArray[i] = SFile();
+            SFile& rFile = pOutArray[i];
+            if (!GetPakEntryView(g_mountedPak, *pEntry, &rFile.pBytes, &rFile.numBytes))
+            {
+                // compressed, decode into an owned allocation
+                rFile.pData.reset(new char[(size_t)pEntry->size]);
+                if (ReadPakEntry(g_mountedPak, *pEntry, rFile.pData.get()))
+                {
+                    rFile.pBytes = rFile.pData.get();
+                    rFile.numBytes = (size_t)pEntry->size;
+                }
+                else
+                {
+                    rFile = SFile();
+                    DiracError("[%s] Failed to decompress pak file: %s", __FUNCTION__, fileNames[i]);
+                    bSuccess = false;
+                }
+            }
+
+            continue;
+        }
+
         FILE* pFile = fopen(fileNames[i], fileTypeDescriptors[uint8_t(fileType)]);
         if (pFile)
         {
@@ -189,6 +361,7 @@ bool LoadFiles(const char* fileNames[], size_t numFiles, EFileType fileType, SFi
             {
                 rFile.pData.reset(new char[fileSize]);
                 rFile.numBytes = fread(rFile.pData.get(), 1, fileSize, pFile);
+                rFile.pBytes = rFile.pData.get();
                 int fileError = ferror(pFile);
                 if (fileError != 0)
                 {
@@ -214,6 +387,84 @@ bool LoadFiles(const char* fileNames[], size_t numFiles, EFileType fileType, SFi
 }
 #pragma warning(pop)
 
+bool MountPak(const char* fileName)
+{
+    assert(fileName && fileName[0]);
+    UnmountPak();
+
+    const TTime mapStartTime = TSteadyClock::now();
+    if (!MapPak(fileName, &g_mountedPak))
+        return false;
+
+    DiracLog(1, "[Platform] mounted %s: %u files, %zu bytes in %.3f ms",
+        fileName,
+        g_mountedPak.pHeader->entryCount,
+        g_mountedPak.numBytes,
+        TMilliseconds(TSteadyClock::now() - mapStartTime).count());
+    return true;
+}
+
+void UnmountPak()
+{
+    UnmapPak(&g_mountedPak);
+}
+
+bool FileExists(const char* fileName)
+{
+    assert(fileName && fileName[0]);
+    std::error_code errorCode;
+    return std::filesystem::is_regular_file(fileName, errorCode);
+}
+
+bool WriteFileAtomic(const char* fileName, const void* pData, size_t numBytes)
+{
+    assert(fileName && fileName[0]);
+    assert(pData != nullptr || numBytes == 0);
+
+    const std::filesystem::path filePath(fileName);
+    std::error_code errorCode;
+    if (filePath.has_parent_path())
+    {
+        std::filesystem::create_directories(filePath.parent_path(), errorCode);
+        if (errorCode)
+        {
+            DiracError("[%s] failed to create directory for file: %s (%s)", __FUNCTION__, fileName, errorCode.message().c_str());
+            return false;
+        }
+    }
+
+    std::filesystem::path tempPath(filePath);
+    tempPath += ".tmp";
+
+    FILE* pFile = fopen(tempPath.string().c_str(), "wb");
+    if (pFile == nullptr)
+    {
+        DiracError("[%s] failed to open temporary file for: %s", __FUNCTION__, fileName);
+        return false;
+    }
+
+    const size_t numWritten = numBytes > 0 ? fwrite(pData, 1, numBytes, pFile) : 0;
+    const bool bFlushed = fflush(pFile) == 0;
+    fclose(pFile);
+    if (numWritten != numBytes || !bFlushed)
+    {
+        DiracError("[%s] failed to write %zu bytes for file: %s", __FUNCTION__, numBytes, fileName);
+        std::filesystem::remove(tempPath, errorCode);
+        return false;
+    }
+
+    // rename replaces the destination in a single step on both POSIX and Windows
+    std::filesystem::rename(tempPath, filePath, errorCode);
+    if (errorCode)
+    {
+        DiracError("[%s] failed to replace file: %s (%s)", __FUNCTION__, fileName, errorCode.message().c_str());
+        std::filesystem::remove(tempPath, errorCode);
+        return false;
+    }
+
+    return true;
+}
+
 void SImageSurfaceDeleter::operator()(SDL_Surface* pSurface)
 {
     SDL_FreeSurface(pSurface);
@@ -222,7 +473,21 @@ void SImageSurfaceDeleter::operator()(SDL_Surface* pSurface)
 ImageSurfacePtr LoadImage(const char* filePath)
 {
     assert(filePath && filePath[0]);
-    SDL_Surface* pSurface = SDL_LoadBMP(filePath);
+    SDL_Surface* pSurface = nullptr;
+    if (FindPakEntry(g_mountedPak, filePath) != nullptr)
+    {
+        const char* fileNames[] = { filePath };
+        SFile file;
+        if (LoadFiles(fileNames, 1, EFileType::Binary, &file) && file.numBytes <= INT32_MAX)
+        {
+            pSurface = SDL_LoadBMP_RW(SDL_RWFromConstMem(file.pBytes, (int)file.numBytes), 1 /* free src */);
+        }
+    }
+    else
+    {
+        pSurface = SDL_LoadBMP(filePath);
+    }
+
     if (pSurface == nullptr)
     {
         DiracError("[%s] failed to load image: %s\n", __FUNCTION__, SDL_GetError());
@@ -234,40 +499,28 @@ ImageSurfacePtr LoadImage(const char* filePath)
 
 TActionMapId PushActionMap(TActionMap&& actionMap)
 {
-    TActionMapId id = g_actionMapIdAllocator++;
-    g_actionMapStack.emplace_back(id, actionMap);
-    return id;
+    return g_actionMaps.Push(std::move(actionMap));
 }
 
 void RemoveActionMap(TActionMapId id)
 {
-    assert(g_actionMapStack.empty() == false);
-    for (
-        TActionMapStack::iterator it = g_actionMapStack.begin();
-        it != g_actionMapStack.end();
-        ++it)
-    {
-        if (it->first == id)
-        {
-            g_actionMapStack.erase(it);
-            return;
-        }
-    }
+    g_actionMaps.Remove(id);
+}
 
-    assert(false && "RemoveActionMap failed to find id!");
+const SInputState& GetInputState()
+{
+    return g_inputState;
 }
 
 uint32_t GetRelativeMouseState(Vec2<int>* pOutRawRel, Vec2<float>* pOutScreenRatioRel)
 {
     assert(pOutRawRel != nullptr);
     assert(pOutScreenRatioRel != nullptr);
-    int x, y;
-    int buttonState = SDL_GetRelativeMouseState(&x, &y);
-    pOutRawRel->x = x;
-    pOutRawRel->y = y;
-    pOutScreenRatioRel->x = float(x) / float(kScreenHalfWidth);
-    pOutScreenRatioRel->y = float(y) / float(kScreenHalfHeight);
-    return buttonState;
+    pOutRawRel->x = g_inputState.GetMouseRelX();
+    pOutRawRel->y = g_inputState.GetMouseRelY();
+    pOutScreenRatioRel->x = float(pOutRawRel->x) / float(kScreenHalfWidth);
+    pOutScreenRatioRel->y = float(pOutRawRel->y) / float(kScreenHalfHeight);
+    return g_inputState.GetMouseButtons();
 }
 
 } // platform namespace
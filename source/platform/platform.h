@@ -8,6 +8,8 @@
 #include <memory>
 #include <vector>
 
+#include "input.h"
+
 struct SDL_Window;
 struct SDL_Surface;
 
@@ -17,9 +19,15 @@ struct Vec2;
 namespace platform
 {
 
+void SetCommandLine(int argc, char* argv[]);
+bool HasCommandLineArg(const char* name); // name is matched exactly, e.g. "--record-per-frame"
+const char* GetCommandLineValue(const char* name); // returns value of "name=value" args, nullptr if not present
+
 ERunResult Initialize();
 ERunResult RunIO(const SFrameContext& frameContext, bool* pExit);
-void RegulateFrameLimit(const SFrameContext& frameContext);
+TTime::duration GetTargetFrameDuration(); // the recording's frame duration when replaying input
+bool IsReplayingInput(); // --input-replay, frames then advance by exactly GetReplayFrameDuration
+TTime::duration GetReplayFrameDuration(); // recorded duration of the frame the next RunIO replays
 ERunResult Shutdown();
 SDL_Window* GetWindow();
 
@@ -33,13 +41,24 @@ enum class EFileType : uint8_t
 struct SFile
 {
     size_t numBytes = 0;
-    std::unique_ptr<char[]> pData = nullptr;
+    const char* pBytes = nullptr; // file contents, points into pData or into the mounted pak archive
+    std::unique_ptr<char[]> pData = nullptr; // null when viewing the pak archive
 };
 
 // pOutArray is assumed to be the same size as numFiles
-// caller owns data allocation (hence, unique_ptr in SFile)
+// Files stored uncompressed in the mounted pak archive are returned as views without copying, compressed pak
+// entries are decoded and other files read from disk into a caller owned allocation (hence, unique_ptr in SFile)
 bool LoadFiles(const char* fileNames[], size_t numFiles, EFileType fileType, SFile* pOutArray);
 
+// Views returned by LoadFiles for pak files stay valid until the archive is unmounted
+bool MountPak(const char* fileName);
+void UnmountPak();
+bool FileExists(const char* fileName);
+
+// Writes to a temporary file next to fileName then renames it over fileName, so readers never observe a partial file.
+// Missing parent directories are created.
+bool WriteFileAtomic(const char* fileName, const void* pData, size_t numBytes);
+
 struct SImageSurfaceDeleter
 {
     void operator()(SDL_Surface* pSurface);
@@ -48,28 +67,14 @@ typedef std::unique_ptr<SDL_Surface, SImageSurfaceDeleter> ImageSurfacePtr;
 
 ImageSurfacePtr LoadImage(const char* filePath);
 
-enum class EKeyChange
-{
-    Pressed,
-    Released
-};
-
-typedef int32_t TKeyCode;
-typedef uint16_t TKeyMod;
-
-struct SActionHandler
-{
-    TKeyCode keyCode = { 0 };
-    TKeyMod requiredKeyMods = { 0 };
-    void (*callback)(TKeyCode keyCode, TKeyMod keyMod, EKeyChange keyChange);
-};
-
-typedef std::vector<SActionHandler> TActionMap;
-typedef uint8_t TActionMapId;
-
+// Maps are compiled into a lookup table on push and remove, not on dispatch
 TActionMapId PushActionMap(TActionMap&& actionMap);
 void RemoveActionMap(TActionMapId id);
 
+// Key events, held keys and mouse motion of the frame as gathered by RunIO
+const SInputState& GetInputState();
+
+// Mouse motion over the frame, sampled (or replayed) by RunIO
 uint32_t GetRelativeMouseState(Vec2<int>* pOutRawRel, Vec2<float>* pOutScreenRatioRel);
 
 } // platform namespace
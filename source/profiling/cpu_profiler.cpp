@@ -0,0 +1,342 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "cpu_profiler.h"
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sync/mutex.h"
+
+namespace profiling
+{
+
+using synchronization::kCacheLineSize;
+using synchronization::SLockGuard;
+using synchronization::SMutex;
+
+struct SProfileEvent
+{
+    const char* name;
+    TTime begin;
+    TTime end;
+};
+
+// Written by one thread only. bWriting brackets every write so a stopping capture can wait out writes in flight:
+// the writer sets it before checking g_bProfileCapturing and the capture clears the flag before checking bWriting,
+// both sequentially consistent, so at least one of them sees the other.
+struct alignas(kCacheLineSize) SThreadProfile
+{
+    std::unique_ptr<SProfileEvent[]> pEvents;
+    std::atomic<uint64_t> writeIndex = { 0 };
+    std::atomic<bool> bWriting = { false };
+    char name[kMaxProfileThreadName] = {};
+    uint32_t trackId = 0;
+};
+
+std::atomic<bool> g_bProfileCapturing = { false };
+
+static uint32_t g_eventsPerThread = 0; // power of two
+static SMutex g_profilesMutex;
+static std::vector<std::unique_ptr<SThreadProfile>> g_profiles; // guarded by g_profilesMutex
+static SThreadProfile g_gpuProfile;
+static std::atomic<uint32_t> g_generation = { 0 }; // bumped by every initialize so threads drop stale profiles
+static thread_local SThreadProfile* t_pProfile = nullptr;
+static thread_local uint32_t t_generation = 0;
+static thread_local char t_threadName[kMaxProfileThreadName] = {};
+
+// main thread
+static uint32_t g_requestedFrames = 0;
+static std::string g_capturePath;
+static uint32_t g_captureFramesLeft = 0;
+static std::vector<std::pair<TFrameId, TTime>> g_captureFrameStarts;
+static SProfileCaptureStats g_lastCaptureStats;
+static TTime g_captureStartTime;
+
+static SThreadProfile* CreateThreadProfile()
+{
+    std::unique_ptr<SThreadProfile> pProfile = std::make_unique<SThreadProfile>();
+    pProfile->pEvents = std::make_unique<SProfileEvent[]>(g_eventsPerThread);
+    memcpy(pProfile->name, t_threadName, sizeof(pProfile->name));
+
+    SLockGuard<SMutex> lock(g_profilesMutex);
+    pProfile->trackId = (uint32_t)g_profiles.size() + 1;
+    g_profiles.push_back(std::move(pProfile));
+    return g_profiles.back().get();
+}
+
+static void WriteEvent(SThreadProfile* pProfile, const char* name, TTime begin, TTime end)
+{
+    pProfile->bWriting.store(true, std::memory_order_seq_cst);
+    if (g_bProfileCapturing.load(std::memory_order_seq_cst))
+    {
+        const uint64_t writeIndex = pProfile->writeIndex.load(std::memory_order_relaxed);
+        pProfile->pEvents[writeIndex & (g_eventsPerThread - 1)] = SProfileEvent{ name, begin, end };
+        pProfile->writeIndex.store(writeIndex + 1, std::memory_order_release);
+    }
+
+    pProfile->bWriting.store(false, std::memory_order_release);
+}
+
+static void WaitForWriter(const SThreadProfile& profile)
+{
+    while (profile.bWriting.load(std::memory_order_seq_cst))
+    {
+        std::this_thread::yield();
+    }
+}
+
+static void WriteJsonString(FILE* pFile, const char* string)
+{
+    fputc('"', pFile);
+    for (const char* pChar = string; *pChar != '\0'; ++pChar)
+    {
+        if (*pChar == '"' || *pChar == '\\')
+        {
+            fputc('\\', pFile);
+        }
+
+        fputc((unsigned char)*pChar >= 0x20 ? *pChar : ' ', pFile);
+    }
+
+    fputc('"', pFile);
+}
+
+static double ToTraceMicroseconds(TTime time)
+{
+    return std::chrono::duration<double, std::micro>(time - g_captureStartTime).count();
+}
+
+static void WriteTrackName(FILE* pFile, uint32_t trackId, const char* name, bool* pbFirst)
+{
+    fprintf(pFile, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", *pbFirst ? "" : ",", trackId);
+    WriteJsonString(pFile, name);
+    fputs("}}", pFile);
+    *pbFirst = false;
+}
+
+static void WriteTrackEvents(FILE* pFile, const SThreadProfile& profile, uint32_t trackId, bool* pbFirst, SProfileCaptureStats* pStats)
+{
+    const uint64_t writeIndex = profile.writeIndex.load(std::memory_order_acquire);
+    const uint64_t firstIndex = writeIndex > g_eventsPerThread ? writeIndex - g_eventsPerThread : 0;
+    pStats->numEvents += writeIndex - firstIndex;
+    pStats->numDroppedEvents += firstIndex;
+    for (uint64_t i = firstIndex; i < writeIndex; ++i)
+    {
+        const SProfileEvent& event = profile.pEvents[i & (g_eventsPerThread - 1)];
+        fprintf(pFile, "%s\n{\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"name\":",
+            *pbFirst ? "" : ",",
+            trackId,
+            ToTraceMicroseconds(event.begin),
+            std::chrono::duration<double, std::micro>(event.end - event.begin).count());
+        WriteJsonString(pFile, event.name);
+        fputc('}', pFile);
+        *pbFirst = false;
+    }
+}
+
+// Capture stopped and every writer drained, g_profilesMutex held
+static bool WriteChromeTrace(const char* path, TTime captureEndTime, SProfileCaptureStats* pStats)
+{
+    FILE* pFile = fopen(path, "wb");
+    if (pFile == nullptr)
+    {
+        DiracError("[Profiler] failed to open %s", path);
+        return false;
+    }
+
+    static constexpr uint32_t kFramesTrackId = 0;
+    const uint32_t gpuTrackId = (uint32_t)g_profiles.size() + 1;
+    bool bFirst = true;
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", pFile);
+    WriteTrackName(pFile, kFramesTrackId, "Frames", &bFirst);
+    for (size_t i = 0; i < g_captureFrameStarts.size(); ++i)
+    {
+        const TTime frameEnd = i + 1 < g_captureFrameStarts.size() ? g_captureFrameStarts[i + 1].second : captureEndTime;
+        fprintf(pFile, ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"name\":\"Frame %llu\"}",
+            kFramesTrackId,
+            ToTraceMicroseconds(g_captureFrameStarts[i].second),
+            std::chrono::duration<double, std::micro>(frameEnd - g_captureFrameStarts[i].second).count(),
+            (unsigned long long)g_captureFrameStarts[i].first);
+    }
+
+    for (const std::unique_ptr<SThreadProfile>& pProfile : g_profiles)
+    {
+        char fallbackName[kMaxProfileThreadName];
+        snprintf(fallbackName, sizeof(fallbackName), "Thread %u", pProfile->trackId);
+        WriteTrackName(pFile, pProfile->trackId, pProfile->name[0] != '\0' ? pProfile->name : fallbackName, &bFirst);
+        WriteTrackEvents(pFile, *pProfile, pProfile->trackId, &bFirst, pStats);
+    }
+
+    WriteTrackName(pFile, gpuTrackId, "GPU", &bFirst);
+    WriteTrackEvents(pFile, g_gpuProfile, gpuTrackId, &bFirst, pStats);
+    fputs("\n]}\n", pFile);
+    const bool bWritten = ferror(pFile) == 0;
+    fclose(pFile);
+    pStats->numThreads = (uint32_t)g_profiles.size();
+    return bWritten;
+}
+
+static void StartCapture(TTime startTime)
+{
+    SLockGuard<SMutex> lock(g_profilesMutex);
+    for (std::unique_ptr<SThreadProfile>& pProfile : g_profiles)
+    {
+        pProfile->writeIndex.store(0, std::memory_order_relaxed);
+    }
+
+    g_gpuProfile.writeIndex.store(0, std::memory_order_relaxed);
+    g_captureFrameStarts.clear();
+    g_captureFrameStarts.reserve(g_requestedFrames);
+    g_captureFramesLeft = g_requestedFrames;
+    g_requestedFrames = 0;
+    g_captureStartTime = startTime;
+    g_bProfileCapturing.store(true, std::memory_order_seq_cst);
+}
+
+static void FinishCapture(TTime endTime)
+{
+    g_bProfileCapturing.store(false, std::memory_order_seq_cst);
+    SLockGuard<SMutex> lock(g_profilesMutex);
+    for (const std::unique_ptr<SThreadProfile>& pProfile : g_profiles)
+    {
+        WaitForWriter(*pProfile);
+    }
+
+    WaitForWriter(g_gpuProfile);
+
+    SProfileCaptureStats stats;
+    stats.numFrames = (uint32_t)g_captureFrameStarts.size();
+    if (WriteChromeTrace(g_capturePath.c_str(), endTime, &stats))
+    {
+        DiracLog(1, "[Profiler] captured %u frames on %u threads to %s: %llu events, %llu dropped",
+            stats.numFrames,
+            stats.numThreads,
+            g_capturePath.c_str(),
+            (unsigned long long)stats.numEvents,
+            (unsigned long long)stats.numDroppedEvents);
+    }
+
+    g_lastCaptureStats = stats;
+}
+
+bool InitializeCpuProfiler(const SCpuProfilerConfig& config)
+{
+    if (config.eventsPerThread == 0 || config.eventsPerThread > (1u << 31))
+    {
+        DiracError("[Profiler] invalid events per thread %u", config.eventsPerThread);
+        return false;
+    }
+
+    assert(g_eventsPerThread == 0 && "profiler is already initialized");
+    g_eventsPerThread = 1;
+    while (g_eventsPerThread < config.eventsPerThread)
+    {
+        g_eventsPerThread <<= 1;
+    }
+
+    g_gpuProfile.pEvents = std::make_unique<SProfileEvent[]>(g_eventsPerThread);
+    g_generation.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+void ShutdownCpuProfiler()
+{
+    g_bProfileCapturing.store(false, std::memory_order_seq_cst);
+    SLockGuard<SMutex> lock(g_profilesMutex);
+    for (const std::unique_ptr<SThreadProfile>& pProfile : g_profiles)
+    {
+        WaitForWriter(*pProfile);
+    }
+
+    g_profiles.clear(); // threads still pointing at theirs recreate it after the next initialize
+    g_gpuProfile.pEvents.reset();
+    g_gpuProfile.writeIndex.store(0, std::memory_order_relaxed);
+    g_eventsPerThread = 0;
+    g_requestedFrames = 0;
+    g_captureFramesLeft = 0;
+}
+
+void SetProfileThreadName(const char* name)
+{
+    snprintf(t_threadName, sizeof(t_threadName), "%s", name);
+    if (t_pProfile != nullptr && t_generation == g_generation.load(std::memory_order_acquire))
+    {
+        SLockGuard<SMutex> lock(g_profilesMutex);
+        memcpy(t_pProfile->name, t_threadName, sizeof(t_threadName));
+    }
+}
+
+bool RequestCpuCapture(uint32_t numFrames, const char* path)
+{
+    assert(g_eventsPerThread != 0 && "profiler isn't initialized");
+    if (numFrames == 0 || path == nullptr || g_requestedFrames != 0 || IsCpuCaptureActive())
+        return false;
+
+    g_requestedFrames = numFrames;
+    g_capturePath = path;
+    return true;
+}
+
+bool IsCpuCaptureActive()
+{
+    return g_bProfileCapturing.load(std::memory_order_relaxed);
+}
+
+void GetLastCaptureStats(SProfileCaptureStats* pOutStats)
+{
+    assert(pOutStats != nullptr);
+    *pOutStats = g_lastCaptureStats;
+}
+
+void BeginProfileFrame(TFrameId frameId)
+{
+    if (g_eventsPerThread == 0)
+        return;
+
+    const TTime now = TSteadyClock::now();
+    if (IsCpuCaptureActive() && --g_captureFramesLeft == 0)
+    {
+        FinishCapture(now);
+    }
+
+    if (!IsCpuCaptureActive() && g_requestedFrames != 0)
+    {
+        StartCapture(now);
+    }
+
+    if (IsCpuCaptureActive())
+    {
+        g_captureFrameStarts.emplace_back(frameId, now);
+    }
+}
+
+void RecordGpuProfileEvent(const char* name, TTime begin, TTime end)
+{
+    if (g_bProfileCapturing.load(std::memory_order_relaxed))
+    {
+        WriteEvent(&g_gpuProfile, name, begin, end);
+    }
+}
+
+void RecordProfileEvent(const char* name, TTime begin, TTime end)
+{
+    if (g_eventsPerThread == 0)
+        return;
+
+    const uint32_t generation = g_generation.load(std::memory_order_acquire);
+    if (t_generation != generation)
+    {
+        t_pProfile = CreateThreadProfile();
+        t_generation = generation;
+    }
+
+    WriteEvent(t_pProfile, name, begin, end);
+}
+
+} // profiling namespace
@@ -0,0 +1,107 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+#include <atomic>
+
+// Set to 0 to compile every PROFILE_SCOPE out
+#if !defined(CPU_PROFILING)
+#define CPU_PROFILING 1
+#endif
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if CPU_PROFILING
+#define PROFILE_SCOPE(name) profiling::SProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
+#else
+#define PROFILE_SCOPE(name) do { } while (0)
+#define PROFILE_FUNCTION() do { } while (0)
+#endif
+
+namespace profiling
+{
+
+/////////////////////////////////////////////////////////
+// CPU profiler
+//
+// PROFILE_SCOPE records a named begin/end pair into a ring buffer owned by the calling thread, so recording takes no
+// locks and threads never share a cache line. Outside of a capture a scope costs one relaxed load. Captures are
+// requested for a number of frames, start at the next BeginProfileFrame and are written as Chrome trace event JSON,
+// which chrome://tracing and the Perfetto UI both open. GPU scopes read back by the renderer are merged in on their
+// own track, aligned to the CPU submission of their frame since the clocks aren't calibrated against each other.
+//
+// Names must be string literals (or otherwise outlive the capture). A scope spanning a job wait that parks its fiber
+// is attributed to the thread it ends on. A ring that wraps during a capture keeps the newest events.
+
+static constexpr uint32_t kDefaultProfileEventsPerThread = 64 * 1024;
+static constexpr size_t kMaxProfileThreadName = 32;
+
+struct SCpuProfilerConfig
+{
+    uint32_t eventsPerThread = kDefaultProfileEventsPerThread; // rounded up to a power of two
+};
+
+struct SProfileCaptureStats
+{
+    uint32_t numFrames = 0;
+    uint32_t numThreads = 0;
+    uint64_t numEvents = 0;
+    uint64_t numDroppedEvents = 0; // overwritten by a ring that wrapped
+};
+
+bool InitializeCpuProfiler(const SCpuProfilerConfig& config);
+void ShutdownCpuProfiler(); // any capture in progress is discarded
+
+void SetProfileThreadName(const char* name); // copied, shown as the thread's track name
+
+// The capture starts at the next BeginProfileFrame and is written to path once numFrames have completed.
+// Returns false if a capture is already requested or running.
+bool RequestCpuCapture(uint32_t numFrames, const char* path);
+bool IsCpuCaptureActive();
+void GetLastCaptureStats(SProfileCaptureStats* pOutStats);
+
+// Main thread, once at the top of every frame. Starts and finishes captures and marks frame boundaries.
+void BeginProfileFrame(TFrameId frameId);
+
+// Single producer, the render thread. Dropped outside of a capture.
+void RecordGpuProfileEvent(const char* name, TTime begin, TTime end);
+
+void RecordProfileEvent(const char* name, TTime begin, TTime end);
+
+extern std::atomic<bool> g_bProfileCapturing;
+
+struct SProfileScope
+{
+    explicit SProfileScope(const char* name)
+        : m_name(name)
+        , m_bActive(g_bProfileCapturing.load(std::memory_order_relaxed))
+    {
+        if (m_bActive)
+        {
+            m_begin = TSteadyClock::now();
+        }
+    }
+
+    ~SProfileScope()
+    {
+        if (m_bActive)
+        {
+            RecordProfileEvent(m_name, m_begin, TSteadyClock::now());
+        }
+    }
+
+    SProfileScope(const SProfileScope&) = delete;
+    SProfileScope& operator=(const SProfileScope&) = delete;
+
+private:
+    const char* m_name;
+    TTime m_begin;
+    bool m_bActive;
+};
+
+} // profiling namespace
@@ -0,0 +1,438 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "metrics.h"
+
+#include <iterator>
+
+namespace profiling
+{
+
+static constexpr uint32_t kSubBucketCount = 1u << kHistogramSubBucketBits;
+
+static SMetricsRegistry g_metrics;
+
+const char* ToString(EMetricKind kind)
+{
+    switch (kind)
+    {
+    case EMetricKind::Counter: return "counter";
+    case EMetricKind::Gauge: return "gauge";
+    case EMetricKind::Histogram: return "histogram";
+    default: return "unknown";
+    }
+}
+
+static uint32_t MostSignificantBit(uint64_t value)
+{
+    uint32_t bit = 0;
+    for (uint32_t shift = 32; shift > 0; shift >>= 1)
+    {
+        if ((value >> shift) != 0)
+        {
+            value >>= shift;
+            bit += shift;
+        }
+    }
+
+    return bit;
+}
+
+/////////////////////////////////////////////////////////
+// SHistogram
+
+uint32_t SHistogram::GetBucketIndex(uint64_t value)
+{
+    if (value < kSubBucketCount)
+        return (uint32_t)value;
+
+    const uint32_t exponent = MostSignificantBit(value) - kHistogramSubBucketBits;
+    return kSubBucketCount + exponent * kSubBucketCount + (uint32_t)((value >> exponent) - kSubBucketCount);
+}
+
+uint64_t SHistogram::GetBucketUpperBound(uint32_t index)
+{
+    if (index < kSubBucketCount)
+        return index;
+
+    const uint32_t exponent = (index - kSubBucketCount) / kSubBucketCount;
+    const uint64_t subBucket = (index - kSubBucketCount) % kSubBucketCount + kSubBucketCount;
+    return ((subBucket + 1) << exponent) - 1;
+}
+
+bool SHistogram::Initialize(uint64_t maxValue, uint32_t numSlices)
+{
+    if (numSlices == 0 || numSlices > kMaxMetricSlices || maxValue == 0)
+        return false;
+
+    m_numSlices = numSlices;
+    m_numBuckets = GetBucketIndex(maxValue) + 1;
+    m_pSlices = std::make_unique<SSlice[]>(numSlices);
+    for (uint32_t i = 0; i < numSlices; ++i)
+    {
+        m_pSlices[i].pCounts = std::make_unique<std::atomic<uint32_t>[]>(m_numBuckets);
+        for (uint32_t bucket = 0; bucket < m_numBuckets; ++bucket)
+        {
+            m_pSlices[i].pCounts[bucket].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    m_currentSlice.store(0, std::memory_order_release);
+    return true;
+}
+
+void SHistogram::Record(uint64_t value)
+{
+    assert(m_pSlices != nullptr);
+    SSlice& slice = m_pSlices[m_currentSlice.load(std::memory_order_acquire)];
+    slice.pCounts[std::min(GetBucketIndex(value), m_numBuckets - 1)].fetch_add(1, std::memory_order_relaxed);
+    slice.count.fetch_add(1, std::memory_order_relaxed);
+    slice.sum.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t max = slice.max.load(std::memory_order_relaxed);
+    while (value > max && !slice.max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+void SHistogram::RecordDuration(TTime begin, TTime end)
+{
+    Record(end > begin ? (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() : 0);
+}
+
+void SHistogram::Rotate()
+{
+    const uint32_t next = (m_currentSlice.load(std::memory_order_relaxed) + 1) % m_numSlices;
+    SSlice& slice = m_pSlices[next];
+    for (uint32_t bucket = 0; bucket < m_numBuckets; ++bucket)
+    {
+        slice.pCounts[bucket].store(0, std::memory_order_relaxed);
+    }
+
+    slice.count.store(0, std::memory_order_relaxed);
+    slice.sum.store(0, std::memory_order_relaxed);
+    slice.max.store(0, std::memory_order_relaxed);
+    m_currentSlice.store(next, std::memory_order_release);
+}
+
+void SHistogram::GetSummary(SHistogramSummary* pOutSummary) const
+{
+    assert(pOutSummary != nullptr);
+    *pOutSummary = SHistogramSummary();
+
+    std::vector<uint64_t> counts(m_numBuckets, 0);
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < m_numSlices; ++i)
+    {
+        const SSlice& slice = m_pSlices[i];
+        for (uint32_t bucket = 0; bucket < m_numBuckets; ++bucket)
+        {
+            counts[bucket] += slice.pCounts[bucket].load(std::memory_order_relaxed);
+        }
+
+        pOutSummary->count += slice.count.load(std::memory_order_relaxed);
+        pOutSummary->max = std::max(pOutSummary->max, slice.max.load(std::memory_order_relaxed));
+        sum += slice.sum.load(std::memory_order_relaxed);
+    }
+
+    if (pOutSummary->count == 0)
+        return;
+
+    pOutSummary->mean = (double)sum / (double)pOutSummary->count;
+
+    // Walk the buckets once, each percentile is the first bucket whose cumulative count reaches its rank
+    const double percentiles[] = { 0.50, 0.95, 0.99 };
+    uint64_t* pResults[] = { &pOutSummary->p50, &pOutSummary->p95, &pOutSummary->p99 };
+    uint64_t cumulative = 0;
+    size_t next = 0;
+    for (uint32_t bucket = 0; bucket < m_numBuckets && next < std::size(percentiles); ++bucket)
+    {
+        cumulative += counts[bucket];
+        while (next < std::size(percentiles) && (double)cumulative >= percentiles[next] * (double)pOutSummary->count)
+        {
+            *pResults[next++] = std::min(GetBucketUpperBound(bucket), pOutSummary->max);
+        }
+    }
+
+    for (; next < std::size(percentiles); ++next) // counts raced with a rotation, fall back to the max
+    {
+        *pResults[next] = pOutSummary->max;
+    }
+}
+
+/////////////////////////////////////////////////////////
+// SMetricsRegistry
+
+bool SMetricsRegistry::Initialize(const SMetricsConfig& config, TTime now)
+{
+    if (config.numSlices < 2 || config.numSlices > kMaxMetricSlices || config.sliceMs == 0)
+    {
+        DiracError("[Metrics] invalid window of %u slices of %u ms", config.numSlices, config.sliceMs);
+        return false;
+    }
+
+    assert(m_metrics.empty() && "metrics are already initialized");
+    m_config = config;
+    m_config.dumpPath = nullptr;
+    m_dumpPath = config.dumpPath != nullptr ? config.dumpPath : "";
+    m_startTime = now;
+    m_sliceStartTime = now;
+    m_lastDumpTime = now;
+    m_currentSlice = 0;
+
+    if (!m_dumpPath.empty())
+    {
+        const size_t extension = m_dumpPath.rfind('.');
+        m_bDumpJson = extension != std::string::npos && m_dumpPath.compare(extension, std::string::npos, ".json") == 0;
+        FILE* pFile = fopen(m_dumpPath.c_str(), "wb"); // every run starts a new file
+        if (pFile == nullptr)
+        {
+            DiracError("[Metrics] failed to open %s, metrics won't be dumped", m_dumpPath.c_str());
+            m_dumpPath.clear();
+        }
+        else
+        {
+            if (!m_bDumpJson)
+            {
+                fputs("time_s,metric,kind,unit,count,mean,p50,p95,p99,max,value\n", pFile);
+            }
+
+            fclose(pFile);
+        }
+    }
+
+    return true;
+}
+
+void SMetricsRegistry::Shutdown()
+{
+    if (!m_dumpPath.empty())
+    {
+        Dump(TSteadyClock::now());
+    }
+
+    m_metrics.clear();
+    m_dumpPath.clear();
+}
+
+SMetricsRegistry::SMetric* SMetricsRegistry::FindOrAdd(const char* name, const char* unit, EMetricKind kind, bool* pbAdded)
+{
+    assert(name != nullptr && unit != nullptr);
+    *pbAdded = false;
+    for (const std::unique_ptr<SMetric>& pMetric : m_metrics)
+    {
+        if (pMetric->name == name)
+        {
+            if (pMetric->kind == kind)
+                return pMetric.get();
+
+            DiracError("[Metrics] %s is already registered as a %s", name, ToString(pMetric->kind));
+            return nullptr;
+        }
+    }
+
+    std::unique_ptr<SMetric> pMetric = std::make_unique<SMetric>();
+    pMetric->name = name;
+    pMetric->unit = unit;
+    pMetric->kind = kind;
+    m_metrics.push_back(std::move(pMetric));
+    *pbAdded = true;
+    return m_metrics.back().get();
+}
+
+SCounter* SMetricsRegistry::RegisterCounter(const char* name, const char* unit)
+{
+    bool bAdded = false;
+    SMetric* pMetric = FindOrAdd(name, unit, EMetricKind::Counter, &bAdded);
+    if (pMetric == nullptr)
+        return nullptr;
+
+    if (bAdded)
+    {
+        pMetric->pCounter = std::make_unique<SCounter>();
+    }
+
+    return pMetric->pCounter.get();
+}
+
+SGauge* SMetricsRegistry::RegisterGauge(const char* name, const char* unit)
+{
+    bool bAdded = false;
+    SMetric* pMetric = FindOrAdd(name, unit, EMetricKind::Gauge, &bAdded);
+    if (pMetric == nullptr)
+        return nullptr;
+
+    if (bAdded)
+    {
+        pMetric->pGauge = std::make_unique<SGauge>();
+    }
+
+    return pMetric->pGauge.get();
+}
+
+SHistogram* SMetricsRegistry::RegisterHistogram(const char* name, const char* unit, uint64_t maxValue)
+{
+    bool bAdded = false;
+    SMetric* pMetric = FindOrAdd(name, unit, EMetricKind::Histogram, &bAdded);
+    if (pMetric == nullptr)
+        return nullptr;
+
+    if (bAdded)
+    {
+        pMetric->pHistogram = std::make_unique<SHistogram>();
+        const bool bInitialized = pMetric->pHistogram->Initialize(maxValue, m_config.numSlices);
+        assert(bInitialized && "invalid histogram range");
+        (void)bInitialized;
+    }
+
+    return pMetric->pHistogram.get();
+}
+
+void SMetricsRegistry::Update(TTime now)
+{
+    if (now - m_sliceStartTime >= std::chrono::milliseconds(m_config.sliceMs))
+    {
+        m_currentSlice = (m_currentSlice + 1) % m_config.numSlices;
+        m_sliceStartTime = now; // a long stall starts a single new slice rather than catching up
+        for (const std::unique_ptr<SMetric>& pMetric : m_metrics)
+        {
+            if (pMetric->kind == EMetricKind::Histogram)
+            {
+                pMetric->pHistogram->Rotate();
+            }
+            else if (pMetric->kind == EMetricKind::Counter)
+            {
+                pMetric->sliceStartValues[m_currentSlice] = pMetric->pCounter->Get();
+            }
+        }
+    }
+
+    if (!m_dumpPath.empty() && now - m_lastDumpTime >= std::chrono::milliseconds(m_config.dumpIntervalMs))
+    {
+        Dump(now);
+    }
+}
+
+uint64_t SMetricsRegistry::GetCounterWindowDelta(const SCounter* pCounter) const
+{
+    for (const std::unique_ptr<SMetric>& pMetric : m_metrics)
+    {
+        if (pMetric->pCounter.get() == pCounter)
+            return pCounter->Get() - pMetric->sliceStartValues[(m_currentSlice + 1) % m_config.numSlices];
+    }
+
+    return 0;
+}
+
+void SMetricsRegistry::WriteDump(FILE* pFile, double timeSecs)
+{
+    if (m_bDumpJson)
+    {
+        fprintf(pFile, "{\"time_s\":%.3f,\"metrics\":[", timeSecs);
+    }
+
+    for (size_t i = 0; i < m_metrics.size(); ++i)
+    {
+        const SMetric& metric = *m_metrics[i];
+        if (m_bDumpJson)
+        {
+            fprintf(pFile, "%s{\"name\":\"%s\",\"kind\":\"%s\",\"unit\":\"%s\"", i == 0 ? "" : ",", metric.name.c_str(), ToString(metric.kind), metric.unit.c_str());
+        }
+        else
+        {
+            fprintf(pFile, "%.3f,%s,%s,%s,", timeSecs, metric.name.c_str(), ToString(metric.kind), metric.unit.c_str());
+        }
+
+        switch (metric.kind)
+        {
+        case EMetricKind::Histogram:
+        {
+            SHistogramSummary summary;
+            metric.pHistogram->GetSummary(&summary);
+            fprintf(pFile,
+                m_bDumpJson ? ",\"count\":%llu,\"mean\":%.3f,\"p50\":%llu,\"p95\":%llu,\"p99\":%llu,\"max\":%llu}" : "%llu,%.3f,%llu,%llu,%llu,%llu,\n",
+                (unsigned long long)summary.count,
+                summary.mean,
+                (unsigned long long)summary.p50,
+                (unsigned long long)summary.p95,
+                (unsigned long long)summary.p99,
+                (unsigned long long)summary.max);
+            break;
+        }
+        case EMetricKind::Counter:
+            fprintf(pFile,
+                m_bDumpJson ? ",\"count\":%llu,\"value\":%llu}" : "%llu,,,,,,%llu\n",
+                (unsigned long long)GetCounterWindowDelta(metric.pCounter.get()),
+                (unsigned long long)metric.pCounter->Get());
+            break;
+        default:
+            fprintf(pFile, m_bDumpJson ? ",\"value\":%g}" : ",,,,,,%g\n", metric.pGauge->Get());
+            break;
+        }
+    }
+
+    if (m_bDumpJson)
+    {
+        fputs("]}\n", pFile);
+    }
+}
+
+bool SMetricsRegistry::Dump(TTime now)
+{
+    m_lastDumpTime = now;
+    if (m_dumpPath.empty())
+        return false;
+
+    FILE* pFile = fopen(m_dumpPath.c_str(), "ab");
+    if (pFile == nullptr)
+    {
+        DiracError("[Metrics] failed to append to %s", m_dumpPath.c_str());
+        return false;
+    }
+
+    WriteDump(pFile, TSeconds(now - m_startTime).count());
+    const bool bWritten = ferror(pFile) == 0;
+    fclose(pFile);
+    return bWritten;
+}
+
+void SMetricsRegistry::Log() const
+{
+    for (const std::unique_ptr<SMetric>& pMetric : m_metrics)
+    {
+        const char* name = pMetric->name.c_str();
+        const char* unit = pMetric->unit.c_str();
+        if (pMetric->kind == EMetricKind::Histogram)
+        {
+            SHistogramSummary summary;
+            pMetric->pHistogram->GetSummary(&summary);
+            DiracLog(1, "[Metrics] %s (%s): %llu samples, mean %.1f p50 %llu p95 %llu p99 %llu max %llu",
+                name,
+                unit,
+                (unsigned long long)summary.count,
+                summary.mean,
+                (unsigned long long)summary.p50,
+                (unsigned long long)summary.p95,
+                (unsigned long long)summary.p99,
+                (unsigned long long)summary.max);
+        }
+        else if (pMetric->kind == EMetricKind::Counter)
+        {
+            DiracLog(1, "[Metrics] %s (%s): %llu, %llu in the window", name, unit, (unsigned long long)pMetric->pCounter->Get(), (unsigned long long)GetCounterWindowDelta(pMetric->pCounter.get()));
+        }
+        else
+        {
+            DiracLog(1, "[Metrics] %s (%s): %g", name, unit, pMetric->pGauge->Get());
+        }
+    }
+}
+
+SMetricsRegistry& GetMetrics()
+{
+    return g_metrics;
+}
+
+} // profiling namespace
@@ -0,0 +1,181 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace profiling
+{
+
+/////////////////////////////////////////////////////////
+// Metrics
+//
+// Named counters, gauges and histograms for production visibility into distributions rather than single samples.
+// Recording is a few relaxed atomics and safe from any thread, registration and the once per frame Update belong to
+// the main thread. Results cover a rolling window of slices: Update starts a new slice every sliceMs and the oldest
+// one falls out, so a window reports the last (numSlices - 1) slices plus the current partial one. With a dump path
+// every metric's window is appended to a CSV file (or JSON lines when the path ends in .json) every dumpIntervalMs.
+// Names and units are written unescaped, keep them to identifiers.
+
+static constexpr uint32_t kHistogramSubBucketBits = 6; // percentiles within 1/64 (~1.6%) of the recorded values
+static constexpr uint32_t kMaxMetricSlices = 16;
+static constexpr uint32_t kDefaultMetricSliceMs = 1000;
+static constexpr uint32_t kDefaultMetricSlices = 6;
+static constexpr uint32_t kDefaultMetricDumpIntervalMs = 10000;
+static constexpr uint64_t kMaxMetricDurationUs = 10 * 1000 * 1000; // durations are recorded in microseconds
+
+enum class EMetricKind : uint8_t
+{
+    Counter,
+    Gauge,
+    Histogram,
+    COUNT
+};
+
+const char* ToString(EMetricKind kind);
+
+struct SCounter
+{
+    void Add(uint64_t amount = 1) { m_value.fetch_add(amount, std::memory_order_relaxed); }
+    uint64_t Get() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> m_value = { 0 };
+};
+
+struct SGauge
+{
+    void Set(double value) { m_value.store(value, std::memory_order_relaxed); }
+    double Get() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> m_value = { 0.0 };
+};
+
+struct SHistogramSummary
+{
+    uint64_t count = 0;
+    double mean = 0.0;
+    uint64_t p50 = 0;
+    uint64_t p95 = 0;
+    uint64_t p99 = 0;
+    uint64_t max = 0;
+};
+
+/////////////////////////////////////////////////////////
+// SHistogram
+//
+// HDR histogram style buckets: values below 2^kHistogramSubBucketBits are counted exactly, above that every power of
+// two is split into 2^kHistogramSubBucketBits linear buckets. Memory is fixed by maxValue, larger values are clamped
+// into the last bucket but the reported max stays exact. A writer that stalls across a whole rotation may land its
+// sample in a slice that is being reset, which only ever loses that one sample.
+struct SHistogram
+{
+    bool Initialize(uint64_t maxValue, uint32_t numSlices);
+
+    void Record(uint64_t value);
+    void RecordDuration(TTime begin, TTime end); // microseconds
+
+    void Rotate(); // main thread, starts the next slice
+    void GetSummary(SHistogramSummary* pOutSummary) const; // over every slice in the window
+
+    static uint32_t GetBucketIndex(uint64_t value);
+    static uint64_t GetBucketUpperBound(uint32_t index); // largest value counted by the bucket
+
+private:
+    struct SSlice
+    {
+        std::unique_ptr<std::atomic<uint32_t>[]> pCounts;
+        std::atomic<uint64_t> count = { 0 };
+        std::atomic<uint64_t> sum = { 0 };
+        std::atomic<uint64_t> max = { 0 };
+    };
+
+    std::unique_ptr<SSlice[]> m_pSlices;
+    uint32_t m_numSlices = 0;
+    uint32_t m_numBuckets = 0;
+    std::atomic<uint32_t> m_currentSlice = { 0 };
+};
+
+/////////////////////////////////////////////////////////
+// SMetricsRegistry
+
+struct SMetricsConfig
+{
+    uint32_t sliceMs = kDefaultMetricSliceMs;
+    uint32_t numSlices = kDefaultMetricSlices;
+    const char* dumpPath = nullptr; // copied
+    uint32_t dumpIntervalMs = kDefaultMetricDumpIntervalMs;
+};
+
+struct SMetricsRegistry
+{
+    bool Initialize(const SMetricsConfig& config, TTime now);
+    void Shutdown(); // writes a last dump, pointers handed out are invalid afterwards
+
+    // Registering an existing name returns the existing metric, nullptr if it is of another kind
+    SCounter* RegisterCounter(const char* name, const char* unit);
+    SGauge* RegisterGauge(const char* name, const char* unit);
+    SHistogram* RegisterHistogram(const char* name, const char* unit, uint64_t maxValue);
+
+    void Update(TTime now); // main thread, once per frame
+    bool Dump(TTime now); // appends every metric's window to the dump file
+    void Log() const;
+
+    uint64_t GetCounterWindowDelta(const SCounter* pCounter) const; // growth over the window
+
+private:
+    struct SMetric
+    {
+        std::string name;
+        std::string unit;
+        EMetricKind kind = EMetricKind::COUNT;
+        std::unique_ptr<SCounter> pCounter;
+        std::unique_ptr<SGauge> pGauge;
+        std::unique_ptr<SHistogram> pHistogram;
+        uint64_t sliceStartValues[kMaxMetricSlices] = {}; // counters, the value as each slice started
+    };
+
+    SMetric* FindOrAdd(const char* name, const char* unit, EMetricKind kind, bool* pbAdded);
+    void WriteDump(FILE* pFile, double timeSecs);
+
+    std::vector<std::unique_ptr<SMetric>> m_metrics;
+    SMetricsConfig m_config;
+    std::string m_dumpPath;
+    bool m_bDumpJson = false;
+    TTime m_startTime;
+    TTime m_sliceStartTime;
+    TTime m_lastDumpTime;
+    uint32_t m_currentSlice = 0;
+};
+
+SMetricsRegistry& GetMetrics(); // the engine's registry
+
+// Records the lifetime of the scope into a duration histogram, does nothing for nullptr
+struct SScopedHistogramTimer
+{
+    explicit SScopedHistogramTimer(SHistogram* pHistogram) : m_pHistogram(pHistogram), m_begin(TSteadyClock::now()) {}
+    ~SScopedHistogramTimer()
+    {
+        if (m_pHistogram != nullptr)
+        {
+            m_pHistogram->RecordDuration(m_begin, TSteadyClock::now());
+        }
+    }
+
+    SScopedHistogramTimer(const SScopedHistogramTimer&) = delete;
+    SScopedHistogramTimer& operator=(const SScopedHistogramTimer&) = delete;
+
+private:
+    SHistogram* m_pHistogram;
+    TTime m_begin;
+};
+
+} // profiling namespace
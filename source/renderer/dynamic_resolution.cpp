@@ -0,0 +1,72 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "dynamic_resolution.h"
+
+#include <cmath>
+
+namespace renderer
+{
+
+float QuantizeRenderScale(const SDynamicResolutionConfig& config, float scale)
+{
+    assert(config.scaleStep > 0);
+    assert(config.minScale <= config.maxScale);
+    // round down so a requested drop is never undone by quantization
+    const float steps = std::floor((scale + 0.0001f) / config.scaleStep);
+    return std::min(std::max(steps * config.scaleStep, config.minScale), config.maxScale);
+}
+
+bool UpdateDynamicResolution(const SDynamicResolutionConfig& config, SDynamicResolutionState* pState, double frameMs)
+{
+    assert(pState != nullptr);
+    assert(config.budgetMs > 0);
+    if (frameMs <= 0)
+        return false;
+
+    if (pState->bHasSample)
+    {
+        pState->filteredFrameMs += (frameMs - pState->filteredFrameMs) * config.smoothing;
+    }
+    else
+    {
+        pState->filteredFrameMs = frameMs;
+        pState->bHasSample = true;
+    }
+
+    ++pState->framesSinceChange;
+    if (pState->framesSinceChange < config.cooldownFrames)
+        return false;
+
+    const double targetMs = config.budgetMs * config.targetFraction;
+    float newScale = pState->scale;
+    if (pState->filteredFrameMs > targetMs)
+    {
+        // cost is roughly proportional to pixel count, i.e. scale squared
+        const double ratio = std::sqrt(targetMs / pState->filteredFrameMs);
+        newScale = QuantizeRenderScale(config, float(pState->scale * ratio));
+        if (newScale >= pState->scale && pState->scale > config.minScale)
+        {
+            newScale = QuantizeRenderScale(config, pState->scale - config.scaleStep);
+        }
+    }
+    else if (pState->filteredFrameMs < config.budgetMs * config.raiseFraction)
+    {
+        newScale = QuantizeRenderScale(config, pState->scale + config.scaleStep);
+    }
+
+    if (newScale == pState->scale)
+        return false;
+
+    // Predict the new frame time so the next decision doesn't wait for the average to settle
+    const double pixelRatio = double(newScale * newScale) / double(pState->scale * pState->scale);
+    pState->filteredFrameMs *= pixelRatio;
+    pState->scale = newScale;
+    pState->framesSinceChange = 0;
+    return true;
+}
+
+} // renderer namespace
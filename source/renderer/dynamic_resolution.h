@@ -0,0 +1,42 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+namespace renderer
+{
+
+/////////////////////////////////////////////////////////
+// Dynamic resolution
+//
+// Picks the SDF pass render scale (per axis) from measured GPU frame times. The scale is quantized to
+// scaleStep so it only changes occasionally, every change re-records the static command buffers.
+
+struct SDynamicResolutionConfig
+{
+    float minScale = 0.5f;
+    float maxScale = 1.0f;
+    float scaleStep = 0.05f;
+    double budgetMs = 8.0; // frame time to hold, normally the platform frame duration
+    double targetFraction = 0.85; // aim below the budget to leave headroom for spikes
+    double raiseFraction = 0.7; // only scale up when comfortably under the budget
+    double smoothing = 0.1; // exponential moving average weight of new samples
+    uint32_t cooldownFrames = 8; // samples to wait after a change, results lag the GPU by a few frames
+};
+
+struct SDynamicResolutionState
+{
+    float scale = 1.0f;
+    double filteredFrameMs = 0;
+    uint32_t framesSinceChange = 0;
+    bool bHasSample = false;
+};
+
+float QuantizeRenderScale(const SDynamicResolutionConfig& config, float scale);
+
+// Feed one GPU frame time sample, returns true when pState->scale changed
+bool UpdateDynamicResolution(const SDynamicResolutionConfig& config, SDynamicResolutionState* pState, double frameMs);
+
+} // renderer namespace
@@ -0,0 +1,96 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "gpu_profiler.h"
+
+namespace renderer
+{
+
+const char* ToString(EGpuScope scope)
+{
+    switch (scope)
+    {
+    case EGpuScope::SceneUpload: return "SceneUpload";
+    case EGpuScope::SdfPass: return "SdfPass";
+    case EGpuScope::Upscale: return "Upscale";
+    case EGpuScope::Frame: return "Frame";
+    case EGpuScope::COUNT: break;
+    }
+
+    return "Unknown";
+}
+
+double TimestampDeltaMs(uint64_t beginTicks, uint64_t endTicks, uint32_t timestampValidBits, float timestampPeriodNs)
+{
+    assert(timestampValidBits > 0 && timestampValidBits <= 64);
+    const uint64_t mask = timestampValidBits == 64 ? UINT64_MAX : ((1ull << timestampValidBits) - 1);
+    const uint64_t deltaTicks = (endTicks - beginTicks) & mask;
+    return double(deltaTicks) * double(timestampPeriodNs) / 1000000.0;
+}
+
+void AddGpuScopeSample(SGpuStatsHistory* pHistory, EGpuScope scope, double ms)
+{
+    assert(pHistory != nullptr);
+    assert(scope < EGpuScope::COUNT);
+    const size_t scopeIndex = (size_t)scope;
+    uint32_t& nextSample = pHistory->scopeNextSample[scopeIndex];
+    pHistory->scopeSamples[scopeIndex][nextSample] = ms;
+    nextSample = (nextSample + 1) % kGpuStatsWindow;
+    pHistory->scopeSampleCounts[scopeIndex] = std::min<uint32_t>(pHistory->scopeSampleCounts[scopeIndex] + 1, kGpuStatsWindow);
+}
+
+void AddFragmentInvocationsSample(SGpuStatsHistory* pHistory, uint64_t invocations)
+{
+    assert(pHistory != nullptr);
+    pHistory->invocationSamples[pHistory->invocationNextSample] = double(invocations);
+    pHistory->invocationNextSample = (pHistory->invocationNextSample + 1) % kGpuStatsWindow;
+    pHistory->invocationSampleCount = std::min<uint32_t>(pHistory->invocationSampleCount + 1, kGpuStatsWindow);
+}
+
+void GetGpuFrameStats(const SGpuStatsHistory& history, SGpuFrameStats* pOutStats)
+{
+    assert(pOutStats != nullptr);
+    pOutStats->frameId = history.lastFrameId;
+
+    for (size_t i = 0; i < (size_t)EGpuScope::COUNT; ++i)
+    {
+        SGpuScopeStats& stats = pOutStats->scopes[i];
+        stats = SGpuScopeStats();
+        stats.sampleCount = history.scopeSampleCounts[i];
+        if (stats.sampleCount == 0)
+            continue;
+
+        const uint32_t lastSample = (history.scopeNextSample[i] + kGpuStatsWindow - 1) % kGpuStatsWindow;
+        stats.lastMs = history.scopeSamples[i][lastSample];
+
+        double sum = 0;
+        for (uint32_t j = 0; j < stats.sampleCount; ++j)
+        {
+            sum += history.scopeSamples[i][j];
+            stats.maxMs = std::max(stats.maxMs, history.scopeSamples[i][j]);
+        }
+
+        stats.averageMs = sum / stats.sampleCount;
+    }
+
+    pOutStats->fragmentShaderInvocations = 0;
+    pOutStats->averageFragmentShaderInvocations = 0;
+    if (history.invocationSampleCount > 0)
+    {
+        const uint32_t lastSample = (history.invocationNextSample + kGpuStatsWindow - 1) % kGpuStatsWindow;
+        pOutStats->fragmentShaderInvocations = uint64_t(history.invocationSamples[lastSample]);
+
+        double sum = 0;
+        for (uint32_t j = 0; j < history.invocationSampleCount; ++j)
+        {
+            sum += history.invocationSamples[j];
+        }
+
+        pOutStats->averageFragmentShaderInvocations = sum / history.invocationSampleCount;
+    }
+}
+
+} // renderer namespace
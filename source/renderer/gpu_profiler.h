@@ -0,0 +1,67 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+namespace renderer
+{
+
+/////////////////////////////////////////////////////////
+// GPU profiling
+//
+// Timestamp scopes are written by the renderer around each upload and pass and read back once the
+// swap chain image's previous submission has retired, so reading never stalls the CPU.
+// Results lag the CPU by the number of swap chain images.
+
+enum class EGpuScope : uint8_t
+{
+    SceneUpload, // shape transform upload, only present on frames where the scene changed
+    SdfPass, // SDF raymarch render pass at the dynamic render scale
+    Upscale, // bilinear upscale of the SDF pass to the swap chain image
+    Frame, // first recorded scope begin -> last recorded scope end
+    COUNT
+};
+
+const char* ToString(EGpuScope scope);
+
+static constexpr size_t kGpuStatsWindow = 64; // frames averaged in SGpuScopeStats::averageMs
+
+struct SGpuScopeStats
+{
+    double lastMs = 0;
+    double averageMs = 0;
+    double maxMs = 0; // over the window
+    uint32_t sampleCount = 0; // samples currently in the window
+};
+
+struct SGpuFrameStats
+{
+    TFrameId frameId = 0; // CPU frame the latest results belong to
+    SGpuScopeStats scopes[(size_t)EGpuScope::COUNT];
+    bool bPipelineStatistics = false; // false when the device or command line didn't enable them
+    uint64_t fragmentShaderInvocations = 0;
+    double averageFragmentShaderInvocations = 0;
+};
+
+// Rolling window of per scope samples
+struct SGpuStatsHistory
+{
+    double scopeSamples[(size_t)EGpuScope::COUNT][kGpuStatsWindow] = { { 0 } };
+    uint32_t scopeSampleCounts[(size_t)EGpuScope::COUNT] = { 0 };
+    uint32_t scopeNextSample[(size_t)EGpuScope::COUNT] = { 0 };
+    double invocationSamples[kGpuStatsWindow] = { 0 };
+    uint32_t invocationSampleCount = 0;
+    uint32_t invocationNextSample = 0;
+    TFrameId lastFrameId = 0;
+};
+
+// Converts a pair of raw timestamps to milliseconds, handling counters narrower than 64 bits wrapping
+double TimestampDeltaMs(uint64_t beginTicks, uint64_t endTicks, uint32_t timestampValidBits, float timestampPeriodNs);
+
+void AddGpuScopeSample(SGpuStatsHistory* pHistory, EGpuScope scope, double ms);
+void AddFragmentInvocationsSample(SGpuStatsHistory* pHistory, uint64_t invocations);
+void GetGpuFrameStats(const SGpuStatsHistory& history, SGpuFrameStats* pOutStats);
+
+} // renderer namespace
@@ -0,0 +1,165 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "pipeline_cache.h"
+
+namespace renderer
+{
+
+/////////////////////////////////////////////////////////
+// Constants
+
+static constexpr uint32_t kPipelineCacheMagic = 0x43505344; // "DSPC"
+static constexpr uint32_t kPipelineCacheVersion = 1;
+
+// Leading bytes of every driver blob, see VkPipelineCacheHeaderVersionOne
+static constexpr size_t kDriverHeaderSize = 16 + kPipelineCacheUUIDSize;
+static constexpr uint32_t kDriverHeaderVersionOne = 1; // VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+
+/////////////////////////////////////////////////////////
+// Functions
+
+static uint64_t HashBytes(const void* pData, size_t size)
+{
+    // FNV-1a
+    const uint8_t* pBytes = (const uint8_t*)pData;
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= pBytes[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+static uint32_t ReadLittleEndian32(const char* pData)
+{
+    const uint8_t* pBytes = (const uint8_t*)pData;
+    return uint32_t(pBytes[0]) | (uint32_t(pBytes[1]) << 8) | (uint32_t(pBytes[2]) << 16) | (uint32_t(pBytes[3]) << 24);
+}
+
+static bool KeysEqual(const SPipelineCacheKey& a, const SPipelineCacheKey& b)
+{
+    return a.vendorId == b.vendorId
+        && a.deviceId == b.deviceId
+        && a.driverVersion == b.driverVersion
+        && memcmp(a.pipelineCacheUUID, b.pipelineCacheUUID, kPipelineCacheUUIDSize) == 0;
+}
+
+const char* ToString(EPipelineCacheValidation validation)
+{
+    switch (validation)
+    {
+    case EPipelineCacheValidation::Valid: return "Valid";
+    case EPipelineCacheValidation::TooSmall: return "TooSmall";
+    case EPipelineCacheValidation::BadMagic: return "BadMagic";
+    case EPipelineCacheValidation::BadVersion: return "BadVersion";
+    case EPipelineCacheValidation::KeyMismatch: return "KeyMismatch";
+    case EPipelineCacheValidation::SizeMismatch: return "SizeMismatch";
+    case EPipelineCacheValidation::HashMismatch: return "HashMismatch";
+    case EPipelineCacheValidation::BadDriverHeader: return "BadDriverHeader";
+    }
+
+    return "Unknown";
+}
+
+bool MakePipelineCacheFileName(const char* directory, const SPipelineCacheKey& key, char* pOutFileName, size_t outFileNameSize)
+{
+    assert(directory != nullptr);
+    assert(pOutFileName != nullptr);
+
+    char uuid[kPipelineCacheUUIDSize * 2 + 1];
+    for (size_t i = 0; i < kPipelineCacheUUIDSize; ++i)
+    {
+        snprintf(uuid + i * 2, 3, "%02x", key.pipelineCacheUUID[i]);
+    }
+
+    const int length = snprintf(
+        pOutFileName,
+        outFileNameSize,
+        "%s/pipeline_cache_%04x_%04x_%08x_%s.bin",
+        directory,
+        key.vendorId,
+        key.deviceId,
+        key.driverVersion,
+        uuid);
+
+    return length > 0 && (size_t)length < outFileNameSize;
+}
+
+void BuildPipelineCacheFile(const SPipelineCacheKey& key, const void* pData, size_t dataSize, std::vector<char>* pOutFile)
+{
+    assert(pOutFile != nullptr);
+    assert(pData != nullptr || dataSize == 0);
+
+    SPipelineCacheFileHeader header;
+    header.magic = kPipelineCacheMagic;
+    header.version = kPipelineCacheVersion;
+    header.key = key;
+    header.dataSize = dataSize;
+    header.dataHash = HashBytes(pData, dataSize);
+
+    pOutFile->resize(sizeof(SPipelineCacheFileHeader) + dataSize);
+    memcpy(pOutFile->data(), &header, sizeof(SPipelineCacheFileHeader));
+    if (dataSize > 0)
+    {
+        memcpy(pOutFile->data() + sizeof(SPipelineCacheFileHeader), pData, dataSize);
+    }
+}
+
+EPipelineCacheValidation ValidatePipelineCacheFile(
+    const char* pFileData,
+    size_t fileSize,
+    const SPipelineCacheKey& key,
+    const char** ppOutData,
+    size_t* pOutDataSize)
+{
+    assert(ppOutData != nullptr);
+    assert(pOutDataSize != nullptr);
+    *ppOutData = nullptr;
+    *pOutDataSize = 0;
+
+    if (pFileData == nullptr || fileSize < sizeof(SPipelineCacheFileHeader))
+        return EPipelineCacheValidation::TooSmall;
+
+    SPipelineCacheFileHeader header;
+    memcpy(&header, pFileData, sizeof(SPipelineCacheFileHeader));
+
+    if (header.magic != kPipelineCacheMagic)
+        return EPipelineCacheValidation::BadMagic;
+
+    if (header.version != kPipelineCacheVersion)
+        return EPipelineCacheValidation::BadVersion;
+
+    if (!KeysEqual(header.key, key))
+        return EPipelineCacheValidation::KeyMismatch;
+
+    const size_t dataSize = fileSize - sizeof(SPipelineCacheFileHeader);
+    if (header.dataSize != dataSize)
+        return EPipelineCacheValidation::SizeMismatch;
+
+    const char* pData = pFileData + sizeof(SPipelineCacheFileHeader);
+    if (header.dataHash != HashBytes(pData, dataSize))
+        return EPipelineCacheValidation::HashMismatch;
+
+    // The driver validates its own header too, but a mismatch there is silently treated as an empty cache
+    if (dataSize < kDriverHeaderSize
+        || ReadLittleEndian32(pData) < kDriverHeaderSize
+        || ReadLittleEndian32(pData + 4) != kDriverHeaderVersionOne
+        || ReadLittleEndian32(pData + 8) != key.vendorId
+        || ReadLittleEndian32(pData + 12) != key.deviceId
+        || memcmp(pData + 16, key.pipelineCacheUUID, kPipelineCacheUUIDSize) != 0)
+    {
+        return EPipelineCacheValidation::BadDriverHeader;
+    }
+
+    *ppOutData = pData;
+    *pOutDataSize = dataSize;
+    return EPipelineCacheValidation::Valid;
+}
+
+} // renderer namespace
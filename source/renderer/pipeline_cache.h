@@ -0,0 +1,67 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+#include <vector>
+
+namespace renderer
+{
+
+/////////////////////////////////////////////////////////
+// Pipeline cache file
+//
+// On disk layout: SPipelineCacheFileHeader followed by the driver's pipeline cache blob.
+// The file name and header are both keyed by the device, a cache from any other device or driver
+// version is rejected before it is handed to vkCreatePipelineCache.
+
+static constexpr size_t kPipelineCacheUUIDSize = 16; // VK_UUID_SIZE
+
+struct SPipelineCacheKey
+{
+    uint32_t vendorId = 0;
+    uint32_t deviceId = 0;
+    uint32_t driverVersion = 0;
+    uint8_t pipelineCacheUUID[kPipelineCacheUUIDSize] = { 0 };
+};
+
+struct SPipelineCacheFileHeader
+{
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    SPipelineCacheKey key;
+    uint64_t dataSize = 0;
+    uint64_t dataHash = 0;
+};
+
+enum class EPipelineCacheValidation : uint8_t
+{
+    Valid,
+    TooSmall,
+    BadMagic,
+    BadVersion,
+    KeyMismatch,
+    SizeMismatch,
+    HashMismatch,
+    BadDriverHeader
+};
+
+const char* ToString(EPipelineCacheValidation validation);
+
+// writes "<directory>/pipeline_cache_<vendor>_<device>_<driver>_<uuid>.bin" into pOutFileName
+bool MakePipelineCacheFileName(const char* directory, const SPipelineCacheKey& key, char* pOutFileName, size_t outFileNameSize);
+
+// builds the file contents for the driver blob pData
+void BuildPipelineCacheFile(const SPipelineCacheKey& key, const void* pData, size_t dataSize, std::vector<char>* pOutFile);
+
+// on success ppOutData/pOutDataSize point at the driver blob inside pFileData
+EPipelineCacheValidation ValidatePipelineCacheFile(
+    const char* pFileData,
+    size_t fileSize,
+    const SPipelineCacheKey& key,
+    const char** ppOutData,
+    size_t* pOutDataSize);
+
+} // renderer namespace
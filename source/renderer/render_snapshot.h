@@ -0,0 +1,65 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+#include "frame_arena.h"
+#include "matrix44.h"
+
+namespace renderer
+{
+
+/////////////////////////////////////////////////////////
+// Render snapshot
+//
+// Everything the renderer reads from the simulation for one frame. The game fills a snapshot, the frame pipeline
+// hands it to the render thread, and Render applies it before recording, so simulation of the next frame can run
+// while this one is submitted without either side touching the other's state. Variable sized parts live in the
+// snapshot frame's arena, which stays valid until the frame pipeline has retired the frame.
+
+// The SDF scene, spheres first then cubes. Shape updates index into it.
+static constexpr uint32_t kNumSceneSpheres = 2;
+static constexpr uint32_t kNumSceneCubes = 2;
+static constexpr uint32_t kNumSceneShapes = kNumSceneSpheres + kNumSceneCubes;
+
+struct SShapeTransformUpdate
+{
+    uint32_t shapeIndex = 0;
+    Matrix44l invTransform = { EIdentity::Constructor }; // world to shape space, what the SDF shaders consume
+};
+
+struct SRenderSnapshot
+{
+    SFrameContext frameContext;
+    bool bSkipRender = false; // applied but not rendered, see platform::SFramePacer
+    Matrix44l viewMatrix = { EIdentity::Constructor };
+    SShapeTransformUpdate* pShapeUpdates = nullptr; // frame memory, see ReserveShapeTransformUpdates
+    uint32_t numShapeUpdates = 0;
+    uint32_t maxShapeUpdates = 0;
+};
+
+// Allocates room for maxUpdates shape updates from the frame arena of pSnapshot->frameContext
+inline void ReserveShapeTransformUpdates(SRenderSnapshot* pSnapshot, uint32_t maxUpdates)
+{
+    assert(pSnapshot != nullptr);
+    assert(pSnapshot->numShapeUpdates == 0 && "reserve before adding updates");
+    pSnapshot->pShapeUpdates = memory::FrameAllocArray<SShapeTransformUpdate>(pSnapshot->frameContext, maxUpdates);
+    pSnapshot->maxShapeUpdates = maxUpdates;
+}
+
+// Returns false when the reservation is full, the update is dropped
+inline bool AddShapeTransformUpdate(SRenderSnapshot* pSnapshot, uint32_t shapeIndex, const Matrix44l& invTransform)
+{
+    assert(pSnapshot != nullptr);
+    if (pSnapshot->numShapeUpdates >= pSnapshot->maxShapeUpdates)
+        return false;
+
+    SShapeTransformUpdate* pUpdate = new (&pSnapshot->pShapeUpdates[pSnapshot->numShapeUpdates++]) SShapeTransformUpdate();
+    pUpdate->shapeIndex = shapeIndex;
+    pUpdate->invTransform = invTransform;
+    return true;
+}
+
+} // renderer namespace
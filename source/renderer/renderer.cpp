@@ -13,7 +13,15 @@
 
 #include "math/matrix43.h"
 #include "math/matrix44.h"
+#include "platform/async_io.h"
 #include "platform/platform.h"
+#include "profiling/cpu_profiler.h"
+#include "profiling/metrics.h"
+#include "renderer/dynamic_resolution.h"
+#include "renderer/gpu_profiler.h"
+#include "renderer/pipeline_cache.h"
+#include "renderer/render_snapshot.h"
+#include "renderer/texture_format.h"
 
 #define VK_FUNCTION_PTR_DECLARATION(fun) PFN_##fun fun = nullptr;
 
@@ -62,9 +70,21 @@
 	x(vkCreateShaderModule)\
 	x(vkCreatePipelineLayout)\
 	x(vkCreateGraphicsPipelines)\
+	x(vkCreateComputePipelines)\
+	x(vkCreatePipelineCache)\
+	x(vkGetPipelineCacheData)\
+	x(vkDestroyPipelineCache)\
+	x(vkCreateQueryPool)\
+	x(vkDestroyQueryPool)\
+	x(vkGetQueryPoolResults)\
+	x(vkCmdResetQueryPool)\
+	x(vkCmdWriteTimestamp)\
+	x(vkCmdBeginQuery)\
+	x(vkCmdEndQuery)\
 	x(vkCmdBeginRenderPass)\
 	x(vkCmdBindPipeline)\
 	x(vkCmdDraw)\
+	x(vkCmdDispatch)\
 	x(vkCmdEndRenderPass)\
 	x(vkDestroyShaderModule)\
 	x(vkDestroyPipelineLayout)\
@@ -109,9 +129,21 @@ namespace vulkan
 {
 /////////////////////////////////////////////////////////
 // Constants
-static constexpr VkDeviceSize MAX_PUSH_CONSTANTS_SIZE = 128;
 static constexpr uint32_t INVALID_QUEUE_FAMILY_PROPERTIES_INDEX = UINT32_MAX;
 static constexpr size_t MAX_IMAGE_COUNT = 4;
+static constexpr const char* PIPELINE_CACHE_DIRECTORY = "cache";
+static constexpr uint32_t GPU_TIMESTAMP_QUERY_COUNT = 2 * (uint32_t)renderer::EGpuScope::Frame; // begin/end per recorded scope, Frame is derived
+static constexpr TFrameId GPU_STATS_LOG_INTERVAL = 240; // frames between rolling average log lines
+static constexpr VkFormat SCENE_COLOR_FORMAT = VK_FORMAT_R8G8B8A8_UNORM; // storage image support is mandatory
+static constexpr const char* COMPUTE_SHADER_FILE_PATH = "data/shaders/sdf.comp.spv";
+static constexpr const char* TEXTURE_FILE_PATH = "data/images/tentacle.dtex"; // cooked from tentacle.bmp by TextureCooker
+
+static_assert(renderer::kVkFormatR8G8B8A8Unorm == VK_FORMAT_R8G8B8A8_UNORM);
+static_assert(renderer::kVkFormatR8G8B8A8Srgb == VK_FORMAT_R8G8B8A8_SRGB);
+static_assert(renderer::kVkFormatBC1RgbaUnorm == VK_FORMAT_BC1_RGBA_UNORM_BLOCK);
+static_assert(renderer::kVkFormatBC1RgbaSrgb == VK_FORMAT_BC1_RGBA_SRGB_BLOCK);
+static_assert(renderer::kVkFormatBC3Unorm == VK_FORMAT_BC3_UNORM_BLOCK);
+static_assert(renderer::kVkFormatBC3Srgb == VK_FORMAT_BC3_SRGB_BLOCK);
 static constexpr size_t MAX_COMMAND_BUFFER_COUNT = MAX_IMAGE_COUNT;
 static constexpr size_t RENDER_RESOURCES_COUNT = 3;
 static_assert(RENDER_RESOURCES_COUNT <= MAX_COMMAND_BUFFER_COUNT);
@@ -135,16 +167,34 @@ static constexpr VkDeviceSize SHAPE_TRANSFORMS_SIZE = SHAPE_TRANSFORM_SIZE * MAX
 /////////////////////////////////////////////////////////
 // State
 
-struct SPushConstants
+// Per-frame data, written into a persistently mapped dynamic uniform buffer slice
+// Keep in sync with u_FrameUniforms in sdf.frag (std140 layout)
+struct SFrameUniforms
 {
     Matrix44l viewMatrix = { EIdentity::Constructor };
+    float renderWidth = 0; // u_RenderSize, pixels rendered by the SDF pass
+    float renderHeight = 0;
+    float outputWidth = 0; // u_OutputSize, swap chain extent
+    float outputHeight = 0;
     float timeSecs = 0;
 
     // Keep in sync with EShape enum
     int numSpheres = 0;
     int numCubes = 0;
 };
-static_assert(sizeof(SPushConstants) <= MAX_PUSH_CONSTANTS_SIZE);
+
+// Selected at startup with --raymarch=fragment|compute
+enum class ERaymarchPath : uint8_t
+{
+    Fragment, // full screen quad, every pixel marches against every shape
+    Compute // tiled compute dispatch, every tile marches against the shapes culled to its view cone
+};
+
+enum class ECommandRecordingMode : uint8_t
+{
+    PerFrame, // re-record the full command buffer every frame
+    Prerecorded // record static command buffers per swap chain image once, re-record only on structural changes
+};
 
 ///////////////////////////
 // SDevice
@@ -166,6 +216,9 @@ struct SDevice
     uint32_t graphicsQueueFamilyIndex = INVALID_QUEUE_FAMILY_PROPERTIES_INDEX;
     uint32_t presentQueueFamilyIndex = INVALID_QUEUE_FAMILY_PROPERTIES_INDEX;
     VkDeviceSize memoryAlignment = { 0 };
+    VkPhysicalDeviceProperties properties;
+    VkPhysicalDeviceFeatures enabledFeatures;
+    uint32_t timestampValidBits = 0; // of the graphics queue family, 0 when timestamps are unsupported
     EState state = EState::Uninitialized;
 };
 
@@ -331,15 +384,42 @@ struct SBuffer
 
 ///////////////////////////
 // SRenderResources
-struct SRenderResources
+struct SRenderResources // per frame in flight
 {
-    VkFramebuffer frameBuffer = VK_NULL_HANDLE;
     VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
     VkSemaphore imageAvailableSemaphore = VK_NULL_HANDLE;
     VkSemaphore renderingFinishedSemaphore = VK_NULL_HANDLE;
     VkFence fence = VK_NULL_HANDLE;
 };
 
+///////////////////////////
+// SImageResources
+struct SImageResources // per swap chain image
+{
+    VkFramebuffer frameBuffer = VK_NULL_HANDLE;
+    SImage sceneColor; // SDF pass target, allocated at the swap chain extent and rendered into at the render scale
+    VkFramebuffer sceneFrameBuffer = VK_NULL_HANDLE;
+    VkDescriptorSet upscaleDescriptorSet = VK_NULL_HANDLE; // samples sceneColor
+    VkDescriptorSet computeDescriptorSet = VK_NULL_HANDLE; // writes sceneColor, compute path only
+    VkCommandBuffer staticCommandBuffer = VK_NULL_HANDLE;
+    VkFence lastSubmitFence = VK_NULL_HANDLE; // fence of the last frame that rendered into this image
+    uint64_t recordedGeneration = 0; // compared against g_staticCommandBufferGeneration
+    VkQueryPool timestampQueryPool = VK_NULL_HANDLE;
+    VkQueryPool statisticsQueryPool = VK_NULL_HANDLE;
+    uint32_t writtenGpuScopes = 0; // bit per EGpuScope written by the last submission
+    TFrameId submittedFrameId = 0;
+    TTime submitTime; // anchors the GPU scopes on the CPU profiler's timeline
+};
+
+///////////////////////////
+// SGpuProfiler
+struct SGpuProfiler
+{
+    bool bTimestamps = false;
+    bool bPipelineStatistics = false;
+    renderer::SGpuStatsHistory history;
+};
+
 ///////////////////////////
 // SDescriptorSet
 struct SDescriptorSet
@@ -351,7 +431,7 @@ struct SDescriptorSet
 
 // TODO: Add allocation callbacks for debugging
 static const VkAllocationCallbacks* g_pAllocationCallbacks = nullptr;
-static SPushConstants g_pushConstants;
+static SFrameUniforms g_frameUniforms;
 static Matrix44l g_invShapeTransforms[MAX_SHAPES] = { EIdentity::Constructor };
 static SDevice g_device;
 static SInstance g_instance;
@@ -363,12 +443,50 @@ static VkCommandPool g_graphicsCommandPool = VK_NULL_HANDLE;
 static SPrepareFrame g_prepareFrameState;
 
 static SRenderResources g_renderResources[RENDER_RESOURCES_COUNT];
+static SImageResources g_imageResources[MAX_IMAGE_COUNT];
 
-static VkRenderPass g_renderPass = VK_NULL_HANDLE;
+static SGpuProfiler g_gpuProfiler;
+
+static ECommandRecordingMode g_commandRecordingMode = ECommandRecordingMode::Prerecorded;
+static uint64_t g_staticCommandBufferGeneration = 1;
+static size_t g_sceneDirtyStartIndex = 0;
+static size_t g_sceneDirtyEndIndex = 0;
+static bool g_bSceneDirty = false;
+
+static VkRenderPass g_renderPass = VK_NULL_HANDLE; // upscale onto the swap chain image
+static VkRenderPass g_sceneRenderPass = VK_NULL_HANDLE; // SDF pass into SImageResources::sceneColor
 static VkPipelineLayout g_pipelineLayout = VK_NULL_HANDLE;
 static VkPipeline g_graphicsPipeline = VK_NULL_HANDLE;
+static VkPipelineLayout g_upscalePipelineLayout = VK_NULL_HANDLE;
+static VkPipeline g_upscalePipeline = VK_NULL_HANDLE;
+static VkDescriptorSetLayout g_upscaleDescriptorSetLayout = VK_NULL_HANDLE;
+static VkDescriptorPool g_upscaleDescriptorPool = VK_NULL_HANDLE; // one set per swap chain image, see SImageResources
+static VkSampler g_sceneColorSampler = VK_NULL_HANDLE;
+static ERaymarchPath g_raymarchPath = ERaymarchPath::Fragment;
+static uint32_t g_computeTileSize = 8; // workgroup is g_computeTileSize x g_computeTileSize invocations
+static platform::SFile g_computeShaderFile;
+static platform::SFile g_textureFile; // cooked .dtex, only held between Initialize and CreateTexture
+static platform::TAsyncReadHandle g_textureReadHandle = platform::kInvalidAsyncReadHandle;
+static VkShaderModule g_computeShaderModule = VK_NULL_HANDLE;
+static VkDescriptorSetLayout g_computeDescriptorSetLayout = VK_NULL_HANDLE;
+static VkDescriptorPool g_computeDescriptorPool = VK_NULL_HANDLE; // one set per swap chain image, see SImageResources
+static VkPipelineLayout g_computePipelineLayout = VK_NULL_HANDLE;
+static VkPipeline g_computePipeline = VK_NULL_HANDLE;
+static renderer::SDynamicResolutionConfig g_dynamicResolutionConfig;
+static renderer::SDynamicResolutionState g_dynamicResolution;
+static bool g_bDynamicResolution = true;
+static TFrameId g_dynamicResolutionFrameId = 0; // last GPU frame fed to the controller
+static uint64_t g_frameUploadBytes = 0; // host to device bytes written by the frame being recorded
+static profiling::SHistogram* g_pFrameUploadMetric = nullptr;
+static profiling::SCounter* g_pUploadTotalMetric = nullptr;
+static profiling::SGauge* g_pRenderScaleMetric = nullptr;
+static VkPipelineCache g_pipelineCache = VK_NULL_HANDLE;
+static size_t g_pipelineCacheLoadedSize = 0; // 0 when starting from an empty cache
 static SBuffer g_vertexBuffer;
 static SBuffer g_uniformBuffer;
+static SBuffer g_frameUniformBuffer;
+static void* g_pMappedFrameUniforms = nullptr;
+static VkDeviceSize g_frameUniformsSliceSize = 0;
 static void* g_pMappedStagingBuffer = nullptr;
 static SBuffer g_stagingBuffer;
 static SImage g_image;
@@ -388,7 +506,7 @@ static SDescriptorSet g_descriptorSet;
 //
 // SHADER_BANK(MyShaders, MY_SHADERS_LIST)
 //
-// MyShaders.LoadFiles();
+// MyShaders.LoadFiles(); // or BeginLoadFiles() ... FinishLoadFiles() to overlap the reads with other work
 // MyShaders.GetVertexShader(EMyShaders::Enum::shader1);
 // MyShaders.GetFragmentShader(EMyShaders::Enum::shader1);
 // MyShaders.CreateShaderModules();
@@ -422,6 +540,7 @@ public:
     bool UnloadFiles()
     {
         bool bSuccess = m_bShadersLoaded;
+        WaitForPendingLoads(); // the IO threads may still be writing into the files
         for (size_t i = 0; i < EnumCount; ++i)
         {
             m_vertexShaders[i] = platform::SFile();
@@ -432,33 +551,45 @@ public:
     }
 
     bool LoadFiles()
+    {
+        return BeginLoadFiles() && FinishLoadFiles();
+    }
+
+    // Queues the vertex and fragment shader reads on the IO threads
+    bool BeginLoadFiles()
     {
         assert(m_bShadersLoaded == false);
         m_bShadersLoaded = true;
-        bool bVertexFilesLoaded = platform::LoadFiles(m_vertexShaderFilePaths, EnumCount, platform::EFileType::Binary, m_vertexShaders.data());
-        if (bVertexFilesLoaded)
-        {
-            bool bFragFilesLoaded = platform::LoadFiles(m_fragmentShaderFilePaths, EnumCount, platform::EFileType::Binary, m_fragmentShaders.data());
+        m_vertexLoadHandle = platform::SubmitAsyncRead(m_vertexShaderFilePaths, EnumCount, platform::EFileType::Binary, m_vertexShaders.data());
+        m_fragmentLoadHandle = platform::SubmitAsyncRead(m_fragmentShaderFilePaths, EnumCount, platform::EFileType::Binary, m_fragmentShaders.data());
+        return m_vertexLoadHandle != platform::kInvalidAsyncReadHandle && m_fragmentLoadHandle != platform::kInvalidAsyncReadHandle;
+    }
+
+    // Blocks until the reads queued by BeginLoadFiles have finished
+    bool FinishLoadFiles()
+    {
+        assert(m_bShadersLoaded == true);
+        const bool bFilesLoaded = WaitForPendingLoads();
 #if PRINT_SHADERS_ON_LOAD
-            if (bFragFilesLoaded)
+        if (bFilesLoaded)
+        {
+            for (size_t i = 0; i < EnumCount; ++i)
             {
-                for (size_t i = 0; i < EnumCount; ++i)
+                DiracLog(1, "=====================================================");
+                DiracLog(1, "Shader: %s", m_vertexShaderFilePaths[i]);
+                const size_t numBytes = m_vertexShaders[i].numBytes;
+                const char* pData = m_vertexShaders[i].pBytes;
+                for (size_t j = 0; j < numBytes; ++j)
                 {
-                    DiracLog(1, "=====================================================");
-                    DiracLog(1, "Shader: %s", m_vertexShaderFilePaths[i]);
-                    const size_t numBytes = m_vertexShaders[i].numBytes;
-                    const char* pData = m_vertexShaders[i].pData.get();
-                    for (size_t j = 0; j < numBytes; ++j)
-                    {
-                        DiracLogSameLine(1, "%c", pData[j]);
-                    }
-                    DiracLog(1, "\n=====================================================");
+                    DiracLogSameLine(1, "%c", pData[j]);
                 }
+                DiracLog(1, "\n=====================================================");
             }
-#endif
-            if (bFragFilesLoaded)
-                return true;
         }
+#endif
+        if (bFilesLoaded)
+            return true;
+
         UnloadFiles();
         m_bShadersLoaded = false;
         return false;
@@ -546,12 +677,29 @@ public:
     }
 
 private:
+    bool WaitForPendingLoads()
+    {
+        bool bSuccess = true;
+        for (platform::TAsyncReadHandle* pHandle : { &m_vertexLoadHandle, &m_fragmentLoadHandle })
+        {
+            if (*pHandle != platform::kInvalidAsyncReadHandle)
+            {
+                bSuccess &= platform::WaitForAsyncRead(*pHandle);
+                *pHandle = platform::kInvalidAsyncReadHandle;
+            }
+        }
+
+        return bSuccess;
+    }
+
     const char** m_vertexShaderFilePaths;
     const char** m_fragmentShaderFilePaths;
     std::array<platform::SFile, EnumCount> m_vertexShaders = { platform::SFile() };
     std::array<platform::SFile, EnumCount> m_fragmentShaders = { platform::SFile() };
     std::array<VkShaderModule, EnumCount> m_vertexShaderModules = { VK_NULL_HANDLE };
     std::array<VkShaderModule, EnumCount> m_fragmentShaderModules = { VK_NULL_HANDLE };
+    platform::TAsyncReadHandle m_vertexLoadHandle = platform::kInvalidAsyncReadHandle;
+    platform::TAsyncReadHandle m_fragmentLoadHandle = platform::kInvalidAsyncReadHandle;
     bool m_bShadersLoaded = false;
     bool m_bShaderModulesCreated = false;
 };
@@ -574,7 +722,8 @@ static SShaderBankState<E##name::Enum, E##name::count> name(__##name::vertexShad
 ///////////////////////////
 // Default Shaders
 #define DEFAULT_SHADERS(x)\
-    x(sdf)
+    x(sdf)\
+    x(upscale)
 
 SHADER_BANK(DefaultShaders, DEFAULT_SHADERS)
 
@@ -599,6 +748,7 @@ ERunResult SetDevice(
     g_device.graphicsQueueFamilyIndex = _graphicsQueueFamilyIndex;
     g_device.presentQueueFamilyIndex = _presentQueueFamilyIndex;
     g_device.memoryAlignment = _memoryAlignment;
+    vkGetPhysicalDeviceProperties(g_device.physicalDevice, &g_device.properties);
 
 #define SET_DEVICE_LEVEL_FUNCTION(fun)                                                                            \
     g_device.fun = (PFN_##fun)vkGetDeviceProcAddr(g_device.handle, #fun);                                         \
@@ -825,12 +975,14 @@ bool FlushSceneSDF(
     uint32_t srcQueueFamilyIndex,
     uint32_t dstQueueFamilyIndex)
 {
+    PROFILE_FUNCTION();
     assert(endIndex >= startIndex);
     assert(startIndex < MAX_SHAPES);
     assert(endIndex < MAX_SHAPES);
     const size_t count = endIndex - startIndex + 1;
     const size_t offsetSize = startIndex * SHAPE_TRANSFORM_SIZE;
     const size_t rangeSize = count * SHAPE_TRANSFORM_SIZE;
+    g_frameUploadBytes += rangeSize;
 
     ///////////////////////////////////////////////////////////////////////////////////////////////////
     { // Copy shape transforms to staging buffer, then copy to host memory uniform buffer
@@ -874,7 +1026,7 @@ bool FlushSceneSDF(
             g_device.vkCmdPipelineBarrier(
                 commandBuffer,
                 VK_PIPELINE_STAGE_TRANSFER_BIT,
-                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
                 0, // dependency flags
                 0, // memory barrier count
                 nullptr, // memory barriers
@@ -890,199 +1042,766 @@ bool FlushSceneSDF(
     return true;
 }
 
-bool PrepareFrame(
-    VkCommandBuffer commandBuffer,
-    const SImage& image,
-    const SFrameContext& /*frameContext*/,
-    VkFramebuffer& outFrameBuffer)
+/////////////////////////////////////////////////////////
+// GPU profiling
+
+bool CreateGpuQueryPools()
 {
-    assert(g_device.state == SDevice::EState::Initialized);
-    assert(g_swapChain.state == SSwapChain::EState::Initialized);
-    assert(g_renderPass != VK_NULL_HANDLE);
-    assert(commandBuffer != VK_NULL_HANDLE);
-    assert(image.handle != VK_NULL_HANDLE);
-    assert(image.view != VK_NULL_HANDLE);
+    assert(g_device.handle != VK_NULL_HANDLE);
+    for (uint32_t i = 0; i < g_swapChain.imageCount; ++i)
+    {
+        SImageResources& imageResources = g_imageResources[i];
+        if (g_gpuProfiler.bTimestamps)
+        {
+            VkQueryPoolCreateInfo queryPoolCreateInfo;
+            queryPoolCreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            queryPoolCreateInfo.pNext = nullptr;
+            queryPoolCreateInfo.flags = 0;
+            queryPoolCreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+            queryPoolCreateInfo.queryCount = GPU_TIMESTAMP_QUERY_COUNT;
+            queryPoolCreateInfo.pipelineStatistics = 0;
+
+            if (g_device.vkCreateQueryPool(g_device.handle, &queryPoolCreateInfo, g_pAllocationCallbacks, &imageResources.timestampQueryPool) != VK_SUCCESS)
+            {
+                DiracError("Vulkan failed to create timestamp query pool!");
+                return false;
+            }
+        }
+
+        if (g_gpuProfiler.bPipelineStatistics)
+        {
+            VkQueryPoolCreateInfo queryPoolCreateInfo;
+            queryPoolCreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            queryPoolCreateInfo.pNext = nullptr;
+            queryPoolCreateInfo.flags = 0;
+            queryPoolCreateInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+            queryPoolCreateInfo.queryCount = 1;
+            queryPoolCreateInfo.pipelineStatistics = VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+            if (g_device.vkCreateQueryPool(g_device.handle, &queryPoolCreateInfo, g_pAllocationCallbacks, &imageResources.statisticsQueryPool) != VK_SUCCESS)
+            {
+                DiracError("Vulkan failed to create pipeline statistics query pool!");
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// Resets and writes the scope's begin timestamp, must be recorded outside of a render pass
+void BeginGpuScope(VkCommandBuffer commandBuffer, uint32_t imageIndex, renderer::EGpuScope scope)
+{
+    assert(scope < renderer::EGpuScope::Frame);
+    if (!g_gpuProfiler.bTimestamps)
+        return;
+
+    const VkQueryPool queryPool = g_imageResources[imageIndex].timestampQueryPool;
+    const uint32_t firstQuery = 2 * (uint32_t)scope;
+    g_device.vkCmdResetQueryPool(commandBuffer, queryPool, firstQuery, 2);
+    g_device.vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, firstQuery);
+}
+
+void EndGpuScope(VkCommandBuffer commandBuffer, uint32_t imageIndex, renderer::EGpuScope scope)
+{
+    assert(scope < renderer::EGpuScope::Frame);
+    if (!g_gpuProfiler.bTimestamps)
+        return;
+
+    const VkQueryPool queryPool = g_imageResources[imageIndex].timestampQueryPool;
+    g_device.vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, 2 * (uint32_t)scope + 1);
+}
+
+// Only called once the image's last submission has retired, so results are available without waiting
+void ReadGpuQueries(uint32_t imageIndex)
+{
+    SImageResources& imageResources = g_imageResources[imageIndex];
+    if (imageResources.writtenGpuScopes == 0)
+        return;
+
+    renderer::SGpuStatsHistory& history = g_gpuProfiler.history;
+    if (g_gpuProfiler.bTimestamps)
+    {
+        uint64_t frameBeginTicks = UINT64_MAX;
+        uint64_t frameEndTicks = 0;
+        uint64_t scopeTicks[(size_t)renderer::EGpuScope::Frame][2] = {}; // { begin, end }
+        uint32_t validScopes = 0;
+        bool bFrameValid = false;
+        for (uint32_t scope = 0; scope < (uint32_t)renderer::EGpuScope::Frame; ++scope)
+        {
+            if ((imageResources.writtenGpuScopes & BIT(scope)) == 0)
+                continue;
+
+            uint64_t results[4] = { 0 }; // { begin, available, end, available }
+            const VkResult result = g_device.vkGetQueryPoolResults(
+                g_device.handle,
+                imageResources.timestampQueryPool,
+                2 * scope, // first query
+                2, // query count
+                sizeof(results),
+                results,
+                2 * sizeof(uint64_t), // stride
+                VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+            if (result != VK_SUCCESS || results[1] == 0 || results[3] == 0)
+                continue;
+
+            renderer::AddGpuScopeSample(
+                &history,
+                (renderer::EGpuScope)scope,
+                renderer::TimestampDeltaMs(results[0], results[2], g_device.timestampValidBits, g_device.properties.limits.timestampPeriod));
+            frameBeginTicks = std::min(frameBeginTicks, results[0]);
+            frameEndTicks = std::max(frameEndTicks, results[2]);
+            scopeTicks[scope][0] = results[0];
+            scopeTicks[scope][1] = results[2];
+            validScopes |= BIT(scope);
+            bFrameValid = true;
+        }
+
+        if (profiling::IsCpuCaptureActive())
+        { // GPU track of the CPU profiler, offsets from the first scope are placed after the frame's submission
+            for (uint32_t scope = 0; scope < (uint32_t)renderer::EGpuScope::Frame; ++scope)
+            {
+                if ((validScopes & BIT(scope)) == 0)
+                    continue;
+
+                const TMilliseconds beginOffset(renderer::TimestampDeltaMs(frameBeginTicks, scopeTicks[scope][0], g_device.timestampValidBits, g_device.properties.limits.timestampPeriod));
+                const TMilliseconds endOffset(renderer::TimestampDeltaMs(frameBeginTicks, scopeTicks[scope][1], g_device.timestampValidBits, g_device.properties.limits.timestampPeriod));
+                profiling::RecordGpuProfileEvent(
+                    renderer::ToString((renderer::EGpuScope)scope),
+                    imageResources.submitTime + std::chrono::duration_cast<TSteadyClock::duration>(beginOffset),
+                    imageResources.submitTime + std::chrono::duration_cast<TSteadyClock::duration>(endOffset));
+            }
+        }
+
+        if (bFrameValid)
+        {
+            renderer::AddGpuScopeSample(
+                &history,
+                renderer::EGpuScope::Frame,
+                renderer::TimestampDeltaMs(frameBeginTicks, frameEndTicks, g_device.timestampValidBits, g_device.properties.limits.timestampPeriod));
+        }
+    }
 
-    /////////////////////////////////////////////////////
-    // create frame buffer
+    if (g_gpuProfiler.bPipelineStatistics)
     {
-        if (outFrameBuffer != VK_NULL_HANDLE)
+        uint64_t results[2] = { 0 }; // { fragment shader invocations, available }
+        const VkResult result = g_device.vkGetQueryPoolResults(
+            g_device.handle,
+            imageResources.statisticsQueryPool,
+            0, // first query
+            1, // query count
+            sizeof(results),
+            results,
+            sizeof(results), // stride
+            VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+        if (result == VK_SUCCESS && results[1] != 0)
         {
-            g_device.vkDestroyFramebuffer(g_device.handle, outFrameBuffer, g_pAllocationCallbacks);
+            renderer::AddFragmentInvocationsSample(&history, results[0]);
         }
+    }
+
+    history.lastFrameId = imageResources.submittedFrameId;
+    imageResources.writtenGpuScopes = 0;
+
+    if (history.lastFrameId > 0 && (history.lastFrameId % GPU_STATS_LOG_INTERVAL) == 0)
+    {
+        renderer::SGpuFrameStats stats;
+        renderer::GetGpuFrameStats(history, &stats);
+        const renderer::SGpuScopeStats& frameStats = stats.scopes[(size_t)renderer::EGpuScope::Frame];
+        const renderer::SGpuScopeStats& passStats = stats.scopes[(size_t)renderer::EGpuScope::SdfPass];
+        const renderer::SGpuScopeStats& upscaleStats = stats.scopes[(size_t)renderer::EGpuScope::Upscale];
+        const renderer::SGpuScopeStats& uploadStats = stats.scopes[(size_t)renderer::EGpuScope::SceneUpload];
+        DiracLog(1, "[Renderer] GPU avg over %u frames: frame %.3f ms (max %.3f), SdfPass %.3f ms at scale %.2f, Upscale %.3f ms, SceneUpload %.3f ms (%u samples), fragment invocations %.0f",
+            frameStats.sampleCount,
+            frameStats.averageMs,
+            frameStats.maxMs,
+            passStats.averageMs,
+            g_dynamicResolution.scale,
+            upscaleStats.averageMs,
+            uploadStats.averageMs,
+            uploadStats.sampleCount,
+            stats.averageFragmentShaderInvocations);
+    }
+}
+
+/////////////////////////////////////////////////////////
+// Frame
+
+void GetFrameQueueFamilyIndices(uint32_t* pPresentQueueFamilyIndex, uint32_t* pGraphicsQueueFamilyIndex)
+{
+    *pPresentQueueFamilyIndex = g_device.presentQueueFamilyIndex;
+    *pGraphicsQueueFamilyIndex = g_device.graphicsQueueFamilyIndex;
+
+    if (*pPresentQueueFamilyIndex == *pGraphicsQueueFamilyIndex)
+    {
+        *pPresentQueueFamilyIndex = *pGraphicsQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    }
+}
+
+void MarkSceneDirty(size_t startIndex, size_t endIndex)
+{
+    assert(endIndex >= startIndex);
+    assert(endIndex < MAX_SHAPES);
+    if (g_bSceneDirty)
+    {
+        g_sceneDirtyStartIndex = std::min(g_sceneDirtyStartIndex, startIndex);
+        g_sceneDirtyEndIndex = std::max(g_sceneDirtyEndIndex, endIndex);
+    }
+    else
+    {
+        g_sceneDirtyStartIndex = startIndex;
+        g_sceneDirtyEndIndex = endIndex;
+        g_bSceneDirty = true;
+    }
+}
+
+// Any change to state baked into the static command buffers (pipelines, descriptor sets, frame buffers, viewport)
+// must call this so each swap chain image re-records before its next submission
+void InvalidateStaticCommandBuffers()
+{
+    ++g_staticCommandBufferGeneration;
+}
+
+bool CreateFrameBuffers()
+{
+    assert(g_device.state == SDevice::EState::Initialized);
+    assert(g_renderPass != VK_NULL_HANDLE);
 
-        g_prepareFrameState.frameBufferCreateInfo.renderPass = g_renderPass;
-        g_prepareFrameState.frameBufferCreateInfo.pAttachments = &image.view;
-        g_prepareFrameState.frameBufferCreateInfo.width = g_swapChain.extent.width;
-        g_prepareFrameState.frameBufferCreateInfo.height = g_swapChain.extent.height;
+    g_prepareFrameState.frameBufferCreateInfo.renderPass = g_renderPass;
+    g_prepareFrameState.frameBufferCreateInfo.width = g_swapChain.extent.width;
+    g_prepareFrameState.frameBufferCreateInfo.height = g_swapChain.extent.height;
 
+    for (uint32_t i = 0; i < g_swapChain.imageCount; ++i)
+    {
+        assert(g_imageResources[i].frameBuffer == VK_NULL_HANDLE);
+        g_prepareFrameState.frameBufferCreateInfo.pAttachments = &g_swapChain.images[i].view;
         if (g_device.vkCreateFramebuffer(
             g_device.handle,
             &g_prepareFrameState.frameBufferCreateInfo,
             g_pAllocationCallbacks,
-            &outFrameBuffer) != VK_NULL_HANDLE)
+            &g_imageResources[i].frameBuffer) != VK_SUCCESS)
         {
             DiracError("Vulkan failed to create frame buffer!");
             return false;
         }
-    } // ~create frame buffer
-    /////////////////////////////////////////////////////
+    }
 
-    /////////////////////////////////////////////////////
-    // Record commands
-    assert(outFrameBuffer != VK_NULL_HANDLE);
+    return true;
+}
 
-    g_device.vkBeginCommandBuffer(commandBuffer, &g_prepareFrameState.commandBufferBeginInfo);
+// Region of the scene color target rendered by the SDF pass at the current render scale
+VkExtent2D GetSceneExtent()
+{
+    const float scale = g_dynamicResolution.scale;
+    const uint32_t width = std::max<uint32_t>(1, uint32_t(g_swapChain.extent.width * scale));
+    const uint32_t height = std::max<uint32_t>(1, uint32_t(g_swapChain.extent.height * scale));
+    return { width, height };
+}
 
-    uint32_t presentQueueFamilyIndex = vulkan::g_device.presentQueueFamilyIndex;
-    uint32_t graphicsQueueFamilyIndex = vulkan::g_device.graphicsQueueFamilyIndex;
+void WriteRenderSizeUniforms()
+{
+    const VkExtent2D sceneExtent = GetSceneExtent();
+    g_frameUniforms.renderWidth = (float)sceneExtent.width;
+    g_frameUniforms.renderHeight = (float)sceneExtent.height;
+    g_frameUniforms.outputWidth = (float)g_swapChain.extent.width;
+    g_frameUniforms.outputHeight = (float)g_swapChain.extent.height;
+}
 
-    if (presentQueueFamilyIndex == graphicsQueueFamilyIndex)
-    {
-        presentQueueFamilyIndex = graphicsQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    }
+void WriteFrameUniforms(uint32_t imageIndex)
+{
+    assert(imageIndex < g_swapChain.imageCount);
+    assert(g_pMappedFrameUniforms != nullptr);
+    const VkDeviceSize offset = g_frameUniformsSliceSize * imageIndex;
+    memcpy((char*)g_pMappedFrameUniforms + offset, &g_frameUniforms, sizeof(SFrameUniforms));
+    g_frameUploadBytes += sizeof(SFrameUniforms);
+
+    VkMappedMemoryRange flushRange;
+    flushRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+    flushRange.pNext = nullptr;
+    flushRange.memory = g_frameUniformBuffer.memory;
+    flushRange.offset = offset;
+    flushRange.size = g_frameUniformsSliceSize;
+
+    g_device.vkFlushMappedMemoryRanges(g_device.handle, 1, &flushRange);
+}
 
-#if 0 // Debug movement
-    for (size_t i = 0; i < 4; ++i)
-    {
-        Vec4l translation = g_invShapeTransforms[i].GetRow4();
-        Vec3l mvt = Vec3l(translation.x, translation.y, translation.z).Normalized();
-        mvt.Scale(float(TSeconds(frameContext.lastFrameDuration).count()));
-        translation = translation + Vec4l(mvt.x, mvt.y, mvt.z, 0.0);
-        g_invShapeTransforms[i].SetRow4(translation);
-    }
-#endif
+bool FlushDirtySceneSDF(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+{
+    if (!g_bSceneDirty)
+        return true;
 
-    if (!FlushSceneSDF(0, 3, commandBuffer, presentQueueFamilyIndex, graphicsQueueFamilyIndex))
+    uint32_t presentQueueFamilyIndex, graphicsQueueFamilyIndex;
+    GetFrameQueueFamilyIndices(&presentQueueFamilyIndex, &graphicsQueueFamilyIndex);
+    BeginGpuScope(commandBuffer, imageIndex, renderer::EGpuScope::SceneUpload);
+    if (!FlushSceneSDF(g_sceneDirtyStartIndex, g_sceneDirtyEndIndex, commandBuffer, presentQueueFamilyIndex, graphicsQueueFamilyIndex))
     {
         DiracError("Failed to update SDF scene!");
         return false;
     }
 
-    g_prepareFrameState.barrierPresentToDraw.image = image.handle;
-    g_prepareFrameState.barrierPresentToDraw.srcQueueFamilyIndex = presentQueueFamilyIndex;
-    g_prepareFrameState.barrierPresentToDraw.dstQueueFamilyIndex = graphicsQueueFamilyIndex;
+    EndGpuScope(commandBuffer, imageIndex, renderer::EGpuScope::SceneUpload);
+    g_imageResources[imageIndex].writtenGpuScopes |= BIT((uint32_t)renderer::EGpuScope::SceneUpload);
+    g_bSceneDirty = false;
+    return true;
+}
+
+// Compute path equivalent of the SDF render pass, leaves the scene color target ready for the upscale pass
+void RecordComputeSdfPass(VkCommandBuffer commandBuffer, uint32_t imageIndex, uint32_t frameUniformsOffset)
+{
+    assert(g_computePipeline != VK_NULL_HANDLE);
+    const SImageResources& imageResources = g_imageResources[imageIndex];
+    assert(imageResources.computeDescriptorSet != VK_NULL_HANDLE);
+
+    BeginGpuScope(commandBuffer, imageIndex, renderer::EGpuScope::SdfPass);
+
+    VkImageMemoryBarrier imageMemoryBarrier;
+    imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    imageMemoryBarrier.pNext = nullptr;
+    imageMemoryBarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT; // previous upscale read
+    imageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED; // fully overwritten inside the render region
+    imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageMemoryBarrier.image = imageResources.sceneColor.handle;
+    imageMemoryBarrier.subresourceRange = g_prepareFrameState.imageSubresourceRange;
 
     g_device.vkCmdPipelineBarrier(
         commandBuffer,
-        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
         0, // dependencyFlags
         0, // memoryBarrierCount
         nullptr, // pMemoryBarries
         0, // bufferMemoryCount
         nullptr, // pBufferMemoryBarriers
         1, // imageMemoryarrierCount
-        &g_prepareFrameState.barrierPresentToDraw);
-
-    g_prepareFrameState.renderPassBeginInfo.renderPass = g_renderPass;
-    g_prepareFrameState.renderPassBeginInfo.framebuffer = outFrameBuffer;
-
-    g_device.vkCmdBeginRenderPass(commandBuffer, &g_prepareFrameState.renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-    g_device.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, g_graphicsPipeline);
-
-    g_device.vkCmdSetViewport(commandBuffer, 0, 1, &g_prepareFrameState.viewport);
-    g_device.vkCmdSetScissor(commandBuffer, 0, 1, &g_prepareFrameState.scissor);
-
-    VkDeviceSize offset = 0;
-    g_device.vkCmdBindVertexBuffers(
-        commandBuffer,
-        0, // firstBinding
-        1, // bindingCount
-        &g_vertexBuffer.handle,
-        &offset);
+        &imageMemoryBarrier);
 
-    assert(g_pipelineLayout != VK_NULL_HANDLE);
-    assert(g_descriptorSet.handle != VK_NULL_HANDLE);
+    g_device.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, g_computePipeline);
     g_device.vkCmdBindDescriptorSets(
         commandBuffer,
-        VK_PIPELINE_BIND_POINT_GRAPHICS,
-        g_pipelineLayout,
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        g_computePipelineLayout,
         0, // first set
         1, // descriptor set count
-        &g_descriptorSet.handle,
-        0, // dynamic offset count
-        nullptr /* dynamic offsets */);
+        &imageResources.computeDescriptorSet,
+        1, // dynamic offset count
+        &frameUniformsOffset /* dynamic offsets */);
 
-    g_device.vkCmdPushConstants(
+    const VkExtent2D sceneExtent = GetSceneExtent();
+    g_device.vkCmdDispatch(
         commandBuffer,
-        g_pipelineLayout,
-        VK_SHADER_STAGE_FRAGMENT_BIT,
-        0,
-        sizeof(SPushConstants),
-        &g_pushConstants);
+        (sceneExtent.width + g_computeTileSize - 1) / g_computeTileSize,
+        (sceneExtent.height + g_computeTileSize - 1) / g_computeTileSize,
+        1);
 
-    g_device.vkCmdDraw(commandBuffer, 4, 1, 0, 0);
-    g_device.vkCmdEndRenderPass(commandBuffer);
-
-    g_prepareFrameState.barrierDrawToPresent.image = image.handle;
-    g_prepareFrameState.barrierDrawToPresent.srcQueueFamilyIndex = graphicsQueueFamilyIndex;
-    g_prepareFrameState.barrierDrawToPresent.dstQueueFamilyIndex = presentQueueFamilyIndex;
+    imageMemoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    imageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
     g_device.vkCmdPipelineBarrier(
         commandBuffer,
-        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
         0, // dependencyFlags
         0, // memoryBarrierCount
         nullptr, // pMemoryBarries
         0, // bufferMemoryCount
         nullptr, // pBufferMemoryBarriers
         1, // imageMemoryarrierCount
-        &g_prepareFrameState.barrierDrawToPresent);
+        &imageMemoryBarrier);
 
-    if (g_device.vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+    EndGpuScope(commandBuffer, imageIndex, renderer::EGpuScope::SdfPass);
+}
+
+// Records everything that doesn't change from frame to frame for a given swap chain image
+void RecordRenderCommands(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+{
+    assert(g_device.state == SDevice::EState::Initialized);
+    assert(g_swapChain.state == SSwapChain::EState::Initialized);
+    assert(g_renderPass != VK_NULL_HANDLE);
+    assert(g_sceneRenderPass != VK_NULL_HANDLE);
+    assert(commandBuffer != VK_NULL_HANDLE);
+    assert(imageIndex < g_swapChain.imageCount);
+
+    const SImage& image = g_swapChain.images[imageIndex];
+    const SImageResources& imageResources = g_imageResources[imageIndex];
+    assert(image.handle != VK_NULL_HANDLE);
+    assert(image.view != VK_NULL_HANDLE);
+    assert(imageResources.frameBuffer != VK_NULL_HANDLE);
+    assert(imageResources.sceneFrameBuffer != VK_NULL_HANDLE || g_raymarchPath == ERaymarchPath::Compute);
+
+    uint32_t presentQueueFamilyIndex, graphicsQueueFamilyIndex;
+    GetFrameQueueFamilyIndices(&presentQueueFamilyIndex, &graphicsQueueFamilyIndex);
+
+    VkDeviceSize offset = 0;
+    g_device.vkCmdBindVertexBuffers(
+        commandBuffer,
+        0, // firstBinding
+        1, // bindingCount
+        &g_vertexBuffer.handle,
+        &offset);
+
+    const uint32_t frameUniformsOffset = uint32_t(g_frameUniformsSliceSize * imageIndex);
+
+    /////////////////////////////////
+    if (g_raymarchPath == ERaymarchPath::Compute)
     {
-        DiracError("Vulkan could not record command buffers!");
-        return false;
+        RecordComputeSdfPass(commandBuffer, imageIndex, frameUniformsOffset);
     }
+    else
+    { // SDF pass, renders into the scaled region of the scene color target
+        BeginGpuScope(commandBuffer, imageIndex, renderer::EGpuScope::SdfPass);
+        const VkQueryPool statisticsQueryPool = imageResources.statisticsQueryPool;
+        if (g_gpuProfiler.bPipelineStatistics)
+        {
+            g_device.vkCmdResetQueryPool(commandBuffer, statisticsQueryPool, 0, 1);
+        }
 
-    return true;
+        const VkExtent2D sceneExtent = GetSceneExtent();
+        const VkViewport sceneViewport = { 0.0f, 0.0f, (float)sceneExtent.width, (float)sceneExtent.height, 0.0f, 1.0f };
+        const VkRect2D sceneRect = { { 0, 0 }, sceneExtent };
+
+        VkRenderPassBeginInfo renderPassBeginInfo = g_prepareFrameState.renderPassBeginInfo;
+        renderPassBeginInfo.renderPass = g_sceneRenderPass;
+        renderPassBeginInfo.framebuffer = imageResources.sceneFrameBuffer;
+        renderPassBeginInfo.renderArea = sceneRect;
+
+        g_device.vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+        g_device.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, g_graphicsPipeline);
+
+        g_device.vkCmdSetViewport(commandBuffer, 0, 1, &sceneViewport);
+        g_device.vkCmdSetScissor(commandBuffer, 0, 1, &sceneRect);
+
+        assert(g_pipelineLayout != VK_NULL_HANDLE);
+        assert(g_descriptorSet.handle != VK_NULL_HANDLE);
+        g_device.vkCmdBindDescriptorSets(
+            commandBuffer,
+            VK_PIPELINE_BIND_POINT_GRAPHICS,
+            g_pipelineLayout,
+            0, // first set
+            1, // descriptor set count
+            &g_descriptorSet.handle,
+            1, // dynamic offset count
+            &frameUniformsOffset /* dynamic offsets */);
+
+        if (g_gpuProfiler.bPipelineStatistics)
+        {
+            g_device.vkCmdBeginQuery(commandBuffer, statisticsQueryPool, 0, 0);
+        }
+
+        g_device.vkCmdDraw(commandBuffer, 4, 1, 0, 0);
+
+        if (g_gpuProfiler.bPipelineStatistics)
+        {
+            g_device.vkCmdEndQuery(commandBuffer, statisticsQueryPool, 0);
+        }
+
+        g_device.vkCmdEndRenderPass(commandBuffer);
+        EndGpuScope(commandBuffer, imageIndex, renderer::EGpuScope::SdfPass);
+    } // ~SDF pass
+    /////////////////////////////////
+
+    /////////////////////////////////
+    { // Upscale pass, bilinear filters the scene color target to the swap chain image
+        BeginGpuScope(commandBuffer, imageIndex, renderer::EGpuScope::Upscale);
+
+        g_prepareFrameState.barrierPresentToDraw.image = image.handle;
+        g_prepareFrameState.barrierPresentToDraw.srcQueueFamilyIndex = presentQueueFamilyIndex;
+        g_prepareFrameState.barrierPresentToDraw.dstQueueFamilyIndex = graphicsQueueFamilyIndex;
+
+        g_device.vkCmdPipelineBarrier(
+            commandBuffer,
+            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            0, // dependencyFlags
+            0, // memoryBarrierCount
+            nullptr, // pMemoryBarries
+            0, // bufferMemoryCount
+            nullptr, // pBufferMemoryBarriers
+            1, // imageMemoryarrierCount
+            &g_prepareFrameState.barrierPresentToDraw);
+
+        g_prepareFrameState.renderPassBeginInfo.renderPass = g_renderPass;
+        g_prepareFrameState.renderPassBeginInfo.framebuffer = imageResources.frameBuffer;
+
+        g_device.vkCmdBeginRenderPass(commandBuffer, &g_prepareFrameState.renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+        g_device.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, g_upscalePipeline);
+
+        g_device.vkCmdSetViewport(commandBuffer, 0, 1, &g_prepareFrameState.viewport);
+        g_device.vkCmdSetScissor(commandBuffer, 0, 1, &g_prepareFrameState.scissor);
+
+        assert(g_upscalePipelineLayout != VK_NULL_HANDLE);
+        assert(imageResources.upscaleDescriptorSet != VK_NULL_HANDLE);
+        g_device.vkCmdBindDescriptorSets(
+            commandBuffer,
+            VK_PIPELINE_BIND_POINT_GRAPHICS,
+            g_upscalePipelineLayout,
+            0, // first set
+            1, // descriptor set count
+            &imageResources.upscaleDescriptorSet,
+            1, // dynamic offset count
+            &frameUniformsOffset /* dynamic offsets */);
+
+        g_device.vkCmdDraw(commandBuffer, 4, 1, 0, 0);
+        g_device.vkCmdEndRenderPass(commandBuffer);
+
+        g_prepareFrameState.barrierDrawToPresent.image = image.handle;
+        g_prepareFrameState.barrierDrawToPresent.srcQueueFamilyIndex = graphicsQueueFamilyIndex;
+        g_prepareFrameState.barrierDrawToPresent.dstQueueFamilyIndex = presentQueueFamilyIndex;
+
+        g_device.vkCmdPipelineBarrier(
+            commandBuffer,
+            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+            0, // dependencyFlags
+            0, // memoryBarrierCount
+            nullptr, // pMemoryBarries
+            0, // bufferMemoryCount
+            nullptr, // pBufferMemoryBarriers
+            1, // imageMemoryarrierCount
+            &g_prepareFrameState.barrierDrawToPresent);
+
+        EndGpuScope(commandBuffer, imageIndex, renderer::EGpuScope::Upscale);
+    } // ~Upscale pass
+    /////////////////////////////////
 }
 
-VkShaderModule CreateShaderModule(const char* fileName, const platform::SFile& shaderFile)
+// Caller must guarantee the image's previous submission has completed
+bool RecordStaticCommandBuffer(uint32_t imageIndex)
 {
-    assert(shaderFile.numBytes > 0);
-    assert(shaderFile.pData != nullptr);
-    assert(fileName != nullptr);
-    VkShaderModuleCreateInfo  shaderModuleCreateInfo;
-    shaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    shaderModuleCreateInfo.pNext = nullptr;
-    shaderModuleCreateInfo.flags = 0;
-    shaderModuleCreateInfo.codeSize = shaderFile.numBytes;
-    shaderModuleCreateInfo.pCode = reinterpret_cast<const uint32_t*>(shaderFile.pData.get());
+    assert(imageIndex < g_swapChain.imageCount);
+    SImageResources& imageResources = g_imageResources[imageIndex];
+    assert(imageResources.staticCommandBuffer != VK_NULL_HANDLE);
 
-    VkShaderModule shaderModule;
-    if (g_device.vkCreateShaderModule(
-        g_device.handle,
-        &shaderModuleCreateInfo,
-        g_pAllocationCallbacks,
-        &shaderModule) != VK_SUCCESS)
+    VkCommandBufferBeginInfo commandBufferBeginInfo;
+    commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    commandBufferBeginInfo.pNext = nullptr;
+    commandBufferBeginInfo.flags = 0; // submitted many times, never simultaneously
+    commandBufferBeginInfo.pInheritanceInfo = nullptr;
+
+    g_device.vkBeginCommandBuffer(imageResources.staticCommandBuffer, &commandBufferBeginInfo);
+    RecordRenderCommands(imageResources.staticCommandBuffer, imageIndex);
+    if (g_device.vkEndCommandBuffer(imageResources.staticCommandBuffer) != VK_SUCCESS)
     {
-        DiracError("Failed to create shader module for shader file: %s", fileName);
-        return VK_NULL_HANDLE;
+        DiracError("Vulkan could not record static command buffer for swap chain image %u!", imageIndex);
+        return false;
     }
 
-    return shaderModule;
+    imageResources.recordedGeneration = g_staticCommandBufferGeneration;
+    DiracLog(2, "[Renderer] recorded static command buffer for swap chain image %u (generation %llu)", imageIndex, (unsigned long long)g_staticCommandBufferGeneration);
+    return true;
 }
 
-ERunResult DestroyState()
+// Per-frame recording: uploads any dirty scene data and records the whole frame into commandBuffer
+bool PrepareFrame(
+    VkCommandBuffer commandBuffer,
+    uint32_t imageIndex,
+    const SFrameContext& /*frameContext*/)
 {
-    ERunResult destroyResult = g_device.state == SDevice::EState::Initialized ? eRR_Success : eRR_Error;
-    if (g_device.handle != VK_NULL_HANDLE)
-    {
-        g_device.vkDeviceWaitIdle(g_device.handle);
+    PROFILE_FUNCTION();
+    assert(commandBuffer != VK_NULL_HANDLE);
 
-        for (size_t i = 0; i < RENDER_RESOURCES_COUNT; ++i)
-        {
-            SRenderResources& resource = g_renderResources[i];
-            if (resource.frameBuffer != VK_NULL_HANDLE)
-            {
-                g_device.vkDestroyFramebuffer(g_device.handle, resource.frameBuffer, g_pAllocationCallbacks);
-            }
+    g_device.vkBeginCommandBuffer(commandBuffer, &g_prepareFrameState.commandBufferBeginInfo);
 
-            if (resource.commandBuffer != VK_NULL_HANDLE)
-            {
+#if 0 // Debug movement
+    for (size_t i = 0; i < 4; ++i)
+    {
+        Vec4l translation = g_invShapeTransforms[i].GetRow4();
+        Vec3l mvt = Vec3l(translation.x, translation.y, translation.z).Normalized();
+        mvt.Scale(float(TSeconds(frameContext.lastFrameDuration).count()));
+        translation = translation + Vec4l(mvt.x, mvt.y, mvt.z, 0.0);
+        g_invShapeTransforms[i].SetRow4(translation);
+    }
+    MarkSceneDirty(0, 3);
+#endif
+
+    if (!FlushDirtySceneSDF(commandBuffer, imageIndex))
+        return false;
+
+    RecordRenderCommands(commandBuffer, imageIndex);
+
+    if (g_device.vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+    {
+        DiracError("Vulkan could not record command buffers!");
+        return false;
+    }
+
+    return true;
+}
+
+// Prerecorded mode: the only per-frame recording is the shape upload, and only when the scene changed.
+// Returns true with *pbRecorded == false when there is nothing to upload
+bool PrepareSceneUpload(VkCommandBuffer commandBuffer, uint32_t imageIndex, bool* pbRecorded)
+{
+    assert(commandBuffer != VK_NULL_HANDLE);
+    assert(pbRecorded != nullptr);
+    *pbRecorded = false;
+    if (!g_bSceneDirty)
+        return true;
+
+    g_device.vkBeginCommandBuffer(commandBuffer, &g_prepareFrameState.commandBufferBeginInfo);
+    if (!FlushDirtySceneSDF(commandBuffer, imageIndex))
+        return false;
+
+    if (g_device.vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+    {
+        DiracError("Vulkan could not record scene upload command buffer!");
+        return false;
+    }
+
+    *pbRecorded = true;
+    return true;
+}
+
+VkShaderModule CreateShaderModule(const char* fileName, const platform::SFile& shaderFile)
+{
+    assert(shaderFile.numBytes > 0);
+    assert(shaderFile.pBytes != nullptr);
+    assert(fileName != nullptr);
+    VkShaderModuleCreateInfo  shaderModuleCreateInfo;
+    shaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    shaderModuleCreateInfo.pNext = nullptr;
+    shaderModuleCreateInfo.flags = 0;
+    shaderModuleCreateInfo.codeSize = shaderFile.numBytes;
+    shaderModuleCreateInfo.pCode = reinterpret_cast<const uint32_t*>(shaderFile.pBytes);
+
+    VkShaderModule shaderModule;
+    if (g_device.vkCreateShaderModule(
+        g_device.handle,
+        &shaderModuleCreateInfo,
+        g_pAllocationCallbacks,
+        &shaderModule) != VK_SUCCESS)
+    {
+        DiracError("Failed to create shader module for shader file: %s", fileName);
+        return VK_NULL_HANDLE;
+    }
+
+    return shaderModule;
+}
+
+renderer::SPipelineCacheKey GetPipelineCacheKey()
+{
+    renderer::SPipelineCacheKey key;
+    key.vendorId = g_device.properties.vendorID;
+    key.deviceId = g_device.properties.deviceID;
+    key.driverVersion = g_device.properties.driverVersion;
+    static_assert(sizeof(key.pipelineCacheUUID) == VK_UUID_SIZE, "pipeline cache UUID size mismatch");
+    memcpy(key.pipelineCacheUUID, g_device.properties.pipelineCacheUUID, VK_UUID_SIZE);
+    return key;
+}
+
+// Falls back to an empty cache whenever the file is missing or invalid
+bool CreatePipelineCache()
+{
+    assert(g_device.handle != VK_NULL_HANDLE);
+    assert(g_pipelineCache == VK_NULL_HANDLE);
+
+    const TTime loadStartTime = TSteadyClock::now();
+    const renderer::SPipelineCacheKey key = GetPipelineCacheKey();
+    char fileName[256];
+    platform::SFile file;
+    const char* pInitialData = nullptr;
+    size_t initialDataSize = 0;
+
+    if (!renderer::MakePipelineCacheFileName(PIPELINE_CACHE_DIRECTORY, key, fileName, sizeof(fileName)))
+    {
+        DiracError("[%s] pipeline cache file name too long!", __FUNCTION__);
+    }
+    else if (platform::FileExists(fileName))
+    {
+        const char* fileNames[] = { fileName };
+        if (platform::LoadFiles(fileNames, 1, platform::EFileType::Binary, &file))
+        {
+            const renderer::EPipelineCacheValidation validation = renderer::ValidatePipelineCacheFile(file.pBytes, file.numBytes, key, &pInitialData, &initialDataSize);
+            if (validation != renderer::EPipelineCacheValidation::Valid)
+            {
+                DiracLog(1, "[Renderer] discarding pipeline cache %s: %s", fileName, renderer::ToString(validation));
+                pInitialData = nullptr;
+                initialDataSize = 0;
+            }
+        }
+    }
+    else
+    {
+        DiracLog(1, "[Renderer] no pipeline cache found at %s", fileName);
+    }
+
+    VkPipelineCacheCreateInfo pipelineCacheCreateInfo;
+    pipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    pipelineCacheCreateInfo.pNext = nullptr;
+    pipelineCacheCreateInfo.flags = 0;
+    pipelineCacheCreateInfo.initialDataSize = initialDataSize;
+    pipelineCacheCreateInfo.pInitialData = pInitialData;
+
+    if (g_device.vkCreatePipelineCache(g_device.handle, &pipelineCacheCreateInfo, g_pAllocationCallbacks, &g_pipelineCache) != VK_SUCCESS)
+    {
+        DiracError("Vulkan failed to create pipeline cache!");
+        return false;
+    }
+
+    g_pipelineCacheLoadedSize = initialDataSize;
+    DiracLog(1, "[Renderer] pipeline cache %s (%zu bytes) in %.3f ms",
+        initialDataSize > 0 ? "loaded" : "empty",
+        initialDataSize,
+        TMilliseconds(TSteadyClock::now() - loadStartTime).count());
+    return true;
+}
+
+bool SavePipelineCache()
+{
+    assert(g_pipelineCache != VK_NULL_HANDLE);
+
+    size_t dataSize = 0;
+    if (g_device.vkGetPipelineCacheData(g_device.handle, g_pipelineCache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0)
+    {
+        DiracError("[%s] Vulkan failed to get pipeline cache size!", __FUNCTION__);
+        return false;
+    }
+
+    std::vector<char> data(dataSize);
+    if (g_device.vkGetPipelineCacheData(g_device.handle, g_pipelineCache, &dataSize, data.data()) != VK_SUCCESS)
+    {
+        DiracError("[%s] Vulkan failed to get pipeline cache data!", __FUNCTION__);
+        return false;
+    }
+
+    const renderer::SPipelineCacheKey key = GetPipelineCacheKey();
+    char fileName[256];
+    if (!renderer::MakePipelineCacheFileName(PIPELINE_CACHE_DIRECTORY, key, fileName, sizeof(fileName)))
+    {
+        DiracError("[%s] pipeline cache file name too long!", __FUNCTION__);
+        return false;
+    }
+
+    std::vector<char> file;
+    renderer::BuildPipelineCacheFile(key, data.data(), dataSize, &file);
+    if (!platform::WriteFileAtomic(fileName, file.data(), file.size()))
+    {
+        DiracError("[%s] failed to write pipeline cache: %s", __FUNCTION__, fileName);
+        return false;
+    }
+
+    DiracLog(1, "[Renderer] saved pipeline cache %s (%zu bytes, %zu at startup)", fileName, dataSize, g_pipelineCacheLoadedSize);
+    return true;
+}
+
+ERunResult DestroyState()
+{
+    ERunResult destroyResult = g_device.state == SDevice::EState::Initialized ? eRR_Success : eRR_Error;
+    if (g_device.handle != VK_NULL_HANDLE)
+    {
+        g_device.vkDeviceWaitIdle(g_device.handle);
+
+        for (size_t i = 0; i < RENDER_RESOURCES_COUNT; ++i)
+        {
+            SRenderResources& resource = g_renderResources[i];
+            if (resource.commandBuffer != VK_NULL_HANDLE)
+            {
                 g_device.vkFreeCommandBuffers(g_device.handle, g_graphicsCommandPool, 1, &resource.commandBuffer);
                 resource.commandBuffer = VK_NULL_HANDLE;
             }
@@ -1128,6 +1847,52 @@ ERunResult DestroyState()
             resource = SRenderResources();
         }
 
+        for (size_t i = 0; i < MAX_IMAGE_COUNT; ++i)
+        {
+            SImageResources& imageResource = g_imageResources[i];
+            if (imageResource.frameBuffer != VK_NULL_HANDLE)
+            {
+                g_device.vkDestroyFramebuffer(g_device.handle, imageResource.frameBuffer, g_pAllocationCallbacks);
+            }
+
+            if (imageResource.sceneFrameBuffer != VK_NULL_HANDLE)
+            {
+                g_device.vkDestroyFramebuffer(g_device.handle, imageResource.sceneFrameBuffer, g_pAllocationCallbacks);
+            }
+
+            if (imageResource.sceneColor.view != VK_NULL_HANDLE)
+            {
+                g_device.vkDestroyImageView(g_device.handle, imageResource.sceneColor.view, g_pAllocationCallbacks);
+            }
+
+            if (imageResource.sceneColor.handle != VK_NULL_HANDLE)
+            {
+                g_device.vkDestroyImage(g_device.handle, imageResource.sceneColor.handle, g_pAllocationCallbacks);
+            }
+
+            if (imageResource.sceneColor.memory != VK_NULL_HANDLE)
+            {
+                g_device.vkFreeMemory(g_device.handle, imageResource.sceneColor.memory, g_pAllocationCallbacks);
+            }
+
+            if (imageResource.staticCommandBuffer != VK_NULL_HANDLE)
+            {
+                g_device.vkFreeCommandBuffers(g_device.handle, g_graphicsCommandPool, 1, &imageResource.staticCommandBuffer);
+            }
+
+            if (imageResource.timestampQueryPool != VK_NULL_HANDLE)
+            {
+                g_device.vkDestroyQueryPool(g_device.handle, imageResource.timestampQueryPool, g_pAllocationCallbacks);
+            }
+
+            if (imageResource.statisticsQueryPool != VK_NULL_HANDLE)
+            {
+                g_device.vkDestroyQueryPool(g_device.handle, imageResource.statisticsQueryPool, g_pAllocationCallbacks);
+            }
+
+            imageResource = SImageResources();
+        }
+
         if (g_graphicsCommandPool != VK_NULL_HANDLE)
         {
             g_device.vkDestroyCommandPool(g_device.handle, g_graphicsCommandPool, g_pAllocationCallbacks);
@@ -1215,6 +1980,75 @@ ERunResult DestroyState()
             destroyResult = eRR_Error;
         }
 
+        if (g_computePipeline != VK_NULL_HANDLE)
+        {
+            g_device.vkDestroyPipeline(g_device.handle, g_computePipeline, g_pAllocationCallbacks);
+            g_computePipeline = VK_NULL_HANDLE;
+        }
+
+        if (g_computePipelineLayout != VK_NULL_HANDLE)
+        {
+            g_device.vkDestroyPipelineLayout(g_device.handle, g_computePipelineLayout, g_pAllocationCallbacks);
+            g_computePipelineLayout = VK_NULL_HANDLE;
+        }
+
+        if (g_computeDescriptorPool != VK_NULL_HANDLE)
+        {
+            g_device.vkDestroyDescriptorPool(g_device.handle, g_computeDescriptorPool, g_pAllocationCallbacks);
+            g_computeDescriptorPool = VK_NULL_HANDLE;
+        }
+
+        if (g_computeDescriptorSetLayout != VK_NULL_HANDLE)
+        {
+            g_device.vkDestroyDescriptorSetLayout(g_device.handle, g_computeDescriptorSetLayout, g_pAllocationCallbacks);
+            g_computeDescriptorSetLayout = VK_NULL_HANDLE;
+        }
+
+        if (g_computeShaderModule != VK_NULL_HANDLE)
+        {
+            g_device.vkDestroyShaderModule(g_device.handle, g_computeShaderModule, g_pAllocationCallbacks);
+            g_computeShaderModule = VK_NULL_HANDLE;
+        }
+
+        g_computeShaderFile = platform::SFile();
+
+        if (g_upscalePipeline != VK_NULL_HANDLE)
+        {
+            g_device.vkDestroyPipeline(g_device.handle, g_upscalePipeline, g_pAllocationCallbacks);
+            g_upscalePipeline = VK_NULL_HANDLE;
+        }
+
+        if (g_upscalePipelineLayout != VK_NULL_HANDLE)
+        {
+            g_device.vkDestroyPipelineLayout(g_device.handle, g_upscalePipelineLayout, g_pAllocationCallbacks);
+            g_upscalePipelineLayout = VK_NULL_HANDLE;
+        }
+
+        if (g_upscaleDescriptorPool != VK_NULL_HANDLE)
+        {
+            g_device.vkDestroyDescriptorPool(g_device.handle, g_upscaleDescriptorPool, g_pAllocationCallbacks);
+            g_upscaleDescriptorPool = VK_NULL_HANDLE;
+        }
+
+        if (g_upscaleDescriptorSetLayout != VK_NULL_HANDLE)
+        {
+            g_device.vkDestroyDescriptorSetLayout(g_device.handle, g_upscaleDescriptorSetLayout, g_pAllocationCallbacks);
+            g_upscaleDescriptorSetLayout = VK_NULL_HANDLE;
+        }
+
+        if (g_sceneColorSampler != VK_NULL_HANDLE)
+        {
+            g_device.vkDestroySampler(g_device.handle, g_sceneColorSampler, g_pAllocationCallbacks);
+            g_sceneColorSampler = VK_NULL_HANDLE;
+        }
+
+        if (g_pipelineCache != VK_NULL_HANDLE)
+        {
+            SavePipelineCache();
+            g_device.vkDestroyPipelineCache(g_device.handle, g_pipelineCache, g_pAllocationCallbacks);
+            g_pipelineCache = VK_NULL_HANDLE;
+        }
+
         if (DefaultShaders.DestroyShaderModules() == false)
         {
             DiracError("[Renderer] Unloading destroying default shader modules found unexpected behavior!");
@@ -1232,6 +2066,17 @@ ERunResult DestroyState()
             destroyResult = eRR_Error;
         }
 
+        if (g_sceneRenderPass != VK_NULL_HANDLE)
+        {
+            g_device.vkDestroyRenderPass(g_device.handle, g_sceneRenderPass, g_pAllocationCallbacks);
+            g_sceneRenderPass = VK_NULL_HANDLE;
+        }
+        else
+        {
+            DiracError("[%s] g_sceneRenderPass is unexpectedly null!", __FUNCTION__);
+            destroyResult = eRR_Error;
+        }
+
         if (g_descriptorSet.pool != VK_NULL_HANDLE)
         {
             g_device.vkDestroyDescriptorPool(g_device.handle, g_descriptorSet.pool, g_pAllocationCallbacks);
@@ -1276,6 +2121,34 @@ ERunResult DestroyState()
             destroyResult = eRR_Error;
         }
 
+        if (g_pMappedFrameUniforms != nullptr)
+        {
+            g_device.vkUnmapMemory(g_device.handle, g_frameUniformBuffer.memory);
+            g_pMappedFrameUniforms = nullptr;
+        }
+
+        if (g_frameUniformBuffer.handle != VK_NULL_HANDLE)
+        {
+            g_device.vkDestroyBuffer(g_device.handle, g_frameUniformBuffer.handle, g_pAllocationCallbacks);
+            g_frameUniformBuffer.handle = VK_NULL_HANDLE;
+        }
+        else
+        {
+            DiracError("[%s] g_frameUniformBuffer.handle is unexpectedly null!", __FUNCTION__);
+            destroyResult = eRR_Error;
+        }
+
+        if (g_frameUniformBuffer.memory != VK_NULL_HANDLE)
+        {
+            g_device.vkFreeMemory(g_device.handle, g_frameUniformBuffer.memory, g_pAllocationCallbacks);
+            g_frameUniformBuffer.memory = VK_NULL_HANDLE;
+        }
+        else
+        {
+            DiracError("[%s] g_frameUniformBuffer.memory is unexpectedly null!", __FUNCTION__);
+            destroyResult = eRR_Error;
+        }
+
         if (g_image.sampler != VK_NULL_HANDLE)
         {
             g_device.vkDestroySampler(g_device.handle, g_image.sampler, g_pAllocationCallbacks);
@@ -1379,6 +2252,15 @@ ERunResult DestroyState()
 
     SDL_Vulkan_UnloadLibrary();
 
+    if (g_textureReadHandle != platform::kInvalidAsyncReadHandle)
+    {
+        // initialization failed before CreateTexture consumed the read
+        platform::WaitForAsyncRead(g_textureReadHandle);
+        g_textureReadHandle = platform::kInvalidAsyncReadHandle;
+    }
+
+    g_textureFile = platform::SFile();
+
     if (DefaultShaders.UnloadFiles() == false)
     {
         DiracError("[Renderer] Unloading default shader files found unexpected behavior!");
@@ -1481,19 +2363,39 @@ bool CreateTexture()
 {
     assert(g_device.handle != VK_NULL_HANDLE);
     assert(g_device.state == SDevice::EState::Initialized);
-    platform::ImageSurfacePtr pImage = platform::LoadImage("data/images/tentacle.bmp");
-    if (!pImage)
+    assert(g_textureReadHandle != platform::kInvalidAsyncReadHandle);
+    const bool bTextureRead = platform::WaitForAsyncRead(g_textureReadHandle);
+    g_textureReadHandle = platform::kInvalidAsyncReadHandle;
+    renderer::STextureView texture;
+    if (!bTextureRead || !renderer::OpenTexture(g_textureFile.pBytes, g_textureFile.numBytes, &texture))
     {
         DiracLog(1, "[%s] Failed to load texture!", __FUNCTION__);
+        g_textureFile = platform::SFile();
         return false;
     }
 
-    static const uint32_t kRGBASize = sizeof(uint32_t);
-    const uint32_t formatPixelSize = pImage->format->BytesPerPixel;
-    const VkFormat imageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+    const VkFormat imageFormat = (VkFormat)texture.pHeader->vkFormat;
+    const uint32_t mipCount = texture.pHeader->mipCount;
+    const VkDeviceSize dataSize = texture.pHeader->dataSize;
+
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(g_device.physicalDevice, imageFormat, &formatProperties);
+    if ((formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) == 0)
+    {
+        DiracLog(1, "[%s] texture format %u is not supported by the device, recook it with another format", __FUNCTION__, (uint32_t)imageFormat);
+        g_textureFile = platform::SFile();
+        return false;
+    }
 
-    assert(pImage->w > 0);
-    assert(pImage->h > 0);
+    if (dataSize > g_stagingBuffer.size)
+    {
+        DiracLog(1, "[%s] texture needs %llu bytes of staging memory, only %llu are available",
+            __FUNCTION__,
+            (unsigned long long)dataSize,
+            (unsigned long long)g_stagingBuffer.size);
+        g_textureFile = platform::SFile();
+        return false;
+    }
 
     /////////////////////////////////
     { // create image
@@ -1503,8 +2405,8 @@ bool CreateTexture()
         imageCreateInfo.flags = 0;
         imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
         imageCreateInfo.format = imageFormat;
-        imageCreateInfo.extent = { (uint32_t)pImage->w, (uint32_t)pImage->h, 1 };
-        imageCreateInfo.mipLevels = 1;
+        imageCreateInfo.extent = { texture.pHeader->width, texture.pHeader->height, 1 };
+        imageCreateInfo.mipLevels = mipCount;
         imageCreateInfo.arrayLayers = 1;
         imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
         imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
@@ -1604,7 +2506,7 @@ bool CreateTexture()
 
         imageViewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
         imageViewCreateInfo.subresourceRange.baseMipLevel = 0;
-        imageViewCreateInfo.subresourceRange.levelCount = 1;
+        imageViewCreateInfo.subresourceRange.levelCount = mipCount;
         imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
         imageViewCreateInfo.subresourceRange.layerCount = 1;
 
@@ -1628,7 +2530,7 @@ bool CreateTexture()
         samplerCreateInfo.flags = 0;
         samplerCreateInfo.magFilter = VK_FILTER_LINEAR;
         samplerCreateInfo.minFilter = VK_FILTER_LINEAR;
-        samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
         samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
         samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
         samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
@@ -1638,7 +2540,7 @@ bool CreateTexture()
         samplerCreateInfo.compareEnable = VK_FALSE;
         samplerCreateInfo.compareOp = VK_COMPARE_OP_ALWAYS;
         samplerCreateInfo.minLod = 0.0f;
-        samplerCreateInfo.maxLod = 0.0f;
+        samplerCreateInfo.maxLod = (float)mipCount;
         samplerCreateInfo.borderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
         samplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
 
@@ -1661,46 +2563,28 @@ bool CreateTexture()
         assert(g_stagingBuffer.size > 0);
 
         ///////////////////////////////////////////////////////
-        // 1. Copy texture data from image to staging buffer
+        // 1. Copy every level to the staging buffer, the cooked layout is already what the copy expects
 
-        const uint32_t dataSize = pImage->pitch * (uint32_t)pImage->h;
-        assert(g_stagingBuffer.size >= dataSize);
         assert(g_pMappedStagingBuffer != nullptr);
+        memcpy(g_pMappedStagingBuffer, texture.pData, (size_t)dataSize);
 
-        // TODO: Load images in a better/consistent format to allow for memcpy
-        // instead of SDL_GetRGBA (and support across platforms/endianness)
-
-        const size_t width = (size_t)pImage->w;
-        const size_t height = (size_t)pImage->h;
-        const SDL_PixelFormat* srcFormat = pImage->format;
-        const uint32_t* srcPixels = (uint32_t*)pImage->pixels;
-        uint32_t* dstPixels = (uint32_t*)g_pMappedStagingBuffer;
-
-        if (formatPixelSize == kRGBASize && !kIsBigEndian && srcFormat->format == SDL_PIXELFORMAT_RGBA32)
+        VkBufferImageCopy bufferImageCopies[renderer::kMaxTextureMipCount];
+        for (uint32_t i = 0; i < mipCount; ++i)
         {
-            memcpy(dstPixels, srcPixels, dataSize);
+            const renderer::STextureLevel& level = texture.pLevels[i];
+            VkBufferImageCopy& bufferImageCopy = bufferImageCopies[i];
+            bufferImageCopy.bufferOffset = level.offset;
+            bufferImageCopy.bufferRowLength = 0; // tightly packed
+            bufferImageCopy.bufferImageHeight = 0;
+            bufferImageCopy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            bufferImageCopy.imageSubresource.mipLevel = i;
+            bufferImageCopy.imageSubresource.baseArrayLayer = 0;
+            bufferImageCopy.imageSubresource.layerCount = 1;
+            bufferImageCopy.imageOffset = { 0, 0, 0 };
+            bufferImageCopy.imageExtent = { level.width, level.height, 1 };
         }
-        else
-        {
-            struct SRGBA
-            {
-                uint8_t r, g, b, a;
-            } rgba;
-            static_assert(sizeof(SRGBA) == kRGBASize);
 
-            for (size_t h = 0; h < height; ++h)
-            {
-                for (size_t w = 0; w < width; ++w)
-                {
-                    const size_t pos = w + (h * width);
-                    SDL_GetRGBA(
-                        srcPixels[pos],
-                        srcFormat,
-                        &rgba.r, &rgba.g, &rgba.b, &rgba.a);
-                    memcpy(dstPixels + pos, &rgba, kRGBASize);
-                }
-            }
-        }
+        g_textureFile = platform::SFile(); // texture views are invalid from here on
 
         const VkDeviceSize flushSize = (dataSize + g_device.memoryAlignment - 1) / g_device.memoryAlignment;
 
@@ -1740,7 +2624,7 @@ bool CreateTexture()
 
         imageMemoryBarrierUndefinedToTransferDST.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
         imageMemoryBarrierUndefinedToTransferDST.subresourceRange.baseMipLevel = 0;
-        imageMemoryBarrierUndefinedToTransferDST.subresourceRange.levelCount = 1;
+        imageMemoryBarrierUndefinedToTransferDST.subresourceRange.levelCount = mipCount;
         imageMemoryBarrierUndefinedToTransferDST.subresourceRange.baseArrayLayer = 0;
         imageMemoryBarrierUndefinedToTransferDST.subresourceRange.layerCount = 1;
 
@@ -1756,24 +2640,13 @@ bool CreateTexture()
             1, // image memory barrier count
             &imageMemoryBarrierUndefinedToTransferDST);
 
-        VkBufferImageCopy bufferImageCopy;
-        bufferImageCopy.bufferOffset = 0;
-        bufferImageCopy.bufferRowLength = 0;
-        bufferImageCopy.bufferImageHeight = 0;
-        bufferImageCopy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        bufferImageCopy.imageSubresource.mipLevel = 0;
-        bufferImageCopy.imageSubresource.baseArrayLayer = 0;
-        bufferImageCopy.imageSubresource.layerCount = 1;
-        bufferImageCopy.imageOffset = { 0, 0, 0 };
-        bufferImageCopy.imageExtent = { (uint32_t)width, (uint32_t)height, 1 };
-
         g_device.vkCmdCopyBufferToImage(
             commandBuffer,
             g_stagingBuffer.handle,
             g_image.handle,
             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            1, // region count
-            &bufferImageCopy);
+            mipCount, // region count
+            bufferImageCopies);
 
         VkImageMemoryBarrier imageMemoryBarrierTransferToShaderRead;
         imageMemoryBarrierTransferToShaderRead.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -1787,50 +2660,681 @@ bool CreateTexture()
         imageMemoryBarrierTransferToShaderRead.image = g_image.handle;
         imageMemoryBarrierTransferToShaderRead.subresourceRange = imageMemoryBarrierUndefinedToTransferDST.subresourceRange;
 
-        g_device.vkCmdPipelineBarrier(
-            commandBuffer,
-            VK_PIPELINE_STAGE_TRANSFER_BIT,
-            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-            0, // dependency flags
-            0, // memory barrier count
-            nullptr, // memory barriers
-            0, // buffer memory barrier count
-            nullptr, // buffer memory barriers
-            1, // image barrier count
-            &imageMemoryBarrierTransferToShaderRead);
+        g_device.vkCmdPipelineBarrier(
+            commandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            0, // dependency flags
+            0, // memory barrier count
+            nullptr, // memory barriers
+            0, // buffer memory barrier count
+            nullptr, // buffer memory barriers
+            1, // image barrier count
+            &imageMemoryBarrierTransferToShaderRead);
+
+        g_device.vkEndCommandBuffer(commandBuffer);
+
+        VkSubmitInfo submitInfo;
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.pNext = nullptr;
+        submitInfo.waitSemaphoreCount = 0;
+        submitInfo.pWaitSemaphores = nullptr;
+        submitInfo.pWaitDstStageMask = nullptr;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &commandBuffer;
+        submitInfo.signalSemaphoreCount = 0;
+        submitInfo.pSignalSemaphores = nullptr;
+
+        if (g_device.vkQueueSubmit(
+            g_device.graphicsQueue,
+            1, // submit count
+            &submitInfo,
+            VK_NULL_HANDLE /* fence */) != VK_SUCCESS)
+        {
+            DiracLog(1, "[%s] failed to queue command buffer submission!", __FUNCTION__);
+            return false;
+        }
+
+        // TODO: consider synchronization later more fully with architecture,
+        // Use semaphores to coordinate instead of just waiting on the device
+        g_device.vkDeviceWaitIdle(g_device.handle);
+    } // ~copy texture data
+    /////////////////////////////////
+
+    return true;
+}
+
+bool CreateColorTarget(const VkExtent2D& extent, VkFormat format, VkImageUsageFlags usage, SImage& outImage)
+{
+    assert(g_device.handle != VK_NULL_HANDLE);
+    assert(outImage.handle == VK_NULL_HANDLE);
+
+    /////////////////////////////////
+    { // create image
+        VkImageCreateInfo imageCreateInfo;
+        imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageCreateInfo.pNext = nullptr;
+        imageCreateInfo.flags = 0;
+        imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageCreateInfo.format = format;
+        imageCreateInfo.extent = { extent.width, extent.height, 1 };
+        imageCreateInfo.mipLevels = 1;
+        imageCreateInfo.arrayLayers = 1;
+        imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageCreateInfo.usage = usage;
+        imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageCreateInfo.queueFamilyIndexCount = 0;
+        imageCreateInfo.pQueueFamilyIndices = nullptr;
+        imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        if (g_device.vkCreateImage(
+            g_device.handle,
+            &imageCreateInfo,
+            g_pAllocationCallbacks,
+            &outImage.handle) != VK_SUCCESS)
+        {
+            DiracLog(1, "[%s] Vulkan failed to create image!", __FUNCTION__);
+            return false;
+        }
+    } // ~create image
+    /////////////////////////////////
+
+    /////////////////////////////////
+    { // allocate and bind image memory
+        VkMemoryRequirements imageMemoryRequirements;
+        g_device.vkGetImageMemoryRequirements(g_device.handle, outImage.handle, &imageMemoryRequirements);
+
+        VkPhysicalDeviceMemoryProperties memoryProperties;
+        vkGetPhysicalDeviceMemoryProperties(g_device.physicalDevice, &memoryProperties);
+
+        VkMemoryAllocateInfo memoryAllocateInfo;
+        memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        memoryAllocateInfo.pNext = nullptr;
+        memoryAllocateInfo.allocationSize = imageMemoryRequirements.size;
+        memoryAllocateInfo.memoryTypeIndex = 0; // filled out in loop below
+
+        bool bAllocatedMemory = false;
+        for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i)
+        {
+            if ((imageMemoryRequirements.memoryTypeBits & BIT(i)) &&
+                (memoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT))
+            {
+                memoryAllocateInfo.memoryTypeIndex = i;
+                if (g_device.vkAllocateMemory(
+                    g_device.handle,
+                    &memoryAllocateInfo,
+                    g_pAllocationCallbacks,
+                    &outImage.memory) == VK_SUCCESS)
+                {
+                    bAllocatedMemory = true;
+                    break;
+                }
+            }
+        }
+
+        if (bAllocatedMemory == false)
+        {
+            DiracLog(1, "[%s] Failed to allocate memory for image!", __FUNCTION__);
+            return false;
+        }
+
+        if (g_device.vkBindImageMemory(g_device.handle, outImage.handle, outImage.memory, 0 /* memory offset */) != VK_SUCCESS)
+        {
+            DiracLog(1, "[%s] Vulkan failed to bind image memory!", __FUNCTION__);
+            return false;
+        }
+    } // ~allocate and bind image memory
+    /////////////////////////////////
+
+    /////////////////////////////////
+    { // create image view
+        VkImageViewCreateInfo imageViewCreateInfo;
+        imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        imageViewCreateInfo.pNext = nullptr;
+        imageViewCreateInfo.flags = 0;
+        imageViewCreateInfo.image = outImage.handle;
+        imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        imageViewCreateInfo.format = format;
+
+        imageViewCreateInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+        imageViewCreateInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+        imageViewCreateInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+        imageViewCreateInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+
+        imageViewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        imageViewCreateInfo.subresourceRange.baseMipLevel = 0;
+        imageViewCreateInfo.subresourceRange.levelCount = 1;
+        imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
+        imageViewCreateInfo.subresourceRange.layerCount = 1;
+
+        if (g_device.vkCreateImageView(
+            g_device.handle,
+            &imageViewCreateInfo,
+            g_pAllocationCallbacks,
+            &outImage.view) != VK_SUCCESS)
+        {
+            DiracLog(1, "[%s] Failed to create image view!", __FUNCTION__);
+            return false;
+        }
+    } // ~create image view
+    /////////////////////////////////
+
+    return true;
+}
+
+// Scene color targets are allocated at the full swap chain extent so changing the render scale only
+// changes the viewport and render area, never reallocates
+bool CreateSceneColorTargets()
+{
+    assert(g_device.state == SDevice::EState::Initialized);
+    assert(g_sceneRenderPass != VK_NULL_HANDLE);
+
+    VkFramebufferCreateInfo frameBufferCreateInfo;
+    frameBufferCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    frameBufferCreateInfo.pNext = nullptr;
+    frameBufferCreateInfo.flags = 0;
+    frameBufferCreateInfo.renderPass = g_sceneRenderPass;
+    frameBufferCreateInfo.attachmentCount = 1;
+    frameBufferCreateInfo.pAttachments = nullptr; // set per image below
+    frameBufferCreateInfo.width = g_swapChain.extent.width;
+    frameBufferCreateInfo.height = g_swapChain.extent.height;
+    frameBufferCreateInfo.layers = 1;
+
+    for (uint32_t i = 0; i < g_swapChain.imageCount; ++i)
+    {
+        SImageResources& imageResources = g_imageResources[i];
+        if (!CreateColorTarget(
+            g_swapChain.extent,
+            SCENE_COLOR_FORMAT,
+            g_raymarchPath == ERaymarchPath::Compute
+                ? VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT
+                : VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+            imageResources.sceneColor))
+        {
+            DiracError("Vulkan failed to create scene color target!");
+            return false;
+        }
+
+        if (g_raymarchPath == ERaymarchPath::Compute)
+            continue;
+
+        assert(imageResources.sceneFrameBuffer == VK_NULL_HANDLE);
+        frameBufferCreateInfo.pAttachments = &imageResources.sceneColor.view;
+        if (g_device.vkCreateFramebuffer(
+            g_device.handle,
+            &frameBufferCreateInfo,
+            g_pAllocationCallbacks,
+            &imageResources.sceneFrameBuffer) != VK_SUCCESS)
+        {
+            DiracError("Vulkan failed to create scene frame buffer!");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool CreateUpscaleDescriptorSets()
+{
+    assert(g_device.state == SDevice::EState::Initialized);
+    static const uint32_t numDescriptors = 2;
+
+    /////////////////////////////////
+    { // create sampler
+        VkSamplerCreateInfo samplerCreateInfo;
+        samplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerCreateInfo.pNext = nullptr;
+        samplerCreateInfo.flags = 0;
+        samplerCreateInfo.magFilter = VK_FILTER_LINEAR;
+        samplerCreateInfo.minFilter = VK_FILTER_LINEAR;
+        samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerCreateInfo.mipLodBias = 0.0f;
+        samplerCreateInfo.anisotropyEnable = VK_FALSE;
+        samplerCreateInfo.maxAnisotropy = 1.0f;
+        samplerCreateInfo.compareEnable = VK_FALSE;
+        samplerCreateInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+        samplerCreateInfo.minLod = 0.0f;
+        samplerCreateInfo.maxLod = 0.0f;
+        samplerCreateInfo.borderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
+        samplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
+
+        if (g_device.vkCreateSampler(
+            g_device.handle,
+            &samplerCreateInfo,
+            g_pAllocationCallbacks,
+            &g_sceneColorSampler) != VK_SUCCESS)
+        {
+            DiracLog(1, "[%s] failed to create scene color sampler!", __FUNCTION__);
+            return false;
+        }
+    } // ~create sampler
+    /////////////////////////////////
+
+    /////////////////////////////////
+    { // create descriptor set layout
+        VkDescriptorSetLayoutBinding layoutBindings[numDescriptors]
+        {
+            {
+                0, // binding
+                VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, // descriptor type
+                1, // descriptor count
+                VK_SHADER_STAGE_FRAGMENT_BIT, // stage flags
+                nullptr // immutable samplers
+            },
+            {
+                1, // binding
+                VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, // descriptor type
+                1, // descriptor count
+                VK_SHADER_STAGE_FRAGMENT_BIT, // stage flags
+                nullptr // immutable samplers
+            }
+        };
+
+        VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo;
+        descriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        descriptorSetLayoutCreateInfo.pNext = nullptr;
+        descriptorSetLayoutCreateInfo.flags = 0;
+        descriptorSetLayoutCreateInfo.bindingCount = numDescriptors;
+        descriptorSetLayoutCreateInfo.pBindings = layoutBindings;
+
+        if (g_device.vkCreateDescriptorSetLayout(
+            g_device.handle,
+            &descriptorSetLayoutCreateInfo,
+            g_pAllocationCallbacks,
+            &g_upscaleDescriptorSetLayout) != VK_SUCCESS)
+        {
+            DiracLog(1, "[%s] failed to create upscale descriptor set layout!", __FUNCTION__);
+            return false;
+        }
+    } // ~create descriptor set layout
+    /////////////////////////////////
+
+    /////////////////////////////////
+    { // create descriptor pool
+        const VkDescriptorPoolSize poolSizes[numDescriptors] =
+        {
+            { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, g_swapChain.imageCount },
+            { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, g_swapChain.imageCount }
+        };
+
+        VkDescriptorPoolCreateInfo descriptorPoolCreateInfo;
+        descriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        descriptorPoolCreateInfo.pNext = nullptr;
+        descriptorPoolCreateInfo.flags = 0;
+        descriptorPoolCreateInfo.maxSets = g_swapChain.imageCount;
+        descriptorPoolCreateInfo.poolSizeCount = numDescriptors;
+        descriptorPoolCreateInfo.pPoolSizes = poolSizes;
+
+        if (g_device.vkCreateDescriptorPool(
+            g_device.handle,
+            &descriptorPoolCreateInfo,
+            g_pAllocationCallbacks,
+            &g_upscaleDescriptorPool) != VK_SUCCESS)
+        {
+            DiracLog(1, "[%s] failed to create upscale descriptor pool!", __FUNCTION__);
+            return false;
+        }
+    } // ~create descriptor pool
+    /////////////////////////////////
+
+    /////////////////////////////////
+    { // allocate and update descriptor sets
+        VkDescriptorSetAllocateInfo descriptorSetAllocateInfo;
+        descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        descriptorSetAllocateInfo.pNext = nullptr;
+        descriptorSetAllocateInfo.descriptorPool = g_upscaleDescriptorPool;
+        descriptorSetAllocateInfo.descriptorSetCount = 1;
+        descriptorSetAllocateInfo.pSetLayouts = &g_upscaleDescriptorSetLayout;
+
+        VkDescriptorBufferInfo frameUniformsInfo;
+        frameUniformsInfo.buffer = g_frameUniformBuffer.handle;
+        frameUniformsInfo.offset = 0; // offset per swap chain image is supplied when binding
+        frameUniformsInfo.range = sizeof(SFrameUniforms);
+
+        for (uint32_t i = 0; i < g_swapChain.imageCount; ++i)
+        {
+            SImageResources& imageResources = g_imageResources[i];
+            assert(imageResources.sceneColor.view != VK_NULL_HANDLE);
+            if (g_device.vkAllocateDescriptorSets(
+                g_device.handle,
+                &descriptorSetAllocateInfo,
+                &imageResources.upscaleDescriptorSet) != VK_SUCCESS)
+            {
+                DiracLog(1, "[%s] failed to allocate upscale descriptor set!", __FUNCTION__);
+                return false;
+            }
+
+            VkDescriptorImageInfo imageInfo;
+            imageInfo.sampler = g_sceneColorSampler;
+            imageInfo.imageView = imageResources.sceneColor.view;
+            imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+            VkWriteDescriptorSet descriptorWrites[numDescriptors] =
+            {
+                {
+                    VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, // sType
+                    nullptr, // pNext
+                    imageResources.upscaleDescriptorSet, // dstSet
+                    0, // dstBinding
+                    0, // dstArrayElement
+                    1, // descriptor count
+                    VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, // descriptorType
+                    &imageInfo, // pImageInfo
+                    nullptr, // pBufferInfo
+                    nullptr // pTexelBufferView
+                },
+                {
+                    VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, // sType
+                    nullptr, // pNext
+                    imageResources.upscaleDescriptorSet, // dstSet
+                    1, // dstBinding
+                    0, // dstArrayElement
+                    1, // descriptor count
+                    VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, // descriptorType
+                    nullptr, // pImageInfo
+                    &frameUniformsInfo, // pBufferInfo
+                    nullptr // pTexelBufferView
+                }
+            };
+
+            g_device.vkUpdateDescriptorSets(
+                g_device.handle,
+                numDescriptors, // descriptor write count
+                descriptorWrites,
+                0, // descriptor copy count
+                nullptr /* descriptor copies */);
+        }
+    } // ~allocate and update descriptor sets
+    /////////////////////////////////
+
+    return true;
+}
+
+bool CreateComputeRaymarchPipeline()
+{
+    assert(g_device.state == SDevice::EState::Initialized);
+    assert(g_raymarchPath == ERaymarchPath::Compute);
+    static const uint32_t numDescriptors = 3;
+
+    /////////////////////////////////
+    { // load shader
+        const char* shaderFilePaths[] = { COMPUTE_SHADER_FILE_PATH };
+        if (!platform::LoadFiles(shaderFilePaths, 1, platform::EFileType::Binary, &g_computeShaderFile))
+        {
+            DiracError("[Renderer] failed to load %s", COMPUTE_SHADER_FILE_PATH);
+            return false;
+        }
+
+        g_computeShaderModule = CreateShaderModule(COMPUTE_SHADER_FILE_PATH, g_computeShaderFile);
+        if (g_computeShaderModule == VK_NULL_HANDLE)
+            return false;
+    } // ~load shader
+    /////////////////////////////////
+
+    /////////////////////////////////
+    { // create descriptor set layout, bindings match sdf_scene.glsl plus the storage image
+        VkDescriptorSetLayoutBinding layoutBindings[numDescriptors]
+        {
+            {
+                1, // binding
+                VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, // descriptor type
+                1, // descriptor count
+                VK_SHADER_STAGE_COMPUTE_BIT, // stage flags
+                nullptr // immutable samplers
+            },
+            {
+                2, // binding
+                VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, // descriptor type
+                1, // descriptor count
+                VK_SHADER_STAGE_COMPUTE_BIT, // stage flags
+                nullptr // immutable samplers
+            },
+            {
+                3, // binding
+                VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, // descriptor type
+                1, // descriptor count
+                VK_SHADER_STAGE_COMPUTE_BIT, // stage flags
+                nullptr // immutable samplers
+            }
+        };
+
+        VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo;
+        descriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        descriptorSetLayoutCreateInfo.pNext = nullptr;
+        descriptorSetLayoutCreateInfo.flags = 0;
+        descriptorSetLayoutCreateInfo.bindingCount = numDescriptors;
+        descriptorSetLayoutCreateInfo.pBindings = layoutBindings;
+
+        if (g_device.vkCreateDescriptorSetLayout(
+            g_device.handle,
+            &descriptorSetLayoutCreateInfo,
+            g_pAllocationCallbacks,
+            &g_computeDescriptorSetLayout) != VK_SUCCESS)
+        {
+            DiracLog(1, "[%s] failed to create compute descriptor set layout!", __FUNCTION__);
+            return false;
+        }
+    } // ~create descriptor set layout
+    /////////////////////////////////
+
+    /////////////////////////////////
+    { // create descriptor pool
+        const VkDescriptorPoolSize poolSizes[numDescriptors] =
+        {
+            { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, g_swapChain.imageCount },
+            { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, g_swapChain.imageCount },
+            { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, g_swapChain.imageCount }
+        };
+
+        VkDescriptorPoolCreateInfo descriptorPoolCreateInfo;
+        descriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        descriptorPoolCreateInfo.pNext = nullptr;
+        descriptorPoolCreateInfo.flags = 0;
+        descriptorPoolCreateInfo.maxSets = g_swapChain.imageCount;
+        descriptorPoolCreateInfo.poolSizeCount = numDescriptors;
+        descriptorPoolCreateInfo.pPoolSizes = poolSizes;
+
+        if (g_device.vkCreateDescriptorPool(
+            g_device.handle,
+            &descriptorPoolCreateInfo,
+            g_pAllocationCallbacks,
+            &g_computeDescriptorPool) != VK_SUCCESS)
+        {
+            DiracLog(1, "[%s] failed to create compute descriptor pool!", __FUNCTION__);
+            return false;
+        }
+    } // ~create descriptor pool
+    /////////////////////////////////
+
+    /////////////////////////////////
+    { // allocate and update descriptor sets
+        VkDescriptorSetAllocateInfo descriptorSetAllocateInfo;
+        descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        descriptorSetAllocateInfo.pNext = nullptr;
+        descriptorSetAllocateInfo.descriptorPool = g_computeDescriptorPool;
+        descriptorSetAllocateInfo.descriptorSetCount = 1;
+        descriptorSetAllocateInfo.pSetLayouts = &g_computeDescriptorSetLayout;
+
+        VkDescriptorBufferInfo shapesInfo;
+        shapesInfo.buffer = g_uniformBuffer.handle;
+        shapesInfo.offset = 0;
+        shapesInfo.range = g_uniformBuffer.size;
+
+        VkDescriptorBufferInfo frameUniformsInfo;
+        frameUniformsInfo.buffer = g_frameUniformBuffer.handle;
+        frameUniformsInfo.offset = 0; // offset per swap chain image is supplied when binding
+        frameUniformsInfo.range = sizeof(SFrameUniforms);
+
+        for (uint32_t i = 0; i < g_swapChain.imageCount; ++i)
+        {
+            SImageResources& imageResources = g_imageResources[i];
+            assert(imageResources.sceneColor.view != VK_NULL_HANDLE);
+            if (g_device.vkAllocateDescriptorSets(
+                g_device.handle,
+                &descriptorSetAllocateInfo,
+                &imageResources.computeDescriptorSet) != VK_SUCCESS)
+            {
+                DiracLog(1, "[%s] failed to allocate compute descriptor set!", __FUNCTION__);
+                return false;
+            }
+
+            VkDescriptorImageInfo imageInfo;
+            imageInfo.sampler = VK_NULL_HANDLE;
+            imageInfo.imageView = imageResources.sceneColor.view;
+            imageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+            VkWriteDescriptorSet descriptorWrites[numDescriptors] =
+            {
+                {
+                    VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, // sType
+                    nullptr, // pNext
+                    imageResources.computeDescriptorSet, // dstSet
+                    1, // dstBinding
+                    0, // dstArrayElement
+                    1, // descriptor count
+                    VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, // descriptorType
+                    nullptr, // pImageInfo
+                    &shapesInfo, // pBufferInfo
+                    nullptr // pTexelBufferView
+                },
+                {
+                    VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, // sType
+                    nullptr, // pNext
+                    imageResources.computeDescriptorSet, // dstSet
+                    2, // dstBinding
+                    0, // dstArrayElement
+                    1, // descriptor count
+                    VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, // descriptorType
+                    nullptr, // pImageInfo
+                    &frameUniformsInfo, // pBufferInfo
+                    nullptr // pTexelBufferView
+                },
+                {
+                    VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, // sType
+                    nullptr, // pNext
+                    imageResources.computeDescriptorSet, // dstSet
+                    3, // dstBinding
+                    0, // dstArrayElement
+                    1, // descriptor count
+                    VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, // descriptorType
+                    &imageInfo, // pImageInfo
+                    nullptr, // pBufferInfo
+                    nullptr // pTexelBufferView
+                }
+            };
+
+            g_device.vkUpdateDescriptorSets(
+                g_device.handle,
+                numDescriptors, // descriptor write count
+                descriptorWrites,
+                0, // descriptor copy count
+                nullptr /* descriptor copies */);
+        }
+    } // ~allocate and update descriptor sets
+    /////////////////////////////////
+
+    /////////////////////////////////
+    { // create pipeline
+        VkPipelineLayoutCreateInfo layoutCreateInfo;
+        layoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        layoutCreateInfo.pNext = nullptr;
+        layoutCreateInfo.flags = 0;
+        layoutCreateInfo.setLayoutCount = 1;
+        layoutCreateInfo.pSetLayouts = &g_computeDescriptorSetLayout;
+        layoutCreateInfo.pushConstantRangeCount = 0;
+        layoutCreateInfo.pPushConstantRanges = nullptr;
+
+        if (g_device.vkCreatePipelineLayout(
+            g_device.handle,
+            &layoutCreateInfo,
+            g_pAllocationCallbacks,
+            &g_computePipelineLayout) != VK_SUCCESS)
+        {
+            DiracError("Vulkan failed to create compute pipeline layout!");
+            return false;
+        }
+
+        // local_size_x_id = 0, local_size_y_id = 1 in sdf.comp
+        const uint32_t tileSize[2] = { g_computeTileSize, g_computeTileSize };
+        const VkSpecializationMapEntry specializationMapEntries[2] =
+        {
+            { 0, 0, sizeof(uint32_t) }, // constantID, offset, size
+            { 1, sizeof(uint32_t), sizeof(uint32_t) }
+        };
 
-        g_device.vkEndCommandBuffer(commandBuffer);
+        VkSpecializationInfo specializationInfo;
+        specializationInfo.mapEntryCount = 2;
+        specializationInfo.pMapEntries = specializationMapEntries;
+        specializationInfo.dataSize = sizeof(tileSize);
+        specializationInfo.pData = tileSize;
 
-        VkSubmitInfo submitInfo;
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.pNext = nullptr;
-        submitInfo.waitSemaphoreCount = 0;
-        submitInfo.pWaitSemaphores = nullptr;
-        submitInfo.pWaitDstStageMask = nullptr;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &commandBuffer;
-        submitInfo.signalSemaphoreCount = 0;
-        submitInfo.pSignalSemaphores = nullptr;
+        VkComputePipelineCreateInfo pipelineCreateInfo;
+        pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineCreateInfo.pNext = nullptr;
+        pipelineCreateInfo.flags = 0;
+        pipelineCreateInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineCreateInfo.stage.pNext = nullptr;
+        pipelineCreateInfo.stage.flags = 0;
+        pipelineCreateInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineCreateInfo.stage.module = g_computeShaderModule;
+        pipelineCreateInfo.stage.pName = "main";
+        pipelineCreateInfo.stage.pSpecializationInfo = &specializationInfo;
+        pipelineCreateInfo.layout = g_computePipelineLayout;
+        pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+        pipelineCreateInfo.basePipelineIndex = -1;
 
-        if (g_device.vkQueueSubmit(
-            g_device.graphicsQueue,
-            1, // submit count
-            &submitInfo,
-            VK_NULL_HANDLE /* fence */) != VK_SUCCESS)
+        if (g_device.vkCreateComputePipelines(
+            g_device.handle,
+            g_pipelineCache,
+            1,
+            &pipelineCreateInfo,
+            g_pAllocationCallbacks,
+            &g_computePipeline) != VK_SUCCESS)
         {
-            DiracLog(1, "[%s] failed to queue command buffer submission!", __FUNCTION__);
+            DiracError("Vulkan failed to create compute pipeline!");
             return false;
         }
-
-        // TODO: consider synchronization later more fully with architecture,
-        // Use semaphores to coordinate instead of just waiting on the device
-        g_device.vkDeviceWaitIdle(g_device.handle);
-    } // ~copy texture data
+    } // ~create pipeline
     /////////////////////////////////
 
     return true;
 }
 
+// Feeds the latest GPU frame time to the dynamic resolution controller. Only the viewport, render area
+// and render size uniforms change with the scale so a change just re-records the static command buffers.
+void UpdateRenderScale()
+{
+    if (!g_bDynamicResolution || !g_gpuProfiler.bTimestamps)
+        return;
+
+    const renderer::SGpuStatsHistory& history = g_gpuProfiler.history;
+    if (history.lastFrameId == g_dynamicResolutionFrameId)
+        return;
+
+    g_dynamicResolutionFrameId = history.lastFrameId;
+
+    const size_t frameScope = (size_t)renderer::EGpuScope::Frame;
+    if (history.scopeSampleCounts[frameScope] == 0)
+        return;
+
+    const uint32_t lastSample = (history.scopeNextSample[frameScope] + renderer::kGpuStatsWindow - 1) % renderer::kGpuStatsWindow;
+    const float previousScale = g_dynamicResolution.scale;
+    if (renderer::UpdateDynamicResolution(g_dynamicResolutionConfig, &g_dynamicResolution, history.scopeSamples[frameScope][lastSample]))
+    {
+        WriteRenderSizeUniforms();
+        InvalidateStaticCommandBuffers();
+        DiracLog(2, "[Renderer] render scale %.2f -> %.2f (filtered GPU frame %.3f ms, budget %.3f ms)",
+            previousScale,
+            g_dynamicResolution.scale,
+            g_dynamicResolution.filteredFrameMs,
+            g_dynamicResolutionConfig.budgetMs);
+    }
+}
+
 } // vulkan namespace
 
 
@@ -1842,11 +3346,57 @@ ERunResult Initialize()
     SDL_Window* pWindow = platform::GetWindow();
     assert(pWindow != nullptr);
 
-    if (!vulkan::DefaultShaders.LoadFiles())
-    {
-        DiracError("Failed to load default shader files!");
-        return eRR_Error;
-    }
+    vulkan::g_commandRecordingMode = platform::HasCommandLineArg("--record-per-frame")
+        ? vulkan::ECommandRecordingMode::PerFrame
+        : vulkan::ECommandRecordingMode::Prerecorded;
+    DiracLog(1, "[Renderer] command recording mode: %s",
+        vulkan::g_commandRecordingMode == vulkan::ECommandRecordingMode::PerFrame ? "per frame" : "prerecorded");
+
+    { // raymarch path
+        const char* raymarchPath = platform::GetCommandLineValue("--raymarch");
+        vulkan::g_raymarchPath = raymarchPath != nullptr && strcmp(raymarchPath, "compute") == 0
+            ? vulkan::ERaymarchPath::Compute
+            : vulkan::ERaymarchPath::Fragment;
+
+        if (const char* tileSize = platform::GetCommandLineValue("--compute-tile-size"))
+        {
+            vulkan::g_computeTileSize = atoi(tileSize) >= 16 ? 16 : 8;
+        }
+
+        if (vulkan::g_raymarchPath == vulkan::ERaymarchPath::Compute)
+        {
+            DiracLog(1, "[Renderer] raymarch path: compute, %ux%u tiles", vulkan::g_computeTileSize, vulkan::g_computeTileSize);
+        }
+        else
+        {
+            DiracLog(1, "[Renderer] raymarch path: fragment");
+        }
+    } // ~raymarch path
+
+    { // dynamic resolution
+        vulkan::g_dynamicResolutionConfig.budgetMs = TMilliseconds(platform::GetTargetFrameDuration()).count();
+        vulkan::g_bDynamicResolution = !platform::HasCommandLineArg("--no-dynamic-resolution");
+        if (const char* renderScale = platform::GetCommandLineValue("--render-scale"))
+        {
+            vulkan::g_dynamicResolution.scale = renderer::QuantizeRenderScale(vulkan::g_dynamicResolutionConfig, (float)atof(renderScale));
+        }
+
+        DiracLog(1, "[Renderer] render scale %.2f, dynamic resolution %s (budget %.3f ms)",
+            vulkan::g_dynamicResolution.scale,
+            vulkan::g_bDynamicResolution ? "on" : "off",
+            vulkan::g_dynamicResolutionConfig.budgetMs);
+    } // ~dynamic resolution
+
+    { // start file reads, they complete on the IO threads while the instance and device are created
+        if (!vulkan::DefaultShaders.BeginLoadFiles())
+        {
+            DiracError("Failed to load default shader files!");
+            return eRR_Error;
+        }
+
+        const char* textureFilePaths[] = { vulkan::TEXTURE_FILE_PATH };
+        vulkan::g_textureReadHandle = platform::SubmitAsyncRead(textureFilePaths, 1, platform::EFileType::Binary, &vulkan::g_textureFile);
+    } // ~start file reads
 
     ///////////////////////////////////////////////////////////////////////////////////////////////////
     { // Vulkan instance creation
@@ -1993,6 +3543,23 @@ ERunResult Initialize()
         static const uint32_t extensionsCount = 1;
         const char* extensions[extensionsCount] = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
 
+        VkPhysicalDeviceFeatures supportedFeatures;
+        vkGetPhysicalDeviceFeatures(selectedPhysicalDevice, &supportedFeatures);
+
+        VkPhysicalDeviceFeatures enabledFeatures;
+        memset(&enabledFeatures, 0, sizeof(VkPhysicalDeviceFeatures));
+        if (platform::HasCommandLineArg("--gpu-pipeline-stats"))
+        {
+            if (supportedFeatures.pipelineStatisticsQuery)
+            {
+                enabledFeatures.pipelineStatisticsQuery = VK_TRUE;
+            }
+            else
+            {
+                DiracLog(1, "[Renderer] pipeline statistics queries are not supported by this device");
+            }
+        }
+
         VkDeviceCreateInfo deviceCreateInfo;
         deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
         deviceCreateInfo.pNext = nullptr;
@@ -2003,7 +3570,7 @@ ERunResult Initialize()
         deviceCreateInfo.ppEnabledLayerNames = nullptr;
         deviceCreateInfo.enabledExtensionCount = extensionsCount;
         deviceCreateInfo.ppEnabledExtensionNames = extensions;
-        deviceCreateInfo.pEnabledFeatures = nullptr;
+        deviceCreateInfo.pEnabledFeatures = &enabledFeatures;
 
         const VkResult deviceCreationResult = vkCreateDevice(
             selectedPhysicalDevice,
@@ -2027,6 +3594,22 @@ ERunResult Initialize()
             return eRR_Error;
         }
 
+        vulkan::g_device.enabledFeatures = enabledFeatures;
+
+        uint32_t queueFamiliesCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(selectedPhysicalDevice, &queueFamiliesCount, nullptr);
+        VkQueueFamilyProperties* const pQueueFamilyProperties = (VkQueueFamilyProperties*)alloca(sizeof(VkQueueFamilyProperties) * queueFamiliesCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(selectedPhysicalDevice, &queueFamiliesCount, pQueueFamilyProperties);
+        assert(graphicsQueueFamilyIndex < queueFamiliesCount);
+        vulkan::g_device.timestampValidBits = pQueueFamilyProperties[graphicsQueueFamilyIndex].timestampValidBits;
+
+        vulkan::g_gpuProfiler.bTimestamps = vulkan::g_device.timestampValidBits > 0 && vulkan::g_device.properties.limits.timestampPeriod > 0;
+        // The statistics pool only counts fragment shader invocations, which the compute path doesn't have
+        vulkan::g_gpuProfiler.bPipelineStatistics = enabledFeatures.pipelineStatisticsQuery == VK_TRUE
+            && vulkan::g_raymarchPath == vulkan::ERaymarchPath::Fragment;
+        DiracLog(1, "[Renderer] GPU timestamps %s, pipeline statistics %s",
+            vulkan::g_gpuProfiler.bTimestamps ? "enabled" : "unsupported",
+            vulkan::g_gpuProfiler.bPipelineStatistics ? "enabled" : "disabled");
     } // ~Vulkan logical device creation
     ///////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -2315,9 +3898,35 @@ ERunResult Initialize()
                 return eRR_Error;
             }
         }
+
+        // Reusable per swap chain image command buffers, recorded lazily on first use
+        if (vulkan::g_commandRecordingMode == vulkan::ECommandRecordingMode::Prerecorded)
+        {
+            for (uint32_t i = 0; i < vulkan::g_swapChain.imageCount; ++i)
+            {
+                if (vulkan::g_device.vkAllocateCommandBuffers(
+                    vulkan::g_device.handle,
+                    &commandBufferAllocateInfo,
+                    &vulkan::g_imageResources[i].staticCommandBuffer) != VK_SUCCESS)
+                {
+                    DiracError("Vulkan failed to allocate static command buffers!");
+                    return eRR_Error;
+                }
+            }
+        }
     } // ~create command buffers
     ///////////////////////////////////////////////////////////////////////////////////////////////////
 
+    ///////////////////////////////////////////////////////////////////////////////////////////////////
+    { // Create GPU query pools
+        if (!vulkan::CreateGpuQueryPools())
+        {
+            DiracError("Failed to create GPU query pools!");
+            return eRR_Error;
+        }
+    } // ~create GPU query pools
+    ///////////////////////////////////////////////////////////////////////////////////////////////////
+
     ///////////////////////////////////////////////////////////////////////////////////////////////////
     { // Vulkan semaphore creation
         VkSemaphoreCreateInfo semaphoreCreateInfo;
@@ -2423,6 +4032,46 @@ ERunResult Initialize()
     } // ~create uniform buffer
     ///////////////////////////////////////////////////////////////////////////////////////////////////
 
+    ///////////////////////////////////////////////////////////////////////////////////////////////////
+    { // Create frame uniform buffer
+        // One persistently mapped slice per swap chain image, selected with a dynamic offset so the
+        // static command buffers never need to change when the per-frame data does
+        const VkPhysicalDeviceLimits& limits = vulkan::g_device.properties.limits;
+        const VkDeviceSize sliceAlignment = std::max(limits.minUniformBufferOffsetAlignment, vulkan::g_device.memoryAlignment);
+        vulkan::g_frameUniformsSliceSize = ((sizeof(vulkan::SFrameUniforms) + sliceAlignment - 1) / sliceAlignment) * sliceAlignment;
+
+        const VkDeviceSize frameUniformBufferSize = vulkan::g_frameUniformsSliceSize * vulkan::MAX_IMAGE_COUNT;
+        const VkBufferUsageFlags frameUniformBufferUsage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+        const VkMemoryPropertyFlagBits frameUniformBufferMemoryProperty = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+
+        assert(vulkan::g_pMappedFrameUniforms == nullptr);
+
+        if (vulkan::CreateBuffer(
+            frameUniformBufferUsage,
+            frameUniformBufferMemoryProperty,
+            frameUniformBufferSize,
+            vulkan::g_frameUniformBuffer) == false)
+        {
+            DiracError("Vulkan failed to create frame uniform buffer!");
+            return eRR_Error;
+        }
+
+        if (vulkan::g_device.vkMapMemory(
+            vulkan::g_device.handle,
+            vulkan::g_frameUniformBuffer.memory,
+            0, // offset
+            frameUniformBufferSize, // size
+            0, // flags
+            &vulkan::g_pMappedFrameUniforms) != VK_SUCCESS)
+        {
+            DiracError("Vulkan failed to map frame uniform buffer!");
+            return eRR_Error;
+        }
+
+        assert(vulkan::g_pMappedFrameUniforms != nullptr);
+    } // ~create frame uniform buffer
+    ///////////////////////////////////////////////////////////////////////////////////////////////////
+
     ///////////////////////////////////////////////////////////////////////////////////////////////////
     { // create texture
         if (!vulkan::CreateTexture())
@@ -2436,7 +4085,7 @@ ERunResult Initialize()
     ///////////////////////////////////////////////////////////////////////////////////////////////////
     { // create descriptor set
         assert(vulkan::g_image.handle != VK_NULL_HANDLE);
-        const uint32_t numDescriptors = 2;
+        const uint32_t numDescriptors = 3;
 
         { // create descriptor set layout
             VkDescriptorSetLayoutBinding layoutBindings[numDescriptors]
@@ -2454,6 +4103,13 @@ ERunResult Initialize()
                     1, // descriptor count
                     VK_SHADER_STAGE_FRAGMENT_BIT, // stage flags
                     nullptr // immutable samplers
+                },
+                {
+                    2, // binding
+                    VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, // descriptor type
+                    1, // descriptor count
+                    VK_SHADER_STAGE_FRAGMENT_BIT, // stage flags
+                    nullptr // immutable samplers
                 }
             };
 
@@ -2479,7 +4135,8 @@ ERunResult Initialize()
             const VkDescriptorPoolSize poolSizes[numDescriptors] =
             {
                 { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1 },
-                { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1 }
+                { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1 },
+                { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1 }
             };
 
             VkDescriptorPoolCreateInfo descriptorPoolCreateInfo;
@@ -2536,6 +4193,11 @@ ERunResult Initialize()
             bufferInfo.offset = 0;
             bufferInfo.range = vulkan::g_uniformBuffer.size;
 
+            VkDescriptorBufferInfo frameUniformsInfo;
+            frameUniformsInfo.buffer = vulkan::g_frameUniformBuffer.handle;
+            frameUniformsInfo.offset = 0; // offset per swap chain image is supplied when binding
+            frameUniformsInfo.range = sizeof(vulkan::SFrameUniforms);
+
             VkWriteDescriptorSet descriptorWrites[numDescriptors] =
             {
                 {
@@ -2561,12 +4223,24 @@ ERunResult Initialize()
                     nullptr, // pImageInfo
                     &bufferInfo, // pBufferInfo
                     nullptr // pTexelBufferView
+                },
+                {
+                    VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, // sType
+                    nullptr, // pNext
+                    vulkan::g_descriptorSet.handle, // dstSet
+                    2, // dstBinding
+                    0, // dstArrayElement
+                    1, // descriptor count
+                    VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, // descriptorType
+                    nullptr, // pImageInfo
+                    &frameUniformsInfo, // pBufferInfo
+                    nullptr // pTexelBufferView
                 }
             };
 
             vulkan::g_device.vkUpdateDescriptorSets(
                 vulkan::g_device.handle,
-                2, // descriptor write count
+                numDescriptors, // descriptor write count
                 descriptorWrites,
                 0, // descriptor copy count
                 nullptr /* descriptor copies */);
@@ -2661,11 +4335,78 @@ ERunResult Initialize()
             DiracError("Vulkan failed to create render pass!");
             return eRR_Error;
         }
+
+        // SDF pass, the scene color target is fully overwritten inside the render area and is only read
+        // within it by the upscale pass, so the previous contents are never loaded
+        attachmentDescriptions[0].format = vulkan::SCENE_COLOR_FORMAT;
+        attachmentDescriptions[0].loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachmentDescriptions[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        attachmentDescriptions[0].finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        static const uint32_t numSceneDependencies = 2;
+        const VkSubpassDependency sceneDependencies[numSceneDependencies] =
+        {
+            {
+                VK_SUBPASS_EXTERNAL, // srcSubpass
+                0, // dstSubPass
+                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, // srcStageMask, previous upscale read
+                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, // dstStageMask
+                VK_ACCESS_SHADER_READ_BIT, // srcAccessMask
+                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, // dstAccessMask
+                0 // dependencyFlags
+            },
+            {
+                0, // srcSubpass
+                VK_SUBPASS_EXTERNAL, // dstSubPass
+                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, // srcStageMask
+                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, // dstStageMask, upscale read
+                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, // srcAccessMask
+                VK_ACCESS_SHADER_READ_BIT, // dstAccessMask
+                0 // dependencyFlags
+            }
+        };
+
+        renderPassCreateInfo.dependencyCount = numSceneDependencies;
+        renderPassCreateInfo.pDependencies = sceneDependencies;
+
+        if (vulkan::g_device.vkCreateRenderPass(
+            vulkan::g_device.handle,
+            &renderPassCreateInfo,
+            vulkan::g_pAllocationCallbacks,
+            &vulkan::g_sceneRenderPass) != VK_SUCCESS)
+        {
+            DiracError("Vulkan failed to create scene render pass!");
+            return eRR_Error;
+        }
     } // ~create render pass
     ///////////////////////////////////////////////////////////////////////////////////////////////////
 
+    ///////////////////////////////////////////////////////////////////////////////////////////////////
+    { // Create frame buffers
+        if (!vulkan::CreateFrameBuffers())
+        {
+            DiracError("Failed to create frame buffers!");
+            return eRR_Error;
+        }
+
+        if (!vulkan::CreateSceneColorTargets() || !vulkan::CreateUpscaleDescriptorSets())
+        {
+            DiracError("Failed to create scene color targets!");
+            return eRR_Error;
+        }
+
+        vulkan::WriteRenderSizeUniforms();
+    } // ~create frame buffers
+    ///////////////////////////////////////////////////////////////////////////////////////////////////
+
     ///////////////////////////////////////////////////////////////////////////////////////////////////
     { // create rendering pipeline
+        if (!vulkan::DefaultShaders.FinishLoadFiles())
+        {
+            DiracError("Failed to load default shader files!");
+            return eRR_Error;
+        }
+
         if (!vulkan::DefaultShaders.CreateShaderModules())
         {
             DiracError("Vulkan failed to create graphics pipeline!");
@@ -2802,19 +4543,14 @@ ERunResult Initialize()
             assert(vulkan::g_descriptorSet.handle != VK_NULL_HANDLE);
             assert(vulkan::g_descriptorSet.layout != VK_NULL_HANDLE);
 
-            VkPushConstantRange pushConstantInfo;
-            pushConstantInfo.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-            pushConstantInfo.offset = 0;
-            pushConstantInfo.size = sizeof(vulkan::SPushConstants);
-
             VkPipelineLayoutCreateInfo layoutCreateInfo;
             layoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
             layoutCreateInfo.pNext = nullptr;
             layoutCreateInfo.flags = 0;
             layoutCreateInfo.setLayoutCount = 1;
             layoutCreateInfo.pSetLayouts = &vulkan::g_descriptorSet.layout;
-            layoutCreateInfo.pushConstantRangeCount = 1;
-            layoutCreateInfo.pPushConstantRanges = &pushConstantInfo;
+            layoutCreateInfo.pushConstantRangeCount = 0; // per-frame data lives in the dynamic frame uniform buffer
+            layoutCreateInfo.pPushConstantRanges = nullptr;
 
             if (vulkan::g_device.vkCreatePipelineLayout(
                 vulkan::g_device.handle,
@@ -2826,6 +4562,18 @@ ERunResult Initialize()
                 return eRR_Error;
             }
 
+            assert(vulkan::g_upscaleDescriptorSetLayout != VK_NULL_HANDLE);
+            layoutCreateInfo.pSetLayouts = &vulkan::g_upscaleDescriptorSetLayout;
+            if (vulkan::g_device.vkCreatePipelineLayout(
+                vulkan::g_device.handle,
+                &layoutCreateInfo,
+                vulkan::g_pAllocationCallbacks,
+                &vulkan::g_upscalePipelineLayout) != VK_SUCCESS)
+            {
+                DiracError("Vulkan failed to create upscale pipeline layout!");
+                return eRR_Error;
+            }
+
         } // ~create pipeline layout
 
         assert(vulkan::g_pipelineLayout != VK_NULL_HANDLE);
@@ -2855,22 +4603,58 @@ ERunResult Initialize()
         pipelineCreateInfo.pColorBlendState = &colorBlendStateCreateInfo;
         pipelineCreateInfo.pDynamicState = &dynamicStateCreateInfo;
         pipelineCreateInfo.layout = vulkan::g_pipelineLayout;
-        pipelineCreateInfo.renderPass = vulkan::g_renderPass;
+        pipelineCreateInfo.renderPass = vulkan::g_sceneRenderPass;
         pipelineCreateInfo.subpass = 0;
         pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
         pipelineCreateInfo.basePipelineIndex = -1;
 
+        VkPipelineShaderStageCreateInfo upscaleShaderStageCreateInfos[numShaderStageCreateInfos] =
+        {
+            shaderStageCreateInfos[0],
+            shaderStageCreateInfos[1]
+        };
+
+        upscaleShaderStageCreateInfos[0].module = vulkan::DefaultShaders.GetVertexShaderModule(vulkan::EDefaultShaders::Enum::upscale);
+        upscaleShaderStageCreateInfos[1].module = vulkan::DefaultShaders.GetFragmentShaderModule(vulkan::EDefaultShaders::Enum::upscale);
+
+        static const uint32_t numPipelines = 2;
+        VkGraphicsPipelineCreateInfo pipelineCreateInfos[numPipelines] = { pipelineCreateInfo, pipelineCreateInfo };
+        pipelineCreateInfos[1].pStages = upscaleShaderStageCreateInfos;
+        pipelineCreateInfos[1].layout = vulkan::g_upscalePipelineLayout;
+        pipelineCreateInfos[1].renderPass = vulkan::g_renderPass;
+
+        if (!vulkan::CreatePipelineCache())
+        {
+            DiracError("Failed to create pipeline cache!");
+            return eRR_Error;
+        }
+
+        VkPipeline pipelines[numPipelines] = { VK_NULL_HANDLE, VK_NULL_HANDLE };
+        const TTime pipelineStartTime = TSteadyClock::now();
         if (vulkan::g_device.vkCreateGraphicsPipelines(
             vulkan::g_device.handle,
-            VK_NULL_HANDLE,
-            1,
-            &pipelineCreateInfo,
+            vulkan::g_pipelineCache,
+            numPipelines,
+            pipelineCreateInfos,
             vulkan::g_pAllocationCallbacks,
-            &vulkan::g_graphicsPipeline) != VK_SUCCESS)
+            pipelines) != VK_SUCCESS)
         {
             DiracError("Vulkan failed to create graphics pipeline!");
             return eRR_Error;
         }
+
+        vulkan::g_graphicsPipeline = pipelines[0];
+        vulkan::g_upscalePipeline = pipelines[1];
+
+        if (vulkan::g_raymarchPath == vulkan::ERaymarchPath::Compute && !vulkan::CreateComputeRaymarchPipeline())
+        {
+            DiracError("Failed to create compute raymarch pipeline!");
+            return eRR_Error;
+        }
+
+        DiracLog(1, "[Renderer] graphics pipelines created in %.3f ms (pipeline cache %s)",
+            TMilliseconds(TSteadyClock::now() - pipelineStartTime).count(),
+            vulkan::g_pipelineCacheLoadedSize > 0 ? "hit" : "miss");
     } // ~create rendering pipeline
     ///////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -3009,31 +4793,15 @@ ERunResult Initialize()
 
     ///////////////////////////////////////////////////////////////////////////////////////////////////
     { // Initialize SDF scene data
-        size_t shapeIndex = 0;
-        vulkan::g_pushConstants.numSpheres = 2;
-        vulkan::g_invShapeTransforms[shapeIndex] = Matrix43l::CreateRotationAndTranslation(
-            EIdentity::Constructor,
-            Vec3l(1, 0, -1)
-        ).Inverted();
-        ++shapeIndex;
-
-        vulkan::g_invShapeTransforms[shapeIndex] = Matrix43l::CreateRotationAndTranslation(
-            EIdentity::Constructor,
-            Vec3l(3, 0, -1)
-        ).Inverted();
-        ++shapeIndex;
-
-        vulkan::g_pushConstants.numCubes = 2;
-        vulkan::g_invShapeTransforms[shapeIndex] = Matrix43l::CreateRotationAndTranslation(
-            EIdentity::Constructor,
-            Vec3l(-1, 0, -1)
-        ).Inverted();
-        ++shapeIndex;
-
-        vulkan::g_invShapeTransforms[shapeIndex] = Matrix43l::CreateRotationAndTranslation(
-            EIdentity::Constructor,
-            Vec3l(-3, 0, -1)
-        ).Inverted();
+        // Shapes are placed by the game's transform hierarchy, the first snapshot overwrites these
+        static_assert(renderer::kNumSceneShapes <= vulkan::MAX_SHAPES, "scene shapes don't fit the shape transform buffer");
+        vulkan::g_frameUniforms.numSpheres = (int)renderer::kNumSceneSpheres;
+        vulkan::g_frameUniforms.numCubes = (int)renderer::kNumSceneCubes;
+        const size_t lastShapeIndex = renderer::kNumSceneShapes - 1;
+        for (size_t i = 0; i <= lastShapeIndex; ++i)
+        {
+            vulkan::g_invShapeTransforms[i] = EIdentity::Constructor;
+        }
 
         VkCommandBuffer commandBuffer = vulkan::g_renderResources[0].commandBuffer;
         VkCommandBufferBeginInfo commandBufferBeginInfo;
@@ -3046,7 +4814,7 @@ ERunResult Initialize()
         const uint32_t srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
         const uint32_t dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 
-        if (!vulkan::FlushSceneSDF(0, shapeIndex, commandBuffer, srcQueueFamilyIndex, dstQueueFamilyIndex))
+        if (!vulkan::FlushSceneSDF(0, lastShapeIndex, commandBuffer, srcQueueFamilyIndex, dstQueueFamilyIndex))
         {
             DiracError("Failed to initialize SDF scene!");
             return eRR_Error;
@@ -3079,17 +4847,41 @@ ERunResult Initialize()
     } // ~Initialize SDF scene data
     ///////////////////////////////////////////////////////////////////////////////////////////////////
 
+    { // metrics
+        profiling::SMetricsRegistry& metrics = profiling::GetMetrics();
+        vulkan::g_pFrameUploadMetric = metrics.RegisterHistogram("renderer.frame_upload", "bytes", 256 * 1024 * 1024);
+        vulkan::g_pUploadTotalMetric = metrics.RegisterCounter("renderer.uploaded", "bytes");
+        vulkan::g_pRenderScaleMetric = metrics.RegisterGauge("renderer.render_scale", "ratio");
+        vulkan::g_frameUploadBytes = 0; // the initial scene upload isn't a frame's
+    } // ~metrics
+
     return eRR_Success;
 }
 
-ERunResult Render(const SFrameContext& frameContext)
+void ApplySnapshot(const SRenderSnapshot& snapshot)
+{
+    vulkan::g_frameUniforms.timeSecs += (float)TSeconds(snapshot.frameContext.lastFrameDuration).count();
+    vulkan::g_frameUniforms.viewMatrix = snapshot.viewMatrix;
+    for (uint32_t i = 0; i < snapshot.numShapeUpdates; ++i)
+    {
+        const SShapeTransformUpdate& update = snapshot.pShapeUpdates[i];
+        assert(update.shapeIndex < vulkan::MAX_SHAPES);
+        vulkan::g_invShapeTransforms[update.shapeIndex] = update.invTransform;
+        vulkan::MarkSceneDirty(update.shapeIndex, update.shapeIndex);
+    }
+}
+
+ERunResult Render(const SRenderSnapshot& snapshot)
 {
+    PROFILE_FUNCTION();
+    const SFrameContext& frameContext = snapshot.frameContext;
+
     /////////////////////////
     // Rendering setup
     static size_t resourceIndex = 0;
     vulkan::SRenderResources& currentRenderingResource = vulkan::g_renderResources[resourceIndex];
     resourceIndex = (resourceIndex + 1) % vulkan::RENDER_RESOURCES_COUNT;
-    vulkan::g_pushConstants.timeSecs += (float)TSeconds(frameContext.lastFrameDuration).count();
+    ApplySnapshot(snapshot);
 
     /////////////////////////
     // Fence handling
@@ -3104,11 +4896,6 @@ ERunResult Render(const SFrameContext& frameContext)
         return eRR_Error;
     }
 
-    vulkan::g_device.vkResetFences(
-        vulkan::g_device.handle,
-        1,
-        &currentRenderingResource.fence);
-
     /////////////////////////
     // Acquire next image 
     uint32_t imageIndex = UINT32_MAX;
@@ -3133,29 +4920,95 @@ ERunResult Render(const SFrameContext& frameContext)
         return eRR_Error;
     }
 
+    /////////////////////////
+    // Image fence handling
+    // The image's static command buffer and frame uniform slice can't be touched until its last submission retires
+    vulkan::SImageResources& imageResources = vulkan::g_imageResources[imageIndex];
+    if (imageResources.lastSubmitFence != VK_NULL_HANDLE && imageResources.lastSubmitFence != currentRenderingResource.fence)
+    {
+        if (vulkan::g_device.vkWaitForFences(
+            vulkan::g_device.handle,
+            1, // fenceCount
+            &imageResources.lastSubmitFence,
+            VK_FALSE, // waitAll
+            1000000000 /*timeout*/) != VK_SUCCESS)
+        {
+            DiracError("Vulkan waiting for swap chain image fence is taking too long!");
+            return eRR_Error;
+        }
+    }
+
+    vulkan::g_device.vkResetFences(
+        vulkan::g_device.handle,
+        1,
+        &currentRenderingResource.fence);
+
+    imageResources.lastSubmitFence = currentRenderingResource.fence;
+    vulkan::ReadGpuQueries(imageIndex);
+    vulkan::UpdateRenderScale();
+
     /////////////////////////
     // Prepare frame
-    if (!vulkan::PrepareFrame(
-        currentRenderingResource.commandBuffer,
-        vulkan::g_swapChain.images[imageIndex],
-        frameContext,
-        currentRenderingResource.frameBuffer))
+    const TTime recordStartTime = TSteadyClock::now();
+    vulkan::WriteFrameUniforms(imageIndex);
+
+    VkCommandBuffer submitCommandBuffers[2] = { VK_NULL_HANDLE, VK_NULL_HANDLE };
+    uint32_t submitCommandBufferCount = 0;
+    if (vulkan::g_commandRecordingMode == vulkan::ECommandRecordingMode::PerFrame)
     {
-        DiracError("renderer failed to prepare frame!");
-        return eRR_Error;
+        if (!vulkan::PrepareFrame(
+            currentRenderingResource.commandBuffer,
+            imageIndex,
+            frameContext))
+        {
+            DiracError("renderer failed to prepare frame!");
+            return eRR_Error;
+        }
+
+        submitCommandBuffers[submitCommandBufferCount++] = currentRenderingResource.commandBuffer;
+    }
+    else
+    {
+        bool bRecordedSceneUpload = false;
+        if (!vulkan::PrepareSceneUpload(currentRenderingResource.commandBuffer, imageIndex, &bRecordedSceneUpload))
+        {
+            DiracError("renderer failed to prepare scene upload!");
+            return eRR_Error;
+        }
+
+        if (bRecordedSceneUpload)
+        {
+            submitCommandBuffers[submitCommandBufferCount++] = currentRenderingResource.commandBuffer;
+        }
+
+        if (imageResources.recordedGeneration != vulkan::g_staticCommandBufferGeneration)
+        {
+            if (!vulkan::RecordStaticCommandBuffer(imageIndex))
+            {
+                DiracError("renderer failed to record static command buffer!");
+                return eRR_Error;
+            }
+        }
+
+        submitCommandBuffers[submitCommandBufferCount++] = imageResources.staticCommandBuffer;
     }
 
+    DiracLog(3, "[Renderer] frame %llu command recording took %lld us (%u command buffers)",
+        (unsigned long long)frameContext.frameId,
+        (long long)std::chrono::duration_cast<TMicroseconds>(TSteadyClock::now() - recordStartTime).count(),
+        submitCommandBufferCount);
+
     /////////////////////////
     // Queue submit 
-    VkPipelineStageFlags waitDstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    VkPipelineStageFlags waitDstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
     VkSubmitInfo submitInfo;
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
     submitInfo.pNext = nullptr;
     submitInfo.waitSemaphoreCount = 1;
     submitInfo.pWaitSemaphores = &currentRenderingResource.imageAvailableSemaphore;
     submitInfo.pWaitDstStageMask = &waitDstStageMask;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &currentRenderingResource.commandBuffer;
+    submitInfo.commandBufferCount = submitCommandBufferCount;
+    submitInfo.pCommandBuffers = submitCommandBuffers;
     submitInfo.signalSemaphoreCount = 1;
     submitInfo.pSignalSemaphores = &currentRenderingResource.renderingFinishedSemaphore;
 
@@ -3169,6 +5022,15 @@ ERunResult Render(const SFrameContext& frameContext)
         return eRR_Error;
     }
 
+    imageResources.writtenGpuScopes |= BIT((uint32_t)renderer::EGpuScope::SdfPass) | BIT((uint32_t)renderer::EGpuScope::Upscale);
+    imageResources.submittedFrameId = frameContext.frameId;
+    imageResources.submitTime = TSteadyClock::now();
+
+    vulkan::g_pFrameUploadMetric->Record(vulkan::g_frameUploadBytes);
+    vulkan::g_pUploadTotalMetric->Add(vulkan::g_frameUploadBytes);
+    vulkan::g_pRenderScaleMetric->Set(vulkan::g_dynamicResolution.scale);
+    vulkan::g_frameUploadBytes = 0;
+
     /////////////////////////
     // Presentation 
     VkPresentInfoKHR presentInfo;
@@ -3203,9 +5065,12 @@ ERunResult Shutdown()
     return vulkan::DestroyState();
 }
 
-void SetViewMatrix(const Matrix44<float>& viewMatrix)
+bool GetGpuStats(SGpuFrameStats* pOutStats)
 {
-    vulkan::g_pushConstants.viewMatrix = viewMatrix;
+    assert(pOutStats != nullptr);
+    GetGpuFrameStats(vulkan::g_gpuProfiler.history, pOutStats);
+    pOutStats->bPipelineStatistics = vulkan::g_gpuProfiler.bPipelineStatistics;
+    return vulkan::g_gpuProfiler.bTimestamps && pOutStats->scopes[(size_t)EGpuScope::Frame].sampleCount > 0;
 }
 
 } // renderer namespace
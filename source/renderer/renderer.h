@@ -5,13 +5,22 @@
 
 #pragma once
 
-template <typename T>
-struct Matrix44;
-
 namespace renderer
 {
+    struct SGpuFrameStats;
+    struct SRenderSnapshot;
+
     ERunResult Initialize();
-    ERunResult Render(const SFrameContext& frameContext);
+
+    // Applies the snapshot and submits the frame. Only touches renderer state, so it may run on a render thread
+    // while the game fills the next snapshot.
+    ERunResult Render(const SRenderSnapshot& snapshot);
+
+    // Applies the snapshot without rendering, for frames the frame pacer skips. The changes go out with the next
+    // rendered frame.
+    void ApplySnapshot(const SRenderSnapshot& snapshot);
     ERunResult Shutdown();
-    void SetViewMatrix(const Matrix44<float>& viewMatrix);
+
+    // Rolling GPU timings, see gpu_profiler.h. Returns false until the first results have been read back
+    bool GetGpuStats(SGpuFrameStats* pOutStats);
 } // renderer namespace
@@ -0,0 +1,468 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "texture_format.h"
+
+#include <cmath>
+
+namespace renderer
+{
+
+/////////////////////////////////////////////////////////
+// Constants
+
+static constexpr uint32_t kTextureMagic = 0x58455444; // "DTEX"
+static constexpr uint32_t kTextureVersion = 1;
+
+static const STextureFormatInfo kTextureFormats[] =
+{
+    { kVkFormatR8G8B8A8Unorm, 1, 1, 4, false, "R8G8B8A8_UNORM" },
+    { kVkFormatR8G8B8A8Srgb, 1, 1, 4, true, "R8G8B8A8_SRGB" },
+    { kVkFormatBC1RgbaUnorm, 4, 4, 8, false, "BC1_RGBA_UNORM" },
+    { kVkFormatBC1RgbaSrgb, 4, 4, 8, true, "BC1_RGBA_SRGB" },
+    { kVkFormatBC3Unorm, 4, 4, 16, false, "BC3_UNORM" },
+    { kVkFormatBC3Srgb, 4, 4, 16, true, "BC3_SRGB" },
+};
+
+/////////////////////////////////////////////////////////
+// Functions
+
+static uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static float SrgbToLinear(uint8_t value)
+{
+    const float c = value / 255.0f;
+    return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+static uint8_t LinearToSrgb(float value)
+{
+    const float c = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+    return (uint8_t)std::lround(std::min(std::max(c, 0.0f), 1.0f) * 255.0f);
+}
+
+const char* ToString(ETextureValidation validation)
+{
+    switch (validation)
+    {
+    case ETextureValidation::Valid: return "Valid";
+    case ETextureValidation::TooSmall: return "TooSmall";
+    case ETextureValidation::BadMagic: return "BadMagic";
+    case ETextureValidation::BadVersion: return "BadVersion";
+    case ETextureValidation::UnknownFormat: return "UnknownFormat";
+    case ETextureValidation::BadLevels: return "BadLevels";
+    case ETextureValidation::SizeMismatch: return "SizeMismatch";
+    }
+
+    return "Unknown";
+}
+
+bool GetTextureFormatInfo(uint32_t vkFormat, STextureFormatInfo* pOutInfo)
+{
+    assert(pOutInfo != nullptr);
+    for (const STextureFormatInfo& info : kTextureFormats)
+    {
+        if (info.vkFormat == vkFormat)
+        {
+            *pOutInfo = info;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+uint32_t GetFullMipCount(uint32_t width, uint32_t height)
+{
+    uint32_t mipCount = 1;
+    for (uint32_t size = std::max(width, height); size > 1; size >>= 1)
+    {
+        ++mipCount;
+    }
+
+    return mipCount;
+}
+
+uint64_t GetTextureLevelSize(const STextureFormatInfo& info, uint32_t width, uint32_t height)
+{
+    const uint64_t blocksWide = (width + info.blockWidth - 1) / info.blockWidth;
+    const uint64_t blocksHigh = (height + info.blockHeight - 1) / info.blockHeight;
+    return blocksWide * blocksHigh * info.bytesPerBlock;
+}
+
+void GenerateMipChain(const uint8_t* pRgba, uint32_t width, uint32_t height, uint32_t mipCount, bool bSrgb, std::vector<std::vector<uint8_t>>* pOutLevels)
+{
+    assert(pRgba != nullptr);
+    assert(width > 0 && height > 0);
+    assert(mipCount > 0 && mipCount <= GetFullMipCount(width, height));
+    assert(pOutLevels != nullptr);
+
+    pOutLevels->resize(mipCount);
+    (*pOutLevels)[0].assign(pRgba, pRgba + size_t(width) * height * 4);
+    for (uint32_t level = 1; level < mipCount; ++level)
+    {
+        const std::vector<uint8_t>& src = (*pOutLevels)[level - 1];
+        const uint32_t srcWidth = std::max(width >> (level - 1), 1u);
+        const uint32_t srcHeight = std::max(height >> (level - 1), 1u);
+        const uint32_t dstWidth = std::max(srcWidth >> 1, 1u);
+        const uint32_t dstHeight = std::max(srcHeight >> 1, 1u);
+
+        std::vector<uint8_t>& dst = (*pOutLevels)[level];
+        dst.resize(size_t(dstWidth) * dstHeight * 4);
+        for (uint32_t y = 0; y < dstHeight; ++y)
+        {
+            // odd sizes clamp, so the last row/column of the source is folded into the last texel
+            const uint32_t y0 = std::min(y * 2, srcHeight - 1);
+            const uint32_t y1 = std::min(y * 2 + 1, srcHeight - 1);
+            for (uint32_t x = 0; x < dstWidth; ++x)
+            {
+                const uint32_t x0 = std::min(x * 2, srcWidth - 1);
+                const uint32_t x1 = std::min(x * 2 + 1, srcWidth - 1);
+                const uint8_t* pTexels[4] =
+                {
+                    &src[(size_t(y0) * srcWidth + x0) * 4],
+                    &src[(size_t(y0) * srcWidth + x1) * 4],
+                    &src[(size_t(y1) * srcWidth + x0) * 4],
+                    &src[(size_t(y1) * srcWidth + x1) * 4],
+                };
+
+                uint8_t* pDst = &dst[(size_t(y) * dstWidth + x) * 4];
+                for (uint32_t c = 0; c < 4; ++c)
+                {
+                    if (bSrgb && c < 3)
+                    {
+                        const float sum = SrgbToLinear(pTexels[0][c]) + SrgbToLinear(pTexels[1][c]) + SrgbToLinear(pTexels[2][c]) + SrgbToLinear(pTexels[3][c]);
+                        pDst[c] = LinearToSrgb(sum * 0.25f);
+                    }
+                    else
+                    {
+                        pDst[c] = uint8_t((pTexels[0][c] + pTexels[1][c] + pTexels[2][c] + pTexels[3][c] + 2) / 4);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// 4x4 texels starting at (blockX, blockY) * 4, clamped to the image
+static void FetchBlock(const uint8_t* pRgba, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, uint8_t (*pOutBlock)[4])
+{
+    for (uint32_t y = 0; y < 4; ++y)
+    {
+        const uint32_t srcY = std::min(blockY * 4 + y, height - 1);
+        for (uint32_t x = 0; x < 4; ++x)
+        {
+            const uint32_t srcX = std::min(blockX * 4 + x, width - 1);
+            memcpy(pOutBlock[y * 4 + x], &pRgba[(size_t(srcY) * width + srcX) * 4], 4);
+        }
+    }
+}
+
+static uint16_t PackRgb565(const uint8_t* pRgb)
+{
+    return uint16_t(((pRgb[0] * 31 + 127) / 255) << 11 | ((pRgb[1] * 63 + 127) / 255) << 5 | ((pRgb[2] * 31 + 127) / 255));
+}
+
+static void UnpackRgb565(uint16_t packed, int* pOutRgb)
+{
+    const int r = (packed >> 11) & 31;
+    const int g = (packed >> 5) & 63;
+    const int b = packed & 31;
+    pOutRgb[0] = (r << 3) | (r >> 2);
+    pOutRgb[1] = (g << 2) | (g >> 4);
+    pOutRgb[2] = (b << 3) | (b >> 2);
+}
+
+// Bounding box endpoints, always the opaque 4 color mode (color0 > color1)
+static void EncodeBC1Block(const uint8_t (*pBlock)[4], uint8_t* pOut)
+{
+    uint8_t minColor[3] = { 255, 255, 255 };
+    uint8_t maxColor[3] = { 0, 0, 0 };
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        for (uint32_t c = 0; c < 3; ++c)
+        {
+            minColor[c] = std::min(minColor[c], pBlock[i][c]);
+            maxColor[c] = std::max(maxColor[c], pBlock[i][c]);
+        }
+    }
+
+    uint16_t color0 = PackRgb565(maxColor);
+    uint16_t color1 = PackRgb565(minColor);
+    uint32_t indices = 0;
+    if (color0 < color1)
+    {
+        std::swap(color0, color1);
+    }
+
+    if (color0 != color1)
+    {
+        int palette[4][3];
+        UnpackRgb565(color0, palette[0]);
+        UnpackRgb565(color1, palette[1]);
+        for (uint32_t c = 0; c < 3; ++c)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            uint32_t bestIndex = 0;
+            int bestDistance = INT32_MAX;
+            for (uint32_t p = 0; p < 4; ++p)
+            {
+                int distance = 0;
+                for (uint32_t c = 0; c < 3; ++c)
+                {
+                    const int delta = int(pBlock[i][c]) - palette[p][c];
+                    distance += delta * delta;
+                }
+
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    bestIndex = p;
+                }
+            }
+
+            indices |= bestIndex << (i * 2);
+        }
+    }
+
+    pOut[0] = uint8_t(color0);
+    pOut[1] = uint8_t(color0 >> 8);
+    pOut[2] = uint8_t(color1);
+    pOut[3] = uint8_t(color1 >> 8);
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        pOut[4 + i] = uint8_t(indices >> (i * 8));
+    }
+}
+
+// 8 alpha mode (alpha0 > alpha1), 3 bit indices
+static void EncodeBC3AlphaBlock(const uint8_t (*pBlock)[4], uint8_t* pOut)
+{
+    uint8_t minAlpha = 255;
+    uint8_t maxAlpha = 0;
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        minAlpha = std::min(minAlpha, pBlock[i][3]);
+        maxAlpha = std::max(maxAlpha, pBlock[i][3]);
+    }
+
+    pOut[0] = maxAlpha;
+    pOut[1] = minAlpha;
+    uint64_t indices = 0;
+    if (maxAlpha != minAlpha)
+    {
+        int palette[8];
+        palette[0] = maxAlpha;
+        palette[1] = minAlpha;
+        for (int p = 1; p < 7; ++p)
+        {
+            palette[p + 1] = ((7 - p) * maxAlpha + p * minAlpha) / 7;
+        }
+
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            uint64_t bestIndex = 0;
+            int bestDistance = INT32_MAX;
+            for (uint32_t p = 0; p < 8; ++p)
+            {
+                const int distance = std::abs(int(pBlock[i][3]) - palette[p]);
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    bestIndex = p;
+                }
+            }
+
+            indices |= bestIndex << (i * 3);
+        }
+    }
+
+    for (uint32_t i = 0; i < 6; ++i)
+    {
+        pOut[2 + i] = uint8_t(indices >> (i * 8));
+    }
+}
+
+void EncodeBC1(const uint8_t* pRgba, uint32_t width, uint32_t height, uint8_t* pOut)
+{
+    const uint32_t blocksWide = (width + 3) / 4;
+    const uint32_t blocksHigh = (height + 3) / 4;
+    uint8_t block[16][4];
+    for (uint32_t by = 0; by < blocksHigh; ++by)
+    {
+        for (uint32_t bx = 0; bx < blocksWide; ++bx)
+        {
+            FetchBlock(pRgba, width, height, bx, by, block);
+            EncodeBC1Block(block, pOut + (size_t(by) * blocksWide + bx) * 8);
+        }
+    }
+}
+
+void EncodeBC3(const uint8_t* pRgba, uint32_t width, uint32_t height, uint8_t* pOut)
+{
+    const uint32_t blocksWide = (width + 3) / 4;
+    const uint32_t blocksHigh = (height + 3) / 4;
+    uint8_t block[16][4];
+    for (uint32_t by = 0; by < blocksHigh; ++by)
+    {
+        for (uint32_t bx = 0; bx < blocksWide; ++bx)
+        {
+            FetchBlock(pRgba, width, height, bx, by, block);
+            uint8_t* pBlockOut = pOut + (size_t(by) * blocksWide + bx) * 16;
+            EncodeBC3AlphaBlock(block, pBlockOut);
+            EncodeBC1Block(block, pBlockOut + 8);
+        }
+    }
+}
+
+bool CookTexture(const uint8_t* pRgba, uint32_t width, uint32_t height, const SCookTextureOptions& options, std::vector<char>* pOutFile)
+{
+    assert(pRgba != nullptr);
+    assert(pOutFile != nullptr);
+
+    STextureFormatInfo info;
+    if (!GetTextureFormatInfo(options.vkFormat, &info))
+    {
+        DiracError("[%s] unsupported format: %u", __FUNCTION__, options.vkFormat);
+        return false;
+    }
+
+    if (width == 0 || height == 0)
+    {
+        DiracError("[%s] empty texture", __FUNCTION__);
+        return false;
+    }
+
+    const uint32_t mipCount = options.bMips ? std::min(GetFullMipCount(width, height), kMaxTextureMipCount) : 1;
+    std::vector<std::vector<uint8_t>> levels;
+    GenerateMipChain(pRgba, width, height, mipCount, info.bSrgb, &levels);
+
+    STextureHeader header;
+    header.magic = kTextureMagic;
+    header.version = kTextureVersion;
+    header.vkFormat = options.vkFormat;
+    header.width = width;
+    header.height = height;
+    header.mipCount = mipCount;
+    header.dataOffset = AlignUp(sizeof(STextureHeader) + sizeof(STextureLevel) * mipCount, kTextureLevelAlignment);
+
+    std::vector<STextureLevel> levelTable(mipCount);
+    uint64_t offset = 0;
+    for (uint32_t i = 0; i < mipCount; ++i)
+    {
+        STextureLevel& level = levelTable[i];
+        level.width = std::max(width >> i, 1u);
+        level.height = std::max(height >> i, 1u);
+        level.offset = offset;
+        level.size = GetTextureLevelSize(info, level.width, level.height);
+        offset = AlignUp(offset + level.size, kTextureLevelAlignment);
+    }
+
+    header.dataSize = offset;
+
+    pOutFile->assign((size_t)(header.dataOffset + header.dataSize), 0);
+    char* pFile = pOutFile->data();
+    memcpy(pFile, &header, sizeof(STextureHeader));
+    memcpy(pFile + sizeof(STextureHeader), levelTable.data(), sizeof(STextureLevel) * mipCount);
+    for (uint32_t i = 0; i < mipCount; ++i)
+    {
+        const STextureLevel& level = levelTable[i];
+        uint8_t* pLevel = (uint8_t*)pFile + header.dataOffset + level.offset;
+        if (info.blockWidth == 1)
+        {
+            assert(level.size == levels[i].size());
+            memcpy(pLevel, levels[i].data(), levels[i].size());
+        }
+        else if (info.bytesPerBlock == 8)
+        {
+            EncodeBC1(levels[i].data(), level.width, level.height, pLevel);
+        }
+        else
+        {
+            EncodeBC3(levels[i].data(), level.width, level.height, pLevel);
+        }
+    }
+
+    return true;
+}
+
+ETextureValidation ValidateTexture(const char* pData, size_t numBytes)
+{
+    if (pData == nullptr || numBytes < sizeof(STextureHeader))
+        return ETextureValidation::TooSmall;
+
+    STextureHeader header;
+    memcpy(&header, pData, sizeof(STextureHeader));
+
+    if (header.magic != kTextureMagic)
+        return ETextureValidation::BadMagic;
+
+    if (header.version != kTextureVersion)
+        return ETextureValidation::BadVersion;
+
+    STextureFormatInfo info;
+    if (!GetTextureFormatInfo(header.vkFormat, &info))
+        return ETextureValidation::UnknownFormat;
+
+    if (header.width == 0
+        || header.height == 0
+        || header.mipCount == 0
+        || header.mipCount > std::min(GetFullMipCount(header.width, header.height), kMaxTextureMipCount)
+        || header.dataOffset < sizeof(STextureHeader) + sizeof(STextureLevel) * header.mipCount
+        || header.dataOffset % kTextureLevelAlignment != 0)
+    {
+        return ETextureValidation::BadLevels;
+    }
+
+    if (header.dataOffset > numBytes || header.dataSize != numBytes - header.dataOffset)
+        return ETextureValidation::SizeMismatch;
+
+    for (uint32_t i = 0; i < header.mipCount; ++i)
+    {
+        STextureLevel level;
+        memcpy(&level, pData + sizeof(STextureHeader) + sizeof(STextureLevel) * i, sizeof(STextureLevel));
+        if (level.width != std::max(header.width >> i, 1u)
+            || level.height != std::max(header.height >> i, 1u)
+            || level.size != GetTextureLevelSize(info, level.width, level.height)
+            || level.offset % kTextureLevelAlignment != 0
+            || level.offset > header.dataSize
+            || level.size > header.dataSize - level.offset)
+        {
+            return ETextureValidation::BadLevels;
+        }
+    }
+
+    return ETextureValidation::Valid;
+}
+
+bool OpenTexture(const char* pData, size_t numBytes, STextureView* pOutView)
+{
+    assert(pOutView != nullptr);
+    assert(((uintptr_t)pData % alignof(STextureLevel)) == 0);
+    *pOutView = STextureView();
+
+    const ETextureValidation validation = ValidateTexture(pData, numBytes);
+    if (validation != ETextureValidation::Valid)
+    {
+        DiracError("[%s] invalid texture: %s", __FUNCTION__, ToString(validation));
+        return false;
+    }
+
+    pOutView->pHeader = reinterpret_cast<const STextureHeader*>(pData);
+    pOutView->pLevels = reinterpret_cast<const STextureLevel*>(pData + sizeof(STextureHeader));
+    pOutView->pData = pData + pOutView->pHeader->dataOffset;
+    return true;
+}
+
+} // renderer namespace
@@ -0,0 +1,113 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+#include <vector>
+
+namespace renderer
+{
+
+/////////////////////////////////////////////////////////
+// Cooked textures (.dtex)
+//
+// Layout (little endian):
+//   STextureHeader
+//   STextureLevel[mipCount], largest first
+//   level data from STextureHeader::dataOffset, each level tightly packed in the layout vkCmdCopyBufferToImage
+//   expects for the stored VkFormat (bufferRowLength = 0) and starting on a kTextureLevelAlignment boundary
+//
+// Loading is a single memcpy of the data range into staging memory plus one VkBufferImageCopy per level.
+// Formats are stored as raw VkFormat values so the format and its tools don't depend on the Vulkan headers,
+// the renderer static_asserts they match.
+
+static constexpr uint32_t kVkFormatR8G8B8A8Unorm = 37; // VK_FORMAT_R8G8B8A8_UNORM
+static constexpr uint32_t kVkFormatR8G8B8A8Srgb = 43; // VK_FORMAT_R8G8B8A8_SRGB
+static constexpr uint32_t kVkFormatBC1RgbaUnorm = 133; // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+static constexpr uint32_t kVkFormatBC1RgbaSrgb = 134; // VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+static constexpr uint32_t kVkFormatBC3Unorm = 137; // VK_FORMAT_BC3_UNORM_BLOCK
+static constexpr uint32_t kVkFormatBC3Srgb = 138; // VK_FORMAT_BC3_SRGB_BLOCK
+
+static constexpr uint32_t kTextureLevelAlignment = 16; // multiple of every supported block size and of 4, as copies require
+static constexpr uint32_t kMaxTextureMipCount = 16;
+
+struct STextureFormatInfo
+{
+    uint32_t vkFormat = 0;
+    uint32_t blockWidth = 1;
+    uint32_t blockHeight = 1;
+    uint32_t bytesPerBlock = 0;
+    bool bSrgb = false;
+    const char* name = "";
+};
+
+struct STextureHeader
+{
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    uint32_t vkFormat = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t mipCount = 0;
+    uint64_t dataOffset = 0; // from the start of the file
+    uint64_t dataSize = 0; // all levels, including alignment padding
+};
+
+struct STextureLevel
+{
+    uint64_t offset = 0; // from STextureHeader::dataOffset
+    uint64_t size = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+};
+
+enum class ETextureValidation : uint8_t
+{
+    Valid,
+    TooSmall,
+    BadMagic,
+    BadVersion,
+    UnknownFormat,
+    BadLevels,
+    SizeMismatch
+};
+
+const char* ToString(ETextureValidation validation);
+
+struct STextureView
+{
+    const STextureHeader* pHeader = nullptr;
+    const STextureLevel* pLevels = nullptr;
+    const char* pData = nullptr; // STextureHeader::dataOffset bytes into the file
+};
+
+struct SCookTextureOptions
+{
+    uint32_t vkFormat = kVkFormatR8G8B8A8Unorm;
+    bool bMips = true; // full chain down to 1x1
+};
+
+// False for formats the cooker and loader don't know
+bool GetTextureFormatInfo(uint32_t vkFormat, STextureFormatInfo* pOutInfo);
+
+uint32_t GetFullMipCount(uint32_t width, uint32_t height);
+uint64_t GetTextureLevelSize(const STextureFormatInfo& info, uint32_t width, uint32_t height);
+
+// 2x2 box filter per level, averaged in linear space when bSrgb. pOutLevels[0] is a copy of the top level.
+void GenerateMipChain(const uint8_t* pRgba, uint32_t width, uint32_t height, uint32_t mipCount, bool bSrgb, std::vector<std::vector<uint8_t>>* pOutLevels);
+
+// Block encoders for tightly packed RGBA8, edges are padded by clamping. pOut holds GetTextureLevelSize bytes.
+void EncodeBC1(const uint8_t* pRgba, uint32_t width, uint32_t height, uint8_t* pOut);
+void EncodeBC3(const uint8_t* pRgba, uint32_t width, uint32_t height, uint8_t* pOut);
+
+// pRgba is tightly packed RGBA8, top row first
+bool CookTexture(const uint8_t* pRgba, uint32_t width, uint32_t height, const SCookTextureOptions& options, std::vector<char>* pOutFile);
+
+ETextureValidation ValidateTexture(const char* pData, size_t numBytes);
+
+// pData must stay alive and 8 byte aligned while the view is in use
+bool OpenTexture(const char* pData, size_t numBytes, STextureView* pOutView);
+
+} // renderer namespace
@@ -0,0 +1,218 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "event.h"
+
+namespace synchronization
+{
+
+////////////////////////////////////////////////
+// Constants
+
+static constexpr uint32_t kSemaphoreSpins = 64;
+
+////////////////////////////////////////////////
+// Helpers
+
+// Milliseconds left before deadline, kWaitForever stays forever
+static uint32_t RemainingMs(uint32_t timeoutMs, TTime startTime)
+{
+    if (timeoutMs == kWaitForever)
+        return kWaitForever;
+
+    const TMilliseconds elapsed = TSteadyClock::now() - startTime;
+    return elapsed.count() >= timeoutMs ? 0 : uint32_t(timeoutMs - elapsed.count());
+}
+
+// Sleeps on pWord while it equals expected, registering in pNumWaiters so wakers know to make the syscall.
+// Returns false once the timeout has run out.
+static bool WaitOnWord(std::atomic<uint32_t>* pWord, std::atomic<uint32_t>* pNumWaiters, uint32_t expected, uint32_t timeoutMs, TTime startTime)
+{
+    const uint32_t remainingMs = RemainingMs(timeoutMs, startTime);
+    if (remainingMs == 0)
+        return false;
+
+    // seq_cst pairs with the wakers: either they see the waiter or the futex sees their change
+    pNumWaiters->fetch_add(1, std::memory_order_seq_cst);
+    FutexWait(pWord, expected, remainingMs);
+    pNumWaiters->fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+////////////////////////////////////////////////
+// SEvent
+
+SEvent::SEvent(bool bAutoReset, bool bSignaled)
+    : m_state(bSignaled ? 1 : 0)
+    , m_bAutoReset(bAutoReset)
+{
+}
+
+void SEvent::Set()
+{
+    m_state.store(1, std::memory_order_seq_cst);
+    if (m_numWaiters.load(std::memory_order_seq_cst) == 0)
+        return;
+
+    if (m_bAutoReset)
+    {
+        FutexWakeOne(&m_state);
+    }
+    else
+    {
+        FutexWakeAll(&m_state);
+    }
+}
+
+void SEvent::Reset()
+{
+    m_state.store(0, std::memory_order_relaxed);
+}
+
+bool SEvent::IsSet() const
+{
+    return m_state.load(std::memory_order_acquire) == 1;
+}
+
+bool SEvent::TryConsume()
+{
+    if (!m_bAutoReset)
+        return IsSet();
+
+    uint32_t expected = 1;
+    return m_state.compare_exchange_strong(expected, 0, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+bool SEvent::Wait(uint32_t timeoutMs)
+{
+    const TTime startTime = TSteadyClock::now();
+    while (!TryConsume())
+    {
+        if (!WaitOnWord(&m_state, &m_numWaiters, 0, timeoutMs, startTime))
+            return TryConsume();
+    }
+
+    return true;
+}
+
+////////////////////////////////////////////////
+// SSemaphore
+
+SSemaphore::SSemaphore(uint32_t initialCount)
+    : m_count(initialCount)
+{
+}
+
+void SSemaphore::Release(uint32_t count)
+{
+    m_count.fetch_add(count, std::memory_order_seq_cst);
+    if (m_numWaiters.load(std::memory_order_seq_cst) == 0)
+        return;
+
+    if (count == 1)
+    {
+        FutexWakeOne(&m_count);
+    }
+    else
+    {
+        FutexWakeAll(&m_count);
+    }
+}
+
+bool SSemaphore::TryAcquire()
+{
+    uint32_t count = m_count.load(std::memory_order_relaxed);
+    while (count > 0)
+    {
+        if (m_count.compare_exchange_weak(count, count - 1, std::memory_order_acquire, std::memory_order_relaxed))
+            return true;
+    }
+
+    return false;
+}
+
+bool SSemaphore::Acquire(uint32_t timeoutMs)
+{
+    for (uint32_t spins = 0; spins < kSemaphoreSpins; ++spins)
+    {
+        if (TryAcquire())
+            return true;
+
+        CpuPause();
+    }
+
+    const TTime startTime = TSteadyClock::now();
+    while (!TryAcquire())
+    {
+        if (!WaitOnWord(&m_count, &m_numWaiters, 0, timeoutMs, startTime))
+            return TryAcquire();
+    }
+
+    return true;
+}
+
+uint32_t SSemaphore::GetCount() const
+{
+    return m_count.load(std::memory_order_relaxed);
+}
+
+////////////////////////////////////////////////
+// SWaitableCounter
+
+SWaitableCounter::SWaitableCounter(uint32_t value)
+    : m_value(value)
+{
+}
+
+void SWaitableCounter::WakeWaiters()
+{
+    if (m_numWaiters.load(std::memory_order_seq_cst) > 0)
+    {
+        FutexWakeAll(&m_value);
+    }
+}
+
+uint32_t SWaitableCounter::Add(uint32_t amount)
+{
+    const uint32_t value = m_value.fetch_add(amount, std::memory_order_seq_cst) + amount;
+    WakeWaiters();
+    return value;
+}
+
+uint32_t SWaitableCounter::Subtract(uint32_t amount)
+{
+    const uint32_t value = m_value.fetch_sub(amount, std::memory_order_seq_cst) - amount;
+    WakeWaiters();
+    return value;
+}
+
+void SWaitableCounter::Store(uint32_t value)
+{
+    m_value.store(value, std::memory_order_seq_cst);
+    WakeWaiters();
+}
+
+uint32_t SWaitableCounter::Load() const
+{
+    return m_value.load(std::memory_order_acquire);
+}
+
+bool SWaitableCounter::WaitFor(uint32_t value, uint32_t timeoutMs)
+{
+    const TTime startTime = TSteadyClock::now();
+    uint32_t current = Load();
+    while (current != value)
+    {
+        if (!WaitOnWord(&m_value, &m_numWaiters, current, timeoutMs, startTime))
+            return Load() == value;
+
+        current = Load();
+    }
+
+    return true;
+}
+
+} // synchronization namespace
@@ -0,0 +1,84 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+#include "futex.h"
+
+namespace synchronization
+{
+
+/////////////////////////////////////////////////////////
+// Event
+//
+// Signaled/unsignaled flag threads can block on. Manual reset events stay signaled and release every waiter until
+// Reset, auto reset events release exactly one waiter per Set. Set only wakes the kernel when somebody is waiting.
+
+struct alignas(kCacheLineSize) SEvent
+{
+    explicit SEvent(bool bAutoReset = false, bool bSignaled = false);
+    SEvent(const SEvent&) = delete;
+    SEvent& operator=(const SEvent&) = delete;
+
+    void Set();
+    void Reset();
+    bool IsSet() const;
+    bool Wait(uint32_t timeoutMs = kWaitForever); // returns false on timeout
+
+private:
+    bool TryConsume();
+
+    std::atomic<uint32_t> m_state; // 0 unsignaled, 1 signaled
+    std::atomic<uint32_t> m_numWaiters = { 0 };
+    const bool m_bAutoReset;
+};
+
+/////////////////////////////////////////////////////////
+// Semaphore
+//
+// Counting semaphore, acquires spin briefly before sleeping
+
+struct alignas(kCacheLineSize) SSemaphore
+{
+    explicit SSemaphore(uint32_t initialCount = 0);
+    SSemaphore(const SSemaphore&) = delete;
+    SSemaphore& operator=(const SSemaphore&) = delete;
+
+    void Release(uint32_t count = 1);
+    bool TryAcquire();
+    bool Acquire(uint32_t timeoutMs = kWaitForever); // returns false on timeout
+    uint32_t GetCount() const;
+
+private:
+    std::atomic<uint32_t> m_count;
+    std::atomic<uint32_t> m_numWaiters = { 0 };
+};
+
+/////////////////////////////////////////////////////////
+// Waitable counter
+//
+// Atomic counter threads can block on until it reaches a value, e.g. a fork-join over plain threads where each
+// worker decrements and the owner waits for zero. Only changes that happen while someone waits cost a wake.
+
+struct alignas(kCacheLineSize) SWaitableCounter
+{
+    explicit SWaitableCounter(uint32_t value = 0);
+    SWaitableCounter(const SWaitableCounter&) = delete;
+    SWaitableCounter& operator=(const SWaitableCounter&) = delete;
+
+    uint32_t Add(uint32_t amount); // returns the new value
+    uint32_t Subtract(uint32_t amount); // returns the new value
+    void Store(uint32_t value);
+    uint32_t Load() const;
+    bool WaitFor(uint32_t value, uint32_t timeoutMs = kWaitForever); // returns false on timeout
+
+private:
+    void WakeWaiters();
+
+    std::atomic<uint32_t> m_value;
+    std::atomic<uint32_t> m_numWaiters = { 0 };
+};
+
+} // synchronization namespace
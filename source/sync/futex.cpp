@@ -0,0 +1,123 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "futex.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#pragma comment(lib, "Synchronization.lib")
+#elif defined(__linux__)
+#include <cerrno>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace synchronization
+{
+
+#if defined(_WIN32)
+
+bool FutexWait(const std::atomic<uint32_t>* pWord, uint32_t expected, uint32_t timeoutMs)
+{
+    volatile void* pAddress = const_cast<std::atomic<uint32_t>*>(pWord);
+    const DWORD milliseconds = timeoutMs == kWaitForever ? INFINITE : DWORD(timeoutMs);
+    return WaitOnAddress(pAddress, &expected, sizeof(uint32_t), milliseconds) || GetLastError() != ERROR_TIMEOUT;
+}
+
+void FutexWakeOne(const std::atomic<uint32_t>* pWord)
+{
+    WakeByAddressSingle(const_cast<std::atomic<uint32_t>*>(pWord));
+}
+
+void FutexWakeAll(const std::atomic<uint32_t>* pWord)
+{
+    WakeByAddressAll(const_cast<std::atomic<uint32_t>*>(pWord));
+}
+
+#elif defined(__linux__)
+
+static long Futex(const std::atomic<uint32_t>* pWord, int operation, uint32_t value, const timespec* pTimeout)
+{
+    return syscall(SYS_futex, reinterpret_cast<const uint32_t*>(pWord), operation, value, pTimeout, nullptr, 0);
+}
+
+bool FutexWait(const std::atomic<uint32_t>* pWord, uint32_t expected, uint32_t timeoutMs)
+{
+    timespec timeout;
+    timeout.tv_sec = time_t(timeoutMs / 1000);
+    timeout.tv_nsec = long(timeoutMs % 1000) * 1000000;
+    const long result = Futex(pWord, FUTEX_WAIT_PRIVATE, expected, timeoutMs == kWaitForever ? nullptr : &timeout);
+    return result == 0 || errno != ETIMEDOUT; // EAGAIN (value changed) and EINTR count as wakes
+}
+
+void FutexWakeOne(const std::atomic<uint32_t>* pWord)
+{
+    Futex(pWord, FUTEX_WAKE_PRIVATE, 1, nullptr);
+}
+
+void FutexWakeAll(const std::atomic<uint32_t>* pWord)
+{
+    Futex(pWord, FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr);
+}
+
+#else
+
+// Parking lot fallback, words hash to a bucket and every wake notifies the whole bucket
+struct SFutexBucket
+{
+    std::mutex mutex;
+    std::condition_variable condition;
+};
+
+static constexpr size_t kNumFutexBuckets = 64;
+static SFutexBucket g_futexBuckets[kNumFutexBuckets];
+
+static SFutexBucket& GetFutexBucket(const std::atomic<uint32_t>* pWord)
+{
+    return g_futexBuckets[(reinterpret_cast<uintptr_t>(pWord) / sizeof(uint32_t)) % kNumFutexBuckets];
+}
+
+bool FutexWait(const std::atomic<uint32_t>* pWord, uint32_t expected, uint32_t timeoutMs)
+{
+    SFutexBucket& bucket = GetFutexBucket(pWord);
+    std::unique_lock<std::mutex> lock(bucket.mutex);
+    if (pWord->load(std::memory_order_seq_cst) != expected)
+        return true;
+
+    if (timeoutMs == kWaitForever)
+    {
+        bucket.condition.wait(lock);
+        return true;
+    }
+
+    return bucket.condition.wait_for(lock, std::chrono::milliseconds(timeoutMs)) == std::cv_status::no_timeout;
+}
+
+void FutexWakeOne(const std::atomic<uint32_t>* pWord)
+{
+    FutexWakeAll(pWord); // buckets are shared, waking one could wake the wrong word
+}
+
+void FutexWakeAll(const std::atomic<uint32_t>* pWord)
+{
+    SFutexBucket& bucket = GetFutexBucket(pWord);
+    {
+        std::lock_guard<std::mutex> lock(bucket.mutex); // orders the wake after a waiter's check
+    }
+
+    bucket.condition.notify_all();
+}
+
+#endif
+
+} // synchronization namespace
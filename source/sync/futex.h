@@ -0,0 +1,43 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+#include <atomic>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace synchronization
+{
+
+/////////////////////////////////////////////////////////
+// Futex
+//
+// Block on a 32 bit word until another thread changes it: futex on Linux, WaitOnAddress on Windows and a small
+// table of hashed condition variables elsewhere. Waits can wake spuriously, callers always re-check their condition.
+
+static constexpr size_t kCacheLineSize = 64; // alignment for anything written by more than one thread
+static constexpr uint32_t kWaitForever = UINT32_MAX;
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex words are plain 32 bit integers");
+
+// Sleeps while *pWord == expected, returns false if timeoutMs passed first
+bool FutexWait(const std::atomic<uint32_t>* pWord, uint32_t expected, uint32_t timeoutMs = kWaitForever);
+void FutexWakeOne(const std::atomic<uint32_t>* pWord);
+void FutexWakeAll(const std::atomic<uint32_t>* pWord);
+
+// Spin loop hint, lets the sibling hyperthread run and saves power while spinning
+inline void CpuPause()
+{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+} // synchronization namespace
@@ -0,0 +1,177 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "mutex.h"
+
+#include <thread>
+
+namespace synchronization
+{
+
+////////////////////////////////////////////////
+// Constants
+
+static constexpr uint32_t kMinMutexSpins = 16;
+static constexpr uint32_t kMaxMutexSpins = 1024;
+static constexpr uint32_t kRWLockSpins = 64;
+
+////////////////////////////////////////////////
+// SMutex
+
+static void UpdateSpinEstimate(std::atomic<uint32_t>* pSpinEstimate, uint32_t spinEstimate, uint32_t spins)
+{
+    const int32_t delta = (int32_t(spins) - int32_t(spinEstimate)) / 8;
+    pSpinEstimate->store(uint32_t(int32_t(spinEstimate) + delta), std::memory_order_relaxed);
+}
+
+void SMutex::Lock()
+{
+    uint32_t state = eUnlocked;
+    if (m_state.compare_exchange_strong(state, eLocked, std::memory_order_acquire, std::memory_order_relaxed))
+        return;
+
+    // Spin up to twice the recent average, so the limit grows while spinning pays off and decays when it doesn't
+    const uint32_t spinEstimate = m_spinEstimate.load(std::memory_order_relaxed);
+    const uint32_t maxSpins = std::min(kMaxMutexSpins, spinEstimate * 2 + kMinMutexSpins);
+    for (uint32_t spins = 0; spins < maxSpins; ++spins)
+    {
+        CpuPause();
+        state = m_state.load(std::memory_order_relaxed);
+        if (state == eUnlocked && m_state.compare_exchange_weak(state, eLocked, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            UpdateSpinEstimate(&m_spinEstimate, spinEstimate, spins);
+            return;
+        }
+
+        if (state == eContended)
+            break; // others are already asleep, queue behind them
+    }
+
+    UpdateSpinEstimate(&m_spinEstimate, spinEstimate, maxSpins);
+
+    // Mark contended whenever we take the lock from here on, we can't know whether others are still sleeping
+    state = m_state.exchange(eContended, std::memory_order_acquire);
+    while (state != eUnlocked)
+    {
+        FutexWait(&m_state, eContended);
+        state = m_state.exchange(eContended, std::memory_order_acquire);
+    }
+}
+
+bool SMutex::TryLock()
+{
+    uint32_t state = eUnlocked;
+    return m_state.compare_exchange_strong(state, eLocked, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+void SMutex::Unlock()
+{
+    if (m_state.exchange(eUnlocked, std::memory_order_release) == eContended)
+    {
+        FutexWakeOne(&m_state);
+    }
+}
+
+////////////////////////////////////////////////
+// SRWLock
+
+void SRWLock::WakeWaiters()
+{
+    // seq_cst pairs with the waiter increment, either we see the waiter or it sees the new state in FutexWait
+    if (m_numWaiters.load(std::memory_order_seq_cst) > 0)
+    {
+        FutexWakeAll(&m_state);
+    }
+}
+
+bool SRWLock::TryLockShared()
+{
+    uint32_t state = m_state.load(std::memory_order_relaxed);
+    while ((state & (kWriterBit | kWriterWaitingBit)) == 0)
+    {
+        assert((state & kReaderMask) != kReaderMask && "too many readers");
+        if (m_state.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed))
+            return true;
+    }
+
+    return false;
+}
+
+void SRWLock::LockShared()
+{
+    uint32_t spins = 0;
+    while (!TryLockShared())
+    {
+        if (++spins < kRWLockSpins)
+        {
+            CpuPause();
+            continue;
+        }
+
+        const uint32_t state = m_state.load(std::memory_order_relaxed);
+        if ((state & (kWriterBit | kWriterWaitingBit)) == 0)
+            continue;
+
+        m_numWaiters.fetch_add(1, std::memory_order_seq_cst);
+        FutexWait(&m_state, state);
+        m_numWaiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void SRWLock::UnlockShared()
+{
+    const uint32_t previous = m_state.fetch_sub(1, std::memory_order_seq_cst);
+    assert((previous & kReaderMask) > 0);
+    if ((previous & kReaderMask) == 1 && (previous & kWriterWaitingBit) != 0)
+    {
+        WakeWaiters();
+    }
+}
+
+bool SRWLock::TryLock()
+{
+    // a waiting bit left by another writer is taken over, that writer sets it again if it still has to wait
+    uint32_t state = m_state.load(std::memory_order_relaxed);
+    while ((state & (kWriterBit | kReaderMask)) == 0)
+    {
+        if (m_state.compare_exchange_weak(state, kWriterBit, std::memory_order_acquire, std::memory_order_relaxed))
+            return true;
+    }
+
+    return false;
+}
+
+void SRWLock::Lock()
+{
+    uint32_t spins = 0;
+    while (!TryLock())
+    {
+        if (++spins < kRWLockSpins)
+        {
+            CpuPause();
+            continue;
+        }
+
+        // block new readers, then sleep until the state changes
+        uint32_t state = m_state.fetch_or(kWriterWaitingBit, std::memory_order_relaxed) | kWriterWaitingBit;
+        if ((state & (kWriterBit | kReaderMask)) == 0)
+            continue;
+
+        m_numWaiters.fetch_add(1, std::memory_order_seq_cst);
+        FutexWait(&m_state, state);
+        m_numWaiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void SRWLock::Unlock()
+{
+    const uint32_t previous = m_state.fetch_and(~kWriterBit, std::memory_order_seq_cst);
+    assert((previous & kWriterBit) != 0);
+    (void)previous;
+    WakeWaiters();
+}
+
+} // synchronization namespace
@@ -0,0 +1,99 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+#include "futex.h"
+
+namespace synchronization
+{
+
+/////////////////////////////////////////////////////////
+// Mutex
+//
+// Three state futex mutex ("Futexes Are Tricky", Drepper): uncontended lock and unlock are a single atomic op and
+// unlock only makes a syscall when someone is asleep. Before sleeping a locker spins for an adaptive number of
+// iterations, tracking how long recent lockers had to spin, so short critical sections never reach the kernel.
+
+struct alignas(kCacheLineSize) SMutex
+{
+    SMutex() = default;
+    SMutex(const SMutex&) = delete;
+    SMutex& operator=(const SMutex&) = delete;
+
+    void Lock();
+    bool TryLock();
+    void Unlock();
+
+private:
+    enum : uint32_t
+    {
+        eUnlocked = 0,
+        eLocked = 1,
+        eContended = 2 // locked and somebody may be sleeping
+    };
+
+    std::atomic<uint32_t> m_state = { eUnlocked };
+    std::atomic<uint32_t> m_spinEstimate = { 0 }; // racy average, only a hint
+};
+
+/////////////////////////////////////////////////////////
+// Reader/writer lock
+//
+// Any number of readers or one writer. A waiting writer blocks new readers so a steady stream of readers can't
+// starve it. Sleepers are only woken when the waiter count says someone is asleep.
+
+struct alignas(kCacheLineSize) SRWLock
+{
+    SRWLock() = default;
+    SRWLock(const SRWLock&) = delete;
+    SRWLock& operator=(const SRWLock&) = delete;
+
+    void LockShared();
+    bool TryLockShared();
+    void UnlockShared();
+
+    void Lock();
+    bool TryLock();
+    void Unlock();
+
+private:
+    static constexpr uint32_t kWriterBit = 1u << 31;
+    static constexpr uint32_t kWriterWaitingBit = 1u << 30;
+    static constexpr uint32_t kReaderMask = kWriterWaitingBit - 1;
+
+    void WakeWaiters();
+
+    std::atomic<uint32_t> m_state = { 0 }; // reader count | kWriterWaitingBit | kWriterBit
+    std::atomic<uint32_t> m_numWaiters = { 0 };
+};
+
+/////////////////////////////////////////////////////////
+// Scoped locking
+
+template <typename TLock>
+struct SLockGuard
+{
+    explicit SLockGuard(TLock& lock) : m_lock(lock) { m_lock.Lock(); }
+    ~SLockGuard() { m_lock.Unlock(); }
+    SLockGuard(const SLockGuard&) = delete;
+    SLockGuard& operator=(const SLockGuard&) = delete;
+
+private:
+    TLock& m_lock;
+};
+
+struct SSharedLockGuard
+{
+    explicit SSharedLockGuard(SRWLock& lock) : m_lock(lock) { m_lock.LockShared(); }
+    ~SSharedLockGuard() { m_lock.UnlockShared(); }
+    SSharedLockGuard(const SSharedLockGuard&) = delete;
+    SSharedLockGuard& operator=(const SSharedLockGuard&) = delete;
+
+private:
+    SRWLock& m_lock;
+};
+
+} // synchronization namespace
@@ -0,0 +1,171 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#pragma once
+
+#include <utility>
+
+#include "futex.h"
+
+namespace synchronization
+{
+
+/////////////////////////////////////////////////////////
+// Bounded lock free queues
+//
+// Fixed capacity rings that never allocate or block, TryPush fails when full and TryPop when empty.
+// Positions and slots written by different threads live on separate cache lines.
+
+// Multiple producers, multiple consumers (Vyukov's bounded MPMC queue). Every slot carries a sequence number that says
+// whether it is ready for the producer or the consumer of the current lap, so each side only contends on one counter.
+template <typename T, size_t kCapacity>
+struct SMpmcQueue
+{
+    static_assert(kCapacity >= 2 && (kCapacity & (kCapacity - 1)) == 0, "capacity must be a power of two");
+
+    SMpmcQueue()
+    {
+        for (size_t i = 0; i < kCapacity; ++i)
+        {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    SMpmcQueue(const SMpmcQueue&) = delete;
+    SMpmcQueue& operator=(const SMpmcQueue&) = delete;
+
+    bool TryPush(T value)
+    {
+        size_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+        while (true)
+        {
+            SCell& cell = m_cells[position & (kCapacity - 1)];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const intptr_t difference = intptr_t(sequence) - intptr_t(position);
+            if (difference == 0)
+            {
+                if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    cell.value = std::move(value);
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                return false; // the consumer of the previous lap hasn't emptied the slot, full
+            }
+            else
+            {
+                position = m_enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool TryPop(T* pOutValue)
+    {
+        size_t position = m_dequeuePosition.load(std::memory_order_relaxed);
+        while (true)
+        {
+            SCell& cell = m_cells[position & (kCapacity - 1)];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const intptr_t difference = intptr_t(sequence) - intptr_t(position + 1);
+            if (difference == 0)
+            {
+                if (m_dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    *pOutValue = std::move(cell.value);
+                    cell.sequence.store(position + kCapacity, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                return false; // not produced yet, empty
+            }
+            else
+            {
+                position = m_dequeuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    size_t GetApproximateSize() const
+    {
+        const size_t enqueuePosition = m_enqueuePosition.load(std::memory_order_relaxed);
+        const size_t dequeuePosition = m_dequeuePosition.load(std::memory_order_relaxed);
+        return enqueuePosition > dequeuePosition ? enqueuePosition - dequeuePosition : 0;
+    }
+
+private:
+    struct alignas(kCacheLineSize) SCell
+    {
+        std::atomic<size_t> sequence = { 0 };
+        T value = T();
+    };
+
+    alignas(kCacheLineSize) std::atomic<size_t> m_enqueuePosition = { 0 };
+    alignas(kCacheLineSize) std::atomic<size_t> m_dequeuePosition = { 0 };
+    SCell m_cells[kCapacity];
+};
+
+// Single producer, single consumer. Each side caches the other's position and only re-reads it when the ring looks
+// full or empty, so steady state traffic doesn't bounce the other side's cache line.
+template <typename T, size_t kCapacity>
+struct SSpscQueue
+{
+    static_assert(kCapacity >= 2 && (kCapacity & (kCapacity - 1)) == 0, "capacity must be a power of two");
+
+    SSpscQueue() = default;
+    SSpscQueue(const SSpscQueue&) = delete;
+    SSpscQueue& operator=(const SSpscQueue&) = delete;
+
+    // Producer only
+    bool TryPush(T value)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_cachedTail == kCapacity)
+        {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head - m_cachedTail == kCapacity)
+                return false;
+        }
+
+        m_values[head & (kCapacity - 1)] = std::move(value);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only
+    bool TryPop(T* pOutValue)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_cachedHead)
+        {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail == m_cachedHead)
+                return false;
+        }
+
+        *pOutValue = std::move(m_values[tail & (kCapacity - 1)]);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t GetApproximateSize() const
+    {
+        const size_t tail = m_tail.load(std::memory_order_acquire); // tail first, it never passes head
+        return m_head.load(std::memory_order_acquire) - tail;
+    }
+
+private:
+    alignas(kCacheLineSize) std::atomic<size_t> m_head = { 0 }; // producer line
+    size_t m_cachedTail = 0;
+    alignas(kCacheLineSize) std::atomic<size_t> m_tail = { 0 }; // consumer line
+    size_t m_cachedHead = 0;
+    alignas(kCacheLineSize) T m_values[kCapacity] = {};
+};
+
+} // synchronization namespace
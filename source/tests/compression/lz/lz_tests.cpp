@@ -0,0 +1,105 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "lz_tests.h"
+
+#include <vector>
+
+#include "compression/lz.h"
+#include "tests/test_framework.h"
+
+using namespace compression;
+
+static bool RoundTrip(const std::vector<char>& input, size_t* pOutCompressedSize = nullptr)
+{
+    std::vector<char> compressed(LzCompressBound(input.size()));
+    const size_t compressedSize = LzCompressBlock(input.data(), input.size(), compressed.data(), compressed.size());
+    if (pOutCompressedSize != nullptr)
+    {
+        *pOutCompressedSize = compressedSize;
+    }
+
+    std::vector<char> output(input.size());
+    return compressedSize > 0
+        && LzDecompressBlock(compressed.data(), compressedSize, output.data(), output.size())
+        && output == input;
+}
+
+// xorshift, so the incompressible input is the same on every platform
+static std::vector<char> MakeNoise(size_t numBytes)
+{
+    std::vector<char> noise(numBytes);
+    uint32_t state = 0x9e3779b9;
+    for (char& c : noise)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        c = char(state);
+    }
+
+    return noise;
+}
+
+void RunLzTests()
+{
+    TEST("lz: empty round trip", RoundTrip(std::vector<char>()));
+    TEST("lz: tiny round trip", RoundTrip(std::vector<char>{ 'a', 'b', 'c' }));
+
+    {
+        std::vector<char> runs(40000, 'x');
+        size_t compressedSize = 0;
+        TEST("lz: run round trip", RoundTrip(runs, &compressedSize));
+        TEST("lz: runs compress", compressedSize < runs.size() / 50);
+    }
+
+    {
+        const char* text = "the quick brown fox jumps over the lazy dog, ";
+        std::vector<char> repeated;
+        for (size_t i = 0; i < 500; ++i)
+        {
+            repeated.insert(repeated.end(), text, text + strlen(text) - (i % 7));
+        }
+
+        size_t compressedSize = 0;
+        TEST("lz: text round trip", RoundTrip(repeated, &compressedSize));
+        TEST("lz: text compresses", compressedSize < repeated.size() / 4);
+    }
+
+    {
+        const std::vector<char> noise = MakeNoise(20000);
+        size_t compressedSize = 0;
+        TEST("lz: noise round trip", RoundTrip(noise, &compressedSize));
+        TEST("lz: noise within bound", compressedSize <= LzCompressBound(noise.size()));
+
+        std::vector<char> small(noise.size() / 2);
+        TEST("lz: undersized destination fails", LzCompressBlock(noise.data(), noise.size(), small.data(), small.size()) == 0);
+    }
+
+    {
+        std::vector<char> input(5000);
+        for (size_t i = 0; i < input.size(); ++i)
+        {
+            input[i] = char((i * i) >> 5);
+        }
+
+        std::vector<char> compressed(LzCompressBound(input.size()));
+        const size_t compressedSize = LzCompressBlock(input.data(), input.size(), compressed.data(), compressed.size());
+        std::vector<char> output(input.size());
+        TEST("lz: wrong size rejected", !LzDecompressBlock(compressed.data(), compressedSize, output.data(), output.size() - 1));
+        TEST("lz: truncation rejected", !LzDecompressBlock(compressed.data(), compressedSize - 1, output.data(), output.size()));
+
+        // Damage bytes throughout the block, decoding may fail or produce garbage but must stay in bounds
+        for (size_t i = 0; i < compressedSize; i += 7)
+        {
+            std::vector<char> damaged(compressed.begin(), compressed.begin() + compressedSize);
+            damaged[i] ^= 0x5a;
+            LzDecompressBlock(damaged.data(), damaged.size(), output.data(), output.size());
+        }
+
+        TEST("lz: decodes after damaged inputs", LzDecompressBlock(compressed.data(), compressedSize, output.data(), output.size()) && output == input);
+    }
+}
@@ -0,0 +1,192 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "world_tests.h"
+
+#include <vector>
+
+#include "ecs/command_buffer.h"
+#include "ecs/motion.h"
+#include "ecs/world.h"
+#include "tests/test_framework.h"
+
+using namespace ecs;
+
+static constexpr uint32_t kNumTestEntities = 20000;
+
+struct STestId
+{
+    uint32_t value;
+};
+
+struct STestTag
+{
+    uint8_t bTagged;
+};
+
+void RunWorldTests()
+{
+    { // entity lifetime
+        SWorld world;
+        const SEntity first = world.CreateEntity();
+        TEST("world: created entity is alive", first.IsValid() && world.IsAlive(first) && world.GetEntityCount() == 1);
+        TEST("world: destroy", world.DestroyEntity(first) && !world.IsAlive(first) && world.GetEntityCount() == 0);
+        TEST("world: destroy twice fails", !world.DestroyEntity(first));
+
+        const SEntity second = world.CreateEntity(GetComponentMask<STestId>());
+        TEST("world: slot reused with a new generation", second.index == first.index && second.generation != first.generation);
+        TEST("world: stale handle doesn't resolve", world.GetComponent<STestId>(first) == nullptr && !world.IsAlive(first));
+        TEST("world: components zero filled", world.GetComponent<STestId>(second) != nullptr && world.GetComponent<STestId>(second)->value == 0);
+    } // ~entity lifetime
+
+    { // components
+        SWorld world;
+        const SEntity entity = world.CreateEntity();
+        TEST("world: add component", world.AddComponent(entity, STestId{ 7 }) && world.HasComponent<STestId>(entity));
+        TEST("world: add second component", world.AddComponent(entity, SPosition{ Vec3l(1, 2, 3) }));
+        TEST("world: values survive archetype moves", world.GetComponent<STestId>(entity)->value == 7 && world.GetComponent<SPosition>(entity)->value == Vec3l(1, 2, 3));
+        TEST("world: add overwrites", world.AddComponent(entity, STestId{ 8 }) && world.GetComponent<STestId>(entity)->value == 8);
+        TEST("world: remove component", world.RemoveComponent<STestId>(entity) && !world.HasComponent<STestId>(entity));
+        TEST("world: remaining component kept", world.GetComponentMask(entity) == GetComponentMask<SPosition>() && world.GetComponent<SPosition>(entity)->value == Vec3l(1, 2, 3));
+    } // ~components
+
+    { // dense chunks
+        SWorld world;
+        std::vector<SEntity> entities;
+        for (uint32_t i = 0; i < kNumTestEntities; ++i)
+        {
+            const SEntity entity = world.CreateEntity(GetComponentMask<STestId, SPosition>());
+            world.GetComponent<STestId>(entity)->value = i;
+            entities.push_back(entity);
+        }
+
+        for (uint32_t i = 0; i < kNumTestEntities; i += 3)
+        {
+            world.DestroyEntity(entities[i]);
+        }
+
+        bool bValuesIntact = true;
+        for (uint32_t i = 0; i < kNumTestEntities; ++i)
+        {
+            const STestId* pId = world.GetComponent<STestId>(entities[i]);
+            bValuesIntact = bValuesIntact && (i % 3 == 0 ? pId == nullptr : pId != nullptr && pId->value == i);
+        }
+
+        TEST("world: values intact after swap removal", bValuesIntact);
+
+        uint32_t numVisited = 0;
+        uint32_t numPartialChunks = 0;
+        bool bAligned = true;
+        world.ForEachChunk(SQuery::With<STestId>(), [&](const SChunkView& chunk)
+        {
+            numVisited += chunk.GetCount();
+            numPartialChunks += chunk.GetCount() < chunk.pArchetype->capacity ? 1 : 0;
+            bAligned = bAligned && (uintptr_t(chunk.GetComponents<SPosition>()) % kChunkArrayAlignment) == 0;
+            for (uint32_t i = 0; i < chunk.GetCount(); ++i)
+            {
+                bValuesIntact = bValuesIntact && chunk.GetEntities()[i] == entities[chunk.GetComponents<STestId>()[i].value];
+            }
+        });
+
+        TEST("world: query visits every entity once", numVisited == world.GetEntityCount() && bValuesIntact);
+        TEST("world: only the last chunk is partial", numPartialChunks <= 1);
+        TEST("world: component arrays aligned", bAligned);
+    } // ~dense chunks
+
+    { // queries
+        SWorld world;
+        world.CreateEntity(GetComponentMask<STestId>());
+        world.CreateEntity(GetComponentMask<STestId, STestTag>());
+        world.CreateEntity(GetComponentMask<STestTag>());
+
+        uint32_t numWithId = 0;
+        uint32_t numUntagged = 0;
+        world.ForEachChunk(SQuery::With<STestId>(), [&](const SChunkView& chunk) { numWithId += chunk.GetCount(); });
+        world.ForEachChunk(SQuery::With<STestId>().Without<STestTag>(), [&](const SChunkView& chunk) { numUntagged += chunk.GetCount(); });
+        TEST("world: query matches supersets", numWithId == 2);
+        TEST("world: query exclusion", numUntagged == 1);
+    } // ~queries
+
+    { // command buffers
+        SWorld world;
+        for (uint32_t i = 0; i < 1000; ++i)
+        {
+            world.AddComponent(world.CreateEntity(), STestId{ i });
+        }
+
+        SCommandBuffer commandBuffer(&world);
+        std::vector<SEntity> spawned;
+        world.ForEachChunk(SQuery::With<STestId>(), [&](const SChunkView& chunk)
+        {
+            for (uint32_t i = 0; i < chunk.GetCount(); ++i)
+            {
+                const uint32_t id = chunk.GetComponents<STestId>()[i].value;
+                if (id % 2 == 0)
+                {
+                    commandBuffer.DestroyEntity(chunk.GetEntities()[i]);
+                }
+                else if (id % 5 == 0)
+                {
+                    const SEntity entity = commandBuffer.CreateEntity();
+                    commandBuffer.AddComponent(entity, STestTag{ 1 });
+                    spawned.push_back(entity);
+                }
+            }
+        });
+
+        TEST("command buffer: nothing applied while recording", world.GetEntityCount() == 1000 && !commandBuffer.IsEmpty());
+        TEST("command buffer: reserved handles aren't alive yet", !spawned.empty() && !world.IsAlive(spawned[0]));
+        world.Playback(&commandBuffer);
+        TEST("command buffer: cleared by playback", commandBuffer.IsEmpty() && commandBuffer.GetCommandCount() == 0);
+        TEST("command buffer: destroys and creates applied", world.GetEntityCount() == 500 + uint32_t(spawned.size()));
+
+        bool bSpawnedTagged = true;
+        for (SEntity entity : spawned)
+        {
+            bSpawnedTagged = bSpawnedTagged && world.IsAlive(entity) && world.GetComponentMask(entity) == GetComponentMask<STestTag>();
+        }
+
+        TEST("command buffer: created entities get their components", bSpawnedTagged);
+
+        const SEntity destroyed = spawned[0];
+        commandBuffer.DestroyEntity(destroyed);
+        commandBuffer.AddComponent(destroyed, STestId{ 1 });
+        world.Playback(&commandBuffer);
+        TEST("command buffer: commands on dead entities are skipped", !world.IsAlive(destroyed) && world.GetEntityCount() == 499 + uint32_t(spawned.size()));
+    } // ~command buffers
+
+    { // parallel integration
+        SWorld world;
+        std::vector<SEntity> entities;
+        for (uint32_t i = 0; i < kNumTestEntities; ++i)
+        {
+            const SEntity entity = world.CreateEntity(GetComponentMask<SPosition, SVelocity>());
+            world.GetComponent<SVelocity>(entity)->value = Vec3l(float(i % 7), 1, -2);
+            entities.push_back(entity);
+        }
+
+        const SEntity still = world.CreateEntity(GetComponentMask<SPosition>());
+        world.GetComponent<SPosition>(still)->value = Vec3l(5, 5, 5);
+
+        IntegrateVelocities(&world, 0.5f);
+        IntegrateVelocities(&world, 0.25f);
+
+        bool bIntegrated = true;
+        for (uint32_t i = 0; i < kNumTestEntities; ++i)
+        {
+            bIntegrated = bIntegrated && world.GetComponent<SPosition>(entities[i])->value.IsEquivalent(Vec3l(float(i % 7) * 0.75f, 0.75f, -1.5f), kFLocalEpsilon);
+        }
+
+        TEST("motion: velocities integrated across chunks", bIntegrated);
+        TEST("motion: entities without velocity untouched", world.GetComponent<SPosition>(still)->value == Vec3l(5, 5, 5));
+
+        const SEntity spinner = world.CreateEntity();
+        world.AddComponent(spinner, SOrientation{ Quaternionl(EIdentity::Constructor) });
+        world.AddComponent(spinner, SAngularVelocity{ Vec3l(0, kFLocalPi, 0) });
+        IntegrateAngularVelocities(&world, 0.5f);
+        TEST("motion: angular velocity integrated", world.GetComponent<SOrientation>(spinner)->value.IsEquivalent(Quaternionl::CreateRotationXYZ(0, kFLocalPi * 0.5f, 0), 0.0001f));
+    } // ~parallel integration
+}
@@ -0,0 +1,146 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "game_state_tests.h"
+
+#include <cstddef>
+#include <vector>
+
+#include "game/game_state.h"
+#include "tests/test_framework.h"
+
+using namespace game;
+
+static constexpr uint32_t kNumTestShapes = 8;
+
+struct STestGameState
+{
+    SPlayerState player;
+    SCameraState camera;
+    SShapeState shapes[kNumTestShapes];
+};
+
+static void InitializeTestGameState(STestGameState* pState)
+{
+    pState->player.position = Vec3l(1, 2, 3);
+    pState->player.velocity = Vec3l(0.5f, 0, 0);
+    pState->player.orientation = Quaternionl(EIdentity::Constructor);
+    pState->player.targetOrientation = Quaternionl::CreateRotationXYZ(0.25f, 0, 0);
+    pState->player.activeDirections = 3;
+    pState->camera.transform = Matrix44l::CreateRotationAndTranslation(pState->player.orientation, pState->player.position);
+    for (uint32_t i = 0; i < kNumTestShapes; ++i)
+    {
+        pState->shapes[i].localPosition = Vec3l(float(i), 0, -1);
+        pState->shapes[i].localRotation = Quaternionl(EIdentity::Constructor);
+        pState->shapes[i].localScale = Vec3l(1, 1, 1);
+        pState->shapes[i].inverseWorldMatrix = Matrix43l(EIdentity::Constructor);
+    }
+}
+
+static void BuildTestGameState(const STestGameState& state, TFrameId frameId, std::vector<uint8_t>* pOutState)
+{
+    SGameStateDesc desc;
+    desc.frameId = frameId;
+    desc.pPlayer = &state.player;
+    desc.pCamera = &state.camera;
+    desc.pShapes = state.shapes;
+    desc.numShapes = kNumTestShapes;
+    BuildGameState(desc, pOutState);
+}
+
+void RunGameStateTests()
+{
+    STestGameState state;
+    InitializeTestGameState(&state);
+
+    std::vector<uint8_t> first;
+    BuildTestGameState(state, 1, &first);
+
+    { // in place round trip
+        SGameStateView view;
+        TEST("game state: valid", OpenGameState(first.data(), first.size(), &view) == EGameStateValidation::Valid);
+        TEST("game state: header", view.pHeader->frameId == 1 && view.pHeader->size == first.size() && first.size() % kGameStateAlignment == 0);
+        TEST("game state: player", view.pPlayer->position == state.player.position && view.pPlayer->targetOrientation == state.player.targetOrientation && view.pPlayer->activeDirections == 3);
+        TEST("game state: camera", memcmp(&view.pCamera->transform, &state.camera.transform, sizeof(Matrix44l)) == 0);
+        TEST("game state: shapes used in place", view.numShapes == kNumTestShapes && view.pShapes[5].localPosition == state.shapes[5].localPosition &&
+            (const uint8_t*)view.pShapes >= first.data() && (const uint8_t*)(view.pShapes + kNumTestShapes) <= first.data() + first.size());
+    } // ~in place round trip
+
+    { // hashing
+        std::vector<uint8_t> same;
+        BuildTestGameState(state, 1, &same);
+        TEST("game state: equal state, equal bytes", same == first);
+
+        STestGameState changed = state;
+        changed.shapes[7].localScale.z = 2;
+        std::vector<uint8_t> other;
+        BuildTestGameState(changed, 1, &other);
+        SGameStateHeader firstHeader;
+        SGameStateHeader otherHeader;
+        memcpy(&firstHeader, first.data(), sizeof(firstHeader));
+        memcpy(&otherHeader, other.data(), sizeof(otherHeader));
+        TEST("game state: one float changes the hash", firstHeader.hash != otherHeader.hash);
+        TEST("game state: hash covers odd sizes", HashGameState(first.data(), 13) != HashGameState(first.data(), 12));
+    } // ~hashing
+
+    { // validation
+        SGameStateView view;
+        std::vector<uint8_t> corrupt = first;
+        corrupt[corrupt.size() - kGameStateAlignment - 1] ^= 1;
+        TEST("game state: corruption detected", OpenGameState(corrupt.data(), corrupt.size(), &view) == EGameStateValidation::HashMismatch && view.pPlayer == nullptr);
+        TEST("game state: truncation detected", OpenGameState(first.data(), first.size() - kGameStateAlignment, &view) == EGameStateValidation::SizeMismatch);
+        TEST("game state: too small", OpenGameState(first.data(), sizeof(SGameStateHeader) - 1, &view) == EGameStateValidation::TooSmall);
+
+        std::vector<uint8_t> badVersion = first;
+        const uint32_t version = kGameStateVersion + 1;
+        memcpy(badVersion.data() + offsetof(SGameStateHeader, version), &version, sizeof(version));
+        TEST("game state: version checked", OpenGameState(badVersion.data(), badVersion.size(), &view) == EGameStateValidation::BadVersion);
+
+        std::vector<uint8_t> badSection = first;
+        const uint32_t sectionVersion = SShapeState::kVersion + 1;
+        const size_t shapesSection = sizeof(SGameStateHeader) + sizeof(SGameStateSection) * (size_t)EGameStateSection::Shapes;
+        memcpy(badSection.data() + shapesSection + offsetof(SGameStateSection, version), &sectionVersion, sizeof(sectionVersion));
+        TEST("game state: section versions checked", OpenGameState(badSection.data(), badSection.size(), &view) == EGameStateValidation::BadSection);
+
+        // in bounds and aligned, but pointing the player back over the header
+        std::vector<uint8_t> overlappingSection = first;
+        const uint32_t headerOffset = 0;
+        const size_t playerSection = sizeof(SGameStateHeader) + sizeof(SGameStateSection) * (size_t)EGameStateSection::Player;
+        memcpy(overlappingSection.data() + playerSection + offsetof(SGameStateSection, offset), &headerOffset, sizeof(headerOffset));
+        TEST("game state: sections can't overlap the header", OpenGameState(overlappingSection.data(), overlappingSection.size(), &view) == EGameStateValidation::BadSection);
+    } // ~validation
+
+    { // deltas
+        STestGameState next = state;
+        next.player.position.x += 0.125f;
+        next.shapes[2].localRotation = Quaternionl::CreateRotationXYZ(0, 0.5f, 0);
+        std::vector<uint8_t> second;
+        BuildTestGameState(next, 2, &second);
+
+        std::vector<uint8_t> delta;
+        TEST("game state: build delta", BuildGameStateDelta(first.data(), second.data(), first.size(), &delta));
+        TEST("game state: delta is compact", delta.size() < first.size() / 4);
+
+        std::vector<uint8_t> rewound = first;
+        TEST("game state: apply delta forward", ApplyGameStateDelta(delta.data(), delta.size(), rewound.data(), rewound.size()) && rewound == second);
+        TEST("game state: apply delta backward", ApplyGameStateDelta(delta.data(), delta.size(), rewound.data(), rewound.size()) && rewound == first);
+
+        std::vector<uint8_t> unrelated;
+        STestGameState other = state;
+        other.player.velocity.y = 1;
+        BuildTestGameState(other, 3, &unrelated);
+        const std::vector<uint8_t> unrelatedCopy = unrelated;
+        TEST("game state: delta rejects other snapshots", !ApplyGameStateDelta(delta.data(), delta.size(), unrelated.data(), unrelated.size()) && unrelated == unrelatedCopy);
+
+        std::vector<uint8_t> corruptDelta = delta;
+        corruptDelta.back() ^= 0x10;
+        std::vector<uint8_t> target = first;
+        TEST("game state: corrupt delta restores the snapshot", !ApplyGameStateDelta(corruptDelta.data(), corruptDelta.size(), target.data(), target.size()) && target == first);
+        TEST("game state: truncated delta rejected", !ApplyGameStateDelta(delta.data(), delta.size() - sizeof(uint32_t), target.data(), target.size()) && target == first);
+
+        TEST("game state: delta needs equal sizes", !BuildGameStateDelta(first.data(), second.data(), first.size() - kGameStateAlignment, &delta));
+    } // ~deltas
+}
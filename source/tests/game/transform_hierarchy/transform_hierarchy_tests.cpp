@@ -0,0 +1,114 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "transform_hierarchy_tests.h"
+
+#include <vector>
+
+#include "game/transform_hierarchy.h"
+#include "tests/test_framework.h"
+
+using namespace game;
+
+static constexpr flocal kTransformEpsilon = 0.0001f;
+static constexpr uint32_t kNumWideChildren = 5000;
+static constexpr uint32_t kChainLength = 64;
+
+static Vec3l GetWorldPosition(const STransformHierarchy& hierarchy, TTransformNode node)
+{
+    return hierarchy.GetWorldMatrix(node).GetRow4();
+}
+
+void RunTransformHierarchyTests()
+{
+    { // single node
+        STransformHierarchy hierarchy;
+        const TTransformNode node = hierarchy.CreateNode(kInvalidTransformNode, Vec3l(1, 2, 3), Quaternionl(EIdentity::Constructor), Vec3l(2, 2, 2));
+        TEST("transform hierarchy: first update computes new nodes", hierarchy.UpdateTransforms() == 1 && hierarchy.HasWorldChanged(node));
+        TEST("transform hierarchy: translation", GetWorldPosition(hierarchy, node).IsEquivalent(Vec3l(1, 2, 3), kTransformEpsilon));
+        TEST("transform hierarchy: scale", (Vec3l(1, 0, 0) * hierarchy.GetWorldMatrix(node)).IsEquivalent(Vec3l(3, 2, 3), kTransformEpsilon));
+        TEST("transform hierarchy: inverse", (Vec3l(3, 2, 3) * hierarchy.GetInverseWorldMatrix(node)).IsEquivalent(Vec3l(1, 0, 0), kTransformEpsilon));
+        TEST("transform hierarchy: static nodes cost nothing", hierarchy.UpdateTransforms() == 0 && !hierarchy.HasWorldChanged(node));
+    } // ~single node
+
+    { // parent and children
+        STransformHierarchy hierarchy;
+        const TTransformNode root = hierarchy.CreateNode(kInvalidTransformNode, Vec3l(10, 0, 0));
+        const TTransformNode moving = hierarchy.CreateNode(root, Vec3l(0, 1, 0));
+        const TTransformNode child = hierarchy.CreateNode(moving, Vec3l(0, 0, 1));
+        const TTransformNode staticChild = hierarchy.CreateNode(root, Vec3l(0, -1, 0));
+        hierarchy.UpdateTransforms();
+        TEST("transform hierarchy: depth levels", hierarchy.GetDepthCount() == 3 && hierarchy.GetNodeCount() == 4);
+        TEST("transform hierarchy: child composes parents", GetWorldPosition(hierarchy, child).IsEquivalent(Vec3l(10, 1, 1), kTransformEpsilon));
+
+        hierarchy.SetLocalPosition(moving, Vec3l(0, 2, 0));
+        TEST("transform hierarchy: only the dirty subtree updates", hierarchy.UpdateTransforms() == 2);
+        TEST("transform hierarchy: change propagates to children", hierarchy.HasWorldChanged(child) && GetWorldPosition(hierarchy, child).IsEquivalent(Vec3l(10, 2, 1), kTransformEpsilon));
+        TEST("transform hierarchy: siblings untouched", !hierarchy.HasWorldChanged(staticChild) && !hierarchy.HasWorldChanged(root));
+
+        hierarchy.SetLocalRotation(root, Quaternionl::CreateRotationXYZ(0, 0, kFLocalHalfPi));
+        TEST("transform hierarchy: root change updates everything", hierarchy.UpdateTransforms() == 4);
+        const Vec3l expected = Vec3l(0, 2, 1) * Matrix43l::CreateRotationAndTranslation(Quaternionl::CreateRotationXYZ(0, 0, kFLocalHalfPi), Vec3l(10, 0, 0));
+        TEST("transform hierarchy: rotation propagates", GetWorldPosition(hierarchy, child).IsEquivalent(expected, kTransformEpsilon));
+
+        hierarchy.SetParent(child, staticChild);
+        hierarchy.UpdateTransforms();
+        const Vec3l reparented = Vec3l(0, -1, 1) * Matrix43l::CreateRotationAndTranslation(Quaternionl::CreateRotationXYZ(0, 0, kFLocalHalfPi), Vec3l(10, 0, 0));
+        TEST("transform hierarchy: reparent keeps the local transform", GetWorldPosition(hierarchy, child).IsEquivalent(reparented, kTransformEpsilon));
+
+        hierarchy.DestroyNode(staticChild);
+        TEST("transform hierarchy: destroyed node invalid", !hierarchy.IsValid(staticChild) && hierarchy.IsValid(child));
+        hierarchy.UpdateTransforms();
+        TEST("transform hierarchy: descendants destroyed with it", !hierarchy.IsValid(child) && hierarchy.GetNodeCount() == 2 && hierarchy.GetDepthCount() == 2);
+
+        const TTransformNode reused = hierarchy.CreateNode(moving);
+        TEST("transform hierarchy: node ids reused", (reused == staticChild || reused == child));
+    } // ~parent and children
+
+    { // depth order independent of creation order
+        STransformHierarchy hierarchy;
+        std::vector<TTransformNode> chain;
+        for (uint32_t i = 0; i < kChainLength; ++i)
+        {
+            chain.push_back(hierarchy.CreateNode(kInvalidTransformNode, Vec3l(1, 0, 0)));
+        }
+
+        // link the last created as the root so every parent sits after its child until sorted
+        for (uint32_t i = 0; i + 1 < kChainLength; ++i)
+        {
+            hierarchy.SetParent(chain[i], chain[i + 1]);
+        }
+
+        TEST("transform hierarchy: chain updates every node", hierarchy.UpdateTransforms() == kChainLength);
+        TEST("transform hierarchy: chain depth", hierarchy.GetDepthCount() == kChainLength);
+        TEST("transform hierarchy: chain composes", GetWorldPosition(hierarchy, chain[0]).IsEquivalent(Vec3l(float(kChainLength), 0, 0), kTransformEpsilon));
+    } // ~depth order independent of creation order
+
+    { // wide levels update in parallel
+        STransformHierarchy hierarchy;
+        const TTransformNode root = hierarchy.CreateNode();
+        std::vector<TTransformNode> children;
+        for (uint32_t i = 0; i < kNumWideChildren; ++i)
+        {
+            children.push_back(hierarchy.CreateNode(root, Vec3l(float(i), 0, 0)));
+        }
+
+        hierarchy.UpdateTransforms();
+        hierarchy.SetLocalPosition(root, Vec3l(0, 5, 0));
+        TEST("transform hierarchy: wide level updates", hierarchy.UpdateTransforms() == kNumWideChildren + 1);
+
+        bool bAllMoved = true;
+        for (uint32_t i = 0; i < kNumWideChildren; ++i)
+        {
+            bAllMoved = bAllMoved && GetWorldPosition(hierarchy, children[i]).IsEquivalent(Vec3l(float(i), 5, 0), kTransformEpsilon);
+        }
+
+        TEST("transform hierarchy: wide level values", bAllMoved);
+
+        hierarchy.SetLocalScale(children[17], Vec3l(2, 2, 2));
+        TEST("transform hierarchy: single dirty leaf", hierarchy.UpdateTransforms() == 1 && hierarchy.HasWorldChanged(children[17]) && !hierarchy.HasWorldChanged(children[18]));
+    } // ~wide levels update in parallel
+}
@@ -0,0 +1,247 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "job_system_tests.h"
+
+#include <vector>
+
+#include "jobs/job_system.h"
+#include "tests/test_framework.h"
+
+using namespace jobs;
+
+static constexpr uint32_t kNumForkJoinChildren = 256;
+
+static void IncrementJob(SJob* /*pJob*/, void* pData)
+{
+    static_cast<std::atomic<uint32_t>*>(pData)->fetch_add(1, std::memory_order_relaxed);
+}
+
+static void ForkJoinParentJob(SJob* pJob, void* pData)
+{
+    for (uint32_t i = 0; i < kNumForkJoinChildren; ++i)
+    {
+        SubmitJob(CreateChildJob(pJob, IncrementJob, pData));
+    }
+}
+
+struct SGraphRecord
+{
+    std::atomic<uint32_t> nextOrder = { 1 };
+    uint32_t order[4] = { 0 }; // each slot written by one job, read after the graph finishes
+};
+
+struct SRecursiveWait
+{
+    std::atomic<uint32_t>* pNumRun;
+    uint32_t depth;
+};
+
+struct SGraphNode
+{
+    SGraphRecord* pRecord;
+    uint32_t index;
+};
+
+static void RecordOrderJob(SJob* /*pJob*/, void* pData)
+{
+    SGraphNode* pNode = static_cast<SGraphNode*>(pData);
+    pNode->pRecord->order[pNode->index] = pNode->pRecord->nextOrder.fetch_add(1);
+}
+
+static void RecordThreadJob(SJob* /*pJob*/, void* pData)
+{
+    *static_cast<uint32_t*>(pData) = GetCurrentJobThreadIndex();
+}
+
+static void SubmitMainThreadChildJob(SJob* pJob, void* pData)
+{
+    SubmitJob(CreateChildJob(pJob, RecordThreadJob, pData, EJobAffinity::MainThread));
+}
+
+// Straight line fork-join: waits on its own sub jobs instead of using children
+static void RecursiveWaitJob(SJob* /*pJob*/, void* pData)
+{
+    SRecursiveWait* pWait = static_cast<SRecursiveWait*>(pData);
+    pWait->pNumRun->fetch_add(1, std::memory_order_relaxed);
+    if (pWait->depth == 0)
+        return;
+
+    SRecursiveWait subWaits[2] = { { pWait->pNumRun, pWait->depth - 1 }, { pWait->pNumRun, pWait->depth - 1 } };
+    SJobCounter counter;
+    SubmitJob(CreateJob(RecursiveWaitJob, &subWaits[0]), &counter);
+    SubmitJob(CreateJob(RecursiveWaitJob, &subWaits[1]), &counter);
+    WaitForCounter(&counter);
+}
+
+static void WaitingMainThreadJob(SJob* /*pJob*/, void* pData)
+{
+    std::atomic<uint32_t> numRun = { 0 };
+    SJobCounter counter;
+    SubmitJob(CreateJob(IncrementJob, &numRun), &counter);
+    WaitForCounter(&counter);
+    *static_cast<uint32_t*>(pData) = numRun.load() == 1 ? GetCurrentJobThreadIndex() : UINT32_MAX;
+}
+
+static std::atomic<uint32_t> g_numFiberSwitches = { 0 };
+
+static void CountFiberSwitch(uint32_t /*threadIndex*/, uint32_t fromFiberId, uint32_t toFiberId)
+{
+    if (fromFiberId != toFiberId)
+    {
+        g_numFiberSwitches.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+static void MarkRange(uint32_t begin, uint32_t end, void* pData)
+{
+    uint8_t* pMarks = static_cast<uint8_t*>(pData);
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        ++pMarks[i];
+    }
+}
+
+void RunJobSystemTests()
+{
+    TEST("jobs: initialized", GetJobThreadCount() > 0 && GetCurrentJobThreadIndex() == kMainThreadIndex);
+
+    { // fork join
+        std::atomic<uint32_t> numRun = { 0 };
+        WaitForJob(SubmitJob(CreateJob(ForkJoinParentJob, &numRun)));
+        TEST("jobs: parent waits for its children", numRun.load() == kNumForkJoinChildren);
+    } // ~fork join
+
+    { // counter
+        std::atomic<uint32_t> numRun = { 0 };
+        SJobCounter counter;
+        for (uint32_t i = 0; i < 1000; ++i)
+        {
+            SubmitJob(CreateJob(IncrementJob, &numRun), &counter);
+        }
+
+        WaitForCounter(&counter);
+        TEST("jobs: counter reaches zero after every job", numRun.load() == 1000 && counter.value.load() == 0);
+    } // ~counter
+
+    { // graph, a -> (b, c) -> d
+        SGraphRecord record;
+        SGraphNode nodes[4] = { { &record, 0 }, { &record, 1 }, { &record, 2 }, { &record, 3 } };
+        SJob* pJobs[4];
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            pJobs[i] = CreateJob(RecordOrderJob, &nodes[i]);
+        }
+
+        bool bAdded = AddJobDependency(pJobs[1], pJobs[0]);
+        bAdded = AddJobDependency(pJobs[2], pJobs[0]) && bAdded;
+        bAdded = AddJobDependency(pJobs[3], pJobs[1]) && bAdded;
+        bAdded = AddJobDependency(pJobs[3], pJobs[2]) && bAdded;
+        TEST("jobs: dependencies added", bAdded);
+
+        // submitted in reverse to make sure nothing runs early
+        SJobCounter counter;
+        for (uint32_t i = 4; i-- > 0;)
+        {
+            SubmitJob(pJobs[i], &counter);
+        }
+
+        WaitForCounter(&counter);
+        TEST("jobs: graph roots run first", record.order[0] == 1);
+        TEST("jobs: graph joins run last", record.order[3] == 4);
+    } // ~graph
+
+    { // main thread affinity
+        uint32_t threadIndex = UINT32_MAX;
+        WaitForJob(SubmitJob(CreateJob(SubmitMainThreadChildJob, &threadIndex)));
+        TEST("jobs: main thread jobs run on the main thread", threadIndex == kMainThreadIndex);
+        TEST("jobs: main thread queue drained", RunMainThreadJobs() == 0);
+    } // ~main thread affinity
+
+    { // parallel for
+        const uint32_t counts[] = { 1, 7, 1000, 100000 };
+        bool bAllVisitedOnce = true;
+        for (uint32_t count : counts)
+        {
+            std::vector<uint8_t> marks(count, 0);
+            ParallelFor(count, MarkRange, marks.data());
+            bAllVisitedOnce = bAllVisitedOnce && std::all_of(marks.begin(), marks.end(), [](uint8_t mark) { return mark == 1; });
+        }
+
+        TEST("jobs: parallel for visits every index once", bAllVisitedOnce);
+
+        std::vector<uint8_t> marks(5000, 0);
+        SJob* pLoop = CreateParallelForJob((uint32_t)marks.size(), MarkRange, marks.data(), 64);
+        uint32_t followUp = 0;
+        SJob* pFollowUp = CreateJob(RecordThreadJob, &followUp);
+        TEST("jobs: parallel for can be a prerequisite", AddJobDependency(pFollowUp, pLoop));
+        const SJobHandle followUpHandle = SubmitJob(pFollowUp);
+        SubmitJob(pLoop);
+        WaitForJob(followUpHandle);
+        TEST("jobs: parallel for finishes before dependents", std::all_of(marks.begin(), marks.end(), [](uint8_t mark) { return mark == 1; }));
+    } // ~parallel for
+
+    { // waiting inside jobs
+        std::atomic<uint32_t> numRun = { 0 };
+        SRecursiveWait root = { &numRun, 7 };
+        WaitForJob(SubmitJob(CreateJob(RecursiveWaitJob, &root)));
+        TEST("jobs: nested waits complete", numRun.load() == (1u << 8) - 1);
+
+        uint32_t threadIndex = UINT32_MAX;
+        WaitForJob(SubmitJob(CreateJob(WaitingMainThreadJob, &threadIndex, EJobAffinity::MainThread)));
+        TEST("jobs: main thread jobs resume on the main thread", threadIndex == kMainThreadIndex);
+    } // ~waiting inside jobs
+
+    { // handles outlive their slot
+        std::atomic<uint32_t> numRun = { 0 };
+        const SJobHandle stale = SubmitJob(CreateJob(IncrementJob, &numRun));
+        WaitForJob(stale);
+
+        // wrap the main thread's pool back around onto the stale handle's slot
+        SJobCounter counter;
+        for (uint32_t i = 0; i < kJobPoolSize - 1; ++i)
+        {
+            SubmitJob(CreateJob(IncrementJob, &numRun), &counter);
+        }
+
+        WaitForCounter(&counter);
+        SJob* pReused = CreateJob(IncrementJob, &numRun);
+        TEST("jobs: pool slot reused", pReused == stale.pJob);
+        TEST("jobs: stale handle stays finished while its slot is reused", IsJobFinished(stale));
+
+        const SJobHandle reused = SubmitJob(pReused);
+        WaitForJob(reused);
+        WaitForJob(stale);
+        TEST("jobs: reused slot finishes under its new handle", IsJobFinished(reused) && numRun.load() == kJobPoolSize + 1);
+    } // ~handles outlive their slot
+
+    { // fibers
+        SJobSystemStats before;
+        GetJobSystemStats(&before);
+        g_numFiberSwitches = 0;
+        SetFiberSwitchCallback(CountFiberSwitch);
+
+        // only the main thread can run it, so the wait can't be satisfied before it parks
+        uint32_t threadIndex = UINT32_MAX;
+        WaitForJob(SubmitJob(CreateJob(RecordThreadJob, &threadIndex, EJobAffinity::MainThread)));
+        SetFiberSwitchCallback(nullptr);
+
+        SJobSystemStats after;
+        GetJobSystemStats(&after);
+        TEST("jobs: main thread waits resume on the main thread", threadIndex == kMainThreadIndex && GetCurrentJobThreadIndex() == kMainThreadIndex);
+        TEST("jobs: stats count executed jobs", after.jobsExecuted > before.jobsExecuted);
+        if (AreJobFibersEnabled())
+        {
+            TEST("jobs: waits park the waiting fiber", after.waitsParked == before.waitsParked + 1);
+            TEST("jobs: parking switches away and back", after.fiberSwitches >= before.fiberSwitches + 2 && g_numFiberSwitches.load() >= 2);
+            TEST("jobs: nothing left parked", after.fibersParked == 0 && after.peakFibersInUse > 0);
+        }
+        else
+        {
+            TEST("jobs: waits run jobs without fibers", after.waitsHelped > before.waitsHelped && g_numFiberSwitches.load() == 0);
+        }
+    } // ~fibers
+}
@@ -0,0 +1,71 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "logger_tests.h"
+
+#include <cstddef>
+#include <string>
+
+#include "logging/logger.h"
+#include "tests/test_framework.h"
+
+using namespace logging;
+
+enum class ETestLogEnum : uint16_t
+{
+    First,
+    Second
+};
+
+template <typename... TArgs>
+static bool Formats(const char* expected, const char* format, TArgs... args)
+{
+    char buffer[256];
+    const size_t length = FormatLogMessage(buffer, sizeof(buffer), format, args...);
+    return length == strlen(expected) && strcmp(buffer, expected) == 0;
+}
+
+void RunLoggerTests()
+{
+    { // deferred formatting
+        const char name[] = "sphere";
+        const char* pNull = nullptr;
+        TEST("logger: plain text", Formats("no arguments 100%", "no arguments 100%%"));
+        TEST("logger: integers", Formats("-3 7 4294967295 18446744073709551615 ff", "%d %hu %u %llu %x", -3, (uint16_t)7, -1, ~0ull, 255u));
+        TEST("logger: size types", Formats("[   42] [42   ]", "[%5zu] [%-5zd]", (size_t)42, (ptrdiff_t)42));
+        TEST("logger: floats", Formats("3.14 2.5e+00 0.125", "%.2f %.1e %g", 3.14159f, 2.5, 0.125));
+        TEST("logger: strings copied", Formats("sphere|  ab|(null)", "%s|%4.2s|%s", name, "abc", pNull));
+        TEST("logger: chars and enums", Formats("x 1 1", "%c %d %u", 'x', ETestLogEnum::Second, true));
+        TEST("logger: star width", Formats("[  7] [3.1]", "[%*d] [%.*f]", 3, 7, 1, 3.14));
+        TEST("logger: missing arguments", Formats("1 (missing)", "%d %d", 1));
+
+        char small[8];
+        TEST("logger: truncates", FormatLogMessage(small, sizeof(small), "%s", "truncated message") == 7 && strcmp(small, "truncat") == 0);
+    } // ~deferred formatting
+
+    if (IsLoggerRunning())
+    { // writer thread, filtering and dropping
+        SLogStats before;
+        FlushLog();
+        GetLogStats(&before);
+
+        const int verbosity = g_logVerbosity.load();
+        SetLogVerbosity(0);
+        DiracLog(1, "[LoggerTests] filtered at runtime");
+        SetLogVerbosity(verbosity);
+        DiracLog(1, "[LoggerTests] written by the writer thread %d/%d", 1, 2);
+        DiracLog(1, "[LoggerTests] written by the writer thread %d/%d", 2, 2);
+
+        const std::string tooLong(before.bufferSize, 'x');
+        DiracLog(1, "[LoggerTests] %s", tooLong.c_str());
+        FlushLog();
+
+        SLogStats after;
+        GetLogStats(&after);
+        TEST("logger: messages written", after.numWritten >= before.numWritten + 2);
+        TEST("logger: oversized message dropped", after.numDropped == before.numDropped + 1 && after.numThreads >= 1);
+    } // ~writer thread
+}
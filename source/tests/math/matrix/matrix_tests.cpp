@@ -634,6 +634,15 @@ void RunMatrix4x3Tests()
         TEST("m43: (v * m) * m.Inverted() == v", v.IsEquivalent(v3, epsilon<T>() * 100));
     }
 
+    {
+        Matrix43<T> m = Matrix33<T>::CreateScale(Vec3<T>(2, 4, 8));
+        m = m * Matrix43<T>::CreateTranslation(Vec3<T>(1, 2, 3));
+        Vec3<T> v(1, 2, 4);
+        Vec3<T> v2 = v * m;
+        Vec3<T> v3 = v2 * m.Inverted();
+        TEST("m43: scaled (v * m) * m.Inverted() == v", v.IsEquivalent(v3, epsilon<T>() * 100));
+    }
+
     {
         Matrix43<T> m = Matrix33<T>::CreateOrientation(Vec3<T>::Right, Vec3<T>::Up, kPi<T>);
         Matrix43<T> m2 = Matrix33<T>::CreateOrientation(Vec3<T>::Right, Vec3<T>::Up, 0);
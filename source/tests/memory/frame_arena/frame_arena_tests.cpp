@@ -0,0 +1,131 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "frame_arena_tests.h"
+
+#include <thread>
+
+#include "memory/frame_arena.h"
+#include "tests/test_framework.h"
+
+using namespace memory;
+
+static constexpr size_t kTestArenaSize = 4096;
+static constexpr uint32_t kNumTestThreads = 4;
+
+static SFrameContext MakeTestFrame(TFrameId frameId)
+{
+    SFrameContext frameContext = {};
+    frameContext.frameId = frameId;
+    return frameContext;
+}
+
+static void AllocateOnThread(TFrameId frameId, uintptr_t* pOutAddress)
+{
+    uint32_t* pValues = FrameAllocArray<uint32_t>(MakeTestFrame(frameId), 64);
+    for (uint32_t i = 0; i < 64; ++i)
+    {
+        pValues[i] = i;
+    }
+
+    *pOutAddress = reinterpret_cast<uintptr_t>(pValues);
+}
+
+void RunFrameArenaTests()
+{
+    SFrameArenaConfig config;
+    config.arenaSize = kTestArenaSize;
+    config.numFramesInFlight = 2;
+    TEST("frame arena: invalid config rejected", !InitializeFrameArenas(SFrameArenaConfig{ kTestArenaSize, kMaxFramesInFlight + 1 }));
+    TEST("frame arena: initialize", InitializeFrameArenas(config));
+
+    { // bump allocation
+        const SFrameContext frame = MakeTestFrame(1);
+        uint8_t* pFirst = static_cast<uint8_t*>(FrameAlloc(frame, 3, 1));
+        uint64_t* pAligned = static_cast<uint64_t*>(FrameAlloc(frame, sizeof(uint64_t), alignof(uint64_t)));
+        uint8_t* pWide = static_cast<uint8_t*>(FrameAlloc(frame, 16, 64));
+        TEST("frame arena: allocations are sequential", reinterpret_cast<uint8_t*>(pAligned) > pFirst && pWide > reinterpret_cast<uint8_t*>(pAligned));
+        TEST("frame arena: alignment honoured", (reinterpret_cast<uintptr_t>(pAligned) % alignof(uint64_t)) == 0 && (reinterpret_cast<uintptr_t>(pWide) % 64) == 0);
+
+        uint8_t* pOtherFrame = static_cast<uint8_t*>(FrameAlloc(MakeTestFrame(2), 1, 1));
+        TEST("frame arena: frames in flight use separate arenas", (pOtherFrame < pFirst || pOtherFrame >= pFirst + kTestArenaSize));
+
+        uint8_t* pReused = static_cast<uint8_t*>(FrameAlloc(MakeTestFrame(3), 3, 1));
+        TEST("frame arena: arena reset once the pipeline depth has passed", pReused == pFirst);
+    } // ~bump allocation
+
+    { // overflow
+        const SFrameContext frame = MakeTestFrame(4);
+        void* pFill = FrameAlloc(frame, kTestArenaSize, 1);
+        void* pSpill = FrameAlloc(frame, 100, 16);
+        void* pLarge = FrameAlloc(frame, kTestArenaSize * 4, 16);
+        memset(pSpill, 0xab, 100);
+        memset(pLarge, 0xcd, kTestArenaSize * 4);
+        TEST("frame arena: overflow still allocates", pFill != nullptr && pSpill != nullptr && pLarge != nullptr);
+        TEST("frame arena: overflow is aligned", (reinterpret_cast<uintptr_t>(pSpill) % 16) == 0 && (reinterpret_cast<uintptr_t>(pLarge) % 16) == 0);
+
+        SFrameArenaStats stats;
+        GetFrameArenaStats(&stats);
+        TEST("frame arena: overflow counted", stats.numOverflows == 2 && stats.overflowBytes == 100 + kTestArenaSize * 4);
+        TEST("frame arena: high water mark", stats.highWaterMark == kTestArenaSize && stats.arenaSize == kTestArenaSize);
+    } // ~overflow
+
+    { // stl adapter
+        const SFrameContext frame = MakeTestFrame(6);
+        TFrameVector<uint32_t> values{ SFrameAllocator<uint32_t>(frame) };
+        for (uint32_t i = 0; i < 1000; ++i)
+        {
+            values.push_back(i);
+        }
+
+        bool bValuesMatch = true;
+        for (uint32_t i = 0; i < 1000; ++i)
+        {
+            bValuesMatch &= values[i] == i;
+        }
+
+        TEST("frame arena: vector with the frame allocator", values.size() == 1000 && bValuesMatch);
+        TEST("frame arena: allocators compare by frame", SFrameAllocator<uint32_t>(frame) == SFrameAllocator<uint64_t>(frame) && SFrameAllocator<uint32_t>(frame) != SFrameAllocator<uint32_t>(MakeTestFrame(7)));
+    } // ~stl adapter
+
+    { // threads
+        uintptr_t addresses[kNumTestThreads] = {};
+        std::thread threads[kNumTestThreads];
+        for (uint32_t i = 0; i < kNumTestThreads; ++i)
+        {
+            threads[i] = std::thread(AllocateOnThread, TFrameId(8), &addresses[i]);
+        }
+
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        bool bDistinct = true;
+        for (uint32_t i = 0; i < kNumTestThreads; ++i)
+        {
+            for (uint32_t j = i + 1; j < kNumTestThreads; ++j)
+            {
+                bDistinct &= addresses[i] != addresses[j];
+            }
+        }
+
+        SFrameArenaStats stats;
+        GetFrameArenaStats(&stats);
+        TEST("frame arena: every thread has its own arenas", bDistinct && stats.numThreads == kNumTestThreads + 1);
+    } // ~threads
+
+    ShutdownFrameArenas();
+
+    { // reinitialize
+        TEST("frame arena: reinitialize", InitializeFrameArenas(config));
+        void* pMemory = FrameAlloc(MakeTestFrame(1), 16);
+        SFrameArenaStats stats;
+        GetFrameArenaStats(&stats);
+        TEST("frame arena: stale thread arenas dropped", pMemory != nullptr && stats.numThreads == 1 && stats.numAllocations == 1);
+        ShutdownFrameArenas();
+    } // ~reinitialize
+}
@@ -0,0 +1,189 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "pool_allocator_tests.h"
+
+#include <vector>
+
+#include "jobs/job_system.h"
+#include "memory/memory_report.h"
+#include "memory/pool_allocator.h"
+#include "tests/test_framework.h"
+
+using namespace memory;
+
+static constexpr uint32_t kNumTestBlocks = 1000;
+static constexpr uint32_t kNumParallelBlocks = 20000;
+
+struct alignas(32) STestNode
+{
+    STestNode(uint32_t value_, uint32_t* pNumDestroyed_) : value(value_), pNumDestroyed(pNumDestroyed_) {}
+    ~STestNode() { ++*pNumDestroyed; }
+
+    uint32_t value;
+    uint32_t* pNumDestroyed;
+};
+
+struct SParallelPoolTest
+{
+    SPoolAllocator* pPool = nullptr;
+    void** ppBlocks = nullptr;
+};
+
+static void AllocateRange(uint32_t begin, uint32_t end, void* pData)
+{
+    SParallelPoolTest* pTest = static_cast<SParallelPoolTest*>(pData);
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        uint32_t* pValue = static_cast<uint32_t*>(pTest->pPool->Allocate());
+        *pValue = i;
+        pTest->ppBlocks[i] = pValue;
+    }
+}
+
+static void FreeRange(uint32_t begin, uint32_t end, void* pData)
+{
+    SParallelPoolTest* pTest = static_cast<SParallelPoolTest*>(pData);
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        pTest->pPool->Free(pTest->ppBlocks[i]);
+    }
+}
+
+void RunPoolAllocatorTests()
+{
+    { // allocate and free
+        SPoolAllocatorConfig config;
+        config.name = "test blocks";
+        config.blockSize = 24;
+        config.alignment = 16;
+        config.blocksPerSlab = 64;
+
+        SPoolAllocator pool;
+        TEST("pool: initialize", pool.Initialize(config));
+
+        std::vector<void*> blocks;
+        bool bAligned = true;
+        for (uint32_t i = 0; i < kNumTestBlocks; ++i)
+        {
+            void* pBlock = pool.Allocate();
+            bAligned &= pBlock != nullptr && (reinterpret_cast<uintptr_t>(pBlock) % 16) == 0;
+            memset(pBlock, int(i), config.blockSize);
+            blocks.push_back(pBlock);
+        }
+
+        SPoolAllocatorStats stats;
+        pool.GetStats(&stats);
+        TEST("pool: blocks aligned", bAligned);
+        TEST("pool: grows by slabs", stats.liveBlocks == kNumTestBlocks && stats.numSlabs == (kNumTestBlocks + 63) / 64);
+        TEST("pool: owns its blocks", pool.Owns(blocks[0]) && pool.Owns(blocks.back()) && !pool.Owns(&stats));
+
+        void* pFreed = blocks.back();
+        blocks.pop_back();
+        pool.Free(pFreed);
+        void* pReused = pool.Allocate();
+        TEST("pool: freed block reused", pReused == pFreed);
+        blocks.push_back(pReused);
+
+        for (void* pBlock : blocks)
+        {
+            pool.Free(pBlock);
+        }
+
+        pool.GetStats(&stats);
+        TEST("pool: everything freed", stats.liveBlocks == 0 && stats.peakLiveBlocks >= kNumTestBlocks && stats.numSlabs == (kNumTestBlocks + 63) / 64);
+        TEST("pool: clean shutdown", pool.Shutdown() == 0);
+    } // ~allocate and free
+
+    { // fixed capacity and leaks
+        SPoolAllocatorConfig config;
+        config.name = "test fixed";
+        config.blockSize = 2; // smaller than the free list link
+        config.alignment = 1;
+        config.blocksPerSlab = 8;
+        config.maxSlabs = 1;
+
+        SPoolAllocator pool;
+        TEST("pool: invalid alignment rejected", !pool.Initialize(SPoolAllocatorConfig{ "bad", EMemoryTag::General, 8, 3 }));
+        TEST("pool: fixed pool initialize", pool.Initialize(config));
+        void* blocks[8] = {};
+        for (void*& pBlock : blocks)
+        {
+            pBlock = pool.Allocate();
+        }
+
+        TEST("pool: fixed pool fills", blocks[7] != nullptr && pool.Allocate() == nullptr);
+        pool.Free(blocks[3]);
+        TEST("pool: fixed pool frees", pool.Allocate() == blocks[3]);
+        for (uint32_t i = 0; i < 7; ++i)
+        {
+            pool.Free(blocks[i]);
+        }
+
+        TEST("pool: leaks reported at shutdown", pool.Shutdown() == 1);
+    } // ~fixed capacity and leaks
+
+    { // object pool and memory report
+        SMemoryReport before;
+        GetMemoryReport(&before);
+
+        uint32_t numDestroyed = 0;
+        SObjectPool<STestNode> pool;
+        TEST("object pool: initialize", pool.Initialize("test nodes", EMemoryTag::Game, 16));
+        STestNode* pFirst = pool.New(7u, &numDestroyed);
+        STestNode* pSecond = pool.New(8u, &numDestroyed);
+        TEST("object pool: constructs", pFirst->value == 7 && pSecond->value == 8 && (reinterpret_cast<uintptr_t>(pSecond) % 32) == 0);
+
+        SMemoryReport report;
+        GetMemoryReport(&report);
+        const SMemoryTagStats& game = report.tags[(size_t)EMemoryTag::Game];
+        const SMemoryTagStats& gameBefore = before.tags[(size_t)EMemoryTag::Game];
+        TEST("memory report: pool slab reserved under its tag", game.reservedBytes > gameBefore.reservedBytes && game.peakReservedBytes >= game.reservedBytes);
+        TEST("memory report: pool blocks in use", game.liveAllocations == gameBefore.liveAllocations + 2 && game.usedBytes == gameBefore.usedBytes + 2 * sizeof(STestNode));
+
+        pool.Delete(pFirst);
+        pool.Delete(pSecond);
+        pool.Delete(nullptr);
+        TEST("object pool: destroys", numDestroyed == 2);
+        TEST("object pool: clean shutdown", pool.Shutdown() == 0);
+
+        GetMemoryReport(&report);
+        TEST("memory report: slabs returned", report.tags[(size_t)EMemoryTag::Game].reservedBytes == gameBefore.reservedBytes);
+    } // ~object pool and memory report
+
+    if (jobs::GetJobThreadCount() > 0)
+    { // job threads, allocated and freed through the thread caches on different threads
+        SPoolAllocatorConfig config;
+        config.name = "test parallel";
+        config.blockSize = sizeof(uint32_t);
+
+        SPoolAllocator pool;
+        TEST("pool: parallel initialize", pool.Initialize(config));
+        std::vector<void*> blocks(kNumParallelBlocks);
+        SParallelPoolTest test;
+        test.pPool = &pool;
+        test.ppBlocks = blocks.data();
+
+        jobs::ParallelFor(kNumParallelBlocks, AllocateRange, &test, 64);
+        std::vector<void*> sorted = blocks;
+        std::sort(sorted.begin(), sorted.end());
+        bool bValuesIntact = std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end();
+        for (uint32_t i = 0; i < kNumParallelBlocks; ++i)
+        {
+            bValuesIntact &= *static_cast<uint32_t*>(blocks[i]) == i;
+        }
+
+        TEST("pool: parallel blocks unique and intact", bValuesIntact);
+
+        std::reverse(blocks.begin(), blocks.end()); // free ranges land on different threads than they were allocated on
+        jobs::ParallelFor(kNumParallelBlocks, FreeRange, &test, 64);
+
+        SPoolAllocatorStats stats;
+        pool.GetStats(&stats);
+        TEST("pool: parallel everything freed", stats.liveBlocks == 0 && stats.numAllocations == kNumParallelBlocks);
+        TEST("pool: parallel clean shutdown", pool.Shutdown() == 0);
+    } // ~job threads
+}
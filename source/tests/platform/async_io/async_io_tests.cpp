@@ -0,0 +1,120 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "async_io_tests.h"
+
+#include <filesystem>
+#include <string>
+
+#include "platform/async_io.h"
+#include "tests/test_framework.h"
+
+using namespace platform;
+
+struct SCompletionRecord
+{
+    uint32_t numCalls = 0;
+    bool bSuccess = false;
+};
+
+static void RecordCompletion(TAsyncReadHandle /*handle*/, bool bSuccess, void* pUserData)
+{
+    SCompletionRecord* pRecord = static_cast<SCompletionRecord*>(pUserData);
+    ++pRecord->numCalls;
+    pRecord->bSuccess = bSuccess;
+}
+
+static bool WriteTestFile(const std::string& fileName, const char* contents)
+{
+    FILE* pFile = fopen(fileName.c_str(), "wb");
+    if (pFile == nullptr)
+        return false;
+
+    const bool bWritten = fwrite(contents, 1, strlen(contents), pFile) == strlen(contents);
+    return fclose(pFile) == 0 && bWritten;
+}
+
+static bool FileMatches(const SFile& file, const char* contents)
+{
+    return file.pBytes != nullptr && file.numBytes == strlen(contents) && memcmp(file.pBytes, contents, file.numBytes) == 0;
+}
+
+void RunAsyncIOTests()
+{
+    std::error_code error;
+    const std::filesystem::path directory = std::filesystem::temp_directory_path(error) / "dirac_sea_async_io_tests";
+    std::filesystem::create_directories(directory, error);
+
+    const char* contents[] = { "vertex", "fragment", "texture" };
+    const std::string paths[] =
+    {
+        (directory / "a.bin").string(),
+        (directory / "b.bin").string(),
+        (directory / "c.bin").string(),
+    };
+
+    bool bWritten = true;
+    for (size_t i = 0; i < 3; ++i)
+    {
+        bWritten = bWritten && WriteTestFile(paths[i], contents[i]);
+    }
+
+    TEST("async io: test files written", bWritten);
+    const char* fileNames[] = { paths[0].c_str(), paths[1].c_str(), paths[2].c_str() };
+
+    { // wait
+        SFile files[3];
+        SCompletionRecord record;
+        const TAsyncReadHandle handle = SubmitAsyncRead(fileNames, 3, EFileType::Binary, files, RecordCompletion, &record);
+        TEST("async io: valid handle", handle != kInvalidAsyncReadHandle);
+        TEST("async io: wait succeeds", WaitForAsyncRead(handle));
+        TEST("async io: wait dispatches the callback", record.numCalls == 1 && record.bSuccess);
+        TEST("async io: batch contents", FileMatches(files[0], contents[0]) && FileMatches(files[1], contents[1]) && FileMatches(files[2], contents[2]));
+        TEST("async io: handle retired after wait", GetAsyncReadStatus(handle) == EAsyncReadStatus::Invalid);
+    } // ~wait
+
+    { // dispatch
+        SFile files[3];
+        SCompletionRecord records[3];
+        TAsyncReadHandle handles[3];
+        for (size_t i = 0; i < 3; ++i)
+        {
+            handles[i] = SubmitAsyncRead(&fileNames[i], 1, EFileType::Binary, &files[i], RecordCompletion, &records[i]);
+        }
+
+        while (records[0].numCalls + records[1].numCalls + records[2].numCalls < 3)
+        {
+            DispatchAsyncReadCompletions();
+        }
+
+        bool bAllDispatched = true;
+        for (size_t i = 0; i < 3; ++i)
+        {
+            bAllDispatched = bAllDispatched
+                && records[i].numCalls == 1
+                && records[i].bSuccess
+                && FileMatches(files[i], contents[i])
+                && GetAsyncReadStatus(handles[i]) == EAsyncReadStatus::Invalid;
+        }
+
+        TEST("async io: dispatch runs every callback once", bAllDispatched);
+        TEST("async io: nothing left to dispatch", DispatchAsyncReadCompletions() == 0);
+    } // ~dispatch
+
+    { // failure
+        const std::string missingPath = (directory / "missing.bin").string();
+        const char* batchFileNames[] = { fileNames[0], missingPath.c_str() };
+        SFile files[2];
+        SCompletionRecord record;
+        const TAsyncReadHandle handle = SubmitAsyncRead(batchFileNames, 2, EFileType::Binary, files, RecordCompletion, &record);
+        TEST("async io: missing file fails the batch", !WaitForAsyncRead(handle));
+        TEST("async io: failure reported to the callback", record.numCalls == 1 && !record.bSuccess);
+        TEST("async io: other files in a failed batch still load", FileMatches(files[0], contents[0]));
+        TEST("async io: retired handles can't be waited on", !WaitForAsyncRead(handle));
+    } // ~failure
+
+    std::filesystem::remove_all(directory, error);
+}
@@ -0,0 +1,64 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "fixed_timestep_tests.h"
+
+#include <cmath>
+
+#include "platform/fixed_timestep.h"
+#include "tests/test_framework.h"
+
+using namespace platform;
+
+static constexpr uint32_t kTestTicksPerSecond = 60;
+static constexpr uint32_t kTestMaxTicksPerFrame = 3;
+static constexpr uint32_t kNumTestFrames = 120;
+
+void RunFixedTimestepTests()
+{
+    SFixedTimestep timestep;
+    TEST("fixed timestep: invalid rate rejected", !timestep.Initialize(SFixedTimestepConfig{ 0, kTestMaxTicksPerFrame }));
+    TEST("fixed timestep: invalid clamp rejected", !timestep.Initialize(SFixedTimestepConfig{ kTestTicksPerSecond, 0 }));
+    TEST("fixed timestep: initialize", timestep.Initialize(SFixedTimestepConfig{ kTestTicksPerSecond, kTestMaxTicksPerFrame }));
+
+    const TTime::duration tick = timestep.GetTickDuration();
+    TEST("fixed timestep: tick duration", std::abs(TSeconds(tick).count() - 1.0 / kTestTicksPerSecond) < 1e-6);
+
+    { // frames shorter than a tick
+        uint32_t numTicks = 0;
+        uint32_t numFramesWithTicks = 0;
+        for (uint32_t i = 0; i < kNumTestFrames; ++i)
+        {
+            const uint32_t frameTicks = timestep.Advance(tick / 2); // rendering at twice the simulation rate
+            numTicks += frameTicks;
+            numFramesWithTicks += frameTicks > 0 ? 1 : 0;
+        }
+
+        TEST("fixed timestep: ticks at the simulation rate", numTicks == kNumTestFrames / 2 && numFramesWithTicks == kNumTestFrames / 2);
+        TEST("fixed timestep: whole ticks leave no remainder", timestep.GetInterpolationAlpha() < 1e-4f);
+
+        timestep.Advance(tick / 4);
+        TEST("fixed timestep: interpolation alpha", std::abs(timestep.GetInterpolationAlpha() - 0.25f) < 1e-4f);
+        timestep.Advance(tick - tick / 4);
+    } // ~frames shorter than a tick
+
+    { // frames longer than a tick
+        const uint32_t frameTicks = timestep.Advance(tick * 2 + tick / 2);
+        TEST("fixed timestep: several ticks per frame", frameTicks == 2 && std::abs(timestep.GetInterpolationAlpha() - 0.5f) < 1e-4f);
+        timestep.Advance(tick / 2);
+    } // ~frames longer than a tick
+
+    { // spiral of death clamp
+        const uint64_t ticksBefore = timestep.GetTickCount();
+        const uint32_t frameTicks = timestep.Advance(tick * 10 + tick / 2);
+        SFixedTimestepStats stats;
+        timestep.GetStats(&stats);
+        TEST("fixed timestep: ticks per frame clamped", frameTicks == kTestMaxTicksPerFrame && timestep.GetTickCount() == ticksBefore + kTestMaxTicksPerFrame);
+        TEST("fixed timestep: clamped time dropped", stats.numClampedFrames == 1 && std::abs(stats.droppedMs - 7 * TMilliseconds(tick).count()) < 1e-3);
+        TEST("fixed timestep: remainder kept after a clamp", std::abs(timestep.GetInterpolationAlpha() - 0.5f) < 1e-4f);
+        TEST("fixed timestep: recovers after a clamp", timestep.Advance(tick / 2) == 1);
+    } // ~spiral of death clamp
+}
@@ -0,0 +1,73 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "frame_pacer_tests.h"
+
+#include <thread>
+
+#include "platform/frame_pacer.h"
+#include "tests/test_framework.h"
+
+using namespace platform;
+
+static constexpr uint32_t kNumPacedFrames = 10;
+static constexpr std::chrono::milliseconds kTestFrameDuration = std::chrono::milliseconds(2);
+
+void RunFramePacerTests()
+{
+    SFramePacerConfig config;
+    config.targetFrameDuration = kTestFrameDuration;
+
+    { // paced frames
+        SFramePacer pacer;
+        TEST("frame pacer: invalid duration rejected", !pacer.Initialize(SFramePacerConfig{ TTime::duration::zero() }, TSteadyClock::now()));
+
+        const TTime start = TSteadyClock::now();
+        TEST("frame pacer: initialize", pacer.Initialize(config, start));
+        TTime frameStart = start;
+        for (uint32_t i = 0; i < kNumPacedFrames; ++i)
+        {
+            frameStart = pacer.WaitForNextFrame();
+        }
+
+        SFramePacerStats stats;
+        pacer.GetStats(&stats);
+        TEST("frame pacer: frames start on their deadlines", frameStart - start >= kNumPacedFrames * kTestFrameDuration);
+        TEST("frame pacer: sleeps rather than spins", stats.numFrames == kNumPacedFrames && stats.sleptMs > 0.0 && !pacer.ShouldSkipRender());
+    } // ~paced frames
+
+    { // missed deadlines re-phase
+        SFramePacer pacer;
+        pacer.Initialize(config, TSteadyClock::now());
+        std::this_thread::sleep_for(3 * kTestFrameDuration);
+        const TTime lateFrameStart = pacer.WaitForNextFrame();
+        const TTime nextFrameStart = pacer.WaitForNextFrame();
+
+        SFramePacerStats stats;
+        pacer.GetStats(&stats);
+        TEST("frame pacer: late frame re-phases", stats.numMissedDeadlines >= 1 && stats.numRephases >= 1);
+        TEST("frame pacer: no catch up burst", nextFrameStart - lateFrameStart >= kTestFrameDuration);
+        TEST("frame pacer: no skips without a policy", stats.numSkippedRenders == 0 && !pacer.ShouldSkipRender());
+    } // ~missed deadlines
+
+    { // skip policy
+        config.skipPolicy = EFrameSkipPolicy::SkipRender;
+        config.maxConsecutiveSkips = 1;
+
+        SFramePacer pacer;
+        pacer.Initialize(config, TSteadyClock::now());
+        std::this_thread::sleep_for(3 * kTestFrameDuration);
+        pacer.WaitForNextFrame();
+        const bool bFirstSkipped = pacer.ShouldSkipRender();
+        std::this_thread::sleep_for(3 * kTestFrameDuration);
+        pacer.WaitForNextFrame();
+
+        SFramePacerStats stats;
+        pacer.GetStats(&stats);
+        TEST("frame pacer: frame after a re-phase skips rendering", bFirstSkipped);
+        TEST("frame pacer: consecutive skips are limited", !pacer.ShouldSkipRender() && stats.numSkippedRenders == 1);
+    } // ~skip policy
+}
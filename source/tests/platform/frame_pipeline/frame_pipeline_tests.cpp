@@ -0,0 +1,92 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "frame_pipeline_tests.h"
+
+#include <thread>
+
+#include "platform/frame_pipeline.h"
+#include "tests/test_framework.h"
+
+using namespace platform;
+
+static constexpr uint64_t kNumTestFrames = 2000;
+
+struct SPipelineRun
+{
+    uint64_t frameIds[kMaxFramePipelineDepth] = {}; // stands in for the snapshots
+    std::atomic<uint32_t> framesInFlight = { 0 };
+    std::atomic<uint32_t> maxFramesInFlight = { 0 };
+    bool bInOrder = true;
+    uint64_t framesRendered = 0;
+};
+
+// The calling thread simulates, a second thread renders
+static void RunPipeline(SFramePipeline* pPipeline, SPipelineRun* pRun)
+{
+    std::thread renderThread([pPipeline, pRun]
+    {
+        uint32_t slot = 0;
+        while (pPipeline->BeginRender(&slot))
+        {
+            pRun->bInOrder = pRun->bInOrder && pRun->frameIds[slot] == pRun->framesRendered;
+            ++pRun->framesRendered;
+            pRun->framesInFlight.fetch_sub(1);
+            pPipeline->EndRender(slot);
+        }
+    });
+
+    for (uint64_t frameId = 0; frameId < kNumTestFrames; ++frameId)
+    {
+        const uint32_t slot = pPipeline->BeginSimulation();
+        const uint32_t framesInFlight = pRun->framesInFlight.fetch_add(1) + 1;
+        pRun->maxFramesInFlight = std::max(pRun->maxFramesInFlight.load(), framesInFlight);
+        pRun->frameIds[slot] = frameId;
+        pPipeline->EndSimulation(slot, TSteadyClock::now());
+    }
+
+    pPipeline->Stop();
+    renderThread.join();
+}
+
+void RunFramePipelineTests()
+{
+    { // configuration
+        SFramePipeline tooShallow;
+        TEST("frame pipeline: depth 0 rejected", !tooShallow.Initialize(0));
+        SFramePipeline tooDeep;
+        TEST("frame pipeline: depth above max rejected", !tooDeep.Initialize(kMaxFramePipelineDepth + 1));
+    } // ~configuration
+
+    { // stop with nothing published
+        SFramePipeline pipeline;
+        TEST("frame pipeline: initialize", pipeline.Initialize(2));
+        pipeline.Stop();
+        uint32_t slot = 0;
+        TEST("frame pipeline: render ends after stop", !pipeline.BeginRender(&slot));
+
+        SFramePipelineStats stats;
+        pipeline.GetStats(&stats);
+        TEST("frame pipeline: empty stats", stats.depth == 2 && stats.framesRendered == 0 && stats.framesPerSecond == 0);
+    } // ~stop with nothing published
+
+    for (uint32_t depth = 1; depth <= kMaxFramePipelineDepth; ++depth)
+    {
+        SFramePipeline pipeline;
+        TEST("frame pipeline: initialize", pipeline.Initialize(depth));
+
+        SPipelineRun run;
+        RunPipeline(&pipeline, &run);
+        TEST("frame pipeline: frames render in simulation order", run.bInOrder);
+        TEST("frame pipeline: every frame renders", run.framesRendered == kNumTestFrames);
+        TEST("frame pipeline: depth bounds frames in flight", run.maxFramesInFlight.load() <= depth);
+
+        SFramePipelineStats stats;
+        pipeline.GetStats(&stats);
+        TEST("frame pipeline: stats count frames", stats.depth == depth && stats.framesRendered == kNumTestFrames);
+        TEST("frame pipeline: stats measure latency", stats.averageLatencyMs >= 0 && stats.maxLatencyMs >= stats.averageLatencyMs);
+    }
+}
@@ -0,0 +1,108 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "input_tests.h"
+
+#include "platform/input.h"
+#include "tests/test_framework.h"
+
+using namespace platform;
+
+static constexpr TKeyCode kTestKeyA = 'a';
+static constexpr TKeyCode kTestKeyB = 'b';
+static constexpr TKeyCode kTestKeyC = 'c';
+static constexpr TKeyMod kTestShift = 0x0001;
+static constexpr TKeyMod kTestCtrl = 0x0040;
+static constexpr uint32_t kNumLayeredMaps = 8;
+static constexpr uint32_t kNumBindingsPerMap = 64;
+
+// Distinct bodies so the linker can't fold the handlers into one function
+static int g_lastTestHandler = 0;
+static void HandleBase(TKeyCode, TKeyMod, EKeyChange) { g_lastTestHandler = 1; }
+static void HandleBaseShift(TKeyCode, TKeyMod, EKeyChange) { g_lastTestHandler = 2; }
+static void HandleOverlay(TKeyCode, TKeyMod, EKeyChange) { g_lastTestHandler = 3; }
+static void HandleOverlayCtrl(TKeyCode, TKeyMod, EKeyChange) { g_lastTestHandler = 4; }
+
+typedef void (*TTestCallback)(TKeyCode, TKeyMod, EKeyChange);
+
+static TTestCallback FindCallback(const SActionMapStack& stack, TKeyCode keyCode, TKeyMod keyMod)
+{
+    const SActionHandler* pHandler = stack.Find(keyCode, keyMod);
+    return pHandler != nullptr ? pHandler->callback : nullptr;
+}
+
+void RunInputTests()
+{
+    { // action map priority
+        SActionMapStack stack;
+        stack.Push({
+            { kTestKeyA, kTestShift, HandleBaseShift },
+            { kTestKeyA, 0, HandleBase },
+            { kTestKeyA, kTestCtrl, HandleBaseShift }, // unreachable, the binding above takes any mods
+            { kTestKeyB, 0, HandleBase }
+        });
+
+        TEST("input: exact mods", FindCallback(stack, kTestKeyA, kTestShift) == HandleBaseShift);
+        TEST("input: any mods", FindCallback(stack, kTestKeyA, 0) == HandleBase && FindCallback(stack, kTestKeyA, kTestCtrl) == HandleBase);
+        TEST("input: unbound key", FindCallback(stack, kTestKeyC, 0) == nullptr);
+        TEST("input: unreachable bindings dropped", stack.GetCompiledHandlerCount() == 3);
+
+        const TActionMapId overlay = stack.Push({
+            { kTestKeyA, kTestCtrl, HandleOverlayCtrl },
+            { kTestKeyB, 0, HandleOverlay },
+            { kTestKeyC, kTestShift, HandleOverlayCtrl }
+        });
+
+        TEST("input: top map wins", FindCallback(stack, kTestKeyB, kTestShift) == HandleOverlay && FindCallback(stack, kTestKeyA, kTestCtrl) == HandleOverlayCtrl);
+        TEST("input: falls through to lower maps", FindCallback(stack, kTestKeyA, kTestShift) == HandleBaseShift && FindCallback(stack, kTestKeyA, 0) == HandleBase);
+        TEST("input: mods must match exactly", FindCallback(stack, kTestKeyC, 0) == nullptr && FindCallback(stack, kTestKeyC, kTestShift | kTestCtrl) == nullptr);
+
+        stack.Remove(overlay);
+        TEST("input: removing recompiles", stack.GetMapCount() == 1 && FindCallback(stack, kTestKeyB, 0) == HandleBase && FindCallback(stack, kTestKeyC, kTestShift) == nullptr);
+    } // ~action map priority
+
+    { // layered contexts
+        SActionMapStack stack;
+        for (uint32_t map = 0; map < kNumLayeredMaps; ++map)
+        {
+            TActionMap actionMap;
+            for (uint32_t binding = 0; binding < kNumBindingsPerMap; ++binding)
+            {
+                // Every map binds the same keys, the top one shadows the rest
+                actionMap.push_back({ TKeyCode(binding), 0, map == kNumLayeredMaps - 1 ? HandleOverlay : HandleBase });
+            }
+
+            stack.Push(std::move(actionMap));
+        }
+
+        bool bTopMapWins = true;
+        for (uint32_t binding = 0; binding < kNumBindingsPerMap; ++binding)
+        {
+            bTopMapWins &= FindCallback(stack, TKeyCode(binding), kTestShift) == HandleOverlay;
+        }
+
+        TEST("input: layered maps", bTopMapWins && stack.GetCompiledHandlerCount() == kNumBindingsPerMap);
+    } // ~layered contexts
+
+    { // input state
+        SInputState state;
+        state.BeginFrame();
+        state.AddKeyEvent(kTestKeyA, 0, EKeyChange::Pressed);
+        state.AddKeyEvent(kTestKeyB, 0, EKeyChange::Pressed);
+        state.AddKeyEvent(kTestKeyB, 0, EKeyChange::Released);
+        state.SetMouse(3, -4, 1);
+        TEST("input state: held keys", state.IsKeyDown(kTestKeyA) && !state.IsKeyDown(kTestKeyB));
+        TEST("input state: frame events", state.WasKeyPressed(kTestKeyB) && state.WasKeyReleased(kTestKeyB) && state.GetKeyEvents().size() == 3);
+        TEST("input state: mouse", state.GetMouseRelX() == 3 && state.GetMouseRelY() == -4 && state.GetMouseButtons() == 1);
+
+        state.BeginFrame();
+        TEST("input state: events reset per frame", state.GetKeyEvents().empty() && !state.WasKeyPressed(kTestKeyA) && state.GetMouseRelX() == 0);
+        TEST("input state: keys stay held", state.IsKeyDown(kTestKeyA));
+
+        state.AddKeyEvent(kTestKeyA, 0, EKeyChange::Released);
+        TEST("input state: release", !state.IsKeyDown(kTestKeyA) && state.WasKeyReleased(kTestKeyA));
+    } // ~input state
+}
@@ -0,0 +1,161 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "input_recording_tests.h"
+
+#include <cstddef>
+#include <vector>
+
+#include "platform/input_recording.h"
+#include "tests/test_framework.h"
+
+using namespace platform;
+
+static constexpr const char* kTestRecordingPath = "input_recording_test.dsir";
+static constexpr uint32_t kNumTestFrames = 32;
+static constexpr std::chrono::milliseconds kTestFrameDuration = std::chrono::milliseconds(8);
+
+static int32_t GetTestKeyCode(uint32_t frame)
+{
+    return 'a' + int32_t(frame % 26);
+}
+
+// Frame times vary like a real session with the odd hitch, replays must step by each of them
+static std::chrono::microseconds GetTestFrameDuration(uint32_t frame)
+{
+    return std::chrono::microseconds(frame % 5 == 4 ? 33000 : 8000 + frame * 10);
+}
+
+static void WriteTestRecording(bool bClose)
+{
+    SInputRecorder recorder;
+    TEST("input recording: open for recording", recorder.Open(kTestRecordingPath, kTestFrameDuration));
+    for (uint32_t frame = 0; frame < kNumTestFrames; ++frame)
+    {
+        // A key goes down every third frame and comes back up on the next one
+        if (frame % 3 == 0)
+        {
+            recorder.AddEvent({ frame * 8, GetTestKeyCode(frame), uint16_t(frame), EInputEventType::KeyDown });
+        }
+        else if (frame % 3 == 1)
+        {
+            recorder.AddEvent({ frame * 8, GetTestKeyCode(frame - 1), 0, EInputEventType::KeyUp });
+            recorder.AddEvent({ frame * 8 + 1, 0, 0, EInputEventType::Quit });
+        }
+
+        recorder.EndFrame(GetTestFrameDuration(frame), int32_t(frame), -int32_t(frame), frame & 1);
+    }
+
+    if (bClose)
+    {
+        TEST("input recording: close", recorder.Close() && !recorder.IsRecording());
+    }
+}
+
+// Truncates the recording mid way through its last frame, as if the process died while writing it
+static void TruncateTestRecording()
+{
+    std::vector<char> contents;
+    FILE* pFile = fopen(kTestRecordingPath, "rb");
+    if (pFile != nullptr)
+    {
+        char buffer[4096];
+        size_t bytesRead = 0;
+        while ((bytesRead = fread(buffer, 1, sizeof(buffer), pFile)) > 0)
+        {
+            contents.insert(contents.end(), buffer, buffer + bytesRead);
+        }
+
+        fclose(pFile);
+    }
+
+    contents.resize(contents.size() - 4);
+    const uint32_t frameCount = 0; // never closed
+    memcpy(contents.data() + offsetof(SInputRecordingHeader, frameCount), &frameCount, sizeof(frameCount));
+    pFile = fopen(kTestRecordingPath, "wb");
+    if (pFile != nullptr)
+    {
+        fwrite(contents.data(), 1, contents.size(), pFile);
+        fclose(pFile);
+    }
+}
+
+void RunInputRecordingTests()
+{
+    { // round trip
+        WriteTestRecording(true);
+
+        SInputPlayer player;
+        TEST("input recording: open for replay", player.Open(kTestRecordingPath) && player.IsReplaying());
+        TEST("input recording: frame count and duration", player.GetFrameCount() == kNumTestFrames && player.GetFrameDuration() == kTestFrameDuration);
+
+        bool bFramesMatch = true;
+        SInputFrameRecord frame;
+        std::vector<SInputEventRecord> events;
+        for (uint32_t i = 0; i < kNumTestFrames; ++i)
+        {
+            bFramesMatch &= player.GetNextFrameDuration() == GetTestFrameDuration(i);
+            bFramesMatch &= player.NextFrame(&frame, &events);
+            bFramesMatch &= frame.mouseRelX == int32_t(i) && frame.mouseRelY == -int32_t(i) && frame.mouseButtons == (i & 1);
+            if (i % 3 == 0)
+            {
+                bFramesMatch &= events.size() == 1 && events[0].type == EInputEventType::KeyDown && events[0].keyCode == GetTestKeyCode(i) && events[0].keyMod == i && events[0].timeMs == i * 8;
+            }
+            else if (i % 3 == 1)
+            {
+                bFramesMatch &= events.size() == 2 && events[0].type == EInputEventType::KeyUp && events[0].keyCode == GetTestKeyCode(i - 1) && events[1].type == EInputEventType::Quit;
+            }
+            else
+            {
+                bFramesMatch &= events.empty();
+            }
+        }
+
+        TEST("input recording: frames replay in order", bFramesMatch);
+        TEST("input recording: replay ends", !player.NextFrame(&frame, &events) && player.GetFrameIndex() == kNumTestFrames);
+        TEST("input recording: finished replays fall back to the target duration", player.GetNextFrameDuration() == kTestFrameDuration);
+    } // ~round trip
+
+    { // recordings cut short
+        WriteTestRecording(false);
+        TruncateTestRecording();
+
+        SInputPlayer player;
+        TEST("input recording: unclosed recording replays its complete frames", player.Open(kTestRecordingPath) && player.GetFrameCount() == kNumTestFrames - 1);
+    } // ~recordings cut short
+
+    { // invalid recordings
+        FILE* pFile = fopen(kTestRecordingPath, "wb");
+        if (pFile != nullptr)
+        {
+            SInputRecordingHeader header;
+            header.magic = kInputRecordingMagic + 1;
+            header.version = kInputRecordingVersion;
+            header.frameDurationNs = 1;
+            fwrite(&header, sizeof(header), 1, pFile);
+            fclose(pFile);
+        }
+
+        SInputPlayer player;
+        TEST("input recording: bad magic rejected", !player.Open(kTestRecordingPath) && !player.IsReplaying());
+
+        pFile = fopen(kTestRecordingPath, "wb");
+        if (pFile != nullptr)
+        {
+            SInputRecordingHeader header;
+            header.magic = kInputRecordingMagic;
+            header.version = kInputRecordingVersion - 1;
+            header.frameDurationNs = 1;
+            fwrite(&header, sizeof(header), 1, pFile);
+            fclose(pFile);
+        }
+
+        TEST("input recording: old versions rejected", !player.Open(kTestRecordingPath) && !player.IsReplaying());
+        TEST("input recording: missing file rejected", !player.Open("input_recording_test_missing.dsir"));
+    } // ~invalid recordings
+
+    remove(kTestRecordingPath);
+}
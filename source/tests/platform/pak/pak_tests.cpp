@@ -0,0 +1,179 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "pak_tests.h"
+
+#include "platform/pak.h"
+#include "tests/test_framework.h"
+
+using namespace platform;
+
+// OpenPakFromMemory needs 8 byte aligned storage, std::vector<char> only guarantees operator new alignment
+static std::vector<uint64_t> CopyAligned(const std::vector<char>& pak)
+{
+    std::vector<uint64_t> storage((pak.size() + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+    memcpy(storage.data(), pak.data(), pak.size());
+    return storage;
+}
+
+static bool FindMatches(const SPakArchive& archive, const char* path, const char* expected)
+{
+    const char* pData = nullptr;
+    size_t numBytes = 0;
+    return FindPakFile(archive, path, &pData, &numBytes)
+        && numBytes == strlen(expected)
+        && memcmp(pData, expected, numBytes) == 0;
+}
+
+void RunPakTests()
+{
+    if (kIsBigEndian)
+        return; // archives are little endian and read in place
+
+    const char* shaderData = "\x03\x02\x23\x07 spirv";
+    const char* imageData = "BM image";
+    const SPakBuildInput inputs[] =
+    {
+        { "data/shaders/sdf.frag.spv", shaderData, strlen(shaderData) },
+        { "data/images/tentacle.bmp", imageData, strlen(imageData) },
+        { "data/empty.txt", nullptr, 0 },
+    };
+
+    const size_t numInputs = sizeof(inputs) / sizeof(inputs[0]);
+    std::vector<char> pak;
+    TEST("pak: build", BuildPak(inputs, numInputs, SPakBuildOptions(), &pak));
+    TEST("pak: validates", ValidatePak(pak.data(), pak.size()) == EPakValidation::Valid);
+
+    const std::vector<uint64_t> storage = CopyAligned(pak);
+    const char* pPakData = (const char*)storage.data();
+    SPakArchive archive;
+    TEST("pak: open from memory", OpenPakFromMemory(pPakData, pak.size(), &archive));
+    TEST("pak: entry count", archive.pHeader != nullptr && archive.pHeader->entryCount == numInputs);
+    TEST("pak: find shader", FindMatches(archive, "data/shaders/sdf.frag.spv", shaderData));
+    TEST("pak: find image", FindMatches(archive, "data/images/tentacle.bmp", imageData));
+    TEST("pak: find empty file", FindMatches(archive, "data/empty.txt", ""));
+
+    {
+        const char* pData = nullptr;
+        size_t numBytes = 0;
+        TEST("pak: miss", !FindPakFile(archive, "data/shaders/sdf.vert.spv", &pData, &numBytes));
+        TEST("pak: miss on prefix", !FindPakFile(archive, "data/shaders/sdf.frag", &pData, &numBytes));
+        TEST("pak: miss on unmounted archive", !FindPakFile(SPakArchive(), "data/empty.txt", &pData, &numBytes));
+    }
+
+    {
+        bool bAligned = true;
+        for (uint32_t i = 0; i < archive.pHeader->entryCount; ++i)
+        {
+            bAligned = bAligned && archive.pEntries[i].dataOffset % kPakDataAlignment == 0;
+        }
+
+        TEST("pak: data is aligned", bAligned);
+    }
+
+    { // compression
+        std::vector<char> pattern(3 * kPakDefaultBlockSize + 1234);
+        for (size_t i = 0; i < pattern.size(); ++i)
+        {
+            pattern[i] = char((i % 251) ^ (i / 4096));
+        }
+
+        std::vector<char> noise(1000);
+        uint32_t state = 12345;
+        for (char& c : noise)
+        {
+            state = state * 1664525u + 1013904223u;
+            c = char(state >> 24);
+        }
+
+        const SPakBuildInput compressionInputs[] =
+        {
+            { "data/pattern.bin", pattern.data(), pattern.size(), true },
+            { "data/noise.bin", noise.data(), noise.size(), true },
+            { "data/stored.bin", pattern.data(), 4096, false },
+        };
+
+        std::vector<char> compressedPak;
+        TEST("pak: build compressed", BuildPak(compressionInputs, 3, SPakBuildOptions(), &compressedPak));
+        TEST("pak: compressed archive is smaller", compressedPak.size() < pattern.size() / 2);
+
+        const std::vector<uint64_t> compressedStorage = CopyAligned(compressedPak);
+        SPakArchive compressedArchive;
+        TEST("pak: open compressed", OpenPakFromMemory((const char*)compressedStorage.data(), compressedPak.size(), &compressedArchive));
+
+        const SPakEntry* pPattern = FindPakEntry(compressedArchive, "data/pattern.bin");
+        TEST("pak: compressed entry found", pPattern != nullptr && pPattern->size == pattern.size());
+        TEST("pak: compressed entry is flagged", pPattern->flags == EPakEntryFlags::Compressed && pPattern->storedSize < pattern.size());
+        TEST("pak: compressed entries have no view", !FindMatches(compressedArchive, "data/pattern.bin", ""));
+        TEST("pak: block count", GetPakBlockCount(compressedArchive, *pPattern) == 4);
+
+        std::vector<char> output(pattern.size());
+        TEST("pak: read compressed entry", ReadPakEntry(compressedArchive, *pPattern, output.data()) && output == pattern);
+
+        // blocks are independent, decode them back to front
+        std::fill(output.begin(), output.end(), 0);
+        bool bBlocksRead = true;
+        for (uint32_t i = GetPakBlockCount(compressedArchive, *pPattern); i > 0; --i)
+        {
+            bBlocksRead = bBlocksRead && ReadPakBlock(compressedArchive, *pPattern, i - 1, output.data());
+        }
+
+        TEST("pak: blocks decode out of order", bBlocksRead && output == pattern);
+
+        const SPakEntry* pNoise = FindPakEntry(compressedArchive, "data/noise.bin");
+        TEST("pak: incompressible entries are stored", pNoise != nullptr && pNoise->flags == EPakEntryFlags::None);
+        const SPakEntry* pStored = FindPakEntry(compressedArchive, "data/stored.bin");
+        const char* pStoredData = nullptr;
+        size_t storedBytes = 0;
+        TEST("pak: opted out entries have views",
+            pStored != nullptr
+            && GetPakEntryView(compressedArchive, *pStored, &pStoredData, &storedBytes)
+            && storedBytes == 4096
+            && memcmp(pStoredData, pattern.data(), 4096) == 0);
+
+        SPakBuildOptions uncompressed;
+        uncompressed.bCompress = false;
+        std::vector<char> uncompressedPak;
+        TEST("pak: compression can be disabled", BuildPak(compressionInputs, 3, uncompressed, &uncompressedPak) && uncompressedPak.size() > pattern.size());
+
+        // A bad block table is caught when the archive is opened
+        std::vector<char> corrupt = compressedPak;
+        const size_t lastBlockEndOffset = (size_t)pPattern->dataOffset + 3 * sizeof(uint32_t);
+        uint32_t lastBlockEnd;
+        memcpy(&lastBlockEnd, corrupt.data() + lastBlockEndOffset, sizeof(lastBlockEnd));
+        lastBlockEnd += 1;
+        memcpy(corrupt.data() + lastBlockEndOffset, &lastBlockEnd, sizeof(lastBlockEnd));
+        TEST("pak: detects bad block tables", ValidatePak(corrupt.data(), corrupt.size()) == EPakValidation::BadTableOfContents);
+    } // ~compression
+
+    {
+        const SPakBuildInput duplicates[] =
+        {
+            { "data/a.txt", "a", 1 },
+            { "data/a.txt", "b", 1 },
+        };
+
+        std::vector<char> duplicatePak;
+        TEST("pak: rejects duplicate paths", !BuildPak(duplicates, 2, SPakBuildOptions(), &duplicatePak));
+    }
+
+    {
+        std::vector<char> corrupt = pak;
+        corrupt[0] ^= 0xff;
+        TEST("pak: detects bad magic", ValidatePak(corrupt.data(), corrupt.size()) == EPakValidation::BadMagic);
+        TEST("pak: detects truncation", ValidatePak(pak.data(), pak.size() - 1) == EPakValidation::SizeMismatch);
+        TEST("pak: detects tiny files", ValidatePak(pak.data(), 4) == EPakValidation::TooSmall);
+
+        corrupt = pak;
+        SPakHeader header;
+        memcpy(&header, corrupt.data(), sizeof(header));
+        SPakEntry entry;
+        memcpy(&entry, corrupt.data() + sizeof(header), sizeof(entry));
+        entry.size = header.fileSize;
+        memcpy(corrupt.data() + sizeof(header), &entry, sizeof(entry));
+        TEST("pak: detects out of range entries", ValidatePak(corrupt.data(), corrupt.size()) == EPakValidation::BadTableOfContents);
+    }
+}
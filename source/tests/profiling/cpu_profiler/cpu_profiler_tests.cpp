@@ -0,0 +1,102 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "cpu_profiler_tests.h"
+
+#include <string>
+#include <thread>
+
+#include "profiling/cpu_profiler.h"
+#include "tests/test_framework.h"
+
+using namespace profiling;
+
+static constexpr const char* kTestTracePath = "cpu_profiler_test_trace.json";
+static constexpr uint32_t kTestEventsPerThread = 64;
+static constexpr uint32_t kNumSpamScopes = 100;
+
+static void ProfileOnThread()
+{
+    SetProfileThreadName("Test worker");
+    PROFILE_SCOPE("worker");
+}
+
+static std::string ReadTestTrace()
+{
+    std::string contents;
+    FILE* pFile = fopen(kTestTracePath, "rb");
+    if (pFile == nullptr)
+        return contents;
+
+    char buffer[4096];
+    size_t bytesRead = 0;
+    while ((bytesRead = fread(buffer, 1, sizeof(buffer), pFile)) > 0)
+    {
+        contents.append(buffer, bytesRead);
+    }
+
+    fclose(pFile);
+    return contents;
+}
+
+void RunCpuProfilerTests()
+{
+    SCpuProfilerConfig config;
+    config.eventsPerThread = kTestEventsPerThread;
+    TEST("cpu profiler: initialize", InitializeCpuProfiler(config));
+    SetProfileThreadName("Test main");
+
+    { // outside of a capture
+        PROFILE_SCOPE("not captured");
+        TEST("cpu profiler: idle until requested", !IsCpuCaptureActive());
+    }
+
+    TEST("cpu profiler: request capture", RequestCpuCapture(2, kTestTracePath));
+    TEST("cpu profiler: one request at a time", !RequestCpuCapture(2, kTestTracePath));
+
+    BeginProfileFrame(1);
+    TEST("cpu profiler: capture starts with the frame", IsCpuCaptureActive());
+    for (uint32_t i = 0; i < kNumSpamScopes; ++i)
+    {
+        PROFILE_SCOPE("spam");
+    }
+
+    std::thread worker(ProfileOnThread);
+    worker.join();
+
+    const TTime gpuBegin = TSteadyClock::now();
+    RecordGpuProfileEvent("SdfPass", gpuBegin, gpuBegin + std::chrono::microseconds(500));
+
+    BeginProfileFrame(2);
+    {
+        PROFILE_SCOPE("outer");
+        {
+            PROFILE_SCOPE("inner \"quoted\"");
+        }
+    }
+
+    BeginProfileFrame(3);
+    TEST("cpu profiler: capture ends after the requested frames", !IsCpuCaptureActive());
+
+    { // after the capture
+        PROFILE_SCOPE("not captured either");
+    }
+
+    SProfileCaptureStats stats;
+    GetLastCaptureStats(&stats);
+    TEST("cpu profiler: frames and threads", stats.numFrames == 2 && stats.numThreads == 2);
+    TEST("cpu profiler: ring keeps the newest events", stats.numEvents == kTestEventsPerThread + 2 && stats.numDroppedEvents == kNumSpamScopes + 2 - kTestEventsPerThread);
+
+    const std::string trace = ReadTestTrace();
+    TEST("cpu profiler: trace written", trace.find("\"traceEvents\":[") != std::string::npos && trace.rfind("]}") != std::string::npos);
+    TEST("cpu profiler: thread names", trace.find("\"Test main\"") != std::string::npos && trace.find("\"Test worker\"") != std::string::npos);
+    TEST("cpu profiler: gpu track", trace.find("\"GPU\"") != std::string::npos && trace.find("\"SdfPass\"") != std::string::npos);
+    TEST("cpu profiler: frame markers", trace.find("\"Frame 1\"") != std::string::npos && trace.find("\"Frame 2\"") != std::string::npos);
+    TEST("cpu profiler: names escaped", trace.find("\"inner \\\"quoted\\\"\"") != std::string::npos && trace.find("\"outer\"") != std::string::npos);
+    remove(kTestTracePath);
+
+    ShutdownCpuProfiler();
+}
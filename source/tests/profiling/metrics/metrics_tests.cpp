@@ -0,0 +1,148 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "metrics_tests.h"
+
+#include <string>
+
+#include "profiling/metrics.h"
+#include "tests/test_framework.h"
+
+using namespace profiling;
+
+static constexpr const char* kTestCsvPath = "metrics_test.csv";
+static constexpr const char* kTestJsonPath = "metrics_test.json";
+
+static std::string ReadTestFile(const char* path)
+{
+    std::string contents;
+    FILE* pFile = fopen(path, "rb");
+    if (pFile == nullptr)
+        return contents;
+
+    char buffer[4096];
+    size_t bytesRead = 0;
+    while ((bytesRead = fread(buffer, 1, sizeof(buffer), pFile)) > 0)
+    {
+        contents.append(buffer, bytesRead);
+    }
+
+    fclose(pFile);
+    return contents;
+}
+
+static bool IsWithinBucketError(uint64_t reported, uint64_t expected)
+{
+    const uint64_t error = reported > expected ? reported - expected : expected - reported;
+    return error <= expected / (1u << kHistogramSubBucketBits) + 1;
+}
+
+void RunMetricsTests()
+{
+    { // buckets
+        bool bMonotonic = true;
+        bool bBounded = true;
+        uint32_t lastIndex = 0;
+        for (uint64_t value = 0; value < 2000000; value += 1 + value / 100)
+        {
+            const uint32_t index = SHistogram::GetBucketIndex(value);
+            const uint64_t upperBound = SHistogram::GetBucketUpperBound(index);
+            bMonotonic &= index >= lastIndex;
+            bBounded &= upperBound >= value && IsWithinBucketError(upperBound, value);
+            lastIndex = index;
+        }
+
+        TEST("histogram: bucket indices grow with the value", bMonotonic);
+        TEST("histogram: buckets within the precision", bBounded);
+        TEST("histogram: small values exact", SHistogram::GetBucketUpperBound(SHistogram::GetBucketIndex(37)) == 37);
+        TEST("histogram: bucket edges", SHistogram::GetBucketIndex(UINT64_MAX) > SHistogram::GetBucketIndex(UINT64_MAX / 2) && SHistogram::GetBucketUpperBound(SHistogram::GetBucketIndex(UINT64_MAX)) == UINT64_MAX);
+    } // ~buckets
+
+    { // percentiles
+        SHistogram histogram;
+        TEST("histogram: initialize", histogram.Initialize(100000, 4));
+        for (uint64_t value = 1; value <= 10000; ++value)
+        {
+            histogram.Record(value);
+        }
+
+        SHistogramSummary summary;
+        histogram.GetSummary(&summary);
+        TEST("histogram: count and mean", summary.count == 10000 && summary.mean == 5000.5);
+        TEST("histogram: percentiles", IsWithinBucketError(summary.p50, 5000) && IsWithinBucketError(summary.p95, 9500) && IsWithinBucketError(summary.p99, 9900));
+        TEST("histogram: exact max", summary.max == 10000);
+
+        SHistogram clamped;
+        clamped.Initialize(1000, 2);
+        clamped.Record(10);
+        clamped.Record(1000000);
+        clamped.GetSummary(&summary);
+        TEST("histogram: values past the range clamp", summary.count == 2 && summary.max == 1000000 && summary.p99 >= 1000 && summary.p50 == 10);
+    } // ~percentiles
+
+    { // rolling window
+        SHistogram histogram;
+        histogram.Initialize(1000, 3);
+        histogram.Record(100);
+        histogram.Rotate();
+        histogram.Record(200);
+        histogram.Rotate();
+        histogram.Record(300);
+
+        SHistogramSummary summary;
+        histogram.GetSummary(&summary);
+        TEST("histogram: window covers every slice", summary.count == 3 && summary.max == 300);
+
+        histogram.Rotate();
+        histogram.GetSummary(&summary);
+        TEST("histogram: oldest slice falls out", summary.count == 2 && summary.mean == 250.0 && IsWithinBucketError(summary.p50, 200));
+    } // ~rolling window
+
+    { // registry
+        const TTime start = TSteadyClock::now();
+        SMetricsConfig config;
+        config.sliceMs = 100;
+        config.numSlices = 3;
+        config.dumpPath = kTestCsvPath;
+        config.dumpIntervalMs = 1000;
+
+        SMetricsRegistry registry;
+        TEST("metrics: invalid window rejected", !registry.Initialize(SMetricsConfig{ 100, 1, nullptr, 1000 }, start));
+        TEST("metrics: initialize", registry.Initialize(config, start));
+
+        SCounter* pFrames = registry.RegisterCounter("test.frames", "frames");
+        SGauge* pScale = registry.RegisterGauge("test.scale", "ratio");
+        SHistogram* pTime = registry.RegisterHistogram("test.time", "us", kMaxMetricDurationUs);
+        TEST("metrics: register", pFrames != nullptr && pScale != nullptr && pTime != nullptr);
+        TEST("metrics: names are unique", registry.RegisterCounter("test.frames", "frames") == pFrames && registry.RegisterGauge("test.frames", "frames") == nullptr);
+
+        pFrames->Add(5);
+        registry.Update(start + std::chrono::milliseconds(100));
+        pFrames->Add(3);
+        registry.Update(start + std::chrono::milliseconds(200));
+        registry.Update(start + std::chrono::milliseconds(300));
+        TEST("metrics: counter window", pFrames->Get() == 8 && registry.GetCounterWindowDelta(pFrames) == 3);
+
+        pScale->Set(0.75);
+        pTime->RecordDuration(start, start + std::chrono::microseconds(16667));
+        registry.Update(start + std::chrono::milliseconds(1000));
+
+        const std::string csv = ReadTestFile(kTestCsvPath);
+        TEST("metrics: csv header", csv.compare(0, 7, "time_s,") == 0);
+        TEST("metrics: csv rows", csv.find(",test.frames,counter,frames,0,,,,,,8\n") != std::string::npos && csv.find(",test.scale,gauge,ratio,,,,,,,0.75\n") != std::string::npos && csv.find(",test.time,histogram,us,1,16667.000,") != std::string::npos);
+
+        registry.Shutdown();
+        remove(kTestCsvPath);
+
+        config.dumpPath = kTestJsonPath;
+        TEST("metrics: json initialize", registry.Initialize(config, start));
+        registry.RegisterGauge("test.scale", "ratio")->Set(2.0);
+        TEST("metrics: json dump", registry.Dump(start + std::chrono::seconds(2)));
+        TEST("metrics: json rows", ReadTestFile(kTestJsonPath) == "{\"time_s\":2.000,\"metrics\":[{\"name\":\"test.scale\",\"kind\":\"gauge\",\"unit\":\"ratio\",\"value\":2}]}\n");
+        registry.Shutdown();
+        remove(kTestJsonPath);
+    } // ~registry
+}
@@ -0,0 +1,83 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "dynamic_resolution_tests.h"
+
+#include <cmath>
+
+#include "renderer/dynamic_resolution.h"
+#include "tests/test_framework.h"
+
+using namespace renderer;
+
+static bool NearlyEqual(float a, float b)
+{
+    return std::abs(a - b) < 0.0001f;
+}
+
+void RunDynamicResolutionTests()
+{
+    const SDynamicResolutionConfig config;
+
+    {
+        TEST("dynamic resolution: quantize rounds down", NearlyEqual(QuantizeRenderScale(config, 0.87f), 0.85f));
+        TEST("dynamic resolution: quantize exact step", NearlyEqual(QuantizeRenderScale(config, 0.7f), 0.7f));
+        TEST("dynamic resolution: quantize min", NearlyEqual(QuantizeRenderScale(config, 0.1f), config.minScale));
+        TEST("dynamic resolution: quantize max", NearlyEqual(QuantizeRenderScale(config, 2.0f), config.maxScale));
+    }
+
+    {
+        SDynamicResolutionState state;
+        bool bChanged = false;
+        for (uint32_t i = 0; i + 1 < config.cooldownFrames; ++i)
+        {
+            bChanged |= UpdateDynamicResolution(config, &state, 16.0);
+        }
+
+        TEST("dynamic resolution: waits for cooldown", !bChanged && state.scale == 1.0f);
+        TEST("dynamic resolution: drops when over budget", UpdateDynamicResolution(config, &state, 16.0) && state.scale < 1.0f);
+
+        // 16ms at full scale -> roughly sqrt(6.8 / 16) of the pixels per axis
+        TEST("dynamic resolution: drop is proportional", NearlyEqual(state.scale, 0.65f));
+        TEST("dynamic resolution: predicts new cost", state.filteredFrameMs < 16.0 && state.framesSinceChange == 0);
+    }
+
+    {
+        SDynamicResolutionState state;
+        state.scale = 0.5f;
+        bool bRaised = false;
+        for (uint32_t i = 0; i < config.cooldownFrames; ++i)
+        {
+            bRaised |= UpdateDynamicResolution(config, &state, 2.0);
+        }
+
+        TEST("dynamic resolution: raises one step when under budget", bRaised && NearlyEqual(state.scale, 0.55f));
+    }
+
+    {
+        SDynamicResolutionState state;
+        bool bChanged = false;
+        for (uint32_t i = 0; i < config.cooldownFrames * 4; ++i)
+        {
+            bChanged |= UpdateDynamicResolution(config, &state, config.budgetMs * 0.8);
+        }
+
+        TEST("dynamic resolution: holds inside the dead band", !bChanged && state.scale == 1.0f);
+    }
+
+    {
+        SDynamicResolutionState state;
+        state.scale = config.minScale;
+        bool bChanged = false;
+        for (uint32_t i = 0; i < config.cooldownFrames * 4; ++i)
+        {
+            bChanged |= UpdateDynamicResolution(config, &state, 100.0);
+        }
+
+        TEST("dynamic resolution: clamps at min scale", !bChanged && state.scale == config.minScale);
+        TEST("dynamic resolution: ignores invalid samples", !UpdateDynamicResolution(config, &state, 0.0));
+    }
+}
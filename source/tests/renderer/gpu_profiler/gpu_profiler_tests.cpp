@@ -0,0 +1,71 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "gpu_profiler_tests.h"
+
+#include <cmath>
+
+#include "renderer/gpu_profiler.h"
+#include "tests/test_framework.h"
+
+using namespace renderer;
+
+static bool NearlyEqual(double a, double b)
+{
+    return std::abs(a - b) < 0.000001;
+}
+
+void RunGpuProfilerTests()
+{
+    {
+        TEST("gpu profiler: timestamp delta", NearlyEqual(TimestampDeltaMs(1000, 3000000, 64, 1.0f), 2.999));
+        TEST("gpu profiler: timestamp period", NearlyEqual(TimestampDeltaMs(0, 1000000, 64, 2.5f), 2.5));
+        TEST("gpu profiler: timestamp 36 bit wrap", NearlyEqual(TimestampDeltaMs((1ull << 36) - 500000, 500000, 36, 1.0f), 1.0));
+    }
+
+    {
+        SGpuStatsHistory history;
+        SGpuFrameStats stats;
+        GetGpuFrameStats(history, &stats);
+        TEST("gpu profiler: empty history", stats.scopes[(size_t)EGpuScope::Frame].sampleCount == 0 && stats.scopes[(size_t)EGpuScope::Frame].averageMs == 0);
+
+        AddGpuScopeSample(&history, EGpuScope::SdfPass, 1.0);
+        AddGpuScopeSample(&history, EGpuScope::SdfPass, 3.0);
+        AddFragmentInvocationsSample(&history, 100);
+        AddFragmentInvocationsSample(&history, 300);
+        GetGpuFrameStats(history, &stats);
+        const SGpuScopeStats& pass = stats.scopes[(size_t)EGpuScope::SdfPass];
+        TEST("gpu profiler: sample count", pass.sampleCount == 2);
+        TEST("gpu profiler: last sample", NearlyEqual(pass.lastMs, 3.0));
+        TEST("gpu profiler: average", NearlyEqual(pass.averageMs, 2.0));
+        TEST("gpu profiler: max", NearlyEqual(pass.maxMs, 3.0));
+        TEST("gpu profiler: untouched scope", stats.scopes[(size_t)EGpuScope::SceneUpload].sampleCount == 0);
+        TEST("gpu profiler: invocations", stats.fragmentShaderInvocations == 300 && NearlyEqual(stats.averageFragmentShaderInvocations, 200.0));
+    }
+
+    {
+        // Window rolls over, only the most recent kGpuStatsWindow samples count
+        SGpuStatsHistory history;
+        for (size_t i = 0; i < kGpuStatsWindow; ++i)
+        {
+            AddGpuScopeSample(&history, EGpuScope::Frame, 10.0);
+        }
+
+        for (size_t i = 0; i < kGpuStatsWindow; ++i)
+        {
+            AddGpuScopeSample(&history, EGpuScope::Frame, 2.0);
+        }
+
+        AddGpuScopeSample(&history, EGpuScope::Frame, 4.0);
+        SGpuFrameStats stats;
+        GetGpuFrameStats(history, &stats);
+        const SGpuScopeStats& frame = stats.scopes[(size_t)EGpuScope::Frame];
+        TEST("gpu profiler: window size", frame.sampleCount == kGpuStatsWindow);
+        TEST("gpu profiler: window last", NearlyEqual(frame.lastMs, 4.0));
+        TEST("gpu profiler: window max", NearlyEqual(frame.maxMs, 4.0));
+        TEST("gpu profiler: window average", NearlyEqual(frame.averageMs, (2.0 * (kGpuStatsWindow - 1) + 4.0) / kGpuStatsWindow));
+    }
+}
@@ -0,0 +1,107 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "pipeline_cache_tests.h"
+
+#include "renderer/pipeline_cache.h"
+#include "tests/test_framework.h"
+
+using namespace renderer;
+
+static SPipelineCacheKey MakeTestKey()
+{
+    SPipelineCacheKey key;
+    key.vendorId = 0x10de;
+    key.deviceId = 0x1b80;
+    key.driverVersion = 0x1c2e4000;
+    for (size_t i = 0; i < kPipelineCacheUUIDSize; ++i)
+    {
+        key.pipelineCacheUUID[i] = uint8_t(i * 7 + 1);
+    }
+
+    return key;
+}
+
+// Mimics the VkPipelineCacheHeaderVersionOne prefix written by drivers
+static std::vector<char> MakeDriverBlob(const SPipelineCacheKey& key, size_t payloadSize)
+{
+    std::vector<char> blob(32 + payloadSize);
+    const uint32_t header[4] = { 32, 1, key.vendorId, key.deviceId };
+    memcpy(blob.data(), header, sizeof(header));
+    memcpy(blob.data() + 16, key.pipelineCacheUUID, kPipelineCacheUUIDSize);
+    for (size_t i = 0; i < payloadSize; ++i)
+    {
+        blob[32 + i] = char(i);
+    }
+
+    return blob;
+}
+
+void RunPipelineCacheTests()
+{
+    if (kIsBigEndian)
+        return; // driver header fields are little endian, MakeDriverBlob writes native order
+
+    const SPipelineCacheKey key = MakeTestKey();
+    const std::vector<char> blob = MakeDriverBlob(key, 100);
+
+    {
+        std::vector<char> file;
+        BuildPipelineCacheFile(key, blob.data(), blob.size(), &file);
+        const char* pData = nullptr;
+        size_t dataSize = 0;
+        TEST("pipeline cache: round trip is valid", ValidatePipelineCacheFile(file.data(), file.size(), key, &pData, &dataSize) == EPipelineCacheValidation::Valid);
+        TEST("pipeline cache: round trip size", dataSize == blob.size());
+        TEST("pipeline cache: round trip data", pData != nullptr && memcmp(pData, blob.data(), blob.size()) == 0);
+    }
+
+    {
+        std::vector<char> file;
+        BuildPipelineCacheFile(key, blob.data(), blob.size(), &file);
+        SPipelineCacheKey newDriverKey = key;
+        newDriverKey.driverVersion += 1;
+        const char* pData = nullptr;
+        size_t dataSize = 0;
+        TEST("pipeline cache: driver update rejected", ValidatePipelineCacheFile(file.data(), file.size(), newDriverKey, &pData, &dataSize) == EPipelineCacheValidation::KeyMismatch);
+        TEST("pipeline cache: rejected file yields no data", pData == nullptr && dataSize == 0);
+
+        SPipelineCacheKey otherDeviceKey = key;
+        otherDeviceKey.pipelineCacheUUID[3] ^= 0xff;
+        TEST("pipeline cache: uuid mismatch rejected", ValidatePipelineCacheFile(file.data(), file.size(), otherDeviceKey, &pData, &dataSize) == EPipelineCacheValidation::KeyMismatch);
+    }
+
+    {
+        std::vector<char> file;
+        BuildPipelineCacheFile(key, blob.data(), blob.size(), &file);
+        const char* pData = nullptr;
+        size_t dataSize = 0;
+        TEST("pipeline cache: truncated header rejected", ValidatePipelineCacheFile(file.data(), 8, key, &pData, &dataSize) == EPipelineCacheValidation::TooSmall);
+        TEST("pipeline cache: truncated data rejected", ValidatePipelineCacheFile(file.data(), file.size() - 1, key, &pData, &dataSize) == EPipelineCacheValidation::SizeMismatch);
+
+        file.back() ^= 0x5a;
+        TEST("pipeline cache: corrupt data rejected", ValidatePipelineCacheFile(file.data(), file.size(), key, &pData, &dataSize) == EPipelineCacheValidation::HashMismatch);
+
+        file[0] ^= 0x5a;
+        TEST("pipeline cache: bad magic rejected", ValidatePipelineCacheFile(file.data(), file.size(), key, &pData, &dataSize) == EPipelineCacheValidation::BadMagic);
+    }
+
+    {
+        std::vector<char> badBlob = blob;
+        badBlob[8] ^= 0x01; // driver header vendor id
+        std::vector<char> file;
+        BuildPipelineCacheFile(key, badBlob.data(), badBlob.size(), &file);
+        const char* pData = nullptr;
+        size_t dataSize = 0;
+        TEST("pipeline cache: driver header mismatch rejected", ValidatePipelineCacheFile(file.data(), file.size(), key, &pData, &dataSize) == EPipelineCacheValidation::BadDriverHeader);
+    }
+
+    {
+        char fileName[256];
+        TEST("pipeline cache: file name", MakePipelineCacheFileName("cache", key, fileName, sizeof(fileName)));
+        TEST("pipeline cache: file name contents", strcmp(fileName, "cache/pipeline_cache_10de_1b80_1c2e4000_01080f161d242b323940474e555c636a.bin") == 0);
+        TEST("pipeline cache: file name overflow", !MakePipelineCacheFileName("cache", key, fileName, 16));
+    }
+}
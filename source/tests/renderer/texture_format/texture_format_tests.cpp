@@ -0,0 +1,122 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "texture_format_tests.h"
+
+#include "renderer/texture_format.h"
+#include "tests/test_framework.h"
+
+using namespace renderer;
+
+static std::vector<uint8_t> MakeSolid(uint32_t width, uint32_t height, const uint8_t* pRgba)
+{
+    std::vector<uint8_t> texels(size_t(width) * height * 4);
+    for (size_t i = 0; i < texels.size(); ++i)
+    {
+        texels[i] = pRgba[i % 4];
+    }
+
+    return texels;
+}
+
+// OpenTexture needs 8 byte aligned storage
+static std::vector<uint64_t> CopyAligned(const std::vector<char>& file)
+{
+    std::vector<uint64_t> storage((file.size() + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+    memcpy(storage.data(), file.data(), file.size());
+    return storage;
+}
+
+void RunTextureFormatTests()
+{
+    if (kIsBigEndian)
+        return; // headers are little endian and read in place
+
+    { // sizes
+        TEST("texture: mip count 1x1", GetFullMipCount(1, 1) == 1);
+        TEST("texture: mip count 200x200", GetFullMipCount(200, 200) == 8);
+        TEST("texture: mip count 256x16", GetFullMipCount(256, 16) == 9);
+
+        STextureFormatInfo rgba;
+        STextureFormatInfo bc1;
+        STextureFormatInfo bc3;
+        TEST("texture: known formats", GetTextureFormatInfo(kVkFormatR8G8B8A8Unorm, &rgba) && GetTextureFormatInfo(kVkFormatBC1RgbaUnorm, &bc1) && GetTextureFormatInfo(kVkFormatBC3Unorm, &bc3));
+        TEST("texture: unknown format", !GetTextureFormatInfo(0, &rgba));
+        TEST("texture: rgba level size", GetTextureLevelSize(rgba, 3, 5) == 3 * 5 * 4);
+        TEST("texture: bc1 level size rounds to blocks", GetTextureLevelSize(bc1, 5, 1) == 2 * 8);
+        TEST("texture: bc3 level size", GetTextureLevelSize(bc3, 8, 8) == 4 * 16);
+    } // ~sizes
+
+    { // mips
+        const uint8_t color[4] = { 10, 200, 30, 255 };
+        const std::vector<uint8_t> solid = MakeSolid(7, 3, color);
+        std::vector<std::vector<uint8_t>> levels;
+        GenerateMipChain(solid.data(), 7, 3, GetFullMipCount(7, 3), false, &levels);
+        TEST("texture: mip chain length", levels.size() == 3);
+        TEST("texture: mip level sizes", levels[1].size() == 3 * 1 * 4 && levels[2].size() == 1 * 1 * 4);
+        TEST("texture: solid colors survive filtering", levels[2] == std::vector<uint8_t>(color, color + 4));
+
+        const uint8_t checker[2 * 2 * 4] = { 0, 0, 0, 0, 255, 255, 255, 255, 255, 255, 255, 255, 0, 0, 0, 0 };
+        GenerateMipChain(checker, 2, 2, 2, false, &levels);
+        TEST("texture: box filter", levels[1][0] == 128 && levels[1][3] == 128);
+
+        GenerateMipChain(checker, 2, 2, 2, true, &levels);
+        TEST("texture: srgb filter averages in linear space", levels[1][0] == 188 && levels[1][3] == 128);
+    } // ~mips
+
+    { // bc1
+        const uint8_t color[4] = { 255, 0, 0, 255 };
+        const std::vector<uint8_t> solid = MakeSolid(4, 4, color);
+        uint8_t block[8];
+        EncodeBC1(solid.data(), 4, 4, block);
+        const uint16_t color0 = uint16_t(block[0] | (block[1] << 8));
+        TEST("texture: bc1 endpoint is pure red", color0 == 0xf800);
+        TEST("texture: bc1 solid block uses one index", block[4] == 0 && block[5] == 0 && block[6] == 0 && block[7] == 0);
+    } // ~bc1
+
+    { // cook and open
+        const uint8_t color[4] = { 1, 2, 3, 4 };
+        const std::vector<uint8_t> solid = MakeSolid(20, 12, color);
+        SCookTextureOptions options;
+        std::vector<char> file;
+        TEST("texture: cook", CookTexture(solid.data(), 20, 12, options, &file));
+        TEST("texture: cooked file validates", ValidateTexture(file.data(), file.size()) == ETextureValidation::Valid);
+
+        const std::vector<uint64_t> storage = CopyAligned(file);
+        STextureView view;
+        TEST("texture: open", OpenTexture((const char*)storage.data(), file.size(), &view));
+        TEST("texture: header", view.pHeader->width == 20 && view.pHeader->height == 12 && view.pHeader->mipCount == 5);
+
+        bool bLevelsValid = true;
+        for (uint32_t i = 0; i < view.pHeader->mipCount; ++i)
+        {
+            const STextureLevel& level = view.pLevels[i];
+            bLevelsValid = bLevelsValid
+                && level.offset % kTextureLevelAlignment == 0
+                && level.size == size_t(level.width) * level.height * 4
+                && memcmp(view.pData + level.offset, color, 4) == 0;
+        }
+
+        TEST("texture: levels are aligned and filled", bLevelsValid);
+        TEST("texture: level 0 is a straight copy", memcmp(view.pData, solid.data(), solid.size()) == 0);
+
+        options.bMips = false;
+        options.vkFormat = kVkFormatBC3Unorm;
+        TEST("texture: cook bc3 without mips", CookTexture(solid.data(), 20, 12, options, &file) && ValidateTexture(file.data(), file.size()) == ETextureValidation::Valid);
+
+        std::vector<char> corrupt = file;
+        corrupt[0] ^= 0xff;
+        TEST("texture: detects bad magic", ValidateTexture(corrupt.data(), corrupt.size()) == ETextureValidation::BadMagic);
+        TEST("texture: detects truncation", ValidateTexture(file.data(), file.size() - 1) == ETextureValidation::SizeMismatch);
+
+        corrupt = file;
+        STextureHeader header;
+        memcpy(&header, corrupt.data(), sizeof(header));
+        header.vkFormat = 1;
+        memcpy(corrupt.data(), &header, sizeof(header));
+        TEST("texture: detects unknown formats", ValidateTexture(corrupt.data(), corrupt.size()) == ETextureValidation::UnknownFormat);
+    } // ~cook and open
+}
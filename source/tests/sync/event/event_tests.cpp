@@ -0,0 +1,132 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "event_tests.h"
+
+#include <thread>
+#include <vector>
+
+#include "sync/event.h"
+#include "tests/test_framework.h"
+
+using namespace synchronization;
+
+static constexpr uint32_t kNumTestThreads = 4;
+
+void RunEventTests()
+{
+    { // manual reset event
+        SEvent event;
+        TEST("event: starts unsignaled", !event.IsSet());
+        TEST("event: wait times out", !event.Wait(1));
+
+        std::atomic<uint32_t> numReleased = { 0 };
+        std::vector<std::thread> threads;
+        for (uint32_t i = 0; i < kNumTestThreads; ++i)
+        {
+            threads.emplace_back([&event, &numReleased]
+            {
+                if (event.Wait())
+                {
+                    ++numReleased;
+                }
+            });
+        }
+
+        event.Set();
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        TEST("event: set releases every waiter", numReleased.load() == kNumTestThreads);
+        TEST("event: manual reset stays set", event.IsSet() && event.Wait(0));
+        event.Reset();
+        TEST("event: reset", !event.IsSet());
+    } // ~manual reset event
+
+    { // auto reset event
+        SEvent event(true);
+        event.Set();
+        TEST("event: auto reset releases one wait", event.Wait(0));
+        TEST("event: auto reset clears on release", !event.IsSet() && !event.Wait(1));
+
+        // ping pong, every Set must be consumed by exactly one Wait
+        SEvent ping(true);
+        SEvent pong(true);
+        std::thread other([&ping, &pong]
+        {
+            for (uint32_t i = 0; i < 1000; ++i)
+            {
+                ping.Wait();
+                pong.Set();
+            }
+        });
+
+        bool bAllAnswered = true;
+        for (uint32_t i = 0; i < 1000; ++i)
+        {
+            ping.Set();
+            bAllAnswered = pong.Wait(5000) && bAllAnswered;
+        }
+
+        other.join();
+        TEST("event: auto reset ping pong", bAllAnswered);
+    } // ~auto reset event
+
+    { // semaphore
+        SSemaphore semaphore;
+        TEST("semaphore: empty", !semaphore.TryAcquire() && !semaphore.Acquire(1));
+        semaphore.Release(3);
+        const bool bThreeAcquired = semaphore.TryAcquire() && semaphore.TryAcquire() && semaphore.Acquire();
+        TEST("semaphore: release adds to the count", bThreeAcquired && !semaphore.TryAcquire());
+
+        std::atomic<uint32_t> numAcquired = { 0 };
+        std::vector<std::thread> threads;
+        for (uint32_t i = 0; i < kNumTestThreads; ++i)
+        {
+            threads.emplace_back([&semaphore, &numAcquired]
+            {
+                for (uint32_t j = 0; j < 100; ++j)
+                {
+                    semaphore.Acquire();
+                    ++numAcquired;
+                }
+            });
+        }
+
+        for (uint32_t i = 0; i < kNumTestThreads * 100; ++i)
+        {
+            semaphore.Release();
+        }
+
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        TEST("semaphore: every release is acquired once", numAcquired.load() == kNumTestThreads * 100 && semaphore.GetCount() == 0);
+    } // ~semaphore
+
+    { // waitable counter
+        SWaitableCounter counter(kNumTestThreads);
+        TEST("waitable counter: wait times out", !counter.WaitFor(0, 1));
+
+        std::vector<std::thread> threads;
+        for (uint32_t i = 0; i < kNumTestThreads; ++i)
+        {
+            threads.emplace_back([&counter] { counter.Subtract(1); });
+        }
+
+        TEST("waitable counter: wait for zero", counter.WaitFor(0));
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        TEST("waitable counter: add returns the new value", counter.Add(5) == 5 && counter.Subtract(2) == 3 && counter.Load() == 3);
+    } // ~waitable counter
+}
@@ -0,0 +1,98 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "mutex_tests.h"
+
+#include <thread>
+#include <vector>
+
+#include "sync/mutex.h"
+#include "tests/test_framework.h"
+
+using namespace synchronization;
+
+static constexpr uint32_t kNumTestThreads = 4;
+static constexpr uint32_t kIterationsPerThread = 20000;
+
+void RunMutexTests()
+{
+    { // mutex
+        SMutex mutex;
+        TEST("mutex: try lock when free", mutex.TryLock());
+        TEST("mutex: try lock when held", !mutex.TryLock());
+        mutex.Unlock();
+
+        uint64_t total = 0; // guarded by mutex
+        std::vector<std::thread> threads;
+        for (uint32_t i = 0; i < kNumTestThreads; ++i)
+        {
+            threads.emplace_back([&mutex, &total]
+            {
+                for (uint32_t j = 0; j < kIterationsPerThread; ++j)
+                {
+                    SLockGuard<SMutex> lock(mutex);
+                    ++total;
+                }
+            });
+        }
+
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        TEST("mutex: contended increments are exclusive", total == uint64_t(kNumTestThreads) * kIterationsPerThread);
+    } // ~mutex
+
+    { // reader/writer lock
+        SRWLock lock;
+        lock.LockShared();
+        TEST("rw lock: readers share", lock.TryLockShared());
+        TEST("rw lock: readers exclude writers", !lock.TryLock());
+        lock.UnlockShared();
+        lock.UnlockShared();
+        TEST("rw lock: writer lock when free", lock.TryLock());
+        TEST("rw lock: writers exclude readers", !lock.TryLockShared());
+        lock.Unlock();
+
+        // writers keep both values equal, readers must never see them differ
+        uint64_t values[2] = { 0, 0 };
+        std::atomic<bool> bTorn = { false };
+        std::vector<std::thread> threads;
+        for (uint32_t i = 0; i < kNumTestThreads; ++i)
+        {
+            const bool bWriter = i % 2 == 0;
+            threads.emplace_back([&lock, &values, &bTorn, bWriter]
+            {
+                for (uint32_t j = 0; j < kIterationsPerThread / 4; ++j)
+                {
+                    if (bWriter)
+                    {
+                        SLockGuard<SRWLock> writeLock(lock);
+                        ++values[0];
+                        ++values[1];
+                    }
+                    else
+                    {
+                        SSharedLockGuard readLock(lock);
+                        if (values[0] != values[1])
+                        {
+                            bTorn = true;
+                        }
+                    }
+                }
+            });
+        }
+
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        TEST("rw lock: readers never see a partial write", !bTorn.load());
+        TEST("rw lock: writes are exclusive", values[0] == uint64_t(kNumTestThreads / 2) * (kIterationsPerThread / 4) && values[0] == values[1]);
+    } // ~reader/writer lock
+}
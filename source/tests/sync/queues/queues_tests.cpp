@@ -0,0 +1,128 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "queues_tests.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "sync/queues.h"
+#include "tests/test_framework.h"
+
+using namespace synchronization;
+
+static constexpr uint32_t kNumProducers = 2;
+static constexpr uint32_t kNumConsumers = 2;
+static constexpr uint32_t kValuesPerProducer = 20000;
+
+void RunQueuesTests()
+{
+    { // mpmc
+        std::unique_ptr<SMpmcQueue<uint32_t, 8>> pSmallQueue = std::make_unique<SMpmcQueue<uint32_t, 8>>();
+        bool bPushed = true;
+        for (uint32_t i = 0; i < 8; ++i)
+        {
+            bPushed = pSmallQueue->TryPush(i) && bPushed;
+        }
+
+        TEST("mpmc: fills to capacity", bPushed && pSmallQueue->GetApproximateSize() == 8);
+        TEST("mpmc: push fails when full", !pSmallQueue->TryPush(8));
+
+        bool bInOrder = true;
+        uint32_t value = 0;
+        for (uint32_t i = 0; i < 8; ++i)
+        {
+            bInOrder = pSmallQueue->TryPop(&value) && value == i && bInOrder;
+        }
+
+        TEST("mpmc: fifo", bInOrder);
+        TEST("mpmc: pop fails when empty", !pSmallQueue->TryPop(&value));
+
+        // every value pushed by every producer is popped exactly once
+        std::unique_ptr<SMpmcQueue<uint32_t, 1024>> pQueue = std::make_unique<SMpmcQueue<uint32_t, 1024>>();
+        std::vector<std::atomic<uint8_t>> seen(kNumProducers * kValuesPerProducer);
+        std::atomic<uint32_t> numPopped = { 0 };
+        std::vector<std::thread> threads;
+        for (uint32_t i = 0; i < kNumProducers; ++i)
+        {
+            threads.emplace_back([&pQueue, i]
+            {
+                for (uint32_t j = 0; j < kValuesPerProducer; ++j)
+                {
+                    while (!pQueue->TryPush(i * kValuesPerProducer + j))
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        for (uint32_t i = 0; i < kNumConsumers; ++i)
+        {
+            threads.emplace_back([&pQueue, &seen, &numPopped]
+            {
+                uint32_t popped = 0;
+                while (numPopped.load() < kNumProducers * kValuesPerProducer)
+                {
+                    if (pQueue->TryPop(&popped))
+                    {
+                        seen[popped].fetch_add(1);
+                        numPopped.fetch_add(1);
+                    }
+                    else
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        bool bEachOnce = true;
+        for (const std::atomic<uint8_t>& count : seen)
+        {
+            bEachOnce = bEachOnce && count.load() == 1;
+        }
+
+        TEST("mpmc: concurrent values delivered exactly once", bEachOnce);
+    } // ~mpmc
+
+    { // spsc
+        std::unique_ptr<SSpscQueue<uint32_t, 256>> pQueue = std::make_unique<SSpscQueue<uint32_t, 256>>();
+        uint32_t value = 0;
+        TEST("spsc: pop fails when empty", !pQueue->TryPop(&value));
+
+        std::thread producer([&pQueue]
+        {
+            for (uint32_t i = 0; i < kValuesPerProducer; ++i)
+            {
+                while (!pQueue->TryPush(i))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        bool bInOrder = true;
+        for (uint32_t i = 0; i < kValuesPerProducer; ++i)
+        {
+            while (!pQueue->TryPop(&value))
+            {
+                std::this_thread::yield();
+            }
+
+            bInOrder = bInOrder && value == i;
+        }
+
+        producer.join();
+        TEST("spsc: values arrive in order", bInOrder && pQueue->GetApproximateSize() == 0);
+    } // ~spsc
+}
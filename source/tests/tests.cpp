@@ -8,10 +8,34 @@
 
 #include <cstdio>
 
+#include "tests/compression/lz/lz_tests.h"
+#include "tests/ecs/world/world_tests.h"
+#include "tests/game/game_state/game_state_tests.h"
+#include "tests/game/transform_hierarchy/transform_hierarchy_tests.h"
+#include "tests/jobs/job_system/job_system_tests.h"
+#include "tests/logging/logger/logger_tests.h"
 #include "tests/math/geometry/geometry_tests.h"
 #include "tests/math/quaternion/quaternion_tests.h"
 #include "tests/math/matrix/matrix_tests.h"
 #include "tests/math/vector/vector_tests.h"
+#include "tests/memory/frame_arena/frame_arena_tests.h"
+#include "tests/memory/pool_allocator/pool_allocator_tests.h"
+#include "tests/platform/async_io/async_io_tests.h"
+#include "tests/platform/fixed_timestep/fixed_timestep_tests.h"
+#include "tests/platform/frame_pacer/frame_pacer_tests.h"
+#include "tests/platform/frame_pipeline/frame_pipeline_tests.h"
+#include "tests/platform/input/input_tests.h"
+#include "tests/platform/input_recording/input_recording_tests.h"
+#include "tests/platform/pak/pak_tests.h"
+#include "tests/profiling/cpu_profiler/cpu_profiler_tests.h"
+#include "tests/profiling/metrics/metrics_tests.h"
+#include "tests/renderer/dynamic_resolution/dynamic_resolution_tests.h"
+#include "tests/renderer/gpu_profiler/gpu_profiler_tests.h"
+#include "tests/renderer/pipeline_cache/pipeline_cache_tests.h"
+#include "tests/renderer/texture_format/texture_format_tests.h"
+#include "tests/sync/event/event_tests.h"
+#include "tests/sync/mutex/mutex_tests.h"
+#include "tests/sync/queues/queues_tests.h"
 
 void RunTests()
 {
@@ -19,5 +43,29 @@ void RunTests()
     RunVectorTests();
     RunMatrixTests();
     RunQuaternionTests();
+    RunPipelineCacheTests();
+    RunGpuProfilerTests();
+    RunDynamicResolutionTests();
+    RunLzTests();
+    RunPakTests();
+    RunAsyncIOTests();
+    RunTextureFormatTests();
+    RunJobSystemTests();
+    RunMutexTests();
+    RunEventTests();
+    RunQueuesTests();
+    RunFramePipelineTests();
+    RunWorldTests();
+    RunTransformHierarchyTests();
+    RunGameStateTests();
+    RunFrameArenaTests();
+    RunPoolAllocatorTests();
+    RunCpuProfilerTests();
+    RunLoggerTests();
+    RunMetricsTests();
+    RunFramePacerTests();
+    RunFixedTimestepTests();
+    RunInputTests();
+    RunInputRecordingTests();
     DiracLog(1, "[DiracSea] tests successful");
 }
\ No newline at end of file
@@ -0,0 +1,178 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "compression/lz.h"
+#include "platform/pak.h"
+
+#include <thread>
+#include <vector>
+
+/////////////////////////////////////////////////////////
+// LzBenchmark
+//
+// Usage: LzBenchmark <file>...
+// Compresses each file in pak sized blocks and reports the ratio, compression throughput, and decode throughput
+// on one thread and with the blocks spread over every hardware thread.
+
+static constexpr double kMinBenchmarkSeconds = 0.25; // repeat each measurement until at least this long
+
+struct SBlock
+{
+    size_t srcOffset = 0;
+    size_t srcSize = 0;
+    std::vector<char> compressed; // empty when stored raw
+};
+
+static bool ReadWholeFile(const char* fileName, std::vector<char>* pOutData)
+{
+    FILE* pFile = fopen(fileName, "rb");
+    if (pFile == nullptr)
+        return false;
+
+    fseek(pFile, 0, SEEK_END);
+    const long fileSize = ftell(pFile);
+    fseek(pFile, 0, SEEK_SET);
+    bool bSuccess = fileSize >= 0;
+    if (bSuccess)
+    {
+        pOutData->resize((size_t)fileSize);
+        bSuccess = fread(pOutData->data(), 1, pOutData->size(), pFile) == pOutData->size();
+    }
+
+    fclose(pFile);
+    return bSuccess;
+}
+
+// Runs function until kMinBenchmarkSeconds have passed, returns MB/s for numBytes per run
+template <typename F>
+static double MeasureThroughput(size_t numBytes, F function)
+{
+    size_t runs = 0;
+    const TTime startTime = TSteadyClock::now();
+    TSeconds elapsed(0);
+    do
+    {
+        function();
+        ++runs;
+        elapsed = TSteadyClock::now() - startTime;
+    } while (elapsed.count() < kMinBenchmarkSeconds);
+
+    return double(numBytes) * double(runs) / elapsed.count() / (1024.0 * 1024.0);
+}
+
+static bool DecodeBlocks(const std::vector<char>& source, const std::vector<SBlock>& blocks, size_t first, size_t step, char* pOut)
+{
+    bool bSuccess = true;
+    for (size_t i = first; i < blocks.size(); i += step)
+    {
+        const SBlock& block = blocks[i];
+        if (block.compressed.empty())
+        {
+            memcpy(pOut + block.srcOffset, source.data() + block.srcOffset, block.srcSize);
+        }
+        else
+        {
+            bSuccess &= compression::LzDecompressBlock(block.compressed.data(), block.compressed.size(), pOut + block.srcOffset, block.srcSize);
+        }
+    }
+
+    return bSuccess;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        DiracError("usage: %s <file>...", argv[0]);
+        return eRR_Error;
+    }
+
+    const size_t blockSize = platform::kPakDefaultBlockSize;
+    const uint32_t numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    DiracLog(1, "%-40s %12s %12s %8s %12s %12s %12s", "file", "bytes", "compressed", "ratio", "comp MB/s", "dec MB/s", "dec MB/s MT");
+
+    size_t totalBytes = 0;
+    size_t totalCompressed = 0;
+    for (int arg = 1; arg < argc; ++arg)
+    {
+        std::vector<char> source;
+        if (!ReadWholeFile(argv[arg], &source) || source.empty())
+        {
+            DiracError("[LzBenchmark] failed to read %s", argv[arg]);
+            return eRR_Error;
+        }
+
+        std::vector<SBlock> blocks((source.size() + blockSize - 1) / blockSize);
+        std::vector<char> scratch(compression::LzCompressBound(blockSize));
+        size_t compressedBytes = 0;
+        const double compressMBs = MeasureThroughput(source.size(), [&]
+        {
+            compressedBytes = 0;
+            for (size_t i = 0; i < blocks.size(); ++i)
+            {
+                SBlock& block = blocks[i];
+                block.srcOffset = i * blockSize;
+                block.srcSize = std::min(blockSize, source.size() - block.srcOffset);
+                const size_t size = compression::LzCompressBlock(source.data() + block.srcOffset, block.srcSize, scratch.data(), scratch.size());
+                if (size > 0 && size < block.srcSize)
+                {
+                    block.compressed.assign(scratch.data(), scratch.data() + size);
+                }
+                else
+                {
+                    block.compressed.clear();
+                }
+
+                compressedBytes += block.compressed.empty() ? block.srcSize : size;
+            }
+        });
+
+        std::vector<char> output(source.size());
+        bool bValid = true;
+        const double decodeMBs = MeasureThroughput(source.size(), [&]
+        {
+            bValid &= DecodeBlocks(source, blocks, 0, 1, output.data());
+        });
+
+        bValid &= output == source;
+
+        const double decodeThreadedMBs = MeasureThroughput(source.size(), [&]
+        {
+            std::vector<std::thread> threads;
+            for (uint32_t t = 0; t < numThreads; ++t)
+            {
+                threads.emplace_back([&, t] { DecodeBlocks(source, blocks, t, numThreads, output.data()); });
+            }
+
+            for (std::thread& thread : threads)
+            {
+                thread.join();
+            }
+        });
+
+        bValid &= output == source;
+        if (!bValid)
+        {
+            DiracError("[LzBenchmark] round trip failed for %s", argv[arg]);
+            return eRR_Error;
+        }
+
+        DiracLog(1, "%-40s %12zu %12zu %7.2fx %12.1f %12.1f %12.1f",
+            argv[arg],
+            source.size(),
+            compressedBytes,
+            double(source.size()) / double(compressedBytes),
+            compressMBs,
+            decodeMBs,
+            decodeThreadedMBs);
+
+        totalBytes += source.size();
+        totalCompressed += compressedBytes;
+    }
+
+    DiracLog(1, "total %zu -> %zu bytes (%.2fx), %u decode threads", totalBytes, totalCompressed, double(totalBytes) / double(totalCompressed), numThreads);
+    return eRR_Success;
+}
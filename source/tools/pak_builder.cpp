@@ -0,0 +1,123 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "platform/pak.h"
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+/////////////////////////////////////////////////////////
+// PakBuilder
+//
+// Usage: PakBuilder [--no-compress] <out.pak> <directory>...
+// Packs every regular file under each directory, LZ compressed unless --no-compress is passed or it doesn't pay off. Paths are stored relative to the working directory with
+// forward slashes, so run it from the directory the game runs from, e.g. "PakBuilder data.pak data".
+
+static bool ReadWholeFile(const char* fileName, std::vector<char>* pOutData)
+{
+    FILE* pFile = fopen(fileName, "rb");
+    if (pFile == nullptr)
+        return false;
+
+    fseek(pFile, 0, SEEK_END);
+    const long fileSize = ftell(pFile);
+    fseek(pFile, 0, SEEK_SET);
+    bool bSuccess = fileSize >= 0;
+    if (bSuccess)
+    {
+        pOutData->resize((size_t)fileSize);
+        bSuccess = fread(pOutData->data(), 1, pOutData->size(), pFile) == pOutData->size();
+    }
+
+    fclose(pFile);
+    return bSuccess;
+}
+
+int main(int argc, char** argv)
+{
+    platform::SPakBuildOptions options;
+    int firstArg = 1;
+    if (argc > 1 && strcmp(argv[1], "--no-compress") == 0)
+    {
+        options.bCompress = false;
+        ++firstArg;
+    }
+
+    if (argc - firstArg < 2)
+    {
+        DiracError("usage: %s [--no-compress] <out.pak> <directory>...", argv[0]);
+        return eRR_Error;
+    }
+
+    const char* outFileName = argv[firstArg];
+    std::vector<std::string> paths;
+    for (int i = firstArg + 1; i < argc; ++i)
+    {
+        std::error_code error;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(argv[i], error))
+        {
+            if (entry.is_regular_file())
+            {
+                paths.push_back(entry.path().generic_string());
+            }
+        }
+
+        if (error)
+        {
+            DiracError("[PakBuilder] failed to read directory %s: %s", argv[i], error.message().c_str());
+            return eRR_Error;
+        }
+    }
+
+    // deterministic archives regardless of directory iteration order
+    std::sort(paths.begin(), paths.end());
+
+    std::vector<std::vector<char>> fileData(paths.size());
+    std::vector<platform::SPakBuildInput> inputs(paths.size());
+    size_t totalBytes = 0;
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        if (!ReadWholeFile(paths[i].c_str(), &fileData[i]))
+        {
+            DiracError("[PakBuilder] failed to read %s", paths[i].c_str());
+            return eRR_Error;
+        }
+
+        inputs[i].path = paths[i].c_str();
+        inputs[i].pData = fileData[i].data();
+        inputs[i].numBytes = fileData[i].size();
+        totalBytes += fileData[i].size();
+    }
+
+    std::vector<char> pak;
+    if (!platform::BuildPak(inputs.data(), inputs.size(), options, &pak))
+        return eRR_Error;
+
+    FILE* pFile = fopen(outFileName, "wb");
+    if (pFile == nullptr)
+    {
+        DiracError("[PakBuilder] failed to open %s for writing", outFileName);
+        return eRR_Error;
+    }
+
+    const bool bWritten = fwrite(pak.data(), 1, pak.size(), pFile) == pak.size();
+    const bool bClosed = fclose(pFile) == 0;
+    if (!bWritten || !bClosed)
+    {
+        DiracError("[PakBuilder] failed to write %s", outFileName);
+        return eRR_Error;
+    }
+
+    DiracLog(1, "[PakBuilder] %s: %zu files, %zu bytes of data, %zu bytes total (%.1f%%)",
+        outFileName,
+        paths.size(),
+        totalBytes,
+        pak.size(),
+        totalBytes > 0 ? 100.0 * double(pak.size()) / double(totalBytes) : 100.0);
+    return eRR_Success;
+}
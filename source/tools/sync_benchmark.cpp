@@ -0,0 +1,333 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "sync/event.h"
+#include "sync/mutex.h"
+#include "sync/queues.h"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+/////////////////////////////////////////////////////////
+// SyncBenchmark
+//
+// Usage: SyncBenchmark [opsPerThread]
+// Runs each synchronization primitive against its std equivalent with 2 to 64 threads and reports millions of
+// operations per second across all threads. Threads are released together from a spinning start line so thread
+// creation isn't timed.
+
+static constexpr uint32_t kThreadCounts[] = { 2, 4, 8, 16, 32, 64 };
+static constexpr uint32_t kDefaultOpsPerThread = 50000;
+static constexpr uint32_t kReadsPerWrite = 16;
+static constexpr size_t kQueueCapacity = 1024;
+
+using namespace synchronization;
+
+// Counting semaphore built the textbook way, the baseline for SSemaphore
+struct SStdSemaphore
+{
+    void Release()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++count;
+        }
+
+        condition.notify_one();
+    }
+
+    void Acquire()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this] { return count > 0; });
+        --count;
+    }
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    uint32_t count = 0;
+};
+
+struct SStdQueue
+{
+    bool TryPush(uint32_t value)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (values.size() >= kQueueCapacity)
+            return false;
+
+        values.push_back(value);
+        return true;
+    }
+
+    bool TryPop(uint32_t* pOutValue)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (values.empty())
+            return false;
+
+        *pOutValue = values.front();
+        values.pop_front();
+        return true;
+    }
+
+    std::mutex mutex;
+    std::deque<uint32_t> values;
+};
+
+// Padded so neighbouring threads' results don't share a line while the benchmark runs
+struct alignas(kCacheLineSize) SThreadResult
+{
+    uint64_t value = 0;
+};
+
+// Runs function(threadIndex) on numThreads threads, returns millions of operations per second for totalOps
+template <typename F>
+static double MeasureThreads(uint32_t numThreads, uint64_t totalOps, F function)
+{
+    std::atomic<uint32_t> numReady = { 0 };
+    std::atomic<bool> bGo = { false };
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < numThreads; ++i)
+    {
+        threads.emplace_back([&, i]
+        {
+            numReady.fetch_add(1);
+            while (!bGo.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+
+            function(i);
+        });
+    }
+
+    while (numReady.load() < numThreads)
+    {
+        std::this_thread::yield();
+    }
+
+    const TTime startTime = TSteadyClock::now();
+    bGo.store(true, std::memory_order_release);
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    const TSeconds elapsed = TSteadyClock::now() - startTime;
+    return double(totalOps) / elapsed.count() / 1000000.0;
+}
+
+static void LogResult(const char* name, uint32_t numThreads, double syncMops, double stdMops)
+{
+    DiracLog(1, "%-24s %8u %12.2f %12.2f %8.2fx", name, numThreads, syncMops, stdMops, syncMops / stdMops);
+}
+
+// Every thread increments one shared counter under the lock
+template <typename TLock>
+static double MeasureContendedCounter(uint32_t numThreads, uint32_t opsPerThread, bool* pValid)
+{
+    TLock lock;
+    uint64_t counter = 0;
+    const double mops = MeasureThreads(numThreads, uint64_t(numThreads) * opsPerThread, [&](uint32_t)
+    {
+        for (uint32_t i = 0; i < opsPerThread; ++i)
+        {
+            lock.lock();
+            ++counter;
+            lock.unlock();
+        }
+    });
+
+    *pValid &= counter == uint64_t(numThreads) * opsPerThread;
+    return mops;
+}
+
+// One write for every kReadsPerWrite reads of a small table
+template <typename TLock>
+static double MeasureMostlyReads(uint32_t numThreads, uint32_t opsPerThread, bool* pValid)
+{
+    TLock lock;
+    uint64_t table[8] = {};
+    std::unique_ptr<SThreadResult[]> pSums(new SThreadResult[numThreads]);
+    const double mops = MeasureThreads(numThreads, uint64_t(numThreads) * opsPerThread, [&](uint32_t threadIndex)
+    {
+        for (uint32_t i = 0; i < opsPerThread; ++i)
+        {
+            if (i % kReadsPerWrite == 0)
+            {
+                lock.lock();
+                ++table[i % 8];
+                lock.unlock();
+            }
+            else
+            {
+                lock.lock_shared();
+                pSums[threadIndex].value += table[i % 8];
+                lock.unlock_shared();
+            }
+        }
+    });
+
+    uint64_t totalWrites = 0;
+    for (uint64_t value : table)
+    {
+        totalWrites += value;
+    }
+
+    *pValid &= totalWrites == uint64_t(numThreads) * ((opsPerThread + kReadsPerWrite - 1) / kReadsPerWrite);
+    return mops;
+}
+
+// Half the threads release, half acquire, every release wakes a consumer
+template <typename TSemaphore>
+static double MeasureHandoff(uint32_t numThreads, uint32_t opsPerThread)
+{
+    TSemaphore semaphore;
+    const uint32_t numPairs = numThreads / 2;
+    return MeasureThreads(numPairs * 2, uint64_t(numPairs) * opsPerThread, [&](uint32_t threadIndex)
+    {
+        const bool bProducer = threadIndex < numPairs;
+        for (uint32_t i = 0; i < opsPerThread; ++i)
+        {
+            if (bProducer)
+            {
+                semaphore.Release();
+            }
+            else
+            {
+                semaphore.Acquire();
+            }
+        }
+    });
+}
+
+// Half the threads push, half pop, counts a push and its pop as one operation
+template <typename TQueue>
+static double MeasureQueue(TQueue* pQueue, uint32_t numThreads, uint32_t opsPerThread, bool* pValid)
+{
+    const uint32_t numProducers = std::max(numThreads / 2, 1u);
+    const uint32_t numConsumers = std::max(numThreads - numProducers, 1u);
+    const uint64_t totalOps = uint64_t(numProducers) * opsPerThread;
+    std::atomic<uint64_t> numPopped = { 0 };
+    std::unique_ptr<SThreadResult[]> pSums(new SThreadResult[numConsumers]);
+    const double mops = MeasureThreads(numProducers + numConsumers, totalOps, [&](uint32_t threadIndex)
+    {
+        if (threadIndex < numProducers)
+        {
+            for (uint32_t i = 0; i < opsPerThread; ++i)
+            {
+                while (!pQueue->TryPush(i))
+                {
+                    std::this_thread::yield(); // 64 threads oversubscribe most machines, pure spinning starves the other side
+                }
+            }
+        }
+        else
+        {
+            uint32_t value = 0;
+            while (numPopped.load(std::memory_order_relaxed) < totalOps)
+            {
+                if (pQueue->TryPop(&value))
+                {
+                    pSums[threadIndex - numProducers].value += value;
+                    numPopped.fetch_add(1, std::memory_order_relaxed);
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    });
+
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < numConsumers; ++i)
+    {
+        sum += pSums[i].value;
+    }
+
+    *pValid &= sum == uint64_t(numProducers) * (uint64_t(opsPerThread) * (opsPerThread - 1) / 2);
+    return mops;
+}
+
+// std style names so the same measurement drives both implementations
+struct SMutexAdapter : SMutex
+{
+    void lock() { Lock(); }
+    void unlock() { Unlock(); }
+};
+
+struct SRWLockAdapter : SRWLock
+{
+    void lock() { Lock(); }
+    void unlock() { Unlock(); }
+    void lock_shared() { LockShared(); }
+    void unlock_shared() { UnlockShared(); }
+};
+
+int main(int argc, char** argv)
+{
+    const uint32_t opsPerThread = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 10) : kDefaultOpsPerThread;
+    if (opsPerThread == 0)
+    {
+        DiracError("usage: %s [opsPerThread]", argv[0]);
+        return eRR_Error;
+    }
+
+    bool bValid = true;
+    DiracLog(1, "%-24s %8s %12s %12s %9s", "benchmark", "threads", "sync Mops/s", "std Mops/s", "speedup");
+    for (uint32_t numThreads : kThreadCounts)
+    {
+        LogResult("mutex contended", numThreads,
+            MeasureContendedCounter<SMutexAdapter>(numThreads, opsPerThread, &bValid),
+            MeasureContendedCounter<std::mutex>(numThreads, opsPerThread, &bValid));
+    }
+
+    for (uint32_t numThreads : kThreadCounts)
+    {
+        LogResult("rw lock mostly reads", numThreads,
+            MeasureMostlyReads<SRWLockAdapter>(numThreads, opsPerThread, &bValid),
+            MeasureMostlyReads<std::shared_mutex>(numThreads, opsPerThread, &bValid));
+    }
+
+    for (uint32_t numThreads : kThreadCounts)
+    {
+        LogResult("semaphore handoff", numThreads,
+            MeasureHandoff<SSemaphore>(numThreads, opsPerThread),
+            MeasureHandoff<SStdSemaphore>(numThreads, opsPerThread));
+    }
+
+    for (uint32_t numThreads : kThreadCounts)
+    {
+        std::unique_ptr<SMpmcQueue<uint32_t, kQueueCapacity>> pMpmcQueue = std::make_unique<SMpmcQueue<uint32_t, kQueueCapacity>>();
+        std::unique_ptr<SStdQueue> pStdQueue = std::make_unique<SStdQueue>();
+        LogResult("mpmc queue", numThreads,
+            MeasureQueue(pMpmcQueue.get(), numThreads, opsPerThread, &bValid),
+            MeasureQueue(pStdQueue.get(), numThreads, opsPerThread, &bValid));
+    }
+
+    { // spsc, one producer and one consumer by definition
+        std::unique_ptr<SSpscQueue<uint32_t, kQueueCapacity>> pSpscQueue = std::make_unique<SSpscQueue<uint32_t, kQueueCapacity>>();
+        std::unique_ptr<SStdQueue> pStdQueue = std::make_unique<SStdQueue>();
+        LogResult("spsc queue", 2,
+            MeasureQueue(pSpscQueue.get(), 2, opsPerThread, &bValid),
+            MeasureQueue(pStdQueue.get(), 2, opsPerThread, &bValid));
+    } // ~spsc
+
+    if (!bValid)
+    {
+        DiracError("[SyncBenchmark] a primitive produced the wrong result");
+        return eRR_Error;
+    }
+
+    return eRR_Success;
+}
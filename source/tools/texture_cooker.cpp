@@ -0,0 +1,232 @@
+/* Copyright (C) Chad McKinney - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "diracsea.h"
+#include "renderer/texture_format.h"
+
+#include <vector>
+
+/////////////////////////////////////////////////////////
+// TextureCooker
+//
+// Usage: TextureCooker [--format=rgba8|rgba8-srgb|bc1|bc1-srgb|bc3|bc3-srgb] [--no-mips] <in.bmp> <out.dtex>
+// Converts an uncompressed 24 or 32 bit BMP to a .dtex with a full mip chain, see renderer/texture_format.h.
+
+struct SFormatName
+{
+    const char* name;
+    uint32_t vkFormat;
+};
+
+static const SFormatName kFormatNames[] =
+{
+    { "rgba8", renderer::kVkFormatR8G8B8A8Unorm },
+    { "rgba8-srgb", renderer::kVkFormatR8G8B8A8Srgb },
+    { "bc1", renderer::kVkFormatBC1RgbaUnorm },
+    { "bc1-srgb", renderer::kVkFormatBC1RgbaSrgb },
+    { "bc3", renderer::kVkFormatBC3Unorm },
+    { "bc3-srgb", renderer::kVkFormatBC3Srgb },
+};
+
+static bool ReadWholeFile(const char* fileName, std::vector<uint8_t>* pOutData)
+{
+    FILE* pFile = fopen(fileName, "rb");
+    if (pFile == nullptr)
+        return false;
+
+    fseek(pFile, 0, SEEK_END);
+    const long fileSize = ftell(pFile);
+    fseek(pFile, 0, SEEK_SET);
+    bool bSuccess = fileSize >= 0;
+    if (bSuccess)
+    {
+        pOutData->resize((size_t)fileSize);
+        bSuccess = fread(pOutData->data(), 1, pOutData->size(), pFile) == pOutData->size();
+    }
+
+    fclose(pFile);
+    return bSuccess;
+}
+
+static uint32_t ReadLittleEndian32(const uint8_t* pData)
+{
+    return uint32_t(pData[0]) | (uint32_t(pData[1]) << 8) | (uint32_t(pData[2]) << 16) | (uint32_t(pData[3]) << 24);
+}
+
+static uint8_t ExtractChannel(uint32_t pixel, uint32_t mask)
+{
+    if (mask == 0)
+        return 255;
+
+    uint32_t shift = 0;
+    while (((mask >> shift) & 1) == 0)
+    {
+        ++shift;
+    }
+
+    const uint32_t maxValue = mask >> shift;
+    return uint8_t(((pixel & mask) >> shift) * 255 / maxValue);
+}
+
+// BI_RGB 24/32 bit and BI_BITFIELDS 32 bit, output is RGBA8 top row first
+static bool DecodeBmp(const std::vector<uint8_t>& file, std::vector<uint8_t>* pOutRgba, uint32_t* pOutWidth, uint32_t* pOutHeight)
+{
+    static constexpr uint32_t kBiRgb = 0;
+    static constexpr uint32_t kBiBitfields = 3;
+    if (file.size() < 54 || file[0] != 'B' || file[1] != 'M')
+        return false;
+
+    const uint32_t pixelOffset = ReadLittleEndian32(&file[10]);
+    const uint32_t infoSize = ReadLittleEndian32(&file[14]);
+    const int32_t width = (int32_t)ReadLittleEndian32(&file[18]);
+    const int32_t signedHeight = (int32_t)ReadLittleEndian32(&file[22]);
+    const uint32_t bitsPerPixel = uint32_t(file[28]) | (uint32_t(file[29]) << 8);
+    const uint32_t compression = ReadLittleEndian32(&file[30]);
+    if (width <= 0 || signedHeight == 0 || (bitsPerPixel != 24 && bitsPerPixel != 32))
+        return false;
+
+    uint32_t masks[4] = { 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000 }; // r, g, b, a
+    if (compression == kBiBitfields && bitsPerPixel == 32)
+    {
+        // in the info header for V4/V5, directly after a 40 byte header otherwise
+        if (file.size() < 14 + 40 + 12)
+            return false;
+
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            masks[i] = ReadLittleEndian32(&file[54 + i * 4]);
+        }
+
+        masks[3] = infoSize >= 56 ? ReadLittleEndian32(&file[66]) : 0;
+    }
+    else if (compression != kBiRgb)
+    {
+        return false;
+    }
+
+    const bool bTopDown = signedHeight < 0;
+    const uint32_t height = (uint32_t)(bTopDown ? -signedHeight : signedHeight);
+    const size_t bytesPerPixel = bitsPerPixel / 8;
+    const size_t rowStride = (size_t(width) * bytesPerPixel + 3) & ~size_t(3);
+    if (pixelOffset > file.size() || rowStride * height > file.size() - pixelOffset)
+        return false;
+
+    pOutRgba->resize(size_t(width) * height * 4);
+    bool bAnyAlpha = false;
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        const uint8_t* pRow = &file[pixelOffset + rowStride * (bTopDown ? y : height - 1 - y)];
+        uint8_t* pDst = &(*pOutRgba)[size_t(y) * width * 4];
+        for (int32_t x = 0; x < width; ++x)
+        {
+            const uint8_t* pPixel = pRow + x * bytesPerPixel;
+            const uint32_t pixel = bytesPerPixel == 4
+                ? ReadLittleEndian32(pPixel)
+                : uint32_t(pPixel[0]) | (uint32_t(pPixel[1]) << 8) | (uint32_t(pPixel[2]) << 16) | 0xff000000;
+
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                pDst[x * 4 + c] = ExtractChannel(pixel, masks[c]);
+            }
+
+            bAnyAlpha |= pDst[x * 4 + 3] != 0;
+        }
+    }
+
+    // BI_RGB 32 bit files usually leave the fourth byte as zero padding rather than alpha
+    if (!bAnyAlpha)
+    {
+        for (size_t i = 3; i < pOutRgba->size(); i += 4)
+        {
+            (*pOutRgba)[i] = 255;
+        }
+    }
+
+    *pOutWidth = (uint32_t)width;
+    *pOutHeight = height;
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    renderer::SCookTextureOptions options;
+    const char* fileNames[2] = { nullptr, nullptr };
+    size_t numFileNames = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strncmp(argv[i], "--format=", 9) == 0)
+        {
+            bool bFound = false;
+            for (const SFormatName& format : kFormatNames)
+            {
+                if (strcmp(argv[i] + 9, format.name) == 0)
+                {
+                    options.vkFormat = format.vkFormat;
+                    bFound = true;
+                }
+            }
+
+            if (!bFound)
+            {
+                DiracError("[TextureCooker] unknown format: %s", argv[i] + 9);
+                return eRR_Error;
+            }
+        }
+        else if (strcmp(argv[i], "--no-mips") == 0)
+        {
+            options.bMips = false;
+        }
+        else if (numFileNames < 2)
+        {
+            fileNames[numFileNames++] = argv[i];
+        }
+    }
+
+    if (numFileNames != 2)
+    {
+        DiracError("usage: %s [--format=rgba8|rgba8-srgb|bc1|bc1-srgb|bc3|bc3-srgb] [--no-mips] <in.bmp> <out.dtex>", argv[0]);
+        return eRR_Error;
+    }
+
+    std::vector<uint8_t> bmp;
+    std::vector<uint8_t> rgba;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    if (!ReadWholeFile(fileNames[0], &bmp) || !DecodeBmp(bmp, &rgba, &width, &height))
+    {
+        DiracError("[TextureCooker] failed to read %s, expected an uncompressed 24 or 32 bit BMP", fileNames[0]);
+        return eRR_Error;
+    }
+
+    std::vector<char> texture;
+    if (!renderer::CookTexture(rgba.data(), width, height, options, &texture))
+        return eRR_Error;
+
+    FILE* pFile = fopen(fileNames[1], "wb");
+    if (pFile == nullptr)
+    {
+        DiracError("[TextureCooker] failed to open %s for writing", fileNames[1]);
+        return eRR_Error;
+    }
+
+    const bool bWritten = fwrite(texture.data(), 1, texture.size(), pFile) == texture.size();
+    const bool bClosed = fclose(pFile) == 0;
+    if (!bWritten || !bClosed)
+    {
+        DiracError("[TextureCooker] failed to write %s", fileNames[1]);
+        return eRR_Error;
+    }
+
+    renderer::STextureFormatInfo info;
+    renderer::GetTextureFormatInfo(options.vkFormat, &info);
+    DiracLog(1, "[TextureCooker] %s: %ux%u %s, %u mips, %zu bytes",
+        fileNames[1],
+        width,
+        height,
+        info.name,
+        options.bMips ? renderer::GetFullMipCount(width, height) : 1u,
+        texture.size());
+    return eRR_Success;
+}